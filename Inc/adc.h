@@ -8,6 +8,31 @@
  * This driver provides ADC1 (12-bit converter) functionality for
  * analog input measurement via PA1. Supports single and continuous
  * conversion modes using polling.
+ *
+ * Scan mode converts a list of up to 16 channels, each with its own
+ * sampling time, over and over. DMA2 Stream0 (channel 0) moves every
+ * result into a circular buffer of frames (one sample per channel per
+ * frame); half-transfer and transfer-complete interrupts hand each
+ * finished half of the buffer to a callback while the other half is
+ * being filled. No CPU time is spent per sample.
+ *
+ * Triggered mode runs the same sequence once per TIM3 TRGO event, so
+ * frames are spaced by an exact number of timer clocks instead of the
+ * free-running conversion time. DMA2 Stream0 runs in double buffer mode
+ * (ping/pong); each finished buffer is passed to a callback with the
+ * TIM5 microsecond time of its first frame, derived from the timer
+ * period so it does not depend on interrupt latency.
+ *
+ * Slow inputs are served by two helpers that keep the CPU out of the
+ * per-sample path: the analog watchdog interrupts only when a channel
+ * leaves a window, and the oversampling engine sums 4^n scan frames per
+ * channel and shifts by n for 12 + n bits at 1/4^n of the frame rate.
+ *
+ * The injected group (up to 4 channels) is converted on its own
+ * hardware trigger, e.g. a timer compare at a PWM edge. An injected
+ * trigger interrupts a running regular sequence, which resumes
+ * afterwards, and the results land in JDR1-JDR4 instead of the DMA
+ * stream, so priority samples never wait behind the scan.
  */
 
 #ifndef __ADC_H__
@@ -68,4 +93,364 @@ void startConversion(void);
  * @see startConversion()
  */
 uint32_t adcRead(void);
+
+/** ADC kernel clock: PCLK2 (16 MHz) / 2, ADCPRE reset value */
+#define ADC_CLK_FREQ            8000000U
+
+/** Maximum number of channels in a scan sequence */
+#define ADC_SCAN_MAX_CHANNELS   16U
+
+/** Internal reference voltage channel */
+#define ADC_CHANNEL_VREFINT     17U
+
+/** Internal temperature sensor channel (STM32F411: shared with VBAT) */
+#define ADC_CHANNEL_TEMP        18U
+
+/**
+ * @brief Sampling time of one channel in ADC clock cycles
+ */
+typedef enum
+{
+    ADC_SMP_3 = 0,      /**< 3 cycles */
+    ADC_SMP_15,         /**< 15 cycles */
+    ADC_SMP_28,         /**< 28 cycles */
+    ADC_SMP_56,         /**< 56 cycles */
+    ADC_SMP_84,         /**< 84 cycles */
+    ADC_SMP_112,        /**< 112 cycles */
+    ADC_SMP_144,        /**< 144 cycles */
+    ADC_SMP_480         /**< 480 cycles */
+} adcSampleTime_t;
+
+/**
+ * @brief One entry of the scan sequence
+ */
+typedef struct
+{
+    uint8_t channel;            /**< 0-15 (PA0-PA7, PB0-PB1, PC0-PC5), 17 or 18 */
+    adcSampleTime_t sampleTime; /**< Sampling time */
+} adcScanChannel_t;
+
+/**
+ * @brief Called from the DMA interrupt when half of the buffer is full
+ *
+ * The block stays valid until the DMA comes back to it, i.e. for the
+ * time it takes to fill the other half.
+ *
+ * @param samples First sample of the finished half, in scan order
+ *                (samples[frame * count + index])
+ * @param frames Number of frames in the block
+ */
+typedef void (*adcScanCallback_t)(const uint16_t *samples, uint16_t frames);
+
+/**
+ * @brief Configure ADC1 for continuous scan with circular DMA
+ *
+ * Sets the analog pins, the per-channel sampling times, the regular
+ * sequence and DMA2 Stream0. Conversions start with adcScanStart().
+ *
+ * @param[in] channels Scan sequence
+ * @param[in] count Number of channels (1-ADC_SCAN_MAX_CHANNELS)
+ * @param[out] buffer Circular buffer of frames * count samples
+ * @param[in] frames Frames in the buffer (even, frames * count <= 65535)
+ * @param[in] callback Half-buffer callback (may be 0)
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ * @note Takes over ADC1 from pa1ADCInit()
+ */
+uint8_t adcScanInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *buffer,
+                    uint16_t frames, adcScanCallback_t callback);
+
+/**
+ * @brief Start continuous scanning
+ *
+ * @return None
+ */
+void adcScanStart(void);
+
+/**
+ * @brief Stop scanning and the DMA stream
+ *
+ * @return None
+ */
+void adcScanStop(void);
+
+/**
+ * @brief Number of ADC overruns (DMA did not keep up)
+ *
+ * Each overrun restarts the buffer from its first frame (scan mode,
+ * oversampling sums discarded) or restarts the trigger timer with a new
+ * time base (triggered mode).
+ *
+ * @return Overrun count
+ */
+uint32_t adcScanGetOverruns(void);
+
+/**
+ * @brief Called from the DMA interrupt when a ping-pong buffer is full
+ *
+ * The buffer stays valid until the DMA comes back to it, i.e. for the
+ * time it takes to fill the other buffer.
+ *
+ * @param samples First sample of the buffer, in scan order
+ * @param frames Number of frames in the buffer
+ * @param timestamp Trigger time of the first frame (timGetMicros() scale)
+ */
+typedef void (*adcBlockCallback_t)(const uint16_t *samples, uint16_t frames, uint32_t timestamp);
+
+/**
+ * @brief Configure ADC1 for timer-triggered scans into ping-pong buffers
+ *
+ * Programs TIM3 for the requested frame rate (see tim3TrgoInit()), the
+ * sequence as adcScanInit() does and DMA2 Stream0 in double buffer mode.
+ * Acquisition starts with adcTrigStart().
+ *
+ * @param[in] channels Scan sequence
+ * @param[in] count Number of channels (1-ADC_SCAN_MAX_CHANNELS)
+ * @param[out] ping First buffer of frames * count samples
+ * @param[out] pong Second buffer of frames * count samples
+ * @param[in] frames Frames per buffer (frames * count <= 65535)
+ * @param[in] rateHz Frame rate (one scan of the sequence per trigger)
+ * @param[in] callback Buffer callback (may be 0)
+ *
+ * @return Timer clock ticks (TIM_CLK_FREQ) per frame, 0 if a parameter is
+ *         out of range or the sequence is too long for the rate
+ * @note The exact frame rate is TIM_CLK_FREQ / return value
+ */
+uint32_t adcTrigInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *ping, uint16_t *pong,
+                     uint16_t frames, uint32_t rateHz, adcBlockCallback_t callback);
+
+/**
+ * @brief Hand a new buffer to the DMA in place of the finished one
+ *
+ * Only valid inside the adcBlockCallback_t call: the buffer just passed
+ * to the callback is released to the caller and the DMA fills next
+ * after the buffer currently being written. Without this call the
+ * finished buffer is reused.
+ *
+ * @param[in] next Buffer of frames * count samples
+ *
+ * @return None
+ */
+void adcTrigReplaceBuffer(uint16_t *next);
+
+/**
+ * @brief Start timer-triggered acquisition
+ *
+ * @return None
+ * @note Starts the TIM5 time base if it is not running yet
+ */
+void adcTrigStart(void);
+
+/**
+ * @brief Stop the trigger timer and the DMA stream
+ *
+ * @return None
+ */
+void adcTrigStop(void);
+
+/** Watchdog guards every regular channel */
+#define ADC_WATCHDOG_ALL        0xFFU
+
+/** Largest number of extra bits of the oversampling engine */
+#define ADC_OVERSAMPLE_MAX_BITS 4U
+
+/**
+ * @brief Called from the ADC interrupt when the watchdog trips
+ *
+ * The watchdog is disarmed before the call so a signal that stays out
+ * of the window does not interrupt on every conversion; re-arm it with
+ * adcWatchdogArm() once the excursion has been handled.
+ *
+ * @param timestamp Time of the event (timGetMicros() scale)
+ */
+typedef void (*adcWatchdogCallback_t)(uint32_t timestamp);
+
+/**
+ * @brief Called every 4^bits frames with the oversampled results
+ *
+ * @param values One 12 + bits result per channel, in scan order
+ * @param count Number of channels
+ */
+typedef void (*adcOversampleCallback_t)(const uint16_t *values, uint8_t count);
+
+/**
+ * @brief Configure the analog watchdog on the regular group
+ *
+ * Works in scan and triggered mode; call it after adcScanInit() or
+ * adcTrigInit(). The watchdog trips when a conversion is below low or
+ * above high.
+ *
+ * @param[in] channel Guarded channel (0-18) or ADC_WATCHDOG_ALL
+ * @param[in] low Lower threshold (0-4095)
+ * @param[in] high Upper threshold (low-4095)
+ * @param[in] callback Event callback (may be 0)
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ * @note Starts the TIM5 time base if it is not running yet
+ * @note The watchdog is armed on return
+ */
+uint8_t adcWatchdogInit(uint8_t channel, uint16_t low, uint16_t high, adcWatchdogCallback_t callback);
+
+/**
+ * @brief Re-arm the watchdog after an event
+ *
+ * @return None
+ */
+void adcWatchdogArm(void);
+
+/**
+ * @brief Switch the watchdog off
+ *
+ * @return None
+ */
+void adcWatchdogDisable(void);
+
+/**
+ * @brief Number of watchdog events since adcWatchdogInit()
+ *
+ * @return Event count
+ */
+uint32_t adcWatchdogGetEvents(void);
+
+/**
+ * @brief Configure continuous scan with software oversampling
+ *
+ * Same as adcScanInit() with an internal half-buffer callback that adds
+ * every frame into one 32-bit accumulator per channel. After 4^bits
+ * frames each sum is shifted right by bits and the results are passed
+ * to the callback. Start and stop with adcScanStart()/adcScanStop().
+ *
+ * @param[in] channels Scan sequence
+ * @param[in] count Number of channels (1-ADC_SCAN_MAX_CHANNELS)
+ * @param[out] buffer Circular DMA buffer of frames * count samples
+ * @param[in] frames Frames in the buffer (even, frames * count <= 65535)
+ * @param[in] bits Extra bits (1-ADC_OVERSAMPLE_MAX_BITS): 2 gives 14-bit
+ *                 results from 16 frames, 4 gives 16-bit from 256 frames
+ * @param[in] callback Result callback
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ * @note The extra bits are only real if the input carries at least
+ *       1 LSB of noise; a clean DC input just gives the 12-bit value
+ */
+uint8_t adcOversampleInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *buffer,
+                          uint16_t frames, uint8_t bits, adcOversampleCallback_t callback);
+
+/** Maximum number of channels in the injected group */
+#define ADC_INJ_MAX_CHANNELS    4U
+
+/**
+ * @brief Injected group trigger (CR2 JEXTSEL), rising edge
+ */
+typedef enum
+{
+    ADC_JTRIG_TIM1_CC4 = 0,     /**< TIM1 compare 4 */
+    ADC_JTRIG_TIM1_TRGO,        /**< TIM1 TRGO */
+    ADC_JTRIG_TIM2_CC1,         /**< TIM2 compare 1 */
+    ADC_JTRIG_TIM2_TRGO,        /**< TIM2 TRGO */
+    ADC_JTRIG_TIM3_CC2,         /**< TIM3 compare 2 */
+    ADC_JTRIG_TIM3_CC4,         /**< TIM3 compare 4 */
+    ADC_JTRIG_TIM4_CC1,         /**< TIM4 compare 1 */
+    ADC_JTRIG_TIM4_CC2,         /**< TIM4 compare 2 */
+    ADC_JTRIG_TIM4_CC3,         /**< TIM4 compare 3 */
+    ADC_JTRIG_TIM4_TRGO,        /**< TIM4 TRGO */
+    ADC_JTRIG_TIM5_CC4,         /**< TIM5 compare 4 */
+    ADC_JTRIG_TIM5_TRGO,        /**< TIM5 TRGO */
+    ADC_JTRIG_EXTI15 = 15,      /**< EXTI line 15 */
+    ADC_JTRIG_SOFTWARE = 0xFF   /**< adcInjectedStart() only (JSWSTART) */
+} adcInjTrigger_t;
+
+/**
+ * @brief Called from the ADC interrupt when the injected group is done
+ *
+ * @param values One result per channel, in group order
+ * @param count Number of channels
+ * @param timestamp End of conversion time (timGetMicros() scale)
+ */
+typedef void (*adcInjectedCallback_t)(const uint16_t *values, uint8_t count, uint32_t timestamp);
+
+/**
+ * @brief Saved injected group, see adcInjectedSave()
+ */
+typedef struct
+{
+    uint32_t jsqr;                      /**< Sequence */
+    uint32_t cr2;                       /**< JEXTSEL and JEXTEN */
+    uint32_t smpr1;                     /**< Sampling times of channels 10-18 */
+    uint32_t count;                     /**< Number of channels */
+    adcInjTrigger_t trigger;            /**< Trigger */
+    adcInjectedCallback_t callback;     /**< JEOC callback */
+} adcInjState_t;
+
+/**
+ * @brief Configure the injected group
+ *
+ * Can be combined with any regular mode; sampling times are per channel
+ * and shared by both groups. In triggered mode each injected group
+ * adds its conversion time to the regular frame it interrupts.
+ *
+ * @param[in] channels Injected sequence
+ * @param[in] count Number of channels (1-ADC_INJ_MAX_CHANNELS)
+ * @param[in] trigger Hardware trigger or ADC_JTRIG_SOFTWARE
+ * @param[in] callback JEOC callback (may be 0)
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ * @note Triggers are ignored until adcInjectedStart()
+ * @note Starts the TIM5 time base if it is not running yet
+ */
+uint8_t adcInjectedInit(const adcScanChannel_t *channels, uint8_t count, adcInjTrigger_t trigger,
+                        adcInjectedCallback_t callback);
+
+/**
+ * @brief Enable the injected trigger
+ *
+ * With ADC_JTRIG_SOFTWARE this converts the group once.
+ *
+ * @return None
+ */
+void adcInjectedStart(void);
+
+/**
+ * @brief Ignore further injected triggers
+ *
+ * @return None
+ */
+void adcInjectedStop(void);
+
+/**
+ * @brief Stop the injected triggers and save the group configuration
+ *
+ * For a driver that borrows the injected group for a moment (see
+ * adcCalMeasure()): a group already started by its trigger is let
+ * finish, and its callback runs, before the function returns.
+ *
+ * @param[out] state Saved configuration
+ *
+ * @return 1 when the group is idle, 0 if a started group did not end
+ *         (nothing changed)
+ * @note Uses the ADC interrupt, so it must not be called from a handler
+ *       of equal or higher priority
+ */
+uint8_t adcInjectedSave(adcInjState_t *state);
+
+/**
+ * @brief Restore a configuration saved by adcInjectedSave()
+ *
+ * Triggers enabled at the time of the save are enabled again.
+ *
+ * @param[in] state Saved configuration
+ *
+ * @return None
+ */
+void adcInjectedRestore(const adcInjState_t *state);
+
+/**
+ * @brief DMA2 Stream0 interrupt handler (ADC1 half/full transfer)
+ */
+void DMA2_Stream0_IRQHandler(void);
+
+/**
+ * @brief ADC interrupt handler (overrun recovery, analog watchdog,
+ *        injected end of conversion)
+ */
+void ADC_IRQHandler(void);
 #endif // __ADC_H__
\ No newline at end of file
@@ -0,0 +1,145 @@
+/**
+ * @file adccal.h
+ * @brief Calibrated ADC engineering units (VDDA, millivolts, temperature)
+ *
+ * Converts raw 12-bit ADC counts to millivolts and degrees Celsius using
+ * the factory calibration values stored in system memory, with integer
+ * multiply and shift only per sample.
+ *
+ * @details
+ * Calibration data (RM0383, measured at VDDA = 3.3 V):
+ * - VREFINT_CAL : 0x1FFF7A2A, VREFINT counts at 30 degC
+ * - TS_CAL1     : 0x1FFF7A2C, temperature sensor counts at 30 degC
+ * - TS_CAL2     : 0x1FFF7A2E, temperature sensor counts at 110 degC
+ *
+ * Method:
+ * - VDDA = 3300 mV * VREFINT_CAL / VREFINT counts, from a VREFINT
+ *   sample (adcCalMeasure() or a VREFINT entry of a scan sequence)
+ * - Each VDDA update precomputes Q16 factors; conversions are then
+ *   mV = (raw * k) >> 16 and no division happens per sample
+ * - Temperature is normalized to VDDA = 3.3 V and interpolated between
+ *   the two calibration points with a Q8 slope, result in 0.01 degC
+ * - Nonlinear sensors (NTC dividers, ...) use adcCalLut_t tables built
+ *   at compile time: 2^n + 1 points evenly spaced over the 12-bit range,
+ *   indexed by shift and interpolated without division
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __ADCCAL_H__
+#define __ADCCAL_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** VDDA at which the factory values were measured (mV) */
+#define ADC_CAL_VDDA_REF_MV     3300U
+
+/** Temperatures of the two sensor calibration points (0.01 degC) */
+#define ADC_CAL_TEMP1_CDEG      3000
+#define ADC_CAL_TEMP2_CDEG      11000
+
+/**
+ * @brief Piecewise-linear conversion table
+ *
+ * Entry i is the value at raw = i << shift, so a table covers the
+ * 12-bit range with (4096 >> shift) + 1 entries, e.g. shift 7 = 33
+ * entries.
+ */
+typedef struct
+{
+    const int16_t *points;  /**< (4096 >> shift) + 1 values */
+    uint8_t shift;          /**< log2 of the raw step between points (1-11) */
+} adcCalLut_t;
+
+/**
+ * @brief Load the factory calibration values
+ *
+ * Blank values (0 or 0xFFFF) are replaced by datasheet typicals.
+ * VDDA is assumed to be ADC_CAL_VDDA_REF_MV until the first update.
+ *
+ * @return None
+ */
+void adcCalInit(void);
+
+/**
+ * @brief Update VDDA from a VREFINT sample
+ *
+ * Recomputes the per-sample conversion factors (three divisions).
+ *
+ * @param[in] vrefRaw VREFINT counts (ADC_CHANNEL_VREFINT)
+ *
+ * @return VDDA in mV, 0 if vrefRaw is 0 (factors unchanged)
+ */
+uint32_t adcCalUpdateVdda(uint16_t vrefRaw);
+
+/**
+ * @brief Sample VREFINT and the temperature sensor once
+ *
+ * Converts both internal channels through the injected group (software
+ * trigger, 480-cycle sampling time), so a running regular scan is only
+ * interrupted, then updates VDDA.
+ *
+ * @param[out] tempRaw Temperature sensor counts (may be 0)
+ *
+ * @return 1 on success, 0 on timeout
+ * @note Borrows the injected group: a group configured with
+ *       adcInjectedInit() is saved, its triggers are ignored during the
+ *       measurement and then restored (adcInjectedSave())
+ * @note Blocking for about 140 us, 10 us of it for the sources to start
+ *       up; uses the ADC interrupt, so it must not be called from a
+ *       handler of equal or higher priority
+ * @note Needs the TIM5 time base (tim5TimebaseInit())
+ */
+uint8_t adcCalMeasure(uint16_t *tempRaw);
+
+/**
+ * @brief Current VDDA estimate
+ *
+ * @return VDDA in mV
+ */
+uint32_t adcCalGetVdda(void);
+
+/**
+ * @brief Convert counts to millivolts at the current VDDA
+ *
+ * @param[in] raw ADC counts (0-4095)
+ *
+ * @return Input voltage in mV
+ */
+uint32_t adcCalToMillivolts(uint16_t raw);
+
+/**
+ * @brief Convert one channel of an ADC block to millivolts
+ *
+ * @param[in] src First sample of the channel
+ * @param[in] stride Distance between samples (channels per frame)
+ * @param[out] dst n values in mV, may be src
+ * @param[in] n Number of samples
+ *
+ * @return None
+ */
+void adcCalToMillivoltsBlock(const uint16_t *src, uint32_t stride, uint16_t *dst, uint32_t n);
+
+/**
+ * @brief Convert temperature sensor counts to temperature
+ *
+ * @param[in] raw Temperature sensor counts (ADC_CHANNEL_TEMP)
+ *
+ * @return Temperature in 0.01 degC
+ */
+int32_t adcCalTemperature(uint16_t raw);
+
+/**
+ * @brief Look up counts in a piecewise-linear table
+ *
+ * @param[in] lut Table
+ * @param[in] raw ADC counts (0-4095)
+ *
+ * @return Interpolated table value
+ */
+int32_t adcCalLookup(const adcCalLut_t *lut, uint16_t raw);
+
+#endif // __ADCCAL_H__
@@ -15,6 +15,14 @@
 #define STM32F411xE
 #include "stm32f4xx.h" 
 
+/** Internal RC oscillator frequency */
+#define CLOCK_HSI_VALUE     16000000U
+
+/** External crystal frequency */
+#ifndef CLOCK_HSE_VALUE
+#define CLOCK_HSE_VALUE     8000000U
+#endif
+
 /**
  * @defgroup CLOCK Clock/RCC Driver
  * @brief Reset and Clock Control for peripherals
@@ -34,6 +42,30 @@
  */
 void enableRccAHB1Clk(void);
 
+/**
+ * @brief Start the main PLL for the 48 MHz peripheral clock
+ * 
+ * Configures the PLL from HSI (16 MHz): M = 16, N = 192, Q = 4 gives
+ * PLL48CK = 48 MHz for SDIO. The system clock stays on HSI.
+ * 
+ * @return None
+ * 
+ * @note Does nothing if the PLL is already running
+ */
+void clockEnablePll48(void);
+
+/**
+ * @brief Get the APB1 peripheral clock frequency
+ * 
+ * Decodes the system clock source (HSI, HSE or PLL) and the AHB and
+ * APB1 prescalers from RCC registers.
+ * 
+ * @return PCLK1 in Hz
+ * 
+ * @note HSE is assumed to be CLOCK_HSE_VALUE (8 MHz on the Discovery board)
+ */
+uint32_t clockGetPclk1(void);
+
 /** @} */
 
 #endif // __CLOCK_H__
\ No newline at end of file
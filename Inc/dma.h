@@ -0,0 +1,130 @@
+/**
+ * @file    dma.h
+ * @brief   DMA1/DMA2 stream helper for STM32F411
+ * @author  Bare Metal STM32
+ * @version 1.0
+ * @date    2026
+ *
+ * Small register-level helpers shared by the drivers that move data with
+ * DMA. A stream is addressed by its controller (DMA1 or DMA2) and its
+ * index (0-7). The interrupt flags of a stream are returned and cleared
+ * in a normalized layout so callers do not need to know whether the
+ * stream lives in LISR or HISR.
+ *
+ * @par Stream allocation used in this project:
+ * | Controller | Stream | Channel | Request   |
+ * |------------|--------|---------|-----------|
+ * | DMA1       | 0      | 1       | I2C1_RX   |
+ * | DMA1       | 1      | 1       | I2C3_RX   |
+ * | DMA1       | 2      | 7       | I2C2_RX   |
+ * | DMA1       | 3      | 0       | SPI2_RX   |
+ * | DMA1       | 4      | 0       | SPI2_TX   |
+ * | DMA1       | 4      | 3       | I2C3_TX   |
+ * | DMA1       | 6      | 4       | USART2_TX |
+ * | DMA1       | 7      | 1       | I2C1_TX   |
+ * | DMA1       | 7      | 7       | I2C2_TX   |
+ * | DMA2       | 0      | 0       | ADC1      |
+ * | DMA2       | 2      | 3       | SPI1_RX   |
+ * | DMA2       | 3      | 3       | SPI1_TX   |
+ * | DMA2       | 6      | 4       | SDIO      |
+ */
+
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/**
+ * @defgroup DMA DMA Helper
+ * @brief DMA stream configuration and flag handling
+ * @{
+ */
+
+/** Normalized flag: FIFO error */
+#define DMA_FLAG_FE     (1U<<0)
+/** Normalized flag: direct mode error */
+#define DMA_FLAG_DME    (1U<<2)
+/** Normalized flag: transfer error */
+#define DMA_FLAG_TE     (1U<<3)
+/** Normalized flag: half transfer */
+#define DMA_FLAG_HT     (1U<<4)
+/** Normalized flag: transfer complete */
+#define DMA_FLAG_TC     (1U<<5)
+/** All normalized flags of a stream */
+#define DMA_FLAG_ALL    (DMA_FLAG_FE | DMA_FLAG_DME | DMA_FLAG_TE | DMA_FLAG_HT | DMA_FLAG_TC)
+
+/**
+ * @brief Get the register block of a stream
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ *
+ * @return Pointer to the stream registers
+ */
+DMA_Stream_TypeDef *dmaGetStream(DMA_TypeDef *dma, uint32_t stream);
+
+/**
+ * @brief Configure a stream (stream is disabled first)
+ *
+ * Enables the controller clock, stops the stream, clears its flags and
+ * programs channel, addresses, item count and control bits.
+ *
+ * @param dma     DMA1 or DMA2
+ * @param stream  Stream index (0-7)
+ * @param channel Request channel (0-7)
+ * @param cr      Control bits (DMA_SxCR_DIR, MINC, PSIZE, MSIZE, CIRC, xxIE, PL...)
+ * @param periph  Peripheral register address
+ * @param mem     Memory buffer address
+ * @param count   Number of data items
+ *
+ * @return None
+ * @note Direct mode is used (FIFO disabled)
+ */
+void dmaStreamConfig(DMA_TypeDef *dma, uint32_t stream, uint32_t channel, uint32_t cr,
+                     volatile void *periph, void *mem, uint16_t count);
+
+/**
+ * @brief Enable a configured stream
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ *
+ * @return None
+ */
+void dmaStreamStart(DMA_TypeDef *dma, uint32_t stream);
+
+/**
+ * @brief Disable a stream and wait until it has stopped
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ *
+ * @return None
+ */
+void dmaStreamStop(DMA_TypeDef *dma, uint32_t stream);
+
+/**
+ * @brief Read the interrupt flags of a stream
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ *
+ * @return Normalized flags (DMA_FLAG_xx)
+ */
+uint32_t dmaGetFlags(DMA_TypeDef *dma, uint32_t stream);
+
+/**
+ * @brief Clear interrupt flags of a stream
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ * @param flags  Normalized flags to clear (DMA_FLAG_xx)
+ *
+ * @return None
+ */
+void dmaClearFlags(DMA_TypeDef *dma, uint32_t stream, uint32_t flags);
+
+/** @} */
+
+#endif // __DMA_H__
@@ -0,0 +1,258 @@
+/**
+ * @file dsp.h
+ * @brief Q15/Q31 fixed-point filter kernels for ADC sample streams
+ *
+ * Block FIR, cascaded biquad IIR and decimating FIR filters. On the
+ * Cortex-M4 the Q15 kernels use the DSP extension (SMLALD, QADD16,
+ * SSAT) to process two samples per instruction; on any other
+ * target (e.g. a Linux host for accuracy tests) the portable C
+ * reference path is built instead.
+ *
+ * @details
+ * Formats:
+ * - Q15: int16_t, value / 32768, range [-1, 1)
+ * - Q31: int32_t, value / 2^31, range [-1, 1)
+ * - Results saturate instead of wrapping
+ *
+ * Buffers:
+ * - Every kernel accepts dst == src, so a filter runs in place on an
+ *   ADC DMA block once dspAdcToQ15() has converted it
+ * - Multi-channel scan buffers are interleaved; dspAdcToQ15() takes a
+ *   stride to pull one channel out into a contiguous block
+ *
+ * Each kernel has a *Ref() twin: the portable C implementation. The
+ * normal entry points use the DSP instructions when __ARM_FEATURE_DSP
+ * is defined and fall back to the Ref path otherwise, so both can be
+ * compared on the target (see dspbench.h).
+ *
+ * This module does not touch any peripheral and only needs stdint.h.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __DSP_H__
+#define __DSP_H__
+
+#include <stdint.h>
+
+/** Largest block accepted by the FIR and decimation kernels */
+#ifndef DSP_MAX_BLOCK
+#define DSP_MAX_BLOCK           256U
+#endif
+
+/**
+ * @brief Block FIR filter, Q15
+ *
+ * Coefficients are stored time reversed: coeffs[0] multiplies the
+ * oldest sample, coeffs[numTaps - 1] the newest. The state buffer holds
+ * numTaps - 1 + blockSize samples.
+ */
+typedef struct
+{
+    uint16_t numTaps;           /**< Number of coefficients (even is fastest) */
+    const int16_t *coeffs;      /**< Time reversed coefficients */
+    int16_t *state;             /**< numTaps - 1 + blockSize samples */
+} dspFirQ15_t;
+
+/**
+ * @brief Cascaded biquad IIR filter (direct form I), Q15
+ *
+ * Per stage six coefficients {b0, 0, b1, b2, a1, a2}, the zero keeps
+ * the pairs aligned for SMLALD. Feedback coefficients are negated:
+ * y = b0*x + b1*x1 + b2*x2 + a1*y1 + a2*y2. Coefficients are scaled by
+ * 2^-postShift so values up to 2^postShift fit in Q15.
+ */
+typedef struct
+{
+    uint8_t numStages;          /**< Number of second order sections */
+    uint8_t postShift;          /**< Coefficient scaling shift */
+    const int16_t *coeffs;      /**< 6 * numStages coefficients */
+    int16_t *state;             /**< 4 * numStages: x1, x2, y1, y2 */
+} dspBiquadQ15_t;
+
+/**
+ * @brief Cascaded biquad IIR filter (direct form I), Q31
+ *
+ * Per stage five coefficients {b0, b1, b2, a1, a2}, feedback negated
+ * as in dspBiquadQ15_t.
+ */
+typedef struct
+{
+    uint8_t numStages;          /**< Number of second order sections */
+    uint8_t postShift;          /**< Coefficient scaling shift */
+    const int32_t *coeffs;      /**< 5 * numStages coefficients */
+    int32_t *state;             /**< 4 * numStages: x1, x2, y1, y2 */
+} dspBiquadQ31_t;
+
+/**
+ * @brief Decimating FIR filter, Q15
+ *
+ * Only every factor-th output is computed, which costs the same as
+ * running the factor polyphase branches at the low rate. Output j
+ * lines up with input (j + 1) * factor - 1, the last of its group.
+ * Coefficients are time reversed as in dspFirQ15_t; blockSize must be
+ * a multiple of the factor.
+ */
+typedef struct
+{
+    uint8_t factor;             /**< Decimation factor */
+    uint16_t numTaps;           /**< Number of coefficients */
+    const int16_t *coeffs;      /**< Time reversed coefficients */
+    int16_t *state;             /**< numTaps - 1 + blockSize samples */
+} dspDecimQ15_t;
+
+/**
+ * @brief Convert 12-bit ADC results to Q15
+ *
+ * dst[i] = (src[i * stride] - 2048) << 4, so mid scale becomes 0.
+ *
+ * @param[in] src First ADC sample of the channel
+ * @param[in] stride Distance between samples (channels per frame)
+ * @param[out] dst Destination, may be (int16_t *)src
+ * @param[in] n Number of samples
+ *
+ * @return void
+ */
+void dspAdcToQ15(const uint16_t *src, uint32_t stride, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Saturating element-wise add, Q15 (QADD16)
+ *
+ * @param[in] a First operand
+ * @param[in] b Second operand
+ * @param[out] dst a + b, may alias a or b
+ * @param[in] n Number of samples
+ *
+ * @return void
+ */
+void dspAddQ15(const int16_t *a, const int16_t *b, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Initialize a Q15 FIR filter and clear its state
+ *
+ * @param[out] f Filter
+ * @param[in] numTaps Number of coefficients
+ * @param[in] coeffs Time reversed coefficients
+ * @param[in] state Buffer of numTaps - 1 + DSP_MAX_BLOCK samples
+ *
+ * @return void
+ */
+void dspFirQ15Init(dspFirQ15_t *f, uint16_t numTaps, const int16_t *coeffs, int16_t *state);
+
+/**
+ * @brief Run a block through a Q15 FIR filter
+ *
+ * @param[in,out] f Filter
+ * @param[in] src Input block
+ * @param[out] dst Output block, may equal src
+ * @param[in] n Block size (up to DSP_MAX_BLOCK)
+ *
+ * @return void
+ */
+void dspFirQ15(dspFirQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Portable reference of dspFirQ15()
+ *
+ * @return void
+ */
+void dspFirQ15Ref(dspFirQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Initialize a Q15 biquad cascade and clear its state
+ *
+ * @param[out] f Filter
+ * @param[in] numStages Number of sections
+ * @param[in] coeffs 6 * numStages coefficients
+ * @param[in] state Buffer of 4 * numStages samples
+ * @param[in] postShift Coefficient scaling shift
+ *
+ * @return void
+ */
+void dspBiquadQ15Init(dspBiquadQ15_t *f, uint8_t numStages, const int16_t *coeffs, int16_t *state,
+                      uint8_t postShift);
+
+/**
+ * @brief Run a block through a Q15 biquad cascade
+ *
+ * @param[in,out] f Filter
+ * @param[in] src Input block
+ * @param[out] dst Output block, may equal src
+ * @param[in] n Block size
+ *
+ * @return void
+ */
+void dspBiquadQ15(dspBiquadQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Portable reference of dspBiquadQ15()
+ *
+ * @return void
+ */
+void dspBiquadQ15Ref(dspBiquadQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Initialize a Q31 biquad cascade and clear its state
+ *
+ * @param[out] f Filter
+ * @param[in] numStages Number of sections
+ * @param[in] coeffs 5 * numStages coefficients
+ * @param[in] state Buffer of 4 * numStages samples
+ * @param[in] postShift Coefficient scaling shift
+ *
+ * @return void
+ */
+void dspBiquadQ31Init(dspBiquadQ31_t *f, uint8_t numStages, const int32_t *coeffs, int32_t *state,
+                      uint8_t postShift);
+
+/**
+ * @brief Run a block through a Q31 biquad cascade
+ *
+ * 32 x 32 bit products are accumulated in 64 bits (SMLAL on the M4, the
+ * same C on every target).
+ *
+ * @param[in,out] f Filter
+ * @param[in] src Input block
+ * @param[out] dst Output block, may equal src
+ * @param[in] n Block size
+ *
+ * @return void
+ */
+void dspBiquadQ31(dspBiquadQ31_t *f, const int32_t *src, int32_t *dst, uint32_t n);
+
+/**
+ * @brief Initialize a Q15 decimating FIR filter and clear its state
+ *
+ * @param[out] f Filter
+ * @param[in] factor Decimation factor (1-255)
+ * @param[in] numTaps Number of coefficients
+ * @param[in] coeffs Time reversed coefficients
+ * @param[in] state Buffer of numTaps - 1 + DSP_MAX_BLOCK samples
+ *
+ * @return void
+ */
+void dspDecimQ15Init(dspDecimQ15_t *f, uint8_t factor, uint16_t numTaps, const int16_t *coeffs,
+                     int16_t *state);
+
+/**
+ * @brief Filter and decimate a block, Q15
+ *
+ * @param[in,out] f Filter
+ * @param[in] src Input block
+ * @param[out] dst n / factor output samples, may equal src
+ * @param[in] n Input block size (multiple of factor, up to DSP_MAX_BLOCK)
+ *
+ * @return Number of output samples
+ */
+uint32_t dspDecimQ15(dspDecimQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+/**
+ * @brief Portable reference of dspDecimQ15()
+ *
+ * @return Number of output samples
+ */
+uint32_t dspDecimQ15Ref(dspDecimQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n);
+
+#endif // __DSP_H__
@@ -0,0 +1,74 @@
+/**
+ * @file dspbench.h
+ * @brief Cycle benchmark of the DSP kernels on the target
+ *
+ * Runs each Q15 kernel of dsp.c and its portable *Ref() twin over the
+ * same block and reports cycles per input sample measured with the DWT
+ * cycle counter.
+ *
+ * @details
+ * Benchmark setup:
+ * - Block of DSP_BENCH_BLOCK samples (triangle wave plus noise)
+ * - FIR: 32 taps
+ * - Biquad: 2 sections
+ * - Decimation: factor 4, 32 taps
+ * - FFT: DSP_BENCH_FFT_SIZE point real transform, Hann window, cycles
+ *   per transform (float32 path only with FFT_ENABLE_F32)
+ *
+ * The numbers depend on the optimization level; the Makefile builds
+ * with -O0, so use -O2 or -O3 for representative figures.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __DSPBENCH_H__
+#define __DSPBENCH_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Samples per benchmark block (up to DSP_MAX_BLOCK) */
+#define DSP_BENCH_BLOCK         256U
+
+/** Real FFT size of the benchmark */
+#define DSP_BENCH_FFT_SIZE      1024U
+
+/**
+ * @brief Cycles per sample of one kernel
+ */
+typedef struct
+{
+    uint32_t simd;          /**< DSP instruction path */
+    uint32_t ref;           /**< Portable C path */
+} dspBenchPair_t;
+
+/**
+ * @brief Benchmark results in cycles per input sample
+ */
+typedef struct
+{
+    dspBenchPair_t add;     /**< dspAddQ15 (ref: plain C saturation) */
+    dspBenchPair_t fir;     /**< dspFirQ15 */
+    dspBenchPair_t biquad;  /**< dspBiquadQ15 */
+    dspBenchPair_t decim;   /**< dspDecimQ15 */
+    uint32_t maxDiff;       /**< Largest output difference between paths (LSB) */
+    uint32_t fftQ15;        /**< fftRealQ15 cycles per transform */
+#ifdef FFT_ENABLE_F32
+    uint32_t fftF32;        /**< fftRealF32 cycles per transform */
+#endif
+} dspBenchResult_t;
+
+/**
+ * @brief Run the benchmark
+ *
+ * @param[out] result Cycles per sample and path agreement
+ *
+ * @return void
+ * @note Enables the DWT cycle counter; run with interrupts quiet for
+ *       stable numbers
+ */
+void dspBenchRun(dspBenchResult_t *result);
+
+#endif // __DSPBENCH_H__
@@ -0,0 +1,167 @@
+/**
+ * @file eeprom.h
+ * @brief 24Cxx I2C EEPROM driver with write coalescing and a read cache
+ *
+ * Runs its transfers through the I2C1 scheduler (i2csched.c), so the
+ * EEPROM can share the bus with the sensors.
+ *
+ * @details
+ * Writes:
+ * - Split on page boundaries; whole pages are written at once
+ * - Smaller writes are merged in a one-page RAM buffer while they stay
+ *   adjacent or overlapping inside the same page, and programmed as one
+ *   page write when the page is complete, another page is touched, a
+ *   gap would appear or eepromFlush() is called
+ * - After a page write the device is not waited for: the next access
+ *   first polls the device address until it is ACKed again (end of the
+ *   internal write cycle) instead of waiting a fixed 5 ms
+ * - A page write that fails leaves the buffer pending; the next flush
+ *   programs it again
+ *
+ * Reads:
+ * - Served from a direct-mapped write-through cache of
+ *   EEPROM_CACHE_LINES lines of EEPROM_CACHE_LINE bytes; a miss loads
+ *   the whole line with one transfer. Lines are updated only after a
+ *   page write succeeds, and the pending page is programmed before a
+ *   line overlapping it is read, so the cache never holds bytes the
+ *   device has not stored
+ * - Reads of EEPROM_CACHE_BYPASS bytes or more go to the device in one
+ *   burst and do not evict the cache
+ *
+ * The counters in eepromStats_t give the number of bus transactions,
+ * to compare against an uncached, page-by-page access pattern.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __EEPROM_H__
+#define __EEPROM_H__
+
+#include <stdint.h>
+#include "i2csched.h"
+
+/** 7-bit device address (A2..A0 = 0) */
+#ifndef EEPROM_I2C_ADDR
+#define EEPROM_I2C_ADDR         0x50U
+#endif
+
+/** Device size in bytes (24C32) */
+#ifndef EEPROM_SIZE
+#define EEPROM_SIZE             4096U
+#endif
+
+/** Page size in bytes */
+#ifndef EEPROM_PAGE_SIZE
+#define EEPROM_PAGE_SIZE        32U
+#endif
+
+/** Memory address bytes: 2 for 24C32 and up, 1 for 24C01-24C16 */
+#ifndef EEPROM_ADDR_BYTES
+#define EEPROM_ADDR_BYTES       2U
+#endif
+
+/** Read cache lines (power of two) */
+#ifndef EEPROM_CACHE_LINES
+#define EEPROM_CACHE_LINES      8U
+#endif
+
+/** Read cache line size in bytes (divides EEPROM_PAGE_SIZE) */
+#ifndef EEPROM_CACHE_LINE
+#define EEPROM_CACHE_LINE       16U
+#endif
+
+/** Reads this long or longer bypass the cache */
+#ifndef EEPROM_CACHE_BYPASS
+#define EEPROM_CACHE_BYPASS     64U
+#endif
+
+/** Longest internal write cycle accepted (datasheet: 5 ms) */
+#ifndef EEPROM_WRITE_TIMEOUT_US
+#define EEPROM_WRITE_TIMEOUT_US 10000U
+#endif
+
+/** Deadline of each bus transfer */
+#ifndef EEPROM_XFER_TIMEOUT_US
+#define EEPROM_XFER_TIMEOUT_US  20000U
+#endif
+
+/**
+ * @brief Result codes of the EEPROM functions
+ */
+typedef enum
+{
+    EEPROM_OK = 0,          /**< Operation completed */
+    EEPROM_ERR_RANGE,       /**< Address range outside the device */
+    EEPROM_ERR_BUS,         /**< Transfer failed (NACK, bus error) */
+    EEPROM_ERR_TIMEOUT      /**< Device did not finish its write cycle */
+} eepromStatus_t;
+
+/**
+ * @brief Driver counters
+ */
+typedef struct
+{
+    uint32_t busTransactions;   /**< I2C transfers issued (all kinds) */
+    uint32_t pageWrites;        /**< Page write transfers */
+    uint32_t bytesWritten;      /**< Bytes programmed */
+    uint32_t coalescedWrites;   /**< Writes merged into a pending page */
+    uint32_t ackPolls;          /**< Address probes while the device was busy */
+    uint32_t cacheHits;         /**< Cache lines served from RAM */
+    uint32_t cacheMisses;       /**< Cache lines loaded from the device */
+} eepromStats_t;
+
+/**
+ * @brief Reset the driver state (cache, pending page, counters)
+ *
+ * @return void
+ * @note i2cSchedInit() must have been called
+ */
+void eepromInit(void);
+
+/**
+ * @brief Read bytes
+ *
+ * @param[in] addr First address
+ * @param[out] data Destination
+ * @param[in] len Number of bytes
+ *
+ * @return EEPROM_OK, EEPROM_ERR_RANGE, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ * @note Programs the coalescing buffer first if it overlaps the range
+ */
+eepromStatus_t eepromRead(uint16_t addr, uint8_t *data, uint16_t len);
+
+/**
+ * @brief Write bytes
+ *
+ * May return before the data is programmed (coalescing buffer or
+ * write cycle in progress); call eepromFlush() to make it durable.
+ *
+ * @param[in] addr First address
+ * @param[in] data Source
+ * @param[in] len Number of bytes
+ *
+ * @return EEPROM_OK, EEPROM_ERR_RANGE, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+eepromStatus_t eepromWrite(uint16_t addr, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Program the pending page and wait for the write cycle
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ * @note After an error the page stays pending and is retried by the
+ *       next call
+ */
+eepromStatus_t eepromFlush(void);
+
+/**
+ * @brief Copy the driver counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void eepromGetStats(eepromStats_t *stats);
+
+#endif // __EEPROM_H__
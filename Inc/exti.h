@@ -14,4 +14,14 @@ void pc13ExtiInit(void);
  */
 void EXTI0_IRQHandler(void);
 
+/**
+ * @brief Initialize EXTI1 on PE1 pin for rising edge interrupt
+ */
+void pe1ExtiInit(void);
+
+/**
+ * @brief EXTI1 interrupt handler (PE1)
+ */
+void EXTI1_IRQHandler(void);
+
 #endif //__EXTI__H__
\ No newline at end of file
@@ -0,0 +1,136 @@
+/**
+ * @file fft.h
+ * @brief Fixed-point real FFT and spectral analysis for ADC captures
+ *
+ * In-place real-input FFT of 64 to 2048 samples working directly on an
+ * ADC DMA buffer: the 12-bit results are windowed and converted to Q15
+ * in place, transformed in place and reduced to magnitudes in place.
+ *
+ * @details
+ * Algorithm:
+ * - N real samples are treated as N/2 complex samples (even = real,
+ *   odd = imaginary) and transformed with a complex FFT of N/2 points,
+ *   then split into the N/2 + 1 bins of the real spectrum
+ * - Complex FFT: decimation in frequency with radix-4 stages (radix-2^2
+ *   butterflies, three complex multiplies per four points) and one
+ *   radix-2 stage when log2(N/2) is odd
+ * - Each stage scales by 1/2 per radix-2 step, so Q15 cannot overflow;
+ *   with fftPrepareQ15() input a full-scale sine of amplitude A gives a
+ *   peak bin of magnitude 32768 * A / 4
+ * - Twiddles come from a 513-entry quarter-wave sine table and the
+ *   output reordering from a 1024-entry bit-reversal table, both const
+ *   (flash) and shared by every size
+ *
+ * Spectrum layout after fftRealQ15() (N int16_t):
+ * - buf[0] = bin 0 (DC), buf[1] = bin N/2 (Nyquist), both real
+ * - buf[2k], buf[2k + 1] = real, imaginary part of bin k (1 <= k < N/2)
+ *
+ * A float32 path with the same layout is built when FFT_ENABLE_F32 is
+ * defined; it needs the FPU enabled (-mfpu=fpv4-sp-d16 -mfloat-abi=hard
+ * and CPACR) on the target, or runs on a host for validation.
+ *
+ * Like dsp.c this module only needs stdint.h.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __FFT_H__
+#define __FFT_H__
+
+#include <stdint.h>
+
+/** Smallest transform size (real samples) */
+#define FFT_MIN_SIZE            64U
+
+/** Largest transform size (real samples) */
+#define FFT_MAX_SIZE            2048U
+
+/**
+ * @brief Window applied by fftPrepareQ15()
+ */
+typedef enum
+{
+    FFT_WINDOW_RECT = 0,    /**< No window */
+    FFT_WINDOW_HANN,        /**< Hann (raised cosine) */
+    FFT_WINDOW_HAMMING      /**< Hamming */
+} fftWindow_t;
+
+/**
+ * @brief One spectral peak
+ */
+typedef struct
+{
+    uint16_t bin;           /**< Bin of the local maximum */
+    uint16_t mag;           /**< Magnitude of that bin */
+    uint32_t binQ8;         /**< Parabolic-interpolated bin in 1/256 */
+} fftPeak_t;
+
+/**
+ * @brief Window 12-bit ADC results and convert them to FFT input
+ *
+ * dst[i] = ((src[i * stride] - 2048) << 3) * w[i]: half of Q15 full
+ * scale, which keeps the complex butterflies clear of overflow without
+ * losing any of the 12 ADC bits.
+ *
+ * @param[in] src First ADC sample of the channel
+ * @param[in] stride Distance between samples (channels per frame)
+ * @param[out] dst n samples, may be (int16_t *)src
+ * @param[in] n Transform size
+ * @param[in] window Window type
+ *
+ * @return void
+ */
+void fftPrepareQ15(const uint16_t *src, uint32_t stride, int16_t *dst, uint32_t n, fftWindow_t window);
+
+/**
+ * @brief In-place real FFT, Q15
+ *
+ * @param[in,out] buf n real samples in, n/2 packed bins out (see above)
+ * @param[in] n Transform size (power of two, FFT_MIN_SIZE-FFT_MAX_SIZE)
+ *
+ * @return 1 on success, 0 if n is not a supported size
+ * @note The result is the DFT divided by n
+ */
+uint8_t fftRealQ15(int16_t *buf, uint32_t n);
+
+/**
+ * @brief Magnitudes of the packed spectrum
+ *
+ * mag[0] = |DC|, mag[k] = sqrt(re^2 + im^2) for 1 <= k < n/2.
+ *
+ * @param[in] spec Output of fftRealQ15()
+ * @param[out] mag n/2 magnitudes, may be (uint16_t *)spec
+ * @param[in] n Transform size
+ *
+ * @return void
+ */
+void fftMagnitudeQ15(const int16_t *spec, uint16_t *mag, uint32_t n);
+
+/**
+ * @brief Find the largest local maxima of a magnitude spectrum
+ *
+ * @param[in] mag Magnitudes
+ * @param[in] bins Number of magnitudes
+ * @param[out] peaks Peaks, largest first
+ * @param[in] maxPeaks Capacity of peaks
+ * @param[in] threshold Smallest magnitude reported
+ *
+ * @return Number of peaks found
+ */
+uint32_t fftFindPeaks(const uint16_t *mag, uint32_t bins, fftPeak_t *peaks, uint32_t maxPeaks, uint16_t threshold);
+
+#ifdef FFT_ENABLE_F32
+/**
+ * @brief In-place real FFT, float32 (same layout, no scaling)
+ *
+ * @param[in,out] buf n real samples in, n/2 packed bins out
+ * @param[in] n Transform size
+ *
+ * @return 1 on success, 0 if n is not a supported size
+ */
+uint8_t fftRealF32(float *buf, uint32_t n);
+#endif
+
+#endif // __FFT_H__
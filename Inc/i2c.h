@@ -3,8 +3,21 @@
  * @brief I2C (Inter-Integrated Circuit) driver for STM32F411xE.
  * 
  * This header file provides declarations for I2C1 interface functions
- * used for communication with I2C slave devices. The module is configured
- * for standard mode (100 kHz) on GPIO pins PB8 (SCL) and PB9 (SDA).
+ * used for communication with I2C slave devices. The module runs on GPIO
+ * pins PB8 (SCL) and PB9 (SDA) at I2C1_SPEED (standard mode by default);
+ * CCR and TRISE are computed from the actual PCLK1.
+ * 
+ * Transfers are driven by the I2C1_EV and I2C1_ER interrupts. A transfer
+ * is described by an i2cTransfer_t: an optional 1-2 byte header (register
+ * or memory address), optional bytes to write, then optional bytes to
+ * read after a repeated START. i2c1Submit() starts it and returns; the
+ * completion callback runs from the interrupt with the final status.
+ * The byte/burst functions are blocking wrappers around the same engine.
+ * 
+ * Write or read sections of I2C_DMA_THRESHOLD bytes or more are moved
+ * by DMA1 (Stream0 channel 1 for RX, Stream7 channel 1 for TX). On reads
+ * the LAST bit makes the peripheral NACK the final byte by itself, so a
+ * long burst costs two interrupts instead of one per byte.
  * 
  * @author Bare Metal STM32
  * @date 2026
@@ -16,22 +29,161 @@
 #define STM32F411xE
 #include "stm32f4xx.h" 
 
+/** Standard mode SCL frequency */
+#define I2C_SPEED_STANDARD  100000U
+/** Fast mode SCL frequency */
+#define I2C_SPEED_FAST      400000U
+/** Fast mode plus SCL frequency (not reachable by the F411 I2C, clamped to Fm) */
+#define I2C_SPEED_FAST_PLUS 1000000U
+
+/** Bus speed selected by i2c1Init() */
+#ifndef I2C1_SPEED
+#define I2C1_SPEED          I2C_SPEED_STANDARD
+#endif
+
+/** Deadline of the blocking byte/burst functions in microseconds */
+#ifndef I2C_BLOCKING_TIMEOUT_US
+#define I2C_BLOCKING_TIMEOUT_US 100000U
+#endif
+
+/** Smallest write or read section moved by DMA instead of interrupts */
+#ifndef I2C_DMA_THRESHOLD
+#define I2C_DMA_THRESHOLD   4U
+#endif
+
+/**
+ * @brief Interrupt hook taking over the I2C1 vectors
+ */
+typedef void (*i2cIrqHook_t)(void);
+
+/**
+ * @brief Clock register values for one bus speed
+ */
+typedef struct
+{
+    uint16_t freq;      /**< CR2 FREQ field (PCLK1 in MHz) */
+    uint16_t ccr;       /**< Complete CCR value (F/S, DUTY and CCR field) */
+    uint16_t trise;     /**< TRISE value */
+    uint32_t sclHz;     /**< Resulting SCL frequency, rise times excluded */
+} i2cTiming_t;
+
+/**
+ * @brief Result of an I2C transfer
+ */
+typedef enum
+{
+    I2C_OK = 0,         /**< Transfer completed */
+    I2C_PENDING,        /**< Transfer queued or in progress */
+    I2C_ERR_NACK,       /**< Address or data byte not acknowledged */
+    I2C_ERR_ARLO,       /**< Arbitration lost to another master */
+    I2C_ERR_BUS,        /**< Misplaced START or STOP on the bus */
+    I2C_ERR_OVR,        /**< Overrun or underrun */
+    I2C_ERR_DMA,        /**< DMA transfer error */
+    I2C_ERR_TIMEOUT     /**< Deadline passed, transfer aborted */
+} i2cStatus_t;
+
+typedef struct i2cTransfer i2cTransfer_t;
+
+/**
+ * @brief Called from the I2C interrupt when a transfer has finished
+ *
+ * A new transfer may be submitted from the callback.
+ *
+ * @param xfer Finished transfer (status is set)
+ */
+typedef void (*i2cCallback_t)(i2cTransfer_t *xfer);
+
+/**
+ * @brief I2C transfer descriptor
+ *
+ * Sequence: START, address+W, header, txBuf, then if rxLen is not zero
+ * repeated START, address+R, rxBuf, and STOP. With no header, no tx and
+ * no rx bytes only the address is sent (device presence/ready probe).
+ * With only rx bytes the transfer starts directly with address+R.
+ *
+ * @note The descriptor and its buffers must stay valid until completion
+ */
+struct i2cTransfer
+{
+    uint8_t addr;               /**< 7-bit slave address */
+    uint8_t headerLen;          /**< Header bytes to send first (0-2) */
+    uint8_t header[2];          /**< Register or memory address, MSB first */
+    const uint8_t *txBuf;       /**< Bytes to write after the header */
+    uint16_t txLen;             /**< Number of bytes to write */
+    uint8_t *rxBuf;             /**< Destination of the read bytes */
+    uint16_t rxLen;             /**< Number of bytes to read */
+    i2cCallback_t callback;     /**< Completion callback (may be 0) */
+    void *context;              /**< Free for the submitter */
+    volatile i2cStatus_t status;/**< I2C_PENDING until the transfer ends */
+};
+
 /**
  * @brief Initialize I2C1 peripheral.
  * 
- * Configures I2C1 for standard mode (100 kHz) communication. Sets up:
+ * Configures I2C1 for I2C1_SPEED communication. Sets up:
  * - GPIO pins PB8 (SCL) and PB9 (SDA) as alternate function (AF4)
  * - Open-drain output with pull-up resistors
- * - I2C clock to 100 kHz
- * - Rise time for standard mode
+ * - I2C clock and rise time from the current PCLK1 (i2c1SetSpeed())
  * 
  * @return void
  * 
  * @note Must be called before any other I2C operations.
  * @note Requires prior GPIO and clock initialization.
+ * @note Starts the TIM5 time base used for deadlines and bus recovery.
  */
 void i2c1Init(void);
 
+/**
+ * @brief Compute the clock registers for a bus speed
+ * 
+ * Picks standard mode up to 100 kHz, otherwise fast mode with the duty
+ * cycle (2:1 or 16:9) that gets closest to the target. CCR is rounded
+ * up so the bus is never faster than requested, and raised if needed to
+ * meet the minimum SCL low/high times of the I2C specification. Targets
+ * above 400 kHz are clamped: the F411 I2C has no Fm+ support.
+ * 
+ * @param[in] pclk1 APB1 clock in Hz (2-50 MHz, at least 4 MHz for fast mode)
+ * @param[in] sclHz Target SCL frequency in Hz
+ * @param[out] timing Register values and achieved frequency
+ * 
+ * @return 1 on success, 0 if PCLK1 does not allow the requested mode
+ */
+uint8_t i2cComputeTiming(uint32_t pclk1, uint32_t sclHz, i2cTiming_t *timing);
+
+/**
+ * @brief Change the I2C1 bus speed
+ * 
+ * Reads PCLK1 with clockGetPclk1(), computes the timing and reprograms
+ * CR2, CCR and TRISE with the peripheral disabled.
+ * 
+ * @param[in] sclHz Target SCL frequency in Hz
+ * 
+ * @return Achieved SCL frequency in Hz, 0 if not possible or a transfer
+ *         is running (settings unchanged)
+ */
+uint32_t i2c1SetSpeed(uint32_t sclHz);
+
+/**
+ * @brief Start an interrupt-driven transfer
+ * 
+ * Sets the status to I2C_PENDING, generates START and returns. The rest
+ * of the transfer runs in I2C1_EV_IRQHandler()/I2C1_ER_IRQHandler().
+ * 
+ * @param[in,out] xfer Transfer descriptor
+ * 
+ * @return 1 if the transfer was started, 0 if another one is running
+ * @note Safe from thread and interrupt context (completion callbacks):
+ *       the engine is claimed with interrupts masked
+ */
+uint8_t i2c1Submit(i2cTransfer_t *xfer);
+
+/**
+ * @brief Check whether a transfer is in progress
+ * 
+ * @return 1 if busy, 0 otherwise
+ */
+uint8_t i2c1IsBusy(void);
+
 /**
  * @brief Read a single byte from I2C slave device.
  * 
@@ -44,7 +196,9 @@ void i2c1Init(void);
  * 
  * @return void
  * 
- * @note This function blocks until the byte is received.
+ * @note This function blocks until the byte is received (CPU waits on
+ *       the transfer status, the bytes are handled by the interrupt),
+ *       at most I2C_BLOCKING_TIMEOUT_US; then the bus is recovered.
  * @note The function automatically sends STOP condition after reading.
  * @warning Ensure EEPROM has sufficient time to respond between write and read cycles.
  */
@@ -90,4 +244,94 @@ void i2c1BurstRead(char saddr, char maddr, int n, char* data);
  */
 void i2c1BurstWrite(char saddr, char maddr, int n, char* data);
 
+/**
+ * @brief Abort the running transfer
+ * 
+ * Stops the interrupts and DMA, sets the transfer status to
+ * I2C_ERR_TIMEOUT without calling its callback, and resets the
+ * peripheral with the current speed settings.
+ * 
+ * @return void
+ * @note Does not free a bus held low by a slave, see i2c1BusRecover()
+ */
+void i2c1Abort(void);
+
+/**
+ * @brief Free a bus held low by a slave
+ * 
+ * Takes PB8/PB9 over as open-drain GPIOs and clocks SCL up to nine
+ * times until the slave releases SDA, then generates a STOP, returns
+ * the pins to I2C and resets the peripheral.
+ * 
+ * @return 1 if SDA is released, 0 if it is still low or a transfer is
+ *         running
+ * @note Blocking, about 100 us at 100 kHz timing
+ */
+uint8_t i2c1BusRecover(void);
+
+/**
+ * @brief Route the I2C1 interrupts to another driver (slave mode)
+ * 
+ * While hooks are set the master engine ignores the I2C1 event and
+ * error interrupts and calls the hooks instead.
+ * 
+ * @param[in] ev Event interrupt hook, or 0 to give the vector back
+ * @param[in] er Error interrupt hook, or 0 to give the vector back
+ * 
+ * @return void
+ */
+void i2c1SetSlaveHooks(i2cIrqHook_t ev, i2cIrqHook_t er);
+
+/**
+ * @brief Start a burst read and return immediately
+ * 
+ * Same transfer as i2c1BurstRead(); the callback runs from the
+ * interrupt when the last byte has been stored in data.
+ * 
+ * @param[in] saddr 7-bit slave device address
+ * @param[in] maddr Starting memory address to read from
+ * @param[in] n Number of bytes to read (must be > 0)
+ * @param[out] data Destination buffer, valid until the callback
+ * @param[in] callback Completion callback (may be 0, then poll i2c1IsBusy())
+ * 
+ * @return 1 if the transfer was started, 0 if the bus is busy or n <= 0
+ */
+uint8_t i2c1BurstReadAsync(char saddr, char maddr, int n, char* data, i2cCallback_t callback);
+
+/**
+ * @brief Start a burst write and return immediately
+ * 
+ * Same transfer as i2c1BurstWrite(); the callback runs from the
+ * interrupt after STOP has been requested.
+ * 
+ * @param[in] saddr 7-bit slave device address
+ * @param[in] maddr Starting memory address to write to
+ * @param[in] n Number of bytes to write
+ * @param[in] data Source buffer, valid until the callback
+ * @param[in] callback Completion callback (may be 0, then poll i2c1IsBusy())
+ * 
+ * @return 1 if the transfer was started, 0 if the bus is busy
+ */
+uint8_t i2c1BurstWriteAsync(char saddr, char maddr, int n, char* data, i2cCallback_t callback);
+
+/**
+ * @brief I2C1 event interrupt handler
+ */
+void I2C1_EV_IRQHandler(void);
+
+/**
+ * @brief I2C1 error interrupt handler
+ */
+void I2C1_ER_IRQHandler(void);
+
+/**
+ * @brief DMA1 Stream0 interrupt handler (I2C1 RX complete)
+ */
+void DMA1_Stream0_IRQHandler(void);
+
+/**
+ * @brief DMA1 Stream7 interrupt handler (I2C1 TX complete)
+ */
+void DMA1_Stream7_IRQHandler(void);
+
 #endif // __I2C_H__
@@ -0,0 +1,154 @@
+/**
+ * @file i2csched.h
+ * @brief Priority scheduler for shared I2C1 transfers
+ *
+ * Several drivers (sensors, EEPROM) share I2C1. Each one submits jobs
+ * to this scheduler instead of calling i2c1Submit() directly; jobs are
+ * queued by priority and started back to back from the completion
+ * interrupt of the previous one, so the bus never idles while work is
+ * waiting.
+ *
+ * @details
+ * Every job carries a deadline (timeoutUs from submission), which
+ * bounds the time spent waiting in the queue plus running on the bus:
+ * - A queued job whose deadline has passed completes with
+ *   I2C_ERR_TIMEOUT without being started
+ * - A running job that passes its deadline is aborted by
+ *   i2cSchedPoll() and the bus is recovered (nine SCL pulses + STOP)
+ * - NACK, bus, arbitration and DMA errors are retried up to
+ *   job->retries times before the deadline; after a bus error or a
+ *   timeout the bus is recovered before the retry. A job waiting for
+ *   its retry is back to I2C_PENDING, so only the final attempt's
+ *   status is ever reported
+ *
+ * Jobs live in caller memory (no allocation) and are linked into the
+ * queue through their next field.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __I2CSCHED_H__
+#define __I2CSCHED_H__
+
+#include <stdint.h>
+#include "i2c.h"
+
+/** Highest priority */
+#define I2C_SCHED_PRIO_HIGH     0U
+/** Default priority */
+#define I2C_SCHED_PRIO_NORMAL   4U
+/** Lowest priority */
+#define I2C_SCHED_PRIO_LOW      7U
+
+typedef struct i2cJob i2cJob_t;
+
+/**
+ * @brief Called when a job has finished (interrupt or poll context)
+ *
+ * The final status is in job->xfer.status. The job may be resubmitted
+ * from the callback.
+ *
+ * @param job Finished job
+ */
+typedef void (*i2cJobCallback_t)(i2cJob_t *job);
+
+/**
+ * @brief Scheduled I2C job
+ *
+ * Fill xfer (except callback/context, which the scheduler uses),
+ * priority, retries, timeoutUs and done, then call i2cSchedSubmit().
+ */
+struct i2cJob
+{
+    i2cTransfer_t xfer;         /**< Transfer to run */
+    uint8_t priority;           /**< 0 (highest) to 7 (lowest) */
+    uint8_t retries;            /**< Extra attempts after an error */
+    uint32_t timeoutUs;         /**< Deadline relative to submission */
+    i2cJobCallback_t done;      /**< Completion callback (may be 0) */
+    void *user;                 /**< Free for the client */
+
+    /* Scheduler private */
+    uint32_t deadline;          /**< Absolute deadline (timGetMicros()) */
+    uint8_t attempts;           /**< Attempts made so far */
+    i2cJob_t *next;             /**< Queue link */
+};
+
+/**
+ * @brief Scheduler counters
+ */
+typedef struct
+{
+    uint32_t submitted;         /**< Jobs accepted */
+    uint32_t completed;         /**< Jobs finished with I2C_OK */
+    uint32_t failed;            /**< Jobs finished with an error */
+    uint32_t retries;           /**< Retry attempts */
+    uint32_t timeouts;          /**< Jobs that missed their deadline */
+    uint32_t recoveries;        /**< Bus recoveries performed */
+    uint32_t maxQueueDepth;     /**< Most jobs waiting at once */
+    uint32_t maxLatencyUs;      /**< Longest submission-to-completion time */
+} i2cSchedStats_t;
+
+/**
+ * @brief Initialize I2C1 and the scheduler
+ *
+ * @return void
+ */
+void i2cSchedInit(void);
+
+/**
+ * @brief Queue a job
+ *
+ * The job goes behind every queued job of the same or higher priority
+ * and is started at once if the bus is idle.
+ *
+ * @param[in,out] job Job to run (must stay valid until done is called)
+ *
+ * @return 1 if queued, 0 if the job is already queued or running
+ * @note Safe to call from interrupts, including from a done callback
+ */
+uint8_t i2cSchedSubmit(i2cJob_t *job);
+
+/**
+ * @brief Enforce deadlines and run bus recovery
+ *
+ * Aborts the running job if its deadline has passed, recovers the bus
+ * when an error asked for it and restarts the queue.
+ *
+ * @return void
+ * @note Call periodically from the main loop; the deadline resolution
+ *       is the call period
+ */
+void i2cSchedPoll(void);
+
+/**
+ * @brief Number of jobs queued or running
+ *
+ * @return Job count
+ */
+uint32_t i2cSchedPending(void);
+
+/**
+ * @brief Check whether the scheduler still owns a job
+ *
+ * A job stays owned through its retries and bus recoveries (status
+ * I2C_PENDING meanwhile); once this returns 0 its buffers are free and
+ * it may be changed or submitted again.
+ *
+ * @param[in] job Job
+ *
+ * @return 1 if the job is queued or running, 0 once it has finished
+ */
+uint8_t i2cSchedBusy(const i2cJob_t *job);
+
+/**
+ * @brief Copy the scheduler counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void i2cSchedGetStats(i2cSchedStats_t *stats);
+
+#endif // __I2CSCHED_H__
@@ -0,0 +1,186 @@
+/**
+ * @file i2cslave.h
+ * @brief I2C1/I2C2/I2C3 slave register-file driver with DMA
+ *
+ * Lets an external master read and write a register file on this board
+ * like a standard I2C sensor. The data phase runs on DMA; the CPU only
+ * handles the address match and the end of each transfer.
+ *
+ * @details
+ * Pins (open drain, pull-up) and DMA1 streams:
+ * | Port | SCL        | SDA        | RX DMA      | TX DMA      |
+ * |------|------------|------------|-------------|-------------|
+ * | I2C1 | PB8 (AF4)  | PB9 (AF4)  | S0 ch1      | S7 ch1      |
+ * | I2C2 | PB10 (AF4) | PB3 (AF9)  | S2 ch7      | S7 ch7      |
+ * | I2C3 | PA8 (AF4)  | PB4 (AF9)  | S1 ch1      | S4 ch3      |
+ *
+ * Protocol (standard register convention):
+ * - Write: the first byte sets the register pointer, the following
+ *   bytes are stored from the pointer on. Only the writable area
+ *   [I2C_SLAVE_RO_SIZE, I2C_SLAVE_REG_SIZE) accepts writes.
+ * - Read: bytes are sent from the register pointer on and wrap back to
+ *   the pointer after the end of the file. A write of only the pointer
+ *   followed by a repeated START reads from the new pointer.
+ *
+ * The read-only area is double buffered as in spislave.c: the
+ * application updates the back copy and publishes it with
+ * i2cSlaveCommit() between two master transfers.
+ *
+ * Clock stretching is enabled, so the master waits while the address
+ * match interrupt arms the DMA.
+ *
+ * @note I2C1 slave and the I2C1 master (i2c.c) share pins and DMA
+ *       streams; the slave takes the I2C1 vectors through
+ *       i2c1SetSlaveHooks(), and only while the master engine is idle
+ *       and the scheduler (i2csched.c) has no job queued. Do not submit
+ *       I2C1 master transfers afterwards.
+ * @note I2C2 TX shares DMA1 Stream7 with the I2C1 master TX, and I2C3
+ *       TX shares DMA1 Stream4 with SPI2 TX (lcd.c, spislave.c).
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __I2CSLAVE_H__
+#define __I2CSLAVE_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Register file size in bytes (max 255) */
+#ifndef I2C_SLAVE_REG_SIZE
+#define I2C_SLAVE_REG_SIZE      64U
+#endif
+
+/** Size of the read-only area published by the application */
+#ifndef I2C_SLAVE_RO_SIZE
+#define I2C_SLAVE_RO_SIZE       48U
+#endif
+
+/**
+ * @brief Slave port selection
+ */
+typedef enum
+{
+    I2C_SLAVE_PORT1 = 0,    /**< I2C1 on PB8/PB9 */
+    I2C_SLAVE_PORT2,        /**< I2C2 on PB10/PB3 */
+    I2C_SLAVE_PORT3,        /**< I2C3 on PA8/PB4 */
+    I2C_SLAVE_PORT_COUNT
+} i2cSlavePort_t;
+
+/**
+ * @brief Called from the I2C interrupt after the master wrote registers
+ *
+ * @param port Port that received the write
+ * @param addr First register written
+ * @param len Number of bytes accepted
+ */
+typedef void (*i2cSlaveWriteCallback_t)(i2cSlavePort_t port, uint8_t addr, uint8_t len);
+
+/**
+ * @brief Initialize a port as I2C slave
+ *
+ * Configures the pins, the peripheral with the given own address, the
+ * DMA streams and the event/error interrupts, and clears the register
+ * file.
+ *
+ * @param[in] port Port to initialize
+ * @param[in] ownAddr 7-bit own address
+ *
+ * @return 1 if the port is set up, 0 for I2C_SLAVE_PORT1 while an I2C1
+ *         master transfer is running or scheduler jobs are queued
+ *         (nothing is changed then)
+ * @note The event and error interrupt priorities are only set when
+ *       I2C_SLAVE_IRQ_PRIORITY is defined (e.g. -DI2C_SLAVE_IRQ_PRIORITY=0);
+ *       otherwise they are left as they are, since the I2C1 vectors are
+ *       shared with the master engine
+ */
+uint8_t i2cSlaveInit(i2cSlavePort_t port, uint8_t ownAddr);
+
+/**
+ * @brief Write into the back copy of the read-only area
+ *
+ * @param[in] port Port
+ * @param[in] addr First register (must be below I2C_SLAVE_RO_SIZE)
+ * @param[in] data Bytes to write
+ * @param[in] len Number of bytes (clipped to the read-only area)
+ *
+ * @return void
+ * @note Not visible to the master until i2cSlaveCommit()
+ */
+void i2cSlaveUpdate(i2cSlavePort_t port, uint8_t addr, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Publish the back copy to the master
+ *
+ * Swaps at once if no transfer is addressed to us, otherwise at the
+ * end of the transfer in progress.
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+void i2cSlaveCommit(i2cSlavePort_t port);
+
+/**
+ * @brief Read registers (including the area written by the master)
+ *
+ * @param[in] port Port
+ * @param[in] addr First register
+ * @param[out] data Destination
+ * @param[in] len Number of bytes (clipped to the register file)
+ *
+ * @return void
+ */
+void i2cSlaveRead(i2cSlavePort_t port, uint8_t addr, uint8_t *data, uint8_t len);
+
+/**
+ * @brief Register the master-write notification
+ *
+ * @param[in] port Port
+ * @param[in] callback Function to call, or 0 to disable
+ *
+ * @return void
+ */
+void i2cSlaveSetWriteCallback(i2cSlavePort_t port, i2cSlaveWriteCallback_t callback);
+
+/**
+ * @brief Number of transfers addressed to a port
+ *
+ * @param[in] port Port
+ *
+ * @return Transfer count
+ */
+uint32_t i2cSlaveGetTransactions(i2cSlavePort_t port);
+
+/**
+ * @brief Number of bus errors and discarded (too long) writes on a port
+ *
+ * @param[in] port Port
+ *
+ * @return Error count
+ */
+uint32_t i2cSlaveGetErrors(i2cSlavePort_t port);
+
+/**
+ * @brief I2C2 event interrupt handler
+ */
+void I2C2_EV_IRQHandler(void);
+
+/**
+ * @brief I2C2 error interrupt handler
+ */
+void I2C2_ER_IRQHandler(void);
+
+/**
+ * @brief I2C3 event interrupt handler
+ */
+void I2C3_EV_IRQHandler(void);
+
+/**
+ * @brief I2C3 error interrupt handler
+ */
+void I2C3_ER_IRQHandler(void);
+
+#endif // __I2CSLAVE_H__
@@ -0,0 +1,95 @@
+/**
+ * @file l3gd20.h
+ * @brief L3GD20 3-axis gyroscope streaming driver for STM32F411 Discovery
+ *
+ * The gyroscope shares SPI1 (PA5/PA6/PA7) with the pins set up by
+ * spiInit() and has its own chip select and interrupt lines.
+ *
+ * @details
+ * The driver uses the following pins:
+ * - PE3: CS (Chip Select, active low)
+ * - PE1: INT2 (FIFO watermark interrupt, EXTI1 rising edge)
+ *
+ * Streaming operation:
+ * - Output data rate 760 Hz, 32-sample hardware FIFO in stream mode
+ * - FIFO watermark routed to INT2
+ * - On each watermark edge the whole batch is drained with one SPI1
+ *   DMA burst (DMA2 Stream2/Stream3, channel 3); the register address
+ *   auto-increments and wraps from OUT_Z_H back to OUT_X_L, so one
+ *   read of 6 x N bytes returns N samples
+ * - Samples are timestamped from the TIM5 microsecond time base and
+ *   pushed into a ring buffer read with l3gd20ReadSample()
+ * - SPI1 is taken with spi1TryLock(); while the flash (spiflash.c) holds
+ *   it the burst is deferred until spi1Unlock(), which the FIFO depth
+ *   absorbs. The driver owns the SPI1 release callback
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __L3GD20_H__
+#define __L3GD20_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Samples per watermark interrupt (1-31) */
+#ifndef L3GD20_FIFO_WATERMARK
+#define L3GD20_FIFO_WATERMARK   16U
+#endif
+
+/** Ring buffer size in samples (power of two) */
+#ifndef L3GD20_RING_SIZE
+#define L3GD20_RING_SIZE        128U
+#endif
+
+/** Nominal output data rate in Hz */
+#define L3GD20_ODR_HZ           760U
+
+/**
+ * @brief One angular rate sample
+ */
+typedef struct
+{
+    uint32_t timestamp;     /**< Latch time in microseconds (timGetMicros()) */
+    int16_t x;              /**< X axis raw rate */
+    int16_t y;              /**< Y axis raw rate */
+    int16_t z;              /**< Z axis raw rate */
+} l3gd20Sample_t;
+
+/**
+ * @brief Initialize the gyroscope in FIFO streaming mode
+ *
+ * Configures SPI1, the chip select, the sensor registers, the DMA
+ * streams and the watermark interrupt, then starts streaming.
+ *
+ * @return 1 if the sensor answered WHO_AM_I, 0 otherwise
+ *
+ * @note Starts the TIM5 time base if it is not running yet
+ * @see l3gd20ReadSample()
+ */
+uint8_t l3gd20Init(void);
+
+/**
+ * @brief Pop the oldest sample from the ring buffer
+ *
+ * @param[out] sample Destination
+ *
+ * @return 1 if a sample was returned, 0 if the buffer is empty
+ */
+uint8_t l3gd20ReadSample(l3gd20Sample_t *sample);
+
+/**
+ * @brief Number of samples lost because the ring buffer was full
+ *
+ * @return Dropped sample count
+ */
+uint32_t l3gd20GetDropped(void);
+
+/**
+ * @brief DMA2 Stream2 interrupt handler (SPI1 RX complete)
+ */
+void DMA2_Stream2_IRQHandler(void);
+
+#endif // __L3GD20_H__
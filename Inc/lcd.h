@@ -0,0 +1,158 @@
+/**
+ * @file lcd.h
+ * @brief ILI9341/ST7789 SPI display driver with dirty-tile flushing
+ *
+ * The display sits on SPI2 so its traffic does not compete with the
+ * sensors and the flash on SPI1. Drawing functions only touch a RAM
+ * framebuffer and mark the 16x16 tiles they change; lcdFlush() then
+ * sends the dirty tiles, merged into rectangles, in the background.
+ *
+ * @details
+ * The driver uses the following pins:
+ * - PB13: SCK (AF5)
+ * - PB15: MOSI (AF5)
+ * - PB12: CS (Chip Select, active low)
+ * - PB1:  D/C (low = command, high = data)
+ * - PB0:  RESET (active low)
+ *
+ * Framebuffer:
+ * - 4 bits per pixel, 16-entry RGB565 palette (38.4 KB for 240x320
+ *   instead of 150 KB for RGB565, which would not fit in SRAM)
+ * - Each dirty rectangle is sent as CASET/RASET/RAMWR followed by its
+ *   pixels; every line is expanded through the palette into a 16-bit
+ *   line buffer and sent by DMA1 Stream4 (channel 0) with SPI2 in
+ *   16-bit frame mode, while the next line is being expanded.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __LCD_H__
+#define __LCD_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Panel width in pixels */
+#define LCD_WIDTH           240U
+/** Panel height in pixels */
+#define LCD_HEIGHT          320U
+/** Dirty tracking granularity in pixels */
+#define LCD_TILE_SIZE       16U
+/** Number of palette entries */
+#define LCD_PALETTE_SIZE    16U
+
+/** Memory access control value (ILI9341: column order flip, BGR) */
+#ifndef LCD_MADCTL
+#define LCD_MADCTL          0x48U
+#endif
+
+/** Set to 1 for ST7789 panels, which need display inversion */
+#ifndef LCD_INVERT
+#define LCD_INVERT          0U
+#endif
+
+/**
+ * @brief Initialize SPI2, the control pins and the panel
+ *
+ * Resets the panel, leaves sleep mode, selects 16-bit pixels, clears
+ * the framebuffer to palette index 0 and marks the whole screen dirty.
+ *
+ * @return void
+ * @note Blocking: uses systickMsecDelay() for the reset timings (~250 ms)
+ */
+void lcdInit(void);
+
+/**
+ * @brief Set a palette entry
+ *
+ * @param[in] index Palette index (0-15)
+ * @param[in] rgb565 Color in RGB565 format
+ *
+ * @return void
+ * @note Pixels using the entry are not redrawn automatically
+ */
+void lcdSetPalette(uint8_t index, uint16_t rgb565);
+
+/**
+ * @brief Set one pixel
+ *
+ * @param[in] x Column (0 to LCD_WIDTH-1)
+ * @param[in] y Row (0 to LCD_HEIGHT-1)
+ * @param[in] color Palette index
+ *
+ * @return void
+ */
+void lcdSetPixel(uint16_t x, uint16_t y, uint8_t color);
+
+/**
+ * @brief Fill a rectangle (clipped to the screen)
+ *
+ * @param[in] x Left column
+ * @param[in] y Top row
+ * @param[in] w Width in pixels
+ * @param[in] h Height in pixels
+ * @param[in] color Palette index
+ *
+ * @return void
+ */
+void lcdFillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color);
+
+/**
+ * @brief Draw a 1 bit per pixel bitmap (font glyphs, icons)
+ *
+ * Rows are packed MSB first and padded to a whole byte.
+ *
+ * @param[in] x Left column
+ * @param[in] y Top row
+ * @param[in] w Width in pixels
+ * @param[in] h Height in pixels
+ * @param[in] bits Bitmap data
+ * @param[in] fg Palette index for set bits
+ * @param[in] bg Palette index for clear bits
+ *
+ * @return void
+ */
+void lcdDrawBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                   const uint8_t *bits, uint8_t fg, uint8_t bg);
+
+/**
+ * @brief Mark the whole screen dirty (after palette changes)
+ *
+ * @return void
+ */
+void lcdInvalidate(void);
+
+/**
+ * @brief Start sending the dirty regions to the panel
+ *
+ * Takes a snapshot of the dirty tiles and returns immediately; the
+ * transfer continues from the DMA interrupt. Drawing during a flush is
+ * allowed and is picked up by the next flush.
+ *
+ * @return 1 if a flush was started, 0 if one is still running or
+ *         nothing is dirty
+ */
+uint8_t lcdFlush(void);
+
+/**
+ * @brief Check whether a flush is in progress
+ *
+ * @return 1 if busy, 0 otherwise
+ */
+uint8_t lcdIsBusy(void);
+
+/**
+ * @brief Total bytes clocked out on SPI2 since lcdInit()
+ *
+ * @return Byte count (commands and pixels)
+ */
+uint32_t lcdGetBytesSent(void);
+
+/**
+ * @brief DMA1 Stream4 interrupt handler (SPI2 TX complete)
+ */
+void DMA1_Stream4_IRQHandler(void);
+
+#endif // __LCD_H__
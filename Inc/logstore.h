@@ -0,0 +1,194 @@
+/**
+ * @file logstore.h
+ * @brief Append-only log-structured record store on external SPI flash
+ *
+ * Stores variable length records in a circular log on the flash driven
+ * by spiflash.c. Records are buffered in RAM and written one full page
+ * at a time, so flash wear is proportional to the data logged and not
+ * to the number of records.
+ *
+ * @details
+ * Flash layout (per 4 KB sector):
+ * - Page 0: sector summary (magic, sequence number, header CRC and a
+ *   bitmap of committed data pages)
+ * - Pages 1..15: data pages holding packed records
+ *
+ * Record layout inside a data page:
+ * - uint16_t length (little endian, 0xFFFF marks the end of the page)
+ * - uint16_t CRC-16/CCITT over the length field and the payload
+ * - payload bytes
+ *
+ * On mount only the sector summaries are read, which locates the head
+ * and the tail without scanning the data pages. The oldest sectors are
+ * erased ahead of the head by logStorePoll(), one non-blocking sector
+ * erase at a time.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __LOGSTORE_H__
+#define __LOGSTORE_H__
+
+#include <stdint.h>
+#include "spiflash.h"
+
+/** First flash address used by the log */
+#ifndef LOG_FLASH_BASE
+#define LOG_FLASH_BASE          0x000000U
+#endif
+
+/** Number of 4 KB sectors used by the log (512 = 2 MB, W25Q16) */
+#ifndef LOG_SECTOR_COUNT
+#define LOG_SECTOR_COUNT        512U
+#endif
+
+/** Number of sectors kept erased ahead of the head */
+#ifndef LOG_ERASE_AHEAD
+#define LOG_ERASE_AHEAD         2U
+#endif
+
+/** Number of RAM page buffers (one filling, the rest waiting to program) */
+#ifndef LOG_PAGE_BUFFERS
+#define LOG_PAGE_BUFFERS        2U
+#endif
+
+/** Size of the record header (length + CRC) */
+#define LOG_REC_HDR_SIZE        4U
+/** Largest payload accepted by logStoreAppend() */
+#define LOG_MAX_RECORD_SIZE     (SPI_FLASH_PAGE_SIZE - LOG_REC_HDR_SIZE)
+
+/**
+ * @brief Result codes of the log store functions
+ */
+typedef enum
+{
+    LOG_OK = 0,         /**< Operation completed */
+    LOG_END,            /**< No more records to read */
+    LOG_BUSY,           /**< Flash is programming or erasing, try again */
+    LOG_ERR_SIZE,       /**< Record length is zero or too large */
+    LOG_ERR_FULL        /**< All page buffers are waiting for the flash */
+} logStatus_t;
+
+/**
+ * @brief Read position in the log
+ */
+typedef struct
+{
+    uint32_t seq;       /**< Sequence number of the sector being read */
+    uint16_t sector;    /**< Sector index */
+    uint16_t page;      /**< Data page inside the sector */
+    uint16_t offset;    /**< Byte offset inside the page */
+} logCursor_t;
+
+/**
+ * @brief Counters used to evaluate recovery cost and write amplification
+ *
+ * Write amplification = bytesProgrammed / bytesAppended.
+ */
+typedef struct
+{
+    uint32_t bytesAppended;     /**< Payload bytes accepted */
+    uint32_t bytesProgrammed;   /**< Bytes sent to the flash with page program */
+    uint32_t pagesProgrammed;   /**< Data pages programmed */
+    uint32_t sectorsErased;     /**< Sector erases issued */
+    uint32_t sectorsDropped;    /**< Sectors with data erased to make room */
+    uint32_t recordsDropped;    /**< Records rejected with LOG_ERR_FULL */
+    uint32_t crcErrors;         /**< Records skipped by the reader */
+    uint32_t mountHeaderReads;  /**< Sector summaries read by the last mount */
+} logStats_t;
+
+/**
+ * @brief Initialize the flash and mount the log
+ *
+ * @return void
+ * @see logStoreMount()
+ */
+void logStoreInit(void);
+
+/**
+ * @brief Rebuild head and tail from the sector summaries
+ *
+ * Reads one 12-byte summary per sector. The head is the valid sector
+ * with the highest sequence number and its write page comes from the
+ * committed page bitmap. The tail is found by walking back from the
+ * head through contiguous valid sectors.
+ *
+ * @return void
+ */
+void logStoreMount(void);
+
+/**
+ * @brief Append one record to the log
+ *
+ * Copies the record into the current RAM page. Records never cross a
+ * page: when the record does not fit, the page is sealed and handed to
+ * logStorePoll() for programming.
+ *
+ * @param[in] data Payload bytes
+ * @param[in] len Payload length (1..LOG_MAX_RECORD_SIZE)
+ *
+ * @return LOG_OK, LOG_ERR_SIZE or LOG_ERR_FULL
+ * @note Call from the same context as logStorePoll()
+ */
+logStatus_t logStoreAppend(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Seal the partially filled RAM page
+ *
+ * The rest of the page stays erased (0xFF), which the reader treats as
+ * the end of the page.
+ *
+ * @return LOG_OK or LOG_ERR_FULL
+ */
+logStatus_t logStoreFlush(void);
+
+/**
+ * @brief Advance the background flash work by one step
+ *
+ * Issues at most one flash operation per call and returns immediately
+ * if the flash is busy: open the next sector, mark a page committed,
+ * program a sealed page, or erase the next sector ahead of the head.
+ *
+ * @return void
+ * @note Call periodically from the main loop
+ */
+void logStorePoll(void);
+
+/**
+ * @brief Place a cursor on the oldest record
+ *
+ * @param[out] cursor Cursor to initialize
+ *
+ * @return void
+ */
+void logStoreCursorInit(logCursor_t *cursor);
+
+/**
+ * @brief Read the next record and advance the cursor
+ *
+ * Records with a CRC mismatch are skipped and counted. If the sector
+ * under the cursor has been erased, the cursor restarts at the tail.
+ *
+ * @param[in,out] cursor Read position
+ * @param[out] data Destination buffer
+ * @param[in] maxLen Size of the destination buffer
+ * @param[out] len Length of the record read
+ *
+ * @return LOG_OK, LOG_END, LOG_BUSY or LOG_ERR_SIZE (buffer too small,
+ *         cursor not advanced)
+ * @note Records still in RAM are not visible until programmed
+ */
+logStatus_t logStoreReadNext(logCursor_t *cursor, uint8_t *data, uint16_t maxLen, uint16_t *len);
+
+/**
+ * @brief Copy the log store counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void logStoreGetStats(logStats_t *stats);
+
+#endif // __LOGSTORE_H__
@@ -0,0 +1,182 @@
+/**
+ * @file pipeline.h
+ * @brief Zero-copy acquisition pipeline: ADC -> DSP stage -> pack -> sink
+ *
+ * Timer-triggered ADC blocks travel through an in-place processing
+ * stage, a packing stage and a DMA sink (UART2 or an SD write stream)
+ * without ever being copied: every stage works on the same pool slot
+ * and ownership moves between stages with small descriptors.
+ *
+ * @details
+ * Slot layout (one per descriptor, PIPE_SLOT_BYTES() bytes):
+ * - pipeHeader_t (PIPE_HEADER_BYTES), filled by the pipeline
+ * - frames * channels samples, written by DMA2 Stream0, then processed
+ *   and packed in place; the sink sends header + payload directly
+ *
+ * Descriptor life cycle:
+ * - FREE -> ADC: the DMA interrupt swaps a free slot into the idle
+ *   ping-pong address register (adcTrigReplaceBuffer())
+ * - ADC -> READY: the finished slot is queued for pipePoll()
+ * - READY -> SINK: pipePoll() runs the stage and the packer and queues
+ *   the slot on the sink
+ * - SINK -> FREE: UART DMA completion (interrupt) or a released SD
+ *   stream slot (pipePoll())
+ *
+ * Backpressure: when no slot is free at a DMA swap, the finished block
+ * stays in the DMA (it is overwritten) and counts as dropped; the
+ * header sequence number shows the gap in the output stream.
+ *
+ * Packing:
+ * - RAW16  : samples as they are after the stage
+ * - DELTA16: first frame absolute, then per-channel differences
+ *   (int16 wrap-around, lossless, for downstream compression)
+ * - PACK12 : low 12 bits, two samples in three bytes (s0[7:0],
+ *   s0[11:8] | s1[3:0] << 4, s1[11:4]); an odd last sample uses two
+ *
+ * The SD sink pads every block with zeros to a multiple of 512 bytes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __PIPELINE_H__
+#define __PIPELINE_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+#include "adc.h"
+
+/** Number of descriptors and slots (power of two) */
+#ifndef PIPE_POOL_SIZE
+#define PIPE_POOL_SIZE          4U
+#endif
+
+/** Bytes of pipeHeader_t in front of the samples */
+#define PIPE_HEADER_BYTES       12U
+
+/** Header magic value */
+#define PIPE_MAGIC              0xA55AU
+
+/** Bytes of one slot for a block of samples (frames * channels) */
+#define PIPE_SLOT_BYTES(samples)    (((PIPE_HEADER_BYTES + (2U * (samples))) + 511U) & ~511U)
+
+/** 32-bit words of one slot, for declaring an aligned pool */
+#define PIPE_SLOT_WORDS(samples)    (PIPE_SLOT_BYTES(samples) / 4U)
+
+/**
+ * @brief Packing stage format
+ */
+typedef enum
+{
+    PIPE_PACK_RAW16 = 0,    /**< 16 bits per sample, unchanged */
+    PIPE_PACK_DELTA16,      /**< 16-bit per-channel differences */
+    PIPE_PACK_12BIT         /**< 12 bits per sample, 2 samples in 3 bytes */
+} pipePack_t;
+
+/**
+ * @brief Sink of the packed blocks
+ */
+typedef enum
+{
+    PIPE_SINK_UART = 0,     /**< UART2 DMA (uartInit() first) */
+    PIPE_SINK_SD            /**< SD multi-block write stream (sdInit() first) */
+} pipeSink_t;
+
+/**
+ * @brief Block header, little endian
+ */
+typedef struct
+{
+    uint16_t magic;         /**< PIPE_MAGIC */
+    uint8_t pack;           /**< pipePack_t */
+    uint8_t channels;       /**< Samples per frame */
+    uint16_t frames;        /**< Frames in the block */
+    uint16_t seq;           /**< Block number, gaps mean dropped blocks */
+    uint32_t timestamp;     /**< First frame (timGetMicros() scale) */
+} pipeHeader_t;
+
+/**
+ * @brief In-place processing stage, runs in pipePoll()
+ *
+ * @param samples frames * channels interleaved samples, replaced by the
+ *                stage output (e.g. dspAdcToQ15() then a filter)
+ * @param frames Number of frames
+ * @param channels Samples per frame
+ */
+typedef void (*pipeStage_t)(uint16_t *samples, uint16_t frames, uint8_t channels);
+
+/**
+ * @brief Pipeline configuration
+ */
+typedef struct
+{
+    const adcScanChannel_t *channels;   /**< Scan sequence */
+    uint8_t count;                      /**< Number of channels */
+    uint16_t frames;                    /**< Frames per block */
+    uint32_t rateHz;                    /**< Frame rate */
+    uint32_t *pool;                     /**< PIPE_POOL_SIZE * PIPE_SLOT_WORDS(frames * count) */
+    pipeStage_t stage;                  /**< Processing stage (may be 0) */
+    pipePack_t pack;                    /**< Packing format */
+    pipeSink_t sink;                    /**< Output */
+    uint32_t sdLba;                     /**< First block of the SD stream */
+} pipeConfig_t;
+
+/**
+ * @brief Pipeline counters
+ */
+typedef struct
+{
+    uint32_t acquired;      /**< Blocks completed by the ADC */
+    uint32_t dropped;       /**< Blocks lost because no slot was free */
+    uint32_t processed;     /**< Blocks through the stage and the packer */
+    uint32_t sent;          /**< Blocks released by the sink */
+    uint32_t bytes;         /**< Bytes handed to the sink */
+    uint32_t sinkWaits;     /**< Blocks queued while the sink was busy */
+    uint32_t sinkErrors;    /**< Failed sink transfers */
+    uint32_t minFree;       /**< Lowest number of free slots seen */
+} pipeStats_t;
+
+/**
+ * @brief Configure the ADC, the pool and the sink
+ *
+ * @param[in] config Configuration (copied)
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t pipeInit(const pipeConfig_t *config);
+
+/**
+ * @brief Open the sink and start the ADC trigger
+ *
+ * @return 1 on success, 0 if the SD stream could not be opened
+ */
+uint8_t pipeStart(void);
+
+/**
+ * @brief Run the stage and the packer on every finished block
+ *
+ * Call from the main loop at least once per block period.
+ *
+ * @return Number of blocks processed
+ */
+uint32_t pipePoll(void);
+
+/**
+ * @brief Stop the ADC, flush the queued blocks and close the sink
+ *
+ * @return 1 on success, 0 if the sink failed
+ * @note Blocking until the sink has taken every block
+ */
+uint8_t pipeStop(void);
+
+/**
+ * @brief Copy the counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void pipeGetStats(pipeStats_t *stats);
+
+#endif // __PIPELINE_H__
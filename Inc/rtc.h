@@ -3,29 +3,167 @@
 
 #define STM32F411xE
 #include "stm32f4xx.h"
+#include "rtctime.h"
 
 /**
  * @file rtc.h
  * @brief RTC (Real Time Clock) driver for STM32F411xE
  * 
- * Provides functions to initialize and manage RTC using LSI clock source
- * at 32 kHz frequency.
+ * Provides functions to initialize and manage RTC using the LSI (32 kHz,
+ * +-10 %) or the LSE (32.768 kHz crystal) clock source.
+ *
+ * rtcGetSnapshot() reads SSR, TR and DR in one call and returns the
+ * decoded calendar with sub-second resolution. With shadow registers
+ * (default) reading SSR freezes TR and DR until DR is read, so the
+ * three values always belong to the same instant. In bypass mode
+ * (BYPSHAD) the counters are read directly, which avoids waiting for
+ * RSF after a wakeup; the snapshot then reads everything twice and
+ * retries until both reads agree.
+ *
+ * rtcCalibrate() counts the oscillator with TIM5 input capture (TI4
+ * remapped to LSI or LSE) and programs the smooth digital calibration
+ * (CALR, -487 to +488 ppm in 0.95 ppm steps) without stopping the
+ * calendar. The reference is the timer clock, so the result has crystal
+ * accuracy only when SYSCLK runs from HSE (directly or through the PLL);
+ * on HSI (+-1 %) it only removes the gross LSI error, and an LSE crystal
+ * is left alone (RTC_CAL_NO_REFERENCE). LSI is too far off for CALR
+ * alone: a cold start fits the synchronous prescaler to the measured
+ * LSI (500 ppm steps) and CALR trims the rest. Call it after a cold
+ * start (RTC_CAL_AT_BOOT) and then periodically, e.g. hourly, to follow
+ * temperature drift; CALR is in the backup domain, so a warm start
+ * keeps the last value without the measurement window.
  * 
  * @author Bare Metal STM32
  * @date 2026
  */
 
+/** Backup register value marking a configured RTC */
+#define RTC_BKP_MAGIC           0x52544301U
+
+/** Nominal oscillator frequencies (Hz) */
+#define RTC_LSI_VALUE           32000U
+#define RTC_LSE_VALUE           32768U
+
+/** Longest LSE start-up before falling back to LSI (ms) */
+#ifndef RTC_LSE_STARTUP_MS
+#define RTC_LSE_STARTUP_MS      2000U
+#endif
+
+/** Measurement window of rtcCalibrate() (ms), 1 us timer = 1 ppm per s */
+#ifndef RTC_CAL_WINDOW_MS
+#define RTC_CAL_WINDOW_MS       1000U
+#endif
+
+/** Longest gap between two captures before the measurement fails (us) */
+#define RTC_CAL_CAPTURE_TIMEOUT_US  20000U
+
+/** Run rtcCalibrate() at the end of a cold rtcInit() */
+#ifndef RTC_CAL_AT_BOOT
+#define RTC_CAL_AT_BOOT         1
+#endif
+
+/** Also run it on a warm rtcInit() (blocks for RTC_CAL_WINDOW_MS) */
+#ifndef RTC_CAL_AT_WARM_BOOT
+#define RTC_CAL_AT_WARM_BOOT    0
+#endif
+
+/** rtcCalibrate() results */
+#define RTC_CAL_OK              0U
+#define RTC_CAL_CLAMPED         1U  /**< Error beyond the CALR range, limit applied */
+#define RTC_CAL_FAILED          2U  /**< No oscillator edges or CALR busy */
+#define RTC_CAL_NO_REFERENCE    3U  /**< LSE without an HSE timer clock, CALR unchanged */
+
+/**
+ * @brief RTC clock source
+ */
+typedef enum
+{
+    RTC_CLOCK_LSI = 0,      /**< Internal RC, about 32 kHz */
+    RTC_CLOCK_LSE           /**< External 32.768 kHz crystal */
+} rtcClock_t;
+
+/** Source used by rtcInit() */
+#ifndef RTC_CLOCK_DEFAULT
+#define RTC_CLOCK_DEFAULT       RTC_CLOCK_LSI
+#endif
+
+/**
+ * @brief Result of rtcCalibrate()
+ */
+typedef struct
+{
+    int32_t ppm;            /**< Oscillator error vs. the prescalers, > 0 = fast */
+    uint32_t frequency;     /**< Measured oscillator frequency (Hz) */
+    uint32_t calr;          /**< Value written to RTC->CALR */
+    uint8_t hseReference;   /**< 1 if the timer clock came from HSE */
+} rtcCal_t;
+
+/**
+ * @brief Initialize RTC peripheral with RTC_CLOCK_DEFAULT
+ * 
+ * @return void
+ * @see rtcInitSource()
+ */
+void rtcInit(void);
+
 /**
- * @brief Initialize RTC peripheral
+ * @brief Initialize RTC peripheral with a given clock source
  * 
- * Configures RTC with LSI as clock source (32 kHz) and enters initialization mode.
+ * Cold start: resets the backup domain, starts the oscillator (LSE falls
+ * back to LSI after RTC_LSE_STARTUP_MS), sets the prescalers and the
+ * default calendar, stores the requested source in backup register 1
+ * and RTC_BKP_MAGIC in backup register 0.
+ * Warm start (magic present, same source requested, RTC enabled and
+ * calendar initialized): only restores backup domain access and LSI
+ * and waits for the shadow registers, so the time survives resets and
+ * no oscillator wait is needed.
+ * The cold path ends with rtcCalibrate() when RTC_CAL_AT_BOOT is set,
+ * the warm path only when RTC_CAL_AT_WARM_BOOT is set.
  * Must be called before any other RTC operations.
  * 
+ * @param source RTC_CLOCK_LSI or RTC_CLOCK_LSE
+ *
  * @return void
- * @note Disables write protection after initialization
+ * @note Write protection is enabled on return
+ * @note Starts the TIM5 time base (tim5TimebaseInit())
  */
-void rtcInit(void);
+void rtcInitSource(rtcClock_t source);
+
+/**
+ * @brief Get the clock driving the RTC
+ *
+ * @return RTC_CLOCK_LSE or RTC_CLOCK_LSI
+ */
+rtcClock_t rtcGetClockSource(void);
 
+/**
+ * @brief Measure the RTC clock and program the smooth calibration
+ *
+ * Blocks for RTC_CAL_WINDOW_MS with interrupts enabled and uses TIM5
+ * channel 4; the calendar is not stopped. The calibration value is
+ * absolute, so repeated calls do not accumulate.
+ *
+ * @param result Measurement details (may be 0, unchanged on failure)
+ *
+ * @return RTC_CAL_OK, RTC_CAL_CLAMPED, RTC_CAL_FAILED, or
+ *         RTC_CAL_NO_REFERENCE (LSE and SYSCLK not from HSE; returns at
+ *         once without measuring)
+ */
+uint8_t rtcCalibrate(rtcCal_t *result);
+
+/**
+ * @brief Check how the last rtcInit() started the RTC
+ *
+ * @return 1 if the running calendar was kept, 0 after a cold start
+ */
+uint8_t rtcIsWarmBoot(void);
+
+/**
+ * @brief Convert decimal value to BCD
+ * 
+ * @param value Decimal value (0-99)
+ * @return BCD encoded value
+ */
 uint8_t rtcConvertDec2BCD(uint8_t value);
 
 /**
@@ -81,84 +219,111 @@ uint32_t rtcTimeGetMinute(void);
 uint32_t rtcTimeGetHour(void);
 
 /**
- * @brief Enable RTC initialization mode
- * 
- * Allows writing to RTC registers. Must be enabled before configuring
- * time and date.
- * 
+ * @brief Read the whole calendar coherently
+ *
+ * Reads SSR, TR, DR in that order (shadow registers) or twice until two
+ * reads agree (bypass mode), then decodes the BCD fields.
+ *
+ * @param dt Destination
+ *
  * @return void
+ * @note With shadow registers RSF must be set, which takes up to two
+ *       RTCCLK periods after a wakeup from STOP
  */
-void rtcEnableInitMode(void);
+void rtcGetSnapshot(rtcDateTime_t *dt);
 
 /**
- * @brief Disable RTC initialization mode
- * 
- * Exits initialization mode and resumes normal RTC operation.
- * 
- * @return void
+ * @brief Current time as Unix milliseconds
+ *
+ * @return Milliseconds since 1970-01-01 00:00:00 (RTC taken as UTC)
  */
-void rtcDisableInitMode(void);
+uint64_t rtcGetEpochMs(void);
 
 /**
- * @brief Check if RTC initialization flag is active
- * 
- * @return 1 if init mode is active, 0 otherwise
+ * @brief Set the calendar from Unix seconds
+ *
+ * Writes TR and DR in initialization mode and switches the RTC to the
+ * 24-hour format; the sub-second counter restarts.
+ *
+ * @param seconds RTC_EPOCH_2000 to RTC_EPOCH_2100 - 1
+ *
+ * @return 1 on success, 0 if seconds is out of range or the RTC did
+ *         not enter initialization mode
  */
-uint8_t rtcIsActiveFlagInit(void);
+uint8_t rtcSetEpoch(uint32_t seconds);
 
 /**
- * @brief Check if RTC registers are synchronized
- * 
- * @return 1 if synchronized, 0 otherwise
+ * @brief Select direct counter reads (BYPSHAD)
+ *
+ * @param enable 1 = read the counters directly, 0 = shadow registers
+ *
+ * @return void
  */
-uint8_t rtcIsActiveFlagRS(void);
+void rtcSetBypassShadow(uint8_t enable);
 
 /**
- * @brief Internal initialization sequence
- * 
- * @return Status (1 = success, 0 = fail)
+ * @brief Current time as Unix seconds
+ *
+ * @return Seconds since 1970-01-01 00:00:00 (RTC taken as UTC)
  */
-static uint8_t rtcInitSeq(void);
+uint32_t rtcGetEpoch(void);
 
 /**
- * @brief Wait for RTC synchronization
- * 
- * @return Status (1 = success, 0 = timeout)
+ * @brief Resynchronize the shadow registers after a wakeup
+ *
+ * Clears RSF and waits until TR/DR are copied again, as required after
+ * STOP or STANDBY before reading the calendar. Nothing to do in bypass
+ * mode.
+ *
+ * @return 1 if synchronized, 0 if timeout
  */
-static uint8_t waitForSynchro(void);
+uint8_t rtcResync(void);
 
 /**
- * @brief Exit initialization sequence
- * 
- * @return Status (1 = success, 0 = fail)
+ * @brief Unlock the RTC registers (WPR key sequence)
+ *
+ * @return void
+ */
+void rtcDisableWriteProtection(void);
+
+/**
+ * @brief Lock the RTC registers
+ *
+ * @return void
  */
-static uint8_t exitInitSeq(void);
+void rtcEnableWriteProtection(void);
 
 /**
- * @brief Configure RTC date registers
+ * @brief Enable RTC initialization mode
  * 
- * @param weekDay Day of week (1-7)
- * @param day Day of month (1-31)
- * @param month Month (1-12)
- * @param year Year (0-99)
+ * Allows writing to RTC registers. Must be enabled before configuring
+ * time and date.
  * 
  * @return void
  */
-static void rtcDateConfig(uint32_t weekDay, uint32_t day, uint32_t month, uint32_t year);
+void rtcEnableInitMode(void);
 
 /**
- * @brief Configure RTC time registers
+ * @brief Disable RTC initialization mode
  * 
- * @param format1224 Time format (0=24-hour, 1=12-hour with AM/PM)
- * @param hours Hours (0-23)
- * @param minutes Minutes (0-59)
- * @param seconds Seconds (0-59)
+ * Exits initialization mode and resumes normal RTC operation.
  * 
  * @return void
  */
-static void rtcTimeConfig(uint32_t format1224, uint32_t hours, uint32_t minutes, uint32_t seconds);
+void rtcDisableInitMode(void);
+
+/**
+ * @brief Check if RTC initialization flag is active
+ * 
+ * @return 1 if init mode is active, 0 otherwise
+ */
+uint8_t rtcIsActiveFlagInit(void);
 
+/**
+ * @brief Check if RTC registers are synchronized
+ * 
+ * @return 1 if synchronized, 0 otherwise
+ */
+uint8_t rtcIsActiveFlagRS(void);
 
-static void rtcSetAsynchPrescaler(uint32_t asynchPrescaler);
-static void rtcSetSynchPrescaler(uint32_t synchPrescaler);
 #endif // __RTC__H__
\ No newline at end of file
@@ -0,0 +1,168 @@
+/**
+ * @file rtcalarm.h
+ * @brief Calendar event scheduler on RTC Alarm A/B with wake-up from STOP
+ *
+ * Any number of events wait in a queue sorted by due time; the hardware
+ * alarms always hold the nearest ones, so the MCU can stay in STOP mode
+ * until the next event instead of polling the calendar.
+ *
+ * @details
+ * - Alarm A holds the first queued event, Alarm B the next later one, so
+ *   an event due shortly after the first still wakes the MCU if its
+ *   dispatch runs late
+ * - Alarms compare day of month, hours, minutes and seconds: an event
+ *   more than a month ahead can match early once a month; the dispatch
+ *   then finds nothing due and reprograms the same event
+ * - RTC_Alarm_IRQHandler (EXTI line 17, rising edge) only clears the
+ *   flags and marks the queue pending; callbacks run in rtcAlarmDispatch()
+ *   from the main loop, where they may add or remove events
+ * - Periodic events are put back periodS later (skipping missed
+ *   periods) before their callback runs
+ *
+ * Events live in caller memory (no allocation) and are linked into the
+ * queue through their next field. Times are Unix seconds, RTC taken as
+ * UTC (see rtctime.h), between RTC_EPOCH_2000 and RTC_EPOCH_2100.
+ *
+ * Typical main loop:
+ * @code
+ * while(1)
+ * {
+ *     rtcAlarmDispatch();
+ *     rtcAlarmSleep();
+ * }
+ * @endcode
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __RTCALARM_H__
+#define __RTCALARM_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+typedef struct rtcAlarmEvent rtcAlarmEvent_t;
+
+/**
+ * @brief Called when an event is due (rtcAlarmDispatch() context)
+ *
+ * @param event Due event; a one-shot event is out of the queue and may
+ *              be added again, a periodic one is already requeued
+ * @param now Current Unix time
+ */
+typedef void (*rtcAlarmCallback_t)(rtcAlarmEvent_t *event, uint32_t now);
+
+/**
+ * @brief Scheduled calendar event
+ *
+ * Fill when, periodS, callback and user, then call rtcAlarmAdd().
+ */
+struct rtcAlarmEvent
+{
+    uint32_t when;                  /**< Due time (Unix seconds) */
+    uint32_t periodS;               /**< Repeat interval, 0 = once */
+    rtcAlarmCallback_t callback;    /**< Handler (may be 0) */
+    void *user;                     /**< Free for the client */
+
+    /* Scheduler private */
+    uint8_t queued;                 /**< 1 while in the queue */
+    rtcAlarmEvent_t *next;          /**< Queue link */
+};
+
+/**
+ * @brief Scheduler counters
+ */
+typedef struct
+{
+    uint32_t dispatched;    /**< Callbacks run */
+    uint32_t wakeups;       /**< Alarm interrupts */
+    uint32_t early;         /**< Alarm interrupts with nothing due */
+    uint32_t late;          /**< Due events found while programming the alarms */
+    uint32_t maxQueued;     /**< Most events queued at once */
+} rtcAlarmStats_t;
+
+/**
+ * @brief Enable the alarm interrupt path
+ *
+ * Disables both alarms, routes them to EXTI line 17 (rising edge,
+ * interrupt mask set so they also wake from STOP) and enables
+ * RTC_Alarm_IRQn.
+ *
+ * @return void
+ * @note Call after rtcInit()
+ */
+void rtcAlarmInit(void);
+
+/**
+ * @brief Queue an event
+ *
+ * The event goes behind every queued event with the same due time and
+ * the alarms are reloaded with the two nearest events.
+ *
+ * @param[in,out] event Event (must stay valid while queued)
+ *
+ * @return 1 if queued, 0 if already queued or when is out of range
+ * @note Main loop context only (not from interrupts)
+ */
+uint8_t rtcAlarmAdd(rtcAlarmEvent_t *event);
+
+/**
+ * @brief Take an event out of the queue
+ *
+ * @param[in,out] event Event
+ *
+ * @return 1 if removed, 0 if it was not queued
+ * @note Main loop context only
+ */
+uint8_t rtcAlarmRemove(rtcAlarmEvent_t *event);
+
+/**
+ * @brief Run the callbacks of every due event
+ *
+ * Pops each event whose time has come, requeues periodic ones, calls
+ * the callbacks and reprograms the alarms.
+ *
+ * @return Number of callbacks run
+ */
+uint32_t rtcAlarmDispatch(void);
+
+/**
+ * @brief Due time of the first queued event
+ *
+ * @return Unix seconds, 0 if the queue is empty
+ */
+uint32_t rtcAlarmNext(void);
+
+/**
+ * @brief Enter STOP mode until an interrupt (usually the next alarm)
+ *
+ * Returns at once if an event is already due. STOP runs the regulator
+ * in low-power mode (LPDS); on wake-up the system clock is HSI again,
+ * the PLL is restarted if it was running, and the calendar shadow
+ * registers are resynchronized.
+ *
+ * @return 1 if the MCU went to STOP, 0 if an event was pending
+ * @note TIM5 and SysTick do not count in STOP; finish UART and DMA
+ *       transfers first
+ */
+uint8_t rtcAlarmSleep(void);
+
+/**
+ * @brief Copy the scheduler counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void rtcAlarmGetStats(rtcAlarmStats_t *stats);
+
+/**
+ * @brief RTC Alarm A/B interrupt handler (EXTI line 17)
+ *
+ * @return void
+ */
+void RTC_Alarm_IRQHandler(void);
+
+#endif // __RTCALARM_H__
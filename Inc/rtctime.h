@@ -0,0 +1,169 @@
+/**
+ * @file rtctime.h
+ * @brief Calendar, BCD and Unix epoch conversions for the RTC
+ *
+ * Converts between the RTC calendar (decoded or as raw BCD TR/DR
+ * register values) and Unix time in seconds or milliseconds, cheap
+ * enough to run on every log record.
+ *
+ * @details
+ * - Dates map to day numbers with the days-from-civil algorithm
+ *   (H. Hinnant): a March-based year makes the month lengths a linear
+ *   formula, so there are no loops over months or years and only
+ *   divisions by constants
+ * - BCD fields are encoded through a 100-entry table and decoded
+ *   through a table indexed by the BCD byte itself, so any masked
+ *   register field is a valid index
+ * - The RTC covers 2000-2099, where epoch seconds fit in 32 bits; the
+ *   millisecond value is 64-bit and split without a 64-bit division
+ * - Time is always 24-hour; 12-hour register values must be converted
+ *   by the caller (see rtcGetSnapshot())
+ *
+ * Like dsp.c this module only needs stdint.h, so it is verified on a
+ * host over every day of the RTC range.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __RTCTIME_H__
+#define __RTCTIME_H__
+
+#include <stdint.h>
+
+/** Unix time of 2000-01-01 00:00:00 */
+#define RTC_EPOCH_2000          946684800UL
+
+/** Unix time of 2100-01-01 00:00:00, first value out of range */
+#define RTC_EPOCH_2100          4102444800UL
+
+/**
+ * @brief Decoded calendar at one instant
+ */
+typedef struct
+{
+    uint8_t year;           /**< Year (0-99, 2000-2099) */
+    uint8_t month;          /**< Month (1-12) */
+    uint8_t day;            /**< Day of month (1-31) */
+    uint8_t weekDay;        /**< Day of week (1-7, 1 = Monday) */
+    uint8_t hours;          /**< Hours (0-23, also in 12-hour mode) */
+    uint8_t minutes;        /**< Minutes (0-59) */
+    uint8_t seconds;        /**< Seconds (0-59) */
+    uint16_t subSeconds;    /**< Raw SSR (counts down from PREDIV_S) */
+    uint16_t millis;        /**< Milliseconds (0-999) */
+} rtcDateTime_t;
+
+/** Binary 0-99 to BCD */
+extern const uint8_t rtcBcdEncodeTable[100];
+
+/** BCD byte to binary, 0 for invalid digits */
+extern const uint8_t rtcBcdDecodeTable[256];
+
+/**
+ * @brief Binary to BCD (0-99)
+ *
+ * @param[in] value Binary value
+ *
+ * @return BCD byte
+ */
+static inline uint8_t rtcBcdEncode(uint32_t value)
+{
+    return rtcBcdEncodeTable[value];
+}
+
+/**
+ * @brief BCD to binary
+ *
+ * @param[in] bcd BCD byte (0x00-0x99, other digits give 0)
+ *
+ * @return Binary value
+ */
+static inline uint8_t rtcBcdDecode(uint32_t bcd)
+{
+    return rtcBcdDecodeTable[bcd];
+}
+
+/**
+ * @brief Days since 1970-01-01 of a date
+ *
+ * @param[in] year Full year (2000-2099)
+ * @param[in] month Month (1-12)
+ * @param[in] day Day of month (1-31)
+ *
+ * @return Day number
+ */
+uint32_t rtcDaysFromCivil(uint32_t year, uint32_t month, uint32_t day);
+
+/**
+ * @brief Date of a day number
+ *
+ * Also fills weekDay (1 = Monday); the time fields are not touched.
+ *
+ * @param[in] days Days since 1970-01-01 (2000-2099)
+ * @param[out] dt Date fields
+ *
+ * @return void
+ */
+void rtcCivilFromDays(uint32_t days, rtcDateTime_t *dt);
+
+/**
+ * @brief Unix seconds of a calendar value
+ *
+ * @param[in] dt Calendar (weekDay, subSeconds and millis ignored)
+ *
+ * @return Seconds since 1970-01-01 00:00:00
+ */
+uint32_t rtcEpochFromDateTime(const rtcDateTime_t *dt);
+
+/**
+ * @brief Unix milliseconds of a calendar value
+ *
+ * @param[in] dt Calendar (millis included)
+ *
+ * @return Milliseconds since 1970-01-01 00:00:00
+ */
+uint64_t rtcEpochMsFromDateTime(const rtcDateTime_t *dt);
+
+/**
+ * @brief Calendar of a Unix time
+ *
+ * @param[in] seconds RTC_EPOCH_2000 to RTC_EPOCH_2100 - 1
+ * @param[out] dt Calendar (subSeconds and millis set to 0)
+ *
+ * @return void
+ */
+void rtcDateTimeFromEpoch(uint32_t seconds, rtcDateTime_t *dt);
+
+/**
+ * @brief Calendar of a Unix time in milliseconds
+ *
+ * @param[in] ms Milliseconds in the 2000-2099 range
+ * @param[out] dt Calendar (subSeconds set to 0)
+ *
+ * @return void
+ */
+void rtcDateTimeFromEpochMs(uint64_t ms, rtcDateTime_t *dt);
+
+/**
+ * @brief Unix seconds of raw RTC registers
+ *
+ * @param[in] tr RTC_TR value (24-hour format)
+ * @param[in] dr RTC_DR value
+ *
+ * @return Seconds since 1970-01-01 00:00:00
+ */
+uint32_t rtcEpochFromRegs(uint32_t tr, uint32_t dr);
+
+/**
+ * @brief Raw RTC register values of a Unix time
+ *
+ * @param[in] seconds RTC_EPOCH_2000 to RTC_EPOCH_2100 - 1
+ * @param[out] tr RTC_TR value (24-hour format)
+ * @param[out] dr RTC_DR value, weekday included
+ *
+ * @return void
+ */
+void rtcRegsFromEpoch(uint32_t seconds, uint32_t *tr, uint32_t *dr);
+
+#endif // __RTCTIME_H__
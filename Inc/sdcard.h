@@ -0,0 +1,173 @@
+/**
+ * @file sdcard.h
+ * @brief SD card driver (4-bit SDIO, multi-block DMA streaming)
+ *
+ * Implements the SD protocol on top of sdio.c: card identification,
+ * switch to the 4-bit bus at 24 MHz, multi-block reads and an open-ended
+ * multi-block write stream for data logging.
+ *
+ * @details
+ * Write streaming:
+ * - sdStreamOpen() pre-erases the expected length with ACMD23 and sends
+ *   one WRITE_MULTIPLE_BLOCK (CMD25) for the whole session
+ * - sdStreamSubmit() queues a filled buffer and returns at once; up to
+ *   SD_STREAM_SLOTS buffers can be queued, so the application fills one
+ *   buffer while the other is being written by DMA
+ * - The next queued buffer is started from the data interrupt, so the
+ *   card never waits on the main loop. The card's busy time between
+ *   blocks is absorbed by the data path, which holds the next block
+ *   until D0 is released
+ * - sdStreamClose() waits for the queue, sends STOP_TRANSMISSION and
+ *   waits for the card to finish programming
+ *
+ * All buffers must be 4-byte aligned and a multiple of 512 bytes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SDCARD_H__
+#define __SDCARD_H__
+
+#include <stdint.h>
+#include "sdio.h"
+
+/** Block size in bytes */
+#define SD_BLOCK_SIZE           SDIO_BLOCK_SIZE
+
+/** Buffers that can be queued on the write stream */
+#ifndef SD_STREAM_SLOTS
+#define SD_STREAM_SLOTS         2U
+#endif
+
+/** ACMD41 attempts (1 ms apart) before giving up on power-up */
+#ifndef SD_INIT_TRIES
+#define SD_INIT_TRIES           1000U
+#endif
+
+/** SEND_STATUS polls while waiting for the card to leave programming */
+#ifndef SD_READY_TRIES
+#define SD_READY_TRIES          250000U
+#endif
+
+/**
+ * @brief Result codes of the SD card functions
+ */
+typedef enum
+{
+    SD_OK = 0,              /**< Operation completed */
+    SD_BUSY,                /**< Stream queue full, try again */
+    SD_ERR_NO_CARD,         /**< No response to the first application command */
+    SD_ERR_UNSUPPORTED,     /**< Voltage range or card version not supported */
+    SD_ERR_CMD,             /**< Command timeout, CRC or card status error */
+    SD_ERR_DATA,            /**< Data transfer failed */
+    SD_ERR_STATE            /**< Call not allowed in the current state */
+} sdStatus_t;
+
+/**
+ * @brief Transfer counters
+ */
+typedef struct
+{
+    uint32_t blocksRead;        /**< Blocks read */
+    uint32_t blocksWritten;     /**< Blocks written by the stream */
+    uint32_t streamsOpened;     /**< Write streams opened */
+    uint32_t queueFull;         /**< sdStreamSubmit() calls rejected with SD_BUSY */
+    uint32_t dataErrors;        /**< Data transfers that failed */
+} sdStats_t;
+
+/**
+ * @brief Initialize the controller and identify the card
+ *
+ * Runs CMD0, CMD8, ACMD41, CMD2, CMD3, CMD9 and CMD7, then switches
+ * the card and the controller to the 4-bit bus at 24 MHz.
+ *
+ * @return SD_OK, SD_ERR_NO_CARD, SD_ERR_UNSUPPORTED or SD_ERR_CMD
+ * @note Blocking: up to SD_INIT_TRIES ms while the card powers up
+ */
+sdStatus_t sdInit(void);
+
+/**
+ * @brief Card capacity
+ *
+ * @return Number of 512-byte blocks, 0 before sdInit()
+ */
+uint32_t sdGetBlockCount(void);
+
+/**
+ * @brief Read blocks (CMD17 or CMD18)
+ *
+ * @param[in] lba First block
+ * @param[out] buf Destination (count * 512 bytes, 4-byte aligned)
+ * @param[in] count Number of blocks
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ * @note Blocks until the transfer has completed
+ */
+sdStatus_t sdReadBlocks(uint32_t lba, uint8_t *buf, uint32_t count);
+
+/**
+ * @brief Write blocks (one-shot stream)
+ *
+ * @param[in] lba First block
+ * @param[in] buf Source (count * 512 bytes, 4-byte aligned)
+ * @param[in] count Number of blocks
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ * @note Blocks until the card has programmed the data
+ */
+sdStatus_t sdWriteBlocks(uint32_t lba, const uint8_t *buf, uint32_t count);
+
+/**
+ * @brief Open a multi-block write stream
+ *
+ * @param[in] lba First block of the stream
+ * @param[in] preErase Expected number of blocks (sent with ACMD23,
+ *            0 to skip the pre-erase)
+ *
+ * @return SD_OK, SD_ERR_STATE or SD_ERR_CMD
+ */
+sdStatus_t sdStreamOpen(uint32_t lba, uint32_t preErase);
+
+/**
+ * @brief Queue a buffer on the write stream
+ *
+ * The buffer belongs to the driver until sdStreamSlotsFree() shows that
+ * its slot has been released.
+ *
+ * @param[in] buf Source (blocks * 512 bytes, 4-byte aligned)
+ * @param[in] blocks Number of blocks
+ *
+ * @return SD_OK, SD_BUSY (queue full), SD_ERR_STATE or SD_ERR_DATA
+ *         (an earlier buffer failed; close the stream)
+ */
+sdStatus_t sdStreamSubmit(const uint8_t *buf, uint32_t blocks);
+
+/**
+ * @brief Number of free slots on the write stream queue
+ *
+ * @return 0 to SD_STREAM_SLOTS
+ */
+uint8_t sdStreamSlotsFree(void);
+
+/**
+ * @brief Finish the write stream
+ *
+ * Waits until every queued buffer has been sent, sends CMD12 and waits
+ * until the card is back in the transfer state.
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ */
+sdStatus_t sdStreamClose(void);
+
+/**
+ * @brief Copy the transfer counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void sdGetStats(sdStats_t *stats);
+
+#endif // __SDCARD_H__
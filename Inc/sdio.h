@@ -0,0 +1,151 @@
+/**
+ * @file sdio.h
+ * @brief SDIO host controller driver (command and data path)
+ *
+ * Register-level access to the SDIO peripheral: command/response
+ * exchange and DMA data transfers. The SD card protocol is built on top
+ * of these functions in sdcard.c, which uses nothing else from the
+ * hardware.
+ *
+ * @details
+ * Pins (AF12, pull-ups on CMD and data lines):
+ * - PC8-PC11: D0-D3
+ * - PC12: CK
+ * - PD2: CMD
+ *
+ * Clocking:
+ * - SDIOCLK = PLL48CK = 48 MHz (clockEnablePll48())
+ * - SDIO_CK = SDIOCLK / (CLKDIV + 2): 400 kHz during identification,
+ *   24 MHz for data transfers
+ *
+ * Data path:
+ * - DMA2 Stream6, channel 4, peripheral flow control, FIFO enabled with
+ *   4-beat word bursts on both sides (required by the SDIO FIFO)
+ * - Completion and errors are reported from SDIO_IRQHandler() through
+ *   the callback set with sdioSetDataCallback()
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SDIO_H__
+#define __SDIO_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Block size used by all data transfers */
+#define SDIO_BLOCK_SIZE         512U
+
+/** CLKDIV for 400 kHz (48 MHz / (118 + 2)) */
+#define SDIO_CLKDIV_INIT        118U
+/** CLKDIV for 24 MHz (48 MHz / (0 + 2)) */
+#define SDIO_CLKDIV_TRANSFER    0U
+
+/** Data timeout in SDIO_CK cycles (1 s at 24 MHz) */
+#ifndef SDIO_DATA_TIMEOUT
+#define SDIO_DATA_TIMEOUT       24000000U
+#endif
+
+/**
+ * @brief Response format expected after a command
+ */
+typedef enum
+{
+    SDIO_RESP_NONE = 0,     /**< No response (CMD0) */
+    SDIO_RESP_SHORT,        /**< 48-bit response with CRC (R1, R6, R7) */
+    SDIO_RESP_SHORT_NOCRC,  /**< 48-bit response without valid CRC (R3) */
+    SDIO_RESP_LONG          /**< 136-bit response (R2) */
+} sdioResp_t;
+
+/**
+ * @brief Result of a command or data transfer
+ */
+typedef enum
+{
+    SDIO_OK = 0,            /**< Completed */
+    SDIO_ERR_TIMEOUT,       /**< No response or data timeout */
+    SDIO_ERR_CRC,           /**< Response or data CRC failure */
+    SDIO_ERR_FIFO,          /**< FIFO overrun/underrun or start bit error */
+    SDIO_ERR_DMA            /**< DMA transfer or FIFO error */
+} sdioStatus_t;
+
+/**
+ * @brief Called from SDIO_IRQHandler() when a data transfer has ended
+ *
+ * @param status SDIO_OK or the error that stopped the transfer
+ */
+typedef void (*sdioDataCallback_t)(sdioStatus_t status);
+
+/**
+ * @brief Initialize pins, clocks and the controller
+ *
+ * Starts PLL48CK, powers the card bus, sets 1-bit mode at 400 kHz and
+ * enables the SDIO interrupt.
+ *
+ * @return void
+ */
+void sdioInit(void);
+
+/**
+ * @brief Change the bus clock and width
+ *
+ * @param[in] clkdiv SDIO_CK = 48 MHz / (clkdiv + 2)
+ * @param[in] wide 1 for 4-bit bus, 0 for 1-bit bus
+ *
+ * @return void
+ */
+void sdioSetBus(uint8_t clkdiv, uint8_t wide);
+
+/**
+ * @brief Send a command and wait for its response
+ *
+ * @param[in] index Command index (0-63)
+ * @param[in] arg Command argument
+ * @param[in] resp Expected response format
+ * @param[out] response RESP1 for short responses, RESP1-RESP4 for long
+ *             ones (may be 0 if not needed)
+ *
+ * @return SDIO_OK, SDIO_ERR_TIMEOUT or SDIO_ERR_CRC
+ * @note Bounded by the hardware response timeout (64 SDIO_CK cycles)
+ */
+sdioStatus_t sdioSendCommand(uint8_t index, uint32_t arg, sdioResp_t resp, uint32_t *response);
+
+/**
+ * @brief Start a block data transfer
+ *
+ * Arms DMA2 Stream6 and the data path state machine. For reads this
+ * must be called before the read command is sent, for writes after the
+ * write command has been answered.
+ *
+ * @param[in] buf Data buffer (4-byte aligned)
+ * @param[in] blocks Number of 512-byte blocks
+ * @param[in] toCard 1 for a write, 0 for a read
+ *
+ * @return void
+ */
+void sdioStartData(uint8_t *buf, uint32_t blocks, uint8_t toCard);
+
+/**
+ * @brief Abort the data transfer in progress (no callback)
+ *
+ * @return void
+ */
+void sdioAbortData(void);
+
+/**
+ * @brief Register the data completion callback
+ *
+ * @param[in] callback Function to call, or 0 to disable
+ *
+ * @return void
+ */
+void sdioSetDataCallback(sdioDataCallback_t callback);
+
+/**
+ * @brief SDIO interrupt handler (data end and data errors)
+ */
+void SDIO_IRQHandler(void);
+
+#endif // __SDIO_H__
@@ -0,0 +1,190 @@
+/**
+ * @file sensorhub.h
+ * @brief Timer-scheduled I2C sensor sampling for STM32F411 Discovery
+ *
+ * Samples the LSM303DLHC accelerometer and magnetometer on I2C1 from a
+ * fixed tick instead of polling them from the main loop.
+ *
+ * @details
+ * Scheduling:
+ * - TIM5 channel 1 compares against the free-running microsecond time
+ *   base (timer.c) and interrupts every SENSOR_HUB_TICK_US; the compare
+ *   value is the exact tick time, independent of interrupt latency
+ * - On a tick, each due device gets one I2C scheduler job that reads
+ *   all its output registers in a single auto-increment burst
+ * - A device whose previous burst has not finished yet skips the tick
+ *   (counted as an overrun)
+ *
+ * Timestamps (TIM5 microseconds):
+ * - Magnetometer: rising edge of its DRDY pin (PE2, EXTI2), i.e. the
+ *   moment the sensor latched the sample; no new sample is stored when
+ *   no edge was seen since the previous burst. A burst that an edge
+ *   overlaps may hold either sample, so it is skipped and the next tick
+ *   reads the new one with its own edge time
+ * - Accelerometer: read time, not latch time. Its INT1 DRDY pin (PE4)
+ *   would need EXTI4, which spislave.c owns for the SPI1 NSS edge
+ *   (PA4), so the sample gets the tick time of the burst that read it.
+ *   The sensor latched it up to one ODR period (2.5 ms at 400 Hz)
+ *   earlier; sensorHubTimeErrorUs() reports that bound. STATUS_REG_A
+ *   is read with the data and stale samples are skipped
+ *
+ * Storage:
+ * - One structure-of-arrays ring per device (time, x, y, z arrays), so
+ *   a filter can walk a single axis with a unit stride
+ * - sensorHubRead() copies up to n samples into caller arrays in the
+ *   same layout
+ *
+ * @note i2cSchedInit() must have been called and i2cSchedPoll() must
+ *       keep running from the main loop
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SENSORHUB_H__
+#define __SENSORHUB_H__
+
+#include <stdint.h>
+#include "i2csched.h"
+
+/** Tick period in microseconds (100 Hz) */
+#ifndef SENSOR_HUB_TICK_US
+#define SENSOR_HUB_TICK_US      10000U
+#endif
+
+/** Ring size per device in samples (power of two) */
+#ifndef SENSOR_HUB_RING_SIZE
+#define SENSOR_HUB_RING_SIZE    64U
+#endif
+
+/** Scheduler priority of the sampling jobs */
+#ifndef SENSOR_HUB_PRIORITY
+#define SENSOR_HUB_PRIORITY     I2C_SCHED_PRIO_HIGH
+#endif
+
+/**
+ * @brief Sampled devices
+ */
+typedef enum
+{
+    SENSOR_HUB_ACCEL = 0,   /**< LSM303DLHC accelerometer (0x19) */
+    SENSOR_HUB_MAG,         /**< LSM303DLHC magnetometer (0x1E) */
+    SENSOR_HUB_DEVICE_COUNT
+} sensorHubDevice_t;
+
+/**
+ * @brief Structure-of-arrays sample ring of one device
+ */
+typedef struct
+{
+    uint32_t t[SENSOR_HUB_RING_SIZE];   /**< Sample time in microseconds (latch or read time) */
+    int16_t x[SENSOR_HUB_RING_SIZE];    /**< X axis raw value */
+    int16_t y[SENSOR_HUB_RING_SIZE];    /**< Y axis raw value */
+    int16_t z[SENSOR_HUB_RING_SIZE];    /**< Z axis raw value */
+    volatile uint32_t head;             /**< Next write index (free running) */
+    volatile uint32_t tail;             /**< Next read index (free running) */
+} sensorHubRing_t;
+
+/**
+ * @brief Hub counters
+ */
+typedef struct
+{
+    uint32_t ticks;                                 /**< Ticks handled */
+    uint32_t bursts[SENSOR_HUB_DEVICE_COUNT];       /**< Bursts completed */
+    uint32_t samples[SENSOR_HUB_DEVICE_COUNT];      /**< New samples stored */
+    uint32_t overruns[SENSOR_HUB_DEVICE_COUNT];     /**< Ticks skipped, burst still running */
+    uint32_t errors[SENSOR_HUB_DEVICE_COUNT];       /**< Bursts that failed or were refused */
+    uint32_t dropped[SENSOR_HUB_DEVICE_COUNT];      /**< Samples lost, ring full */
+    uint32_t superseded[SENSOR_HUB_DEVICE_COUNT];   /**< Bursts skipped, DRDY edge during the read */
+} sensorHubStats_t;
+
+/**
+ * @brief Configure the sensors and start sampling
+ *
+ * Writes the sensor configuration through the I2C scheduler (blocking),
+ * sets up the DRDY interrupt and starts the TIM5 compare tick.
+ *
+ * @return Bit mask of the devices that answered (1 << sensorHubDevice_t)
+ * @note Starts the TIM5 time base if it is not running yet
+ */
+uint32_t sensorHubInit(void);
+
+/**
+ * @brief Stop the tick (bursts in flight still complete)
+ *
+ * @return void
+ */
+void sensorHubStop(void);
+
+/**
+ * @brief Number of samples waiting in a device ring
+ *
+ * @param[in] dev Device
+ *
+ * @return Sample count
+ */
+uint32_t sensorHubAvailable(sensorHubDevice_t dev);
+
+/**
+ * @brief Pop samples from a device ring
+ *
+ * Any of the destination arrays may be 0 to skip that field.
+ *
+ * @param[in] dev Device
+ * @param[out] t Sample times (see sensorHubTimeErrorUs())
+ * @param[out] x X axis values
+ * @param[out] y Y axis values
+ * @param[out] z Z axis values
+ * @param[in] n Capacity of the destination arrays
+ *
+ * @return Number of samples copied (oldest first)
+ */
+uint32_t sensorHubRead(sensorHubDevice_t dev, uint32_t *t, int16_t *x, int16_t *y, int16_t *z, uint32_t n);
+
+/**
+ * @brief Direct access to a device ring
+ *
+ * The reader owns tail and may advance it after consuming entries
+ * between tail and head (indices masked with SENSOR_HUB_RING_SIZE - 1).
+ *
+ * @param[in] dev Device
+ *
+ * @return Ring of the device
+ */
+sensorHubRing_t *sensorHubGetRing(sensorHubDevice_t dev);
+
+/**
+ * @brief Copy the hub counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void sensorHubGetStats(sensorHubStats_t *stats);
+
+/**
+ * @brief Worst-case age of a sample at its time stamp
+ *
+ * A device timestamped by its DRDY edge carries the latch time (0); a
+ * device without one carries the read time, which can lag the latch by
+ * up to one output data period.
+ *
+ * @param[in] dev Device
+ *
+ * @return Microseconds
+ */
+uint32_t sensorHubTimeErrorUs(sensorHubDevice_t dev);
+
+/**
+ * @brief TIM5 interrupt handler (channel 1 compare tick)
+ */
+void TIM5_IRQHandler(void);
+
+/**
+ * @brief EXTI2 interrupt handler (PE2, magnetometer DRDY)
+ */
+void EXTI2_IRQHandler(void);
+
+#endif // __SENSORHUB_H__
@@ -21,6 +21,13 @@
  * - Full-duplex mode
  * - Clock frequency = fPCLK/4
  * 
+ * Several devices share SPI1, each with its own chip select (the flash on
+ * PA9, the gyroscope on PE3). A driver owns the bus from chip select low
+ * to chip select high: it takes it with spi1TryLock() (or spi1Lock() in
+ * thread context) and gives it back with spi1Unlock(). An interrupt-driven
+ * driver that finds the bus taken defers its transfer and restarts it from
+ * the release callback.
+ * 
  * @author Bare Metal STM32
  * @version 1.0
  * @date 2026
@@ -114,5 +121,51 @@ void csEnable(void);
  */
 void csDisable(void);
 
+/**
+ * @brief Called from spi1Unlock() once the bus is free
+ * 
+ * Runs in the context of the releasing driver (thread or interrupt).
+ */
+typedef void (*spi1ReleaseCallback_t)(void);
+
+/**
+ * @brief Try to take ownership of SPI1
+ * 
+ * The check and the claim happen with interrupts masked, so a thread and
+ * an interrupt handler can never both own the bus.
+ * 
+ * @return 1 if the bus was taken, 0 if another driver owns it
+ * @note Safe from interrupt context
+ */
+uint8_t spi1TryLock(void);
+
+/**
+ * @brief Take ownership of SPI1, waiting while another driver owns it
+ * 
+ * @return void
+ * @note Thread context only: an interrupt handler spinning here would
+ *       never let the owner finish
+ */
+void spi1Lock(void);
+
+/**
+ * @brief Give SPI1 back and run the release callback
+ * 
+ * @return void
+ * @note Chip select must already be high
+ */
+void spi1Unlock(void);
+
+/**
+ * @brief Register the callback run by every spi1Unlock()
+ * 
+ * Lets an interrupt-driven driver restart a transfer it deferred because
+ * the bus was taken.
+ * 
+ * @param[in] callback Function to call, 0 to remove
+ * 
+ * @return void
+ */
+void spi1SetReleaseCallback(spi1ReleaseCallback_t callback);
 
 #endif // __SPI_H__
\ No newline at end of file
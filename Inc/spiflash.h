@@ -0,0 +1,107 @@
+/**
+ * @file spiflash.h
+ * @brief External SPI NOR flash driver (W25Qxx class) for STM32F411
+ *
+ * This module drives a serial NOR flash connected to SPI1 using the
+ * existing spi.c transfer functions and the PA9 chip select.
+ *
+ * @details
+ * Supported commands:
+ * - 0x9F: Read JEDEC ID
+ * - 0x03: Read data
+ * - 0x06: Write enable
+ * - 0x02: Page program (up to 256 bytes, must not cross a page)
+ * - 0x20: Sector erase (4 KB)
+ * - 0x05: Read status register 1
+ *
+ * Program and erase commands are started and then left running, so the
+ * caller can poll spiFlashIsBusy() instead of blocking for the full
+ * erase time (tens to hundreds of milliseconds for a sector).
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SPIFLASH_H__
+#define __SPIFLASH_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Program page size in bytes */
+#define SPI_FLASH_PAGE_SIZE      256U
+/** Smallest erasable unit in bytes */
+#define SPI_FLASH_SECTOR_SIZE    4096U
+
+/**
+ * @brief Initialize SPI1 and the external flash
+ *
+ * Calls spiInit() and spi1Config(), deselects the chip and waits for
+ * any operation left running before the reset to finish.
+ *
+ * @return void
+ * @see spiInit(), spi1Config()
+ */
+void spiFlashInit(void);
+
+/**
+ * @brief Read the 3-byte JEDEC identification
+ *
+ * @param[out] id Buffer of 3 bytes: manufacturer, memory type, capacity
+ *
+ * @return void
+ */
+void spiFlashReadJedecId(uint8_t *id);
+
+/**
+ * @brief Check if a program or erase operation is in progress
+ *
+ * @return 1 if the BUSY bit is set, 0 otherwise
+ */
+uint8_t spiFlashIsBusy(void);
+
+/**
+ * @brief Wait until the flash is ready for a new command
+ *
+ * @return void
+ * @note Blocking call - use spiFlashIsBusy() for non-blocking code
+ */
+void spiFlashWaitReady(void);
+
+/**
+ * @brief Read data from flash
+ *
+ * @param[in] addr Start address
+ * @param[out] data Destination buffer
+ * @param[in] size Number of bytes to read
+ *
+ * @return void
+ * @note Flash must not be busy
+ */
+void spiFlashRead(uint32_t addr, uint8_t *data, uint32_t size);
+
+/**
+ * @brief Start a page program operation
+ *
+ * @param[in] addr Start address
+ * @param[in] data Bytes to program
+ * @param[in] size Number of bytes (addr + size must stay within one page)
+ *
+ * @return void
+ * @note Returns while the flash is still programming; check spiFlashIsBusy()
+ * @note Programming can only clear bits (1 -> 0)
+ */
+void spiFlashPageProgram(uint32_t addr, const uint8_t *data, uint32_t size);
+
+/**
+ * @brief Start a 4 KB sector erase
+ *
+ * @param[in] addr Any address inside the sector to erase
+ *
+ * @return void
+ * @note Returns while the flash is still erasing; check spiFlashIsBusy()
+ */
+void spiFlashSectorErase(uint32_t addr);
+
+#endif // __SPIFLASH_H__
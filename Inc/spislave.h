@@ -0,0 +1,157 @@
+/**
+ * @file spislave.h
+ * @brief SPI1/SPI2 slave register-file driver with circular DMA
+ *
+ * Lets the board act as an SPI sensor front-end for a host MCU. Each
+ * port exposes a register file that the master reads and writes with
+ * no CPU work per byte: both directions run on circular DMA and the
+ * CPU only steps in once per transaction, on the NSS rising edge.
+ *
+ * @details
+ * Pins (hardware NSS, AF5):
+ * | Port | NSS  | SCK  | MISO | MOSI | RX DMA          | TX DMA          |
+ * |------|------|------|------|------|-----------------|-----------------|
+ * | SPI1 | PA4  | PA5  | PA6  | PA7  | DMA2 S2 ch3     | DMA2 S3 ch3     |
+ * | SPI2 | PB12 | PB13 | PB14 | PB15 | DMA1 S3 ch0     | DMA1 S4 ch0     |
+ *
+ * Protocol (one transaction = NSS low ... NSS high):
+ * - The slave always clocks out the register file starting at the read
+ *   pointer, from the first byte of the transaction.
+ * - First byte from the master with bit 7 clear: sets the read pointer
+ *   for the following transactions (other bytes are ignored).
+ * - First byte with bit 7 set: write; the following bytes are stored
+ *   from address (byte0 & 0x7F) on. Only the writable area
+ *   [SPI_SLAVE_RO_SIZE, SPI_SLAVE_REG_SIZE) accepts writes.
+ * - Reads past the end of the file restart at the read pointer.
+ *
+ * The read-only area is double buffered: the application updates the
+ * back copy and publishes it with spiSlaveCommit(), so the master never
+ * sees a half-updated multi-byte value.
+ *
+ * @note SPI2 slave uses the same pins and DMA stream as lcd.c; only one
+ *       of them can be active.
+ * @note The master must leave a few microseconds between transactions
+ *       for the NSS handler to re-arm the DMA.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SPISLAVE_H__
+#define __SPISLAVE_H__
+
+#define STM32F411xE
+#include "stm32f4xx.h"
+
+/** Register file size in bytes (max 128) */
+#ifndef SPI_SLAVE_REG_SIZE
+#define SPI_SLAVE_REG_SIZE      64U
+#endif
+
+/** Size of the read-only area published by the application */
+#ifndef SPI_SLAVE_RO_SIZE
+#define SPI_SLAVE_RO_SIZE       48U
+#endif
+
+/** Bit 7 of the first byte selects a write transaction */
+#define SPI_SLAVE_CMD_WRITE     (1U<<7)
+
+/**
+ * @brief Slave port selection
+ */
+typedef enum
+{
+    SPI_SLAVE_PORT1 = 0,    /**< SPI1 on PA4-PA7 */
+    SPI_SLAVE_PORT2,        /**< SPI2 on PB12-PB15 */
+    SPI_SLAVE_PORT_COUNT
+} spiSlavePort_t;
+
+/**
+ * @brief Called from the NSS interrupt after the master wrote registers
+ *
+ * @param port Port that received the write
+ * @param addr First register written
+ * @param len Number of bytes accepted
+ */
+typedef void (*spiSlaveWriteCallback_t)(spiSlavePort_t port, uint8_t addr, uint8_t len);
+
+/**
+ * @brief Initialize a port as SPI slave (mode 3, 8-bit, MSB first)
+ *
+ * Configures the pins, the circular RX/TX DMA streams and the NSS
+ * rising-edge interrupt, clears the register file and arms the port.
+ *
+ * @param[in] port Port to initialize
+ *
+ * @return void
+ */
+void spiSlaveInit(spiSlavePort_t port);
+
+/**
+ * @brief Write into the back copy of the read-only area
+ *
+ * @param[in] port Port
+ * @param[in] addr First register (must be below SPI_SLAVE_RO_SIZE)
+ * @param[in] data Bytes to write
+ * @param[in] len Number of bytes (clipped to the read-only area)
+ *
+ * @return void
+ * @note Not visible to the master until spiSlaveCommit()
+ */
+void spiSlaveUpdate(spiSlavePort_t port, uint8_t addr, const uint8_t *data, uint8_t len);
+
+/**
+ * @brief Publish the back copy to the master
+ *
+ * Swaps at once if the bus is idle, otherwise at the end of the
+ * transaction in progress.
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+void spiSlaveCommit(spiSlavePort_t port);
+
+/**
+ * @brief Read registers (including the area written by the master)
+ *
+ * @param[in] port Port
+ * @param[in] addr First register
+ * @param[out] data Destination
+ * @param[in] len Number of bytes (clipped to the register file)
+ *
+ * @return void
+ */
+void spiSlaveRead(spiSlavePort_t port, uint8_t addr, uint8_t *data, uint8_t len);
+
+/**
+ * @brief Register the master-write notification
+ *
+ * @param[in] port Port
+ * @param[in] callback Function to call, or 0 to disable
+ *
+ * @return void
+ */
+void spiSlaveSetWriteCallback(spiSlavePort_t port, spiSlaveWriteCallback_t callback);
+
+/**
+ * @brief Number of transactions handled on a port
+ *
+ * @param[in] port Port
+ *
+ * @return Transaction count
+ */
+uint32_t spiSlaveGetTransactions(spiSlavePort_t port);
+
+/**
+ * @brief EXTI4 interrupt handler (SPI1 NSS rising edge)
+ */
+void EXTI4_IRQHandler(void);
+
+/**
+ * @brief EXTI15_10 interrupt handler (SPI2 NSS rising edge)
+ */
+void EXTI15_10_IRQHandler(void);
+
+#endif // __SPISLAVE_H__
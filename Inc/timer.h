@@ -7,6 +7,12 @@
  *
  * This driver provides TIM2 (32-bit General Purpose Timer) functions.
  * Configured for 1 Hz update event using polling.
+ *
+ * TIM5 (32-bit) is used as a free-running 1 MHz microsecond time base
+ * for timestamping samples and measuring intervals.
+ *
+ * TIM3 (16-bit) generates the TRGO trigger of timer-driven peripherals
+ * such as the ADC.
  */
 
 #ifndef __TIMER_H__
@@ -22,6 +28,9 @@
  * @{
  */
 
+/** Timer kernel clock for APB1 timers (APB1 prescaler = 1) */
+#define TIM_CLK_FREQ    16000000U
+
 /**
  * @brief Initialize TIM2 timer
  * 
@@ -54,5 +63,55 @@ bool getUIF(void);
  */
 void clearUIF(void);
 
+/**
+ * @brief Start TIM5 as a 1 MHz free-running time base
+ *
+ * Counts microseconds from 0 to 0xFFFFFFFF (wraps after ~71 minutes).
+ * Calling it again while the time base runs has no effect.
+ *
+ * @return None
+ * @see timGetMicros()
+ */
+void tim5TimebaseInit(void);
+
+/**
+ * @brief Read the microsecond time base
+ *
+ * @return Current TIM5 counter in microseconds
+ * @note Compute intervals with unsigned subtraction to handle wrap-around
+ */
+uint32_t timGetMicros(void);
+
+/**
+ * @brief Configure TIM3 to output its update event on TRGO
+ *
+ * Chooses the smallest prescaler that fits the 16-bit auto-reload and
+ * the period closest to TIM_CLK_FREQ / rateHz. The timer is left
+ * stopped.
+ *
+ * @param[in] rateHz Update rate (1 Hz to TIM_CLK_FREQ / 2)
+ *
+ * @return Timer clock ticks per update (exact rate is
+ *         TIM_CLK_FREQ / return value), 0 if rateHz is out of range
+ * @see tim3Start(), tim3Stop()
+ */
+uint32_t tim3TrgoInit(uint32_t rateHz);
+
+/**
+ * @brief Start TIM3 from a zero count
+ *
+ * The first update (and TRGO) comes one full period later.
+ *
+ * @return None
+ */
+void tim3Start(void);
+
+/**
+ * @brief Stop TIM3
+ *
+ * @return None
+ */
+void tim3Stop(void);
+
 /** @} */
 #endif // __TIMER_H__
\ No newline at end of file
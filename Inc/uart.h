@@ -7,6 +7,10 @@
  *
  * This driver provides UART2 communication on STM32F411 using PA2 (TX) pin.
  * Supports standard serial communication at 115200 baud rate.
+ *
+ * Besides the blocking calls, a whole buffer can be sent with DMA1
+ * Stream6 (channel 4, USART2_TX); the buffer stays owned by the driver
+ * until the completion callback runs.
  */
 
 #ifndef __UART_H__
@@ -91,6 +95,48 @@ void uartPrintf(const char *format, ...);
  */
 int __io_putchar(int ch);
 
+/**
+ * @brief Called from the DMA interrupt when a buffer has been sent
+ *
+ * @param ok 1 if the transfer completed, 0 on a DMA transfer error
+ */
+typedef void (*uartDmaCallback_t)(uint8_t ok);
+
+/**
+ * @brief Enable DMA transmission on UART2
+ *
+ * @param callback Completion callback (may be 0)
+ *
+ * @return None
+ *
+ * @note Call uartInit() first
+ */
+void uartDmaInit(uartDmaCallback_t callback);
+
+/**
+ * @brief Start sending a buffer with DMA
+ *
+ * Returns at once; the buffer must not change until the callback.
+ *
+ * @param data Bytes to send
+ * @param len Number of bytes (1-65535)
+ *
+ * @return 1 if started, 0 if a transfer is still running or len is 0
+ */
+uint8_t uartWriteDma(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Check for a running DMA transmission
+ *
+ * @return 1 while a buffer is being sent, 0 otherwise
+ */
+uint8_t uartDmaBusy(void);
+
+/**
+ * @brief DMA1 Stream6 interrupt handler (USART2 TX)
+ */
+void DMA1_Stream6_IRQHandler(void);
+
 
 static void setUartBaudrate(uint32_t periphClk, uint32_t baudRate);
 
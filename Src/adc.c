@@ -9,6 +9,72 @@
  */
 
 #include "adc.h"
+#include "dma.h"
+#include "timer.h"
+
+/*ADC1 DMA request: DMA2 Stream0, channel 0*/
+#define ADC_DMA_STREAM      0U
+#define ADC_DMA_CHANNEL     0U
+
+/*TIM3 TRGO in CR2 EXTSEL*/
+#define ADC_EXTSEL_TIM3_TRGO    8U
+
+/*Analog watchdog fields of CR1, kept when the sequence changes*/
+#define ADC_CR1_AWD_MASK    (ADC_CR1_AWDEN | ADC_CR1_AWDSGL | ADC_CR1_AWDCH | ADC_CR1_AWDIE)
+
+/*Injected group fields, kept when the regular group changes*/
+#define ADC_CR1_INJ_MASK    (ADC_CR1_JEOCIE)
+#define ADC_CR2_INJ_MASK    (ADC_CR2_JEXTSEL | ADC_CR2_JEXTEN)
+
+/*Polling limit of adcInjectedSave(), well above four 480-cycle conversions*/
+#define ADC_INJ_IDLE_TIMEOUT    200000U
+
+/** Timer clock ticks per microsecond (timestamp arithmetic) */
+#define ADC_TIM_TICKS_PER_US    (TIM_CLK_FREQ / 1000000U)
+
+/**
+ * @brief User of the ADC1 regular group and DMA2 Stream0
+ */
+typedef enum
+{
+    ADC_MODE_NONE = 0,  /**< Polling API or idle */
+    ADC_MODE_SCAN,      /**< Continuous scan, circular buffer */
+    ADC_MODE_TRIG       /**< Timer triggered, ping-pong buffers */
+} adcMode_t;
+
+static adcMode_t adcMode;
+
+static uint16_t *adcScanBuffer;
+static uint32_t adcScanCount;
+static uint32_t adcScanHalf;
+static adcScanCallback_t adcScanCallback;
+static volatile uint8_t adcScanRunning;
+static volatile uint32_t adcScanOverruns;
+
+static uint16_t *adcTrigBuf[2];
+static uint32_t adcTrigDone;
+static uint32_t adcTrigFrames;
+static uint32_t adcTrigPeriod;
+static adcBlockCallback_t adcTrigCallback;
+static volatile uint8_t adcTrigRunning;
+/*Time of the first frame of the block being filled: microseconds + timer ticks*/
+static uint32_t adcTrigStampUs;
+static uint32_t adcTrigStampFrac;
+
+static adcWatchdogCallback_t adcWdCallback;
+static volatile uint32_t adcWdEvents;
+
+static uint32_t adcOsAcc[ADC_SCAN_MAX_CHANNELS];
+static uint16_t adcOsOut[ADC_SCAN_MAX_CHANNELS];
+static uint32_t adcOsShift;
+static uint32_t adcOsRatio;
+static uint32_t adcOsLeft;
+static adcOversampleCallback_t adcOsCallback;
+
+static uint16_t adcInjValues[ADC_INJ_MAX_CHANNELS];
+static uint32_t adcInjCount;
+static adcInjTrigger_t adcInjTrigger;
+static adcInjectedCallback_t adcInjCallback;
 
 /**
  * @brief Initialize ADC1 peripheral with PA1 input
@@ -103,4 +169,859 @@ uint32_t adcRead(void)
 
     /*Read conversion value*/
     return ADC1->DR;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Set the GPIO pin of an external channel to analog mode
+ *
+ * Channel map: 0-7 = PA0-PA7, 8-9 = PB0-PB1, 10-15 = PC0-PC5.
+ * Internal channels enable the temperature sensor/VREFINT instead.
+ *
+ * @param[in] channel ADC channel
+ *
+ * @return None
+ */
+static void adcPinInit(uint8_t channel)
+{
+    if(channel < 8U)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+        GPIOA->MODER |= (3U << (channel * 2U));
+    }
+    else if(channel < 10U)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+        GPIOB->MODER |= (3U << ((channel - 8U) * 2U));
+    }
+    else if(channel < 16U)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN;
+        GPIOC->MODER |= (3U << ((channel - 10U) * 2U));
+    }
+    else
+    {
+        /*Temperature sensor and VREFINT; VBAT must stay off on channel 18*/
+        ADC1_COMMON->CCR &= ~ADC_CCR_VBATE;
+        ADC1_COMMON->CCR |= ADC_CCR_TSVREFE;
+    }
+}
+
+/**
+ * @brief Program the sampling time of one channel
+ *
+ * @param[in] channel ADC channel (0-18)
+ * @param[in] smp Sampling time
+ *
+ * @return None
+ */
+static void adcSetSampleTime(uint8_t channel, adcSampleTime_t smp)
+{
+    uint32_t shift;
+
+    if(channel < 10U)
+    {
+        shift = channel * 3U;
+        ADC1->SMPR2 = (ADC1->SMPR2 & ~(7U << shift)) | ((uint32_t)smp << shift);
+    }
+    else
+    {
+        shift = (channel - 10U) * 3U;
+        ADC1->SMPR1 = (ADC1->SMPR1 & ~(7U << shift)) | ((uint32_t)smp << shift);
+    }
+}
+
+/**
+ * @brief Put a channel at a position of the regular sequence
+ *
+ * @param[in] rank Position (0-15)
+ * @param[in] channel ADC channel
+ *
+ * @return None
+ */
+static void adcSetSequence(uint32_t rank, uint8_t channel)
+{
+    uint32_t shift = (rank % 6U) * 5U;
+
+    if(rank < 6U)
+    {
+        ADC1->SQR3 = (ADC1->SQR3 & ~(0x1FU << shift)) | ((uint32_t)channel << shift);
+    }
+    else if(rank < 12U)
+    {
+        ADC1->SQR2 = (ADC1->SQR2 & ~(0x1FU << shift)) | ((uint32_t)channel << shift);
+    }
+    else
+    {
+        ADC1->SQR1 = (ADC1->SQR1 & ~(0x1FU << shift)) | ((uint32_t)channel << shift);
+    }
+}
+
+/**
+ * @brief Arm the DMA stream and start the regular sequence
+ *
+ * Also the overrun recovery sequence: DMA reinitialized, OVR cleared,
+ * conversion triggered again.
+ *
+ * @return None
+ */
+static void adcScanArm(void)
+{
+    /*DMA bit must toggle for the ADC to issue requests again*/
+    ADC1->CR2 &= ~(ADC_CR2_DMA);
+
+    dmaStreamConfig(DMA2, ADC_DMA_STREAM, ADC_DMA_CHANNEL,
+                    DMA_SxCR_MINC | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_CIRC |
+                    DMA_SxCR_HTIE | DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_PL_1,
+                    &ADC1->DR, adcScanBuffer, (uint16_t)(adcScanHalf * 2U * adcScanCount));
+    dmaStreamStart(DMA2, ADC_DMA_STREAM);
+
+    /*Clear overrun and stale end of conversion*/
+    ADC1->SR = ~(ADC_SR_OVR | ADC_SR_EOC | ADC_SR_STRT);
+
+    /*Continuous conversion, DMA requests kept after the last transfer*/
+    ADC1->CR2 |= ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_CONT;
+    ADC1->CR2 |= ADC_CR2_SWSTART;
+}
+
+/**
+ * @brief Check a scan sequence and program it into ADC1
+ *
+ * Leaves ADC1 off (ADON = 0) with SCAN and the overrun interrupt set.
+ *
+ * @param[in] channels Scan sequence
+ * @param[in] count Number of channels
+ *
+ * @return ADC clock cycles per frame, 0 if a parameter is out of range
+ */
+static uint32_t adcSequenceConfig(const adcScanChannel_t *channels, uint8_t count)
+{
+    static const uint16_t smpCycles[8] = {3, 15, 28, 56, 84, 112, 144, 480};
+    uint32_t cycles = 0;
+
+    if((count == 0U) || (count > ADC_SCAN_MAX_CHANNELS))
+    {
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if((channels[i].channel > ADC_CHANNEL_TEMP) || (channels[i].channel == 16U))
+        {
+            return 0;
+        }
+    }
+
+    /*Enable clock access to the ADC module*/
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
+
+    /*ADC must be off while the sequence changes; injected group untouched*/
+    ADC1->CR2 &= ADC_CR2_INJ_MASK;
+    ADC1->CR1 = (ADC1->CR1 & (ADC_CR1_AWD_MASK | ADC_CR1_INJ_MASK)) | ADC_CR1_SCAN | ADC_CR1_OVRIE;
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        adcPinInit(channels[i].channel);
+        adcSetSampleTime(channels[i].channel, channels[i].sampleTime);
+        adcSetSequence(i, channels[i].channel);
+
+        /*Sampling plus 12 cycles of 12-bit conversion*/
+        cycles += smpCycles[channels[i].sampleTime & 7U] + 12U;
+    }
+
+    /*Set conversion sequence length*/
+    ADC1->SQR1 = (ADC1->SQR1 & ~ADC_SQR1_L) | (((uint32_t)count - 1U) << ADC_SQR1_L_Pos);
+
+    return cycles;
+}
+
+/**
+ * @brief Configure ADC1 for continuous scan with circular DMA
+ *
+ * Configuration details:
+ * - Resolution     : 12 bit, right aligned
+ * - Mode           : SCAN + CONT, software start
+ * - Sequence       : channels[0..count-1], per-channel sampling time
+ * - DMA            : DMA2 Stream0 channel 0, 16-bit, circular, HT + TC
+ * - Interrupts     : DMA HT/TC/TE, ADC overrun
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t adcScanInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *buffer,
+                    uint16_t frames, adcScanCallback_t callback)
+{
+    if((frames < 2U) || (frames & 1U) || (((uint32_t)frames * count) > 0xFFFFU))
+    {
+        return 0;
+    }
+
+    adcScanStop();
+    adcTrigStop();
+
+    if(!adcSequenceConfig(channels, count))
+    {
+        return 0;
+    }
+
+    adcMode = ADC_MODE_SCAN;
+    adcScanBuffer = buffer;
+    adcScanCount = count;
+    adcScanHalf = frames / 2U;
+    adcScanCallback = callback;
+    adcScanOverruns = 0;
+
+    NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    /*Enable ADC module*/
+    ADC1->CR2 |= ADC_CR2_ADON;
+
+    return 1;
+}
+
+/**
+ * @brief Start continuous scanning
+ *
+ * @return None
+ */
+void adcScanStart(void)
+{
+    adcScanRunning = 1;
+    adcScanArm();
+}
+
+/**
+ * @brief Stop scanning and the DMA stream
+ *
+ * @return None
+ */
+void adcScanStop(void)
+{
+    adcScanRunning = 0;
+
+    /*Stop after the current conversion, then drop the DMA link*/
+    ADC1->CR2 &= ~(ADC_CR2_CONT | ADC_CR2_DMA | ADC_CR2_DDS);
+    dmaStreamStop(DMA2, ADC_DMA_STREAM);
+}
+
+/**
+ * @brief Arm the ping-pong DMA and start the trigger timer
+ *
+ * The timestamp base is taken right before TIM3 starts; the first
+ * trigger comes one period later.
+ *
+ * @return None
+ */
+static void adcTrigArm(void)
+{
+    DMA_Stream_TypeDef *stream = dmaGetStream(DMA2, ADC_DMA_STREAM);
+    uint32_t primask;
+
+    tim3Stop();
+    ADC1->CR2 &= ~(ADC_CR2_DMA);
+
+    /*Double buffer mode: M0AR = ping, M1AR = pong, TC at each switch*/
+    dmaStreamConfig(DMA2, ADC_DMA_STREAM, ADC_DMA_CHANNEL,
+                    DMA_SxCR_MINC | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 | DMA_SxCR_DBM |
+                    DMA_SxCR_TCIE | DMA_SxCR_TEIE | DMA_SxCR_PL_1,
+                    &ADC1->DR, adcTrigBuf[0], (uint16_t)(adcTrigFrames * adcScanCount));
+    stream->M1AR = (uint32_t)adcTrigBuf[1];
+    dmaStreamStart(DMA2, ADC_DMA_STREAM);
+
+    ADC1->SR = ~(ADC_SR_OVR | ADC_SR_EOC | ADC_SR_STRT);
+    ADC1->CR2 |= ADC_CR2_DMA | ADC_CR2_DDS;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    adcTrigStampUs = timGetMicros() + (adcTrigPeriod / ADC_TIM_TICKS_PER_US);
+    adcTrigStampFrac = adcTrigPeriod % ADC_TIM_TICKS_PER_US;
+    tim3Start();
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Configure ADC1 for timer-triggered scans into ping-pong buffers
+ *
+ * Configuration details:
+ * - Trigger        : TIM3 TRGO (update event), rising edge
+ * - Mode           : SCAN, one sequence per trigger, no CONT
+ * - DMA            : DMA2 Stream0 channel 0, double buffer mode, TC
+ * - Interrupts     : DMA TC/TE, ADC overrun
+ *
+ * @return Timer ticks per frame, 0 on error
+ */
+uint32_t adcTrigInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *ping, uint16_t *pong,
+                     uint16_t frames, uint32_t rateHz, adcBlockCallback_t callback)
+{
+    uint32_t cycles;
+    uint32_t period;
+
+    if((frames == 0U) || (((uint32_t)frames * count) > 0xFFFFU))
+    {
+        return 0;
+    }
+
+    adcScanStop();
+    adcTrigStop();
+
+    period = tim3TrgoInit(rateHz);
+    cycles = adcSequenceConfig(channels, count);
+
+    /*Whole sequence must finish before the next trigger*/
+    if(!period || !cycles || ((cycles * (TIM_CLK_FREQ / ADC_CLK_FREQ)) > period))
+    {
+        return 0;
+    }
+
+    /*Start a sequence on each TIM3 TRGO rising edge*/
+    ADC1->CR2 = (ADC1->CR2 & ADC_CR2_INJ_MASK) | (ADC_EXTSEL_TIM3_TRGO << ADC_CR2_EXTSEL_Pos) |
+                ADC_CR2_EXTEN_0;
+
+    adcMode = ADC_MODE_TRIG;
+    adcScanCount = count;
+    adcTrigBuf[0] = ping;
+    adcTrigBuf[1] = pong;
+    adcTrigFrames = frames;
+    adcTrigPeriod = period;
+    adcTrigCallback = callback;
+    adcScanOverruns = 0;
+
+    NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    /*Enable ADC module*/
+    ADC1->CR2 |= ADC_CR2_ADON;
+
+    return period;
+}
+
+/**
+ * @brief Start timer-triggered acquisition
+ *
+ * @return None
+ */
+void adcTrigStart(void)
+{
+    tim5TimebaseInit();
+
+    adcTrigRunning = 1;
+    adcTrigArm();
+}
+
+/**
+ * @brief Stop the trigger timer and the DMA stream
+ *
+ * @return None
+ */
+void adcTrigStop(void)
+{
+    adcTrigRunning = 0;
+
+    tim3Stop();
+    ADC1->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS);
+    dmaStreamStop(DMA2, ADC_DMA_STREAM);
+}
+
+/**
+ * @brief Configure the analog watchdog on the regular group
+ *
+ * Configuration details:
+ * - Thresholds     : HTR = high, LTR = low (12-bit, right aligned)
+ * - Channels       : AWDSGL + AWDCH for one channel, else all regular
+ * - Interrupt      : AWDIE, shared ADC vector
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t adcWatchdogInit(uint8_t channel, uint16_t low, uint16_t high, adcWatchdogCallback_t callback)
+{
+    uint32_t cr1;
+
+    if((low > high) || (high > 0xFFFU))
+    {
+        return 0;
+    }
+    if((channel != ADC_WATCHDOG_ALL) && ((channel > ADC_CHANNEL_TEMP) || (channel == 16U)))
+    {
+        return 0;
+    }
+
+    tim5TimebaseInit();
+
+    /*Enable clock access to the ADC module*/
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
+
+    adcWdCallback = callback;
+    adcWdEvents = 0;
+
+    cr1 = ADC1->CR1 & ~ADC_CR1_AWD_MASK;
+    if(channel != ADC_WATCHDOG_ALL)
+    {
+        cr1 |= ADC_CR1_AWDSGL | ((uint32_t)channel << ADC_CR1_AWDCH_Pos);
+    }
+
+    ADC1->HTR = high;
+    ADC1->LTR = low;
+    ADC1->CR1 = cr1 | ADC_CR1_AWDEN;
+
+    NVIC_EnableIRQ(ADC_IRQn);
+    adcWatchdogArm();
+
+    return 1;
+}
+
+/**
+ * @brief Re-arm the watchdog after an event
+ *
+ * A flag left over from the excursion is dropped so only a new
+ * out-of-window conversion fires.
+ *
+ * @return None
+ */
+void adcWatchdogArm(void)
+{
+    ADC1->SR = ~ADC_SR_AWD;
+    ADC1->CR1 |= ADC_CR1_AWDIE;
+}
+
+/**
+ * @brief Switch the watchdog off
+ *
+ * @return None
+ */
+void adcWatchdogDisable(void)
+{
+    ADC1->CR1 &= ~ADC_CR1_AWD_MASK;
+    ADC1->SR = ~ADC_SR_AWD;
+}
+
+/**
+ * @brief Number of watchdog events
+ *
+ * @return Event count
+ */
+uint32_t adcWatchdogGetEvents(void)
+{
+    return adcWdEvents;
+}
+
+/**
+ * @brief Clear the oversampling sums and start a new output period
+ *
+ * @return None
+ */
+static void adcOversampleReset(void)
+{
+    for(uint32_t c = 0; c < ADC_SCAN_MAX_CHANNELS; c++)
+    {
+        adcOsAcc[c] = 0;
+    }
+    adcOsLeft = adcOsRatio;
+}
+
+/**
+ * @brief Accumulate one half buffer into the oversampling sums
+ *
+ * Frames are added in runs that end either with the block or with an
+ * output period, so the inner loop is a plain add per sample.
+ *
+ * @param[in] samples Finished half buffer
+ * @param[in] frames Frames in it
+ *
+ * @return None
+ */
+static void adcOversampleBlock(const uint16_t *samples, uint16_t frames)
+{
+    uint32_t left = frames;
+    uint32_t run;
+
+    while(left)
+    {
+        run = (left < adcOsLeft) ? left : adcOsLeft;
+        left -= run;
+        adcOsLeft -= run;
+
+        for(uint32_t f = 0; f < run; f++)
+        {
+            for(uint32_t c = 0; c < adcScanCount; c++)
+            {
+                adcOsAcc[c] += *samples++;
+            }
+        }
+
+        if(!adcOsLeft)
+        {
+            /*Sum of 4^n samples has 12 + 2n bits, keep 12 + n*/
+            for(uint32_t c = 0; c < adcScanCount; c++)
+            {
+                adcOsOut[c] = (uint16_t)(adcOsAcc[c] >> adcOsShift);
+                adcOsAcc[c] = 0;
+            }
+            adcOsLeft = adcOsRatio;
+
+            if(adcOsCallback)
+            {
+                adcOsCallback(adcOsOut, (uint8_t)adcScanCount);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Configure continuous scan with software oversampling
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t adcOversampleInit(const adcScanChannel_t *channels, uint8_t count, uint16_t *buffer,
+                          uint16_t frames, uint8_t bits, adcOversampleCallback_t callback)
+{
+    if((bits == 0U) || (bits > ADC_OVERSAMPLE_MAX_BITS))
+    {
+        return 0;
+    }
+
+    if(!adcScanInit(channels, count, buffer, frames, adcOversampleBlock))
+    {
+        return 0;
+    }
+
+    adcOsShift = bits;
+    adcOsRatio = 1UL << (2U * bits);
+    adcOversampleReset();
+    adcOsCallback = callback;
+
+    return 1;
+}
+
+/**
+ * @brief Configure the injected group
+ *
+ * Configuration details:
+ * - Sequence       : JSQR, JL = count - 1; a shorter group occupies the
+ *                    last JSQ slots and its results JDR1 onwards
+ * - Trigger        : JEXTSEL = trigger, JEXTEN set by adcInjectedStart()
+ * - Interrupt      : JEOCIE (end of the whole group, SCAN set)
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t adcInjectedInit(const adcScanChannel_t *channels, uint8_t count, adcInjTrigger_t trigger,
+                        adcInjectedCallback_t callback)
+{
+    uint32_t jsqr;
+    uint32_t slot;
+
+    if((count == 0U) || (count > ADC_INJ_MAX_CHANNELS))
+    {
+        return 0;
+    }
+    if((trigger > ADC_JTRIG_TIM5_TRGO) && (trigger != ADC_JTRIG_EXTI15) && (trigger != ADC_JTRIG_SOFTWARE))
+    {
+        return 0;
+    }
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if((channels[i].channel > ADC_CHANNEL_TEMP) || (channels[i].channel == 16U))
+        {
+            return 0;
+        }
+    }
+
+    tim5TimebaseInit();
+
+    /*Enable clock access to the ADC module*/
+    RCC->APB2ENR |= RCC_APB2ENR_ADC1EN;
+
+    adcInjectedStop();
+
+    jsqr = ((uint32_t)count - 1U) << ADC_JSQR_JL_Pos;
+    for(uint32_t i = 0; i < count; i++)
+    {
+        adcPinInit(channels[i].channel);
+        adcSetSampleTime(channels[i].channel, channels[i].sampleTime);
+
+        slot = (ADC_INJ_MAX_CHANNELS - count) + i;
+        jsqr |= (uint32_t)channels[i].channel << (slot * 5U);
+    }
+
+    adcInjCount = count;
+    adcInjTrigger = trigger;
+    adcInjCallback = callback;
+
+    ADC1->JSQR = jsqr;
+    ADC1->SR = ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+    ADC1->CR1 |= ADC_CR1_SCAN | ADC_CR1_JEOCIE;
+
+    if(trigger != ADC_JTRIG_SOFTWARE)
+    {
+        ADC1->CR2 = (ADC1->CR2 & ~ADC_CR2_JEXTSEL) | ((uint32_t)trigger << ADC_CR2_JEXTSEL_Pos);
+    }
+
+    NVIC_EnableIRQ(ADC_IRQn);
+
+    /*Enable ADC module*/
+    ADC1->CR2 |= ADC_CR2_ADON;
+
+    return 1;
+}
+
+/**
+ * @brief Enable the injected trigger
+ *
+ * @return None
+ */
+void adcInjectedStart(void)
+{
+    if(adcInjTrigger == ADC_JTRIG_SOFTWARE)
+    {
+        ADC1->CR2 |= ADC_CR2_JSWSTART;
+    }
+    else
+    {
+        /*Rising edge*/
+        ADC1->CR2 |= ADC_CR2_JEXTEN_0;
+    }
+}
+
+/**
+ * @brief Ignore further injected triggers
+ *
+ * @return None
+ */
+void adcInjectedStop(void)
+{
+    ADC1->CR2 &= ~ADC_CR2_JEXTEN;
+}
+
+/**
+ * @brief Stop the injected triggers and save the group configuration
+ *
+ * @return 1 when the group is idle, 0 if a started group did not end
+ */
+uint8_t adcInjectedSave(adcInjState_t *state)
+{
+    uint32_t timeout = ADC_INJ_IDLE_TIMEOUT;
+    uint32_t cr2 = ADC1->CR2;
+
+    adcInjectedStop();
+
+    /*JSTRT stays set until ADC_IRQHandler() has served the group*/
+    while(ADC1->SR & ADC_SR_JSTRT)
+    {
+        if(--timeout == 0U)
+        {
+            ADC1->CR2 |= cr2 & ADC_CR2_JEXTEN;
+            return 0;
+        }
+    }
+
+    state->jsqr = ADC1->JSQR;
+    state->cr2 = cr2 & ADC_CR2_INJ_MASK;
+    state->smpr1 = ADC1->SMPR1;
+    state->count = adcInjCount;
+    state->trigger = adcInjTrigger;
+    state->callback = adcInjCallback;
+
+    return 1;
+}
+
+/**
+ * @brief Restore a configuration saved by adcInjectedSave()
+ *
+ * @return None
+ */
+void adcInjectedRestore(const adcInjState_t *state)
+{
+    adcInjectedStop();
+
+    adcInjCount = state->count;
+    adcInjTrigger = state->trigger;
+    adcInjCallback = state->callback;
+
+    ADC1->JSQR = state->jsqr;
+    ADC1->SMPR1 = state->smpr1;
+
+    /*JEXTEN last, so a trigger only sees the restored group*/
+    ADC1->CR2 = (ADC1->CR2 & ~ADC_CR2_INJ_MASK) | (state->cr2 & ADC_CR2_JEXTSEL);
+    ADC1->CR2 |= state->cr2 & ADC_CR2_JEXTEN;
+}
+
+/**
+ * @brief Number of ADC overruns
+ *
+ * @return Overrun count
+ */
+uint32_t adcScanGetOverruns(void)
+{
+    return adcScanOverruns;
+}
+
+/**
+ * @brief Restart the running acquisition after an overrun or DMA error
+ *
+ * @return None
+ */
+static void adcRecover(void)
+{
+    adcScanOverruns++;
+
+    if((adcMode == ADC_MODE_SCAN) && adcScanRunning)
+    {
+        /*Start over from the first frame; no output spans the gap*/
+        adcOversampleReset();
+        adcScanArm();
+    }
+    else if((adcMode == ADC_MODE_TRIG) && adcTrigRunning)
+    {
+        /*Restart the timer too so the timestamps stay exact*/
+        adcTrigArm();
+    }
+    else
+    {
+        ADC1->SR = ~ADC_SR_OVR;
+    }
+}
+
+/**
+ * @brief Hand the finished ping-pong buffer to the callback
+ *
+ * After TC the stream has switched buffers: CT names the one now being
+ * written, the other one is complete.
+ *
+ * @return None
+ */
+static void adcTrigBlockDone(void)
+{
+    uint32_t ct = (dmaGetStream(DMA2, ADC_DMA_STREAM)->CR & DMA_SxCR_CT) ? 1U : 0U;
+    uint32_t stamp = adcTrigStampUs;
+
+    /*Advance the block time by frames * period without a 64-bit product*/
+    adcTrigStampFrac += adcTrigFrames * (adcTrigPeriod % ADC_TIM_TICKS_PER_US);
+    adcTrigStampUs += (adcTrigFrames * (adcTrigPeriod / ADC_TIM_TICKS_PER_US)) +
+                      (adcTrigStampFrac / ADC_TIM_TICKS_PER_US);
+    adcTrigStampFrac %= ADC_TIM_TICKS_PER_US;
+
+    adcTrigDone = ct ^ 1U;
+
+    if(adcTrigCallback)
+    {
+        adcTrigCallback(adcTrigBuf[adcTrigDone], (uint16_t)adcTrigFrames, stamp);
+    }
+}
+
+/**
+ * @brief Hand a new buffer to the DMA in place of the finished one
+ *
+ * The address register of the idle memory target may be written while
+ * the stream runs in double buffer mode.
+ *
+ * @return None
+ */
+void adcTrigReplaceBuffer(uint16_t *next)
+{
+    DMA_Stream_TypeDef *stream = dmaGetStream(DMA2, ADC_DMA_STREAM);
+
+    adcTrigBuf[adcTrigDone] = next;
+
+    if(adcTrigDone)
+    {
+        stream->M1AR = (uint32_t)next;
+    }
+    else
+    {
+        stream->M0AR = (uint32_t)next;
+    }
+}
+
+/**
+ * @brief DMA2 Stream0 interrupt handler (ADC1 transfers)
+ *
+ * Scan mode: HT = first half ready, TC = second half ready.
+ * Triggered mode: TC = one ping-pong buffer ready.
+ *
+ * @return None
+ */
+void DMA2_Stream0_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA2, ADC_DMA_STREAM);
+
+    dmaClearFlags(DMA2, ADC_DMA_STREAM, flags);
+
+    if(flags & DMA_FLAG_TE)
+    {
+        adcRecover();
+        return;
+    }
+
+    if(adcMode == ADC_MODE_TRIG)
+    {
+        if(flags & DMA_FLAG_TC)
+        {
+            adcTrigBlockDone();
+        }
+        return;
+    }
+
+    if(!adcScanCallback)
+    {
+        return;
+    }
+
+    if(flags & DMA_FLAG_HT)
+    {
+        adcScanCallback(adcScanBuffer, (uint16_t)adcScanHalf);
+    }
+
+    if(flags & DMA_FLAG_TC)
+    {
+        adcScanCallback(&adcScanBuffer[adcScanHalf * adcScanCount], (uint16_t)adcScanHalf);
+    }
+}
+
+/**
+ * @brief ADC interrupt handler (overrun recovery, analog watchdog,
+ *        injected end of conversion)
+ *
+ * The injected group is served first: its results are only valid until
+ * the next trigger.
+ *
+ * @return None
+ */
+void ADC_IRQHandler(void)
+{
+    uint32_t sr = ADC1->SR;
+
+    if(sr & ADC_SR_JEOC)
+    {
+        ADC1->SR = ~(ADC_SR_JEOC | ADC_SR_JSTRT);
+
+        /*JDR1-JDR4 are consecutive registers*/
+        for(uint32_t i = 0; i < adcInjCount; i++)
+        {
+            adcInjValues[i] = (uint16_t)(&ADC1->JDR1)[i];
+        }
+
+        if(adcInjCallback)
+        {
+            adcInjCallback(adcInjValues, (uint8_t)adcInjCount, timGetMicros());
+        }
+    }
+
+    if(sr & ADC_SR_OVR)
+    {
+        /*Reinitialize DMA, clear OVR, trigger again*/
+        adcRecover();
+    }
+
+    if((sr & ADC_SR_AWD) && (ADC1->CR1 & ADC_CR1_AWDIE))
+    {
+        /*One event per excursion: disarm until adcWatchdogArm()*/
+        ADC1->CR1 &= ~ADC_CR1_AWDIE;
+        ADC1->SR = ~ADC_SR_AWD;
+        adcWdEvents++;
+
+        if(adcWdCallback)
+        {
+            adcWdCallback(timGetMicros());
+        }
+    }
+}
@@ -0,0 +1,263 @@
+/**
+ * @file adccal.c
+ * @brief Calibrated ADC engineering units implementation
+ *
+ * All divisions happen in adcCalUpdateVdda(); the conversion functions
+ * only multiply and shift.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "adccal.h"
+#include "adc.h"
+#include "timer.h"
+
+/*Factory calibration values in system memory*/
+#define ADC_CAL_VREFINT_ADDR    0x1FFF7A2AUL
+#define ADC_CAL_TS1_ADDR        0x1FFF7A2CUL
+#define ADC_CAL_TS2_ADDR        0x1FFF7A2EUL
+
+/*Datasheet typicals at 3.3 V: VREFINT 1.21 V, sensor 0.76 V at 25 degC + 2.5 mV/degC*/
+#define ADC_CAL_VREFINT_TYP     1502U
+#define ADC_CAL_TS1_TYP         959U
+#define ADC_CAL_TS2_TYP         1207U
+
+/*Full scale counts*/
+#define ADC_CAL_FULL_SCALE      4095U
+
+/*Start-up of VREFINT and the temperature sensor (10 us max), covers ADC tSTAB (3 us)*/
+#define ADC_CAL_STARTUP_US      10U
+
+/*Polling limit of adcCalMeasure(), well above two 480-cycle conversions*/
+#define ADC_CAL_TIMEOUT         200000U
+
+static uint32_t adcCalVrefint;
+static uint32_t adcCalTs1;
+static int32_t adcCalSlopeQ8;
+
+static uint32_t adcCalVdda;
+static uint32_t adcCalMvQ16;
+static uint32_t adcCalNormQ16;
+
+static volatile uint8_t adcCalDone;
+static uint16_t adcCalSamples[2];
+
+/**
+ * @brief Read a calibration value, falling back to a typical one
+ *
+ * @param[in] addr Address in system memory
+ * @param[in] typical Value used if the word is blank
+ *
+ * @return Calibration counts
+ */
+static uint32_t adcCalReadFactory(uint32_t addr, uint32_t typical)
+{
+    uint32_t v = *(const volatile uint16_t *)addr;
+
+    if((v == 0U) || (v == 0xFFFFU))
+    {
+        return typical;
+    }
+
+    return v;
+}
+
+/**
+ * @brief Load the factory calibration values
+ *
+ * @return None
+ */
+void adcCalInit(void)
+{
+    uint32_t ts2;
+
+    adcCalVrefint = adcCalReadFactory(ADC_CAL_VREFINT_ADDR, ADC_CAL_VREFINT_TYP);
+    adcCalTs1 = adcCalReadFactory(ADC_CAL_TS1_ADDR, ADC_CAL_TS1_TYP);
+    ts2 = adcCalReadFactory(ADC_CAL_TS2_ADDR, ADC_CAL_TS2_TYP);
+
+    if(ts2 <= adcCalTs1)
+    {
+        adcCalTs1 = ADC_CAL_TS1_TYP;
+        ts2 = ADC_CAL_TS2_TYP;
+    }
+
+    /*0.01 degC per count, Q8*/
+    adcCalSlopeQ8 = (int32_t)((((uint32_t)(ADC_CAL_TEMP2_CDEG - ADC_CAL_TEMP1_CDEG) << 8) +
+                               ((ts2 - adcCalTs1) / 2U)) / (ts2 - adcCalTs1));
+
+    /*Nominal VDDA until the first VREFINT sample*/
+    adcCalUpdateVdda((uint16_t)adcCalVrefint);
+}
+
+/**
+ * @brief Update VDDA from a VREFINT sample
+ *
+ * @return VDDA in mV, 0 if vrefRaw is 0
+ */
+uint32_t adcCalUpdateVdda(uint16_t vrefRaw)
+{
+    uint32_t vdda;
+
+    if(vrefRaw == 0U)
+    {
+        return 0;
+    }
+
+    vdda = ((ADC_CAL_VDDA_REF_MV * adcCalVrefint) + (vrefRaw / 2U)) / vrefRaw;
+
+    /*vdda << 16 fits for any VDDA below 65 V*/
+    adcCalMvQ16 = ((vdda << 16) + (ADC_CAL_FULL_SCALE / 2U)) / ADC_CAL_FULL_SCALE;
+    adcCalNormQ16 = ((vdda << 16) + (ADC_CAL_VDDA_REF_MV / 2U)) / ADC_CAL_VDDA_REF_MV;
+    adcCalVdda = vdda;
+
+    return vdda;
+}
+
+/**
+ * @brief Injected group callback of adcCalMeasure()
+ *
+ * @return None
+ */
+static void adcCalInjected(const uint16_t *values, uint8_t count, uint32_t timestamp)
+{
+    (void)timestamp;
+
+    if(count == 2U)
+    {
+        adcCalSamples[0] = values[0];
+        adcCalSamples[1] = values[1];
+    }
+    adcCalDone = 1;
+}
+
+/**
+ * @brief Sample VREFINT and the temperature sensor once
+ *
+ * @return 1 on success, 0 on timeout
+ */
+uint8_t adcCalMeasure(uint16_t *tempRaw)
+{
+    static const adcScanChannel_t channels[2] =
+    {
+        {ADC_CHANNEL_VREFINT, ADC_SMP_480},
+        {ADC_CHANNEL_TEMP, ADC_SMP_480}
+    };
+    uint32_t timeout = ADC_CAL_TIMEOUT;
+    uint32_t start;
+    adcInjState_t saved;
+
+    /*Borrow the injected group, e.g. from a current sense on a PWM edge*/
+    if(!adcInjectedSave(&saved))
+    {
+        return 0;
+    }
+
+    adcCalDone = 0;
+
+    if(adcInjectedInit(channels, 2, ADC_JTRIG_SOFTWARE, adcCalInjected))
+    {
+        /*ADON and TSVREFE were just set: let the ADC and both sources settle.
+          The microsecond count can step right after the read, hence <=*/
+        start = timGetMicros();
+        while((timGetMicros() - start) <= ADC_CAL_STARTUP_US)
+        {
+        }
+
+        adcInjectedStart();
+
+        while(!adcCalDone && (--timeout != 0U))
+        {
+        }
+    }
+
+    adcInjectedRestore(&saved);
+
+    if(!adcCalDone)
+    {
+        return 0;
+    }
+
+    adcCalUpdateVdda(adcCalSamples[0]);
+
+    if(tempRaw)
+    {
+        *tempRaw = adcCalSamples[1];
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Current VDDA estimate
+ *
+ * @return VDDA in mV
+ */
+uint32_t adcCalGetVdda(void)
+{
+    return adcCalVdda;
+}
+
+/**
+ * @brief Convert counts to millivolts at the current VDDA
+ *
+ * @return Input voltage in mV
+ */
+uint32_t adcCalToMillivolts(uint16_t raw)
+{
+    return ((raw * adcCalMvQ16) + 0x8000U) >> 16;
+}
+
+/**
+ * @brief Convert one channel of an ADC block to millivolts
+ *
+ * @return None
+ */
+void adcCalToMillivoltsBlock(const uint16_t *src, uint32_t stride, uint16_t *dst, uint32_t n)
+{
+    uint32_t k = adcCalMvQ16;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        dst[i] = (uint16_t)(((src[i * stride] * k) + 0x8000U) >> 16);
+    }
+}
+
+/**
+ * @brief Convert temperature sensor counts to temperature
+ *
+ * @return Temperature in 0.01 degC
+ */
+int32_t adcCalTemperature(uint16_t raw)
+{
+    /*Counts the sensor would give at the calibration VDDA*/
+    int32_t norm = (int32_t)(((raw * adcCalNormQ16) + 0x8000U) >> 16);
+
+    return ADC_CAL_TEMP1_CDEG + (((norm - (int32_t)adcCalTs1) * adcCalSlopeQ8) >> 8);
+}
+
+/**
+ * @brief Look up counts in a piecewise-linear table
+ *
+ * @return Interpolated table value
+ */
+int32_t adcCalLookup(const adcCalLut_t *lut, uint16_t raw)
+{
+    uint32_t i;
+    int32_t frac;
+    int32_t y0;
+    int32_t y1;
+
+    if(raw > ADC_CAL_FULL_SCALE)
+    {
+        raw = ADC_CAL_FULL_SCALE;
+    }
+
+    i = (uint32_t)raw >> lut->shift;
+    frac = (int32_t)(raw & ((1U << lut->shift) - 1U));
+    y0 = lut->points[i];
+    y1 = lut->points[i + 1U];
+
+    return y0 + (((y1 - y0) * frac) >> lut->shift);
+}
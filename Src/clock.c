@@ -22,4 +22,78 @@ void enableRccAHB1Clk(void)
     RCC->AHB1ENR |= RCC_AHB1ENR_GPIODEN; // Enable GPIOD clock (bit 3)
 
     RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN; // Enable GPIOD clock (bit 3)
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start the main PLL for the 48 MHz peripheral clock
+ * 
+ * VCO = 16 MHz / 16 * 192 = 192 MHz, PLL48CK = 192 / 4 = 48 MHz,
+ * PLLP = 192 / 8 = 24 MHz (not used as system clock).
+ * 
+ * @return None
+ */
+void clockEnablePll48(void)
+{
+    /*Already running*/
+    if(RCC->CR & RCC_CR_PLLRDY)
+    {
+        return;
+    }
+
+    /*HSI source, M = 16, N = 192, P = 8, Q = 4*/
+    RCC->PLLCFGR = RCC_PLLCFGR_PLLSRC_HSI |
+                   (16U << RCC_PLLCFGR_PLLM_Pos) |
+                   (192U << RCC_PLLCFGR_PLLN_Pos) |
+                   (3U << RCC_PLLCFGR_PLLP_Pos) |
+                   (4U << RCC_PLLCFGR_PLLQ_Pos);
+
+    /*Enable PLL and wait until it is locked*/
+    RCC->CR |= RCC_CR_PLLON;
+    while(!(RCC->CR & RCC_CR_PLLRDY)){}
+}
+
+/**
+ * @brief Get the APB1 peripheral clock frequency
+ * 
+ * @return PCLK1 in Hz
+ */
+uint32_t clockGetPclk1(void)
+{
+    static const uint8_t ahbShift[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+    static const uint8_t apbShift[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+    uint32_t cfgr = RCC->CFGR;
+    uint32_t pllcfgr;
+    uint32_t sysclk;
+    uint32_t src;
+    uint32_t pllm;
+    uint32_t plln;
+    uint32_t pllp;
+
+    switch(cfgr & RCC_CFGR_SWS)
+    {
+        case RCC_CFGR_SWS_HSE:
+            sysclk = CLOCK_HSE_VALUE;
+            break;
+
+        case RCC_CFGR_SWS_PLL:
+            pllcfgr = RCC->PLLCFGR;
+            src = (pllcfgr & RCC_PLLCFGR_PLLSRC) ? CLOCK_HSE_VALUE : CLOCK_HSI_VALUE;
+            pllm = pllcfgr & RCC_PLLCFGR_PLLM;
+            plln = (pllcfgr & RCC_PLLCFGR_PLLN) >> RCC_PLLCFGR_PLLN_Pos;
+            pllp = (((pllcfgr & RCC_PLLCFGR_PLLP) >> RCC_PLLCFGR_PLLP_Pos) + 1U) * 2U;
+
+            /*The VCO input need not be whole MHz (HSI / 12 = 1.333 MHz), so
+              multiply by PLLN in kHz before dividing by PLLM; the VCO in
+              kHz times 1000 (432 MHz at most) still fits 32 bits*/
+            sysclk = ((((src / 1000U) * plln) / pllm) * 1000U) / pllp;
+            break;
+
+        default:
+            sysclk = CLOCK_HSI_VALUE;
+            break;
+    }
+
+    sysclk >>= ahbShift[(cfgr & RCC_CFGR_HPRE) >> RCC_CFGR_HPRE_Pos];
+
+    return sysclk >> apbShift[(cfgr & RCC_CFGR_PPRE1) >> RCC_CFGR_PPRE1_Pos];
+}
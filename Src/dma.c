@@ -0,0 +1,126 @@
+/**
+ * @file    dma.c
+ * @brief   DMA1/DMA2 stream helper implementation for STM32F411
+ * @author  Bare Metal STM32
+ * @version 1.0
+ * @date    2026
+ */
+
+#include "dma.h"
+
+/** Offset of the stream register blocks from the controller base */
+#define DMA_STREAM_OFFSET   0x10U
+/** Size of one stream register block */
+#define DMA_STREAM_SIZE     0x18U
+
+/**
+ * @brief Bit position of a stream's flags inside LISR/HISR
+ *
+ * Streams 0/4 start at bit 0, 1/5 at bit 6, 2/6 at bit 16, 3/7 at bit 22.
+ */
+static const uint8_t dmaFlagShift[4] = {0U, 6U, 16U, 22U};
+
+/**
+ * @brief Get the register block of a stream
+ *
+ * @param dma    DMA1 or DMA2
+ * @param stream Stream index (0-7)
+ *
+ * @return Pointer to the stream registers
+ */
+DMA_Stream_TypeDef *dmaGetStream(DMA_TypeDef *dma, uint32_t stream)
+{
+    return (DMA_Stream_TypeDef *)((uint32_t)dma + DMA_STREAM_OFFSET + (DMA_STREAM_SIZE * stream));
+}
+
+/**
+ * @brief Configure a stream
+ *
+ * @return None
+ */
+void dmaStreamConfig(DMA_TypeDef *dma, uint32_t stream, uint32_t channel, uint32_t cr,
+                     volatile void *periph, void *mem, uint16_t count)
+{
+    DMA_Stream_TypeDef *s = dmaGetStream(dma, stream);
+
+    /*Enable clock access to the DMA controller*/
+    if(dma == DMA1)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+    }
+    else
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    }
+
+    /*Stream must be disabled before it can be reconfigured*/
+    dmaStreamStop(dma, stream);
+    dmaClearFlags(dma, stream, DMA_FLAG_ALL);
+
+    /*Set addresses and number of items*/
+    s->PAR = (uint32_t)periph;
+    s->M0AR = (uint32_t)mem;
+    s->NDTR = count;
+
+    /*Select channel and transfer settings*/
+    s->CR = ((channel & 0x7U) << DMA_SxCR_CHSEL_Pos) | (cr & ~DMA_SxCR_EN);
+
+    /*Direct mode (FIFO disabled)*/
+    s->FCR = 0;
+}
+
+/**
+ * @brief Enable a configured stream
+ *
+ * @return None
+ */
+void dmaStreamStart(DMA_TypeDef *dma, uint32_t stream)
+{
+    dmaGetStream(dma, stream)->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief Disable a stream and wait until it has stopped
+ *
+ * @return None
+ */
+void dmaStreamStop(DMA_TypeDef *dma, uint32_t stream)
+{
+    DMA_Stream_TypeDef *s = dmaGetStream(dma, stream);
+
+    s->CR &= ~DMA_SxCR_EN;
+
+    /*EN reads back as 1 until the current beat has finished*/
+    while(s->CR & DMA_SxCR_EN){}
+}
+
+/**
+ * @brief Read the interrupt flags of a stream
+ *
+ * @return Normalized flags (DMA_FLAG_xx)
+ */
+uint32_t dmaGetFlags(DMA_TypeDef *dma, uint32_t stream)
+{
+    uint32_t isr = (stream < 4U) ? dma->LISR : dma->HISR;
+
+    return (isr >> dmaFlagShift[stream & 3U]) & DMA_FLAG_ALL;
+}
+
+/**
+ * @brief Clear interrupt flags of a stream
+ *
+ * @return None
+ */
+void dmaClearFlags(DMA_TypeDef *dma, uint32_t stream, uint32_t flags)
+{
+    uint32_t mask = (flags & DMA_FLAG_ALL) << dmaFlagShift[stream & 3U];
+
+    if(stream < 4U)
+    {
+        dma->LIFCR = mask;
+    }
+    else
+    {
+        dma->HIFCR = mask;
+    }
+}
@@ -0,0 +1,596 @@
+/**
+ * @file dsp.c
+ * @brief Q15/Q31 fixed-point filter kernels implementation
+ *
+ * The DSP instructions are reached through small inline assembly
+ * wrappers instead of the CMSIS intrinsics, so this file does not need
+ * the device headers and builds unchanged on a host compiler.
+ *
+ * The FIR kernels keep a history buffer (CMSIS style): each block is
+ * appended behind the last numTaps - 1 inputs, so every output is one
+ * contiguous dot product, and the tail is moved to the front at the
+ * end of the block.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "dsp.h"
+
+/**
+ * @brief Saturate to Q15
+ *
+ * @param[in] x Value
+ *
+ * @return x clipped to [-32768, 32767]
+ */
+static int16_t dspSatQ15(int64_t x)
+{
+    if(x > 32767)
+    {
+        return 32767;
+    }
+    if(x < -32768)
+    {
+        return -32768;
+    }
+    return (int16_t)x;
+}
+
+/**
+ * @brief Saturate to Q31
+ *
+ * @param[in] x Value
+ *
+ * @return x clipped to the int32_t range
+ */
+static int32_t dspSatQ31(int64_t x)
+{
+    if(x > 2147483647LL)
+    {
+        return 2147483647;
+    }
+    if(x < -2147483647LL - 1)
+    {
+        return -2147483647 - 1;
+    }
+    return (int32_t)x;
+}
+
+/**
+ * @brief Append a block to a FIR history buffer
+ *
+ * @param[out] state History buffer
+ * @param[in] taps Number of coefficients
+ * @param[in] src Input block
+ * @param[in] n Block size
+ *
+ * @return void
+ */
+static void dspHistoryPush(int16_t *state, uint32_t taps, const int16_t *src, uint32_t n)
+{
+    int16_t *p = &state[taps - 1U];
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        p[i] = src[i];
+    }
+}
+
+/**
+ * @brief Keep the newest numTaps - 1 samples at the front of the history
+ *
+ * @param[in,out] state History buffer
+ * @param[in] taps Number of coefficients
+ * @param[in] n Block size just processed
+ *
+ * @return void
+ */
+static void dspHistoryShift(int16_t *state, uint32_t taps, uint32_t n)
+{
+    for(uint32_t k = 0; (k + 1U) < taps; k++)
+    {
+        state[k] = state[n + k];
+    }
+}
+
+#if defined(__ARM_FEATURE_DSP)
+
+/** Unaligned 32-bit access; keeps the compiler from merging into LDRD */
+typedef struct __attribute__((packed))
+{
+    int32_t v;
+} dspPacked32_t;
+
+/**
+ * @brief Load two Q15 values (low half = p[0])
+ *
+ * @param[in] p First value, any 16-bit alignment
+ *
+ * @return Packed pair
+ */
+static inline int32_t dspRead2(const int16_t *p)
+{
+    return ((const dspPacked32_t *)p)->v;
+}
+
+/**
+ * @brief Store two Q15 values (low half to p[0])
+ *
+ * @param[out] p First value, any 16-bit alignment
+ * @param[in] v Packed pair
+ *
+ * @return void
+ */
+static inline void dspWrite2(int16_t *p, int32_t v)
+{
+    ((dspPacked32_t *)p)->v = v;
+}
+
+/**
+ * @brief SMLALD: acc + a.lo * b.lo + a.hi * b.hi (64-bit)
+ *
+ * @return Updated accumulator
+ */
+static inline int64_t dspSmlald(int32_t a, int32_t b, int64_t acc)
+{
+    uint32_t lo = (uint32_t)acc;
+    uint32_t hi = (uint32_t)((uint64_t)acc >> 32);
+
+    __asm volatile ("smlald %0, %1, %2, %3" : "+r" (lo), "+r" (hi) : "r" (a), "r" (b));
+
+    return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+/**
+ * @brief QADD16: saturating add of both halves
+ *
+ * @return Packed sums
+ */
+static inline int32_t dspQadd16(int32_t a, int32_t b)
+{
+    int32_t r;
+
+    __asm volatile ("qadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+
+    return r;
+}
+
+/**
+ * @brief SSAT #16: saturate a 32-bit value to Q15
+ *
+ * @return Saturated value
+ */
+static inline int16_t dspSsat16(int32_t x)
+{
+    int32_t r;
+
+    __asm volatile ("ssat %0, #16, %1" : "=r" (r) : "r" (x));
+
+    return (int16_t)r;
+}
+
+#endif
+
+/**
+ * @brief Convert 12-bit ADC results to Q15
+ *
+ * Safe in place for any stride: sample i is written after every source
+ * position up to i has been read.
+ *
+ * @return void
+ */
+void dspAdcToQ15(const uint16_t *src, uint32_t stride, int16_t *dst, uint32_t n)
+{
+    for(uint32_t i = 0; i < n; i++)
+    {
+        dst[i] = (int16_t)(((int32_t)src[i * stride] - 2048) * 16);
+    }
+}
+
+/**
+ * @brief Saturating element-wise add, Q15
+ *
+ * @return void
+ */
+void dspAddQ15(const int16_t *a, const int16_t *b, int16_t *dst, uint32_t n)
+{
+    uint32_t i = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+    for(; (i + 1U) < n; i += 2U)
+    {
+        dspWrite2(&dst[i], dspQadd16(dspRead2(&a[i]), dspRead2(&b[i])));
+    }
+#endif
+
+    for(; i < n; i++)
+    {
+        dst[i] = dspSatQ15((int32_t)a[i] + b[i]);
+    }
+}
+
+/**
+ * @brief Initialize a Q15 FIR filter and clear its state
+ *
+ * @return void
+ */
+void dspFirQ15Init(dspFirQ15_t *f, uint16_t numTaps, const int16_t *coeffs, int16_t *state)
+{
+    f->numTaps = numTaps;
+    f->coeffs = coeffs;
+    f->state = state;
+
+    for(uint32_t k = 0; (k + 1U) < numTaps; k++)
+    {
+        state[k] = 0;
+    }
+}
+
+/**
+ * @brief Portable Q15 FIR
+ *
+ * @return void
+ */
+void dspFirQ15Ref(dspFirQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+    const int16_t *c = f->coeffs;
+    uint32_t taps = f->numTaps;
+    int64_t acc;
+
+    dspHistoryPush(f->state, taps, src, n);
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        const int16_t *x = &f->state[i];
+
+        acc = 0;
+        for(uint32_t k = 0; k < taps; k++)
+        {
+            acc += (int32_t)c[k] * x[k];
+        }
+
+        dst[i] = dspSatQ15(acc >> 15);
+    }
+
+    dspHistoryShift(f->state, taps, n);
+}
+
+/**
+ * @brief Q15 FIR
+ *
+ * SIMD path: two outputs per pass share each coefficient pair, each
+ * SMLALD does two taps.
+ *
+ * @return void
+ */
+void dspFirQ15(dspFirQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+#if defined(__ARM_FEATURE_DSP)
+    const int16_t *c = f->coeffs;
+    uint32_t taps = f->numTaps;
+    uint32_t i;
+    uint32_t k;
+    int64_t acc0;
+    int64_t acc1;
+    int32_t cc;
+
+    dspHistoryPush(f->state, taps, src, n);
+
+    for(i = 0; (i + 1U) < n; i += 2U)
+    {
+        const int16_t *x = &f->state[i];
+
+        acc0 = 0;
+        acc1 = 0;
+        for(k = 0; (k + 1U) < taps; k += 2U)
+        {
+            cc = dspRead2(&c[k]);
+            acc0 = dspSmlald(cc, dspRead2(&x[k]), acc0);
+            acc1 = dspSmlald(cc, dspRead2(&x[k + 1U]), acc1);
+        }
+        if(k < taps)
+        {
+            acc0 += (int32_t)c[k] * x[k];
+            acc1 += (int32_t)c[k] * x[k + 1U];
+        }
+
+        dst[i] = dspSsat16((int32_t)(acc0 >> 15));
+        dst[i + 1U] = dspSsat16((int32_t)(acc1 >> 15));
+    }
+
+    if(i < n)
+    {
+        const int16_t *x = &f->state[i];
+
+        acc0 = 0;
+        for(k = 0; (k + 1U) < taps; k += 2U)
+        {
+            acc0 = dspSmlald(dspRead2(&c[k]), dspRead2(&x[k]), acc0);
+        }
+        if(k < taps)
+        {
+            acc0 += (int32_t)c[k] * x[k];
+        }
+
+        dst[i] = dspSsat16((int32_t)(acc0 >> 15));
+    }
+
+    dspHistoryShift(f->state, taps, n);
+#else
+    dspFirQ15Ref(f, src, dst, n);
+#endif
+}
+
+/**
+ * @brief Initialize a Q15 biquad cascade and clear its state
+ *
+ * @return void
+ */
+void dspBiquadQ15Init(dspBiquadQ15_t *f, uint8_t numStages, const int16_t *coeffs, int16_t *state,
+                      uint8_t postShift)
+{
+    f->numStages = numStages;
+    f->postShift = postShift;
+    f->coeffs = coeffs;
+    f->state = state;
+
+    for(uint32_t k = 0; k < (4U * numStages); k++)
+    {
+        state[k] = 0;
+    }
+}
+
+/**
+ * @brief Portable Q15 biquad cascade
+ *
+ * @return void
+ */
+void dspBiquadQ15Ref(dspBiquadQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+    const int16_t *in = src;
+    uint32_t shift = 15U - f->postShift;
+
+    for(uint32_t s = 0; s < f->numStages; s++)
+    {
+        const int16_t *c = &f->coeffs[6U * s];
+        int16_t *st = &f->state[4U * s];
+        int16_t x1 = st[0];
+        int16_t x2 = st[1];
+        int16_t y1 = st[2];
+        int16_t y2 = st[3];
+        int16_t x;
+        int16_t y;
+        int64_t acc;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            x = in[i];
+            acc = ((int32_t)c[0] * x) + ((int32_t)c[2] * x1) + ((int32_t)c[3] * x2) +
+                  ((int32_t)c[4] * y1) + ((int32_t)c[5] * y2);
+            y = dspSatQ15(acc >> shift);
+
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            dst[i] = y;
+        }
+
+        st[0] = x1;
+        st[1] = x2;
+        st[2] = y1;
+        st[3] = y2;
+
+        /*Next section filters the output of this one*/
+        in = dst;
+    }
+}
+
+/**
+ * @brief Q15 biquad cascade
+ *
+ * SIMD path: the delay lines stay packed in two registers, so a sample
+ * costs three SMLALD and two shifts.
+ *
+ * @return void
+ */
+void dspBiquadQ15(dspBiquadQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+#if defined(__ARM_FEATURE_DSP)
+    const int16_t *in = src;
+    uint32_t shift = 15U - f->postShift;
+
+    for(uint32_t s = 0; s < f->numStages; s++)
+    {
+        const int16_t *c = &f->coeffs[6U * s];
+        int16_t *st = &f->state[4U * s];
+        int32_t b0 = dspRead2(&c[0]);       // b0 | 0 << 16
+        int32_t b12 = dspRead2(&c[2]);      // b1 | b2 << 16
+        int32_t a12 = dspRead2(&c[4]);      // a1 | a2 << 16
+        int32_t x12 = dspRead2(&st[0]);     // x1 | x2 << 16
+        int32_t y12 = dspRead2(&st[2]);     // y1 | y2 << 16
+        int32_t x;
+        int32_t y;
+        int64_t acc;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            x = (uint16_t)in[i];
+            acc = dspSmlald(b0, x, 0);
+            acc = dspSmlald(b12, x12, acc);
+            acc = dspSmlald(a12, y12, acc);
+            y = dspSsat16((int32_t)(acc >> shift));
+
+            /*Shift the delay lines: new sample in the low half*/
+            x12 = (int32_t)(((uint32_t)x12 << 16) | (uint32_t)x);
+            y12 = (int32_t)(((uint32_t)y12 << 16) | (uint16_t)y);
+            dst[i] = (int16_t)y;
+        }
+
+        dspWrite2(&st[0], x12);
+        dspWrite2(&st[2], y12);
+
+        in = dst;
+    }
+#else
+    dspBiquadQ15Ref(f, src, dst, n);
+#endif
+}
+
+/**
+ * @brief Initialize a Q31 biquad cascade and clear its state
+ *
+ * @return void
+ */
+void dspBiquadQ31Init(dspBiquadQ31_t *f, uint8_t numStages, const int32_t *coeffs, int32_t *state,
+                      uint8_t postShift)
+{
+    f->numStages = numStages;
+    f->postShift = postShift;
+    f->coeffs = coeffs;
+    f->state = state;
+
+    for(uint32_t k = 0; k < (4U * numStages); k++)
+    {
+        state[k] = 0;
+    }
+}
+
+/**
+ * @brief Q31 biquad cascade
+ *
+ * @return void
+ */
+void dspBiquadQ31(dspBiquadQ31_t *f, const int32_t *src, int32_t *dst, uint32_t n)
+{
+    const int32_t *in = src;
+    uint32_t shift = 31U - f->postShift;
+
+    for(uint32_t s = 0; s < f->numStages; s++)
+    {
+        const int32_t *c = &f->coeffs[5U * s];
+        int32_t *st = &f->state[4U * s];
+        int32_t x1 = st[0];
+        int32_t x2 = st[1];
+        int32_t y1 = st[2];
+        int32_t y2 = st[3];
+        int32_t x;
+        int32_t y;
+        int64_t acc;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            x = in[i];
+            acc = ((int64_t)c[0] * x) + ((int64_t)c[1] * x1) + ((int64_t)c[2] * x2) +
+                  ((int64_t)c[3] * y1) + ((int64_t)c[4] * y2);
+            y = dspSatQ31(acc >> shift);
+
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            dst[i] = y;
+        }
+
+        st[0] = x1;
+        st[1] = x2;
+        st[2] = y1;
+        st[3] = y2;
+
+        in = dst;
+    }
+}
+
+/**
+ * @brief Initialize a Q15 decimating FIR filter and clear its state
+ *
+ * @return void
+ */
+void dspDecimQ15Init(dspDecimQ15_t *f, uint8_t factor, uint16_t numTaps, const int16_t *coeffs,
+                     int16_t *state)
+{
+    f->factor = factor;
+    f->numTaps = numTaps;
+    f->coeffs = coeffs;
+    f->state = state;
+
+    for(uint32_t k = 0; (k + 1U) < numTaps; k++)
+    {
+        state[k] = 0;
+    }
+}
+
+/**
+ * @brief Portable Q15 decimating FIR
+ *
+ * @return Number of output samples
+ */
+uint32_t dspDecimQ15Ref(dspDecimQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+    const int16_t *c = f->coeffs;
+    uint32_t taps = f->numTaps;
+    uint32_t out = n / f->factor;
+    int64_t acc;
+
+    dspHistoryPush(f->state, taps, src, n);
+
+    for(uint32_t j = 0; j < out; j++)
+    {
+        const int16_t *x = &f->state[((j + 1U) * f->factor) - 1U];
+
+        acc = 0;
+        for(uint32_t k = 0; k < taps; k++)
+        {
+            acc += (int32_t)c[k] * x[k];
+        }
+
+        dst[j] = dspSatQ15(acc >> 15);
+    }
+
+    dspHistoryShift(f->state, taps, n);
+
+    return out;
+}
+
+/**
+ * @brief Q15 decimating FIR
+ *
+ * @return Number of output samples
+ */
+uint32_t dspDecimQ15(dspDecimQ15_t *f, const int16_t *src, int16_t *dst, uint32_t n)
+{
+#if defined(__ARM_FEATURE_DSP)
+    const int16_t *c = f->coeffs;
+    uint32_t taps = f->numTaps;
+    uint32_t out = n / f->factor;
+    uint32_t k;
+    int64_t acc;
+
+    dspHistoryPush(f->state, taps, src, n);
+
+    for(uint32_t j = 0; j < out; j++)
+    {
+        const int16_t *x = &f->state[((j + 1U) * f->factor) - 1U];
+
+        acc = 0;
+        for(k = 0; (k + 1U) < taps; k += 2U)
+        {
+            acc = dspSmlald(dspRead2(&c[k]), dspRead2(&x[k]), acc);
+        }
+        if(k < taps)
+        {
+            acc += (int32_t)c[k] * x[k];
+        }
+
+        dst[j] = dspSsat16((int32_t)(acc >> 15));
+    }
+
+    dspHistoryShift(f->state, taps, n);
+
+    return out;
+#else
+    return dspDecimQ15Ref(f, src, dst, n);
+#endif
+}
@@ -0,0 +1,247 @@
+/**
+ * @file dspbench.c
+ * @brief Cycle benchmark of the DSP kernels implementation
+ *
+ * Each kernel runs on a freshly initialized filter so the optimized and
+ * the reference outputs can be compared sample by sample.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "dspbench.h"
+#include "dsp.h"
+#include "fft.h"
+
+#define DSP_BENCH_TAPS          32U
+#define DSP_BENCH_STAGES        2U
+#define DSP_BENCH_FACTOR        4U
+
+/*Low-pass, Hamming windowed sinc, cutoff 0.1 fs, unity DC gain (symmetric)*/
+static const int16_t dspBenchFir[DSP_BENCH_TAPS] =
+{
+    -17, 20, 73, 135, 164, 91, -129, -466,
+    -783, -850, -435, 588, 2141, 3927, 5501, 6424,
+    6424, 5501, 3927, 2141, 588, -435, -850, -783,
+    -466, -129, 91, 164, 135, 73, 20, -17
+};
+
+/*4th order Butterworth low-pass, cutoff 0.1 fs: {b0, 0, b1, b2, a1, a2}, postShift 1*/
+static const int16_t dspBenchBiquad[6U * DSP_BENCH_STAGES] =
+{
+    1277, 0, 2554, 1277, 21642, -10367,
+    1014, 0, 2028, 1014, 17180, -4852
+};
+
+static int16_t dspBenchIn[DSP_BENCH_BLOCK];
+static int16_t dspBenchOut[DSP_BENCH_BLOCK];
+static int16_t dspBenchRefOut[DSP_BENCH_BLOCK];
+static int16_t dspBenchState[DSP_BENCH_TAPS - 1U + DSP_MAX_BLOCK];
+static uint16_t dspBenchFftBuf[DSP_BENCH_FFT_SIZE];
+#ifdef FFT_ENABLE_F32
+static float dspBenchFftF32[DSP_BENCH_FFT_SIZE];
+#endif
+
+/**
+ * @brief Start the DWT cycle counter
+ *
+ * @return void
+ */
+static void dspBenchCounterInit(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Convert a cycle count into cycles per block sample
+ *
+ * @param[in] cycles Cycles for one block
+ *
+ * @return Rounded cycles per sample
+ */
+static uint32_t dspBenchPerSample(uint32_t cycles)
+{
+    return (cycles + (DSP_BENCH_BLOCK / 2U)) / DSP_BENCH_BLOCK;
+}
+
+/**
+ * @brief Largest difference between two output blocks
+ *
+ * @param[in] a First block
+ * @param[in] b Second block
+ * @param[in] n Number of samples
+ * @param[in] max Running maximum
+ *
+ * @return Updated maximum
+ */
+static uint32_t dspBenchDiff(const int16_t *a, const int16_t *b, uint32_t n, uint32_t max)
+{
+    int32_t d;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        d = (int32_t)a[i] - b[i];
+        if(d < 0)
+        {
+            d = -d;
+        }
+        if((uint32_t)d > max)
+        {
+            max = (uint32_t)d;
+        }
+    }
+
+    return max;
+}
+
+/**
+ * @brief Portable saturating add, the baseline for dspAddQ15()
+ *
+ * @return void
+ */
+static void dspBenchAddRef(const int16_t *a, const int16_t *b, int16_t *dst, uint32_t n)
+{
+    int32_t s;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        s = (int32_t)a[i] + b[i];
+        dst[i] = (s > 32767) ? 32767 : ((s < -32768) ? -32768 : (int16_t)s);
+    }
+}
+
+/**
+ * @brief Fill the input block with a triangle wave plus noise
+ *
+ * @return void
+ */
+static void dspBenchFill(void)
+{
+    uint32_t lcg = 12345U;
+    int32_t tri = 0;
+    int32_t step = 1024;
+
+    for(uint32_t i = 0; i < DSP_BENCH_BLOCK; i++)
+    {
+        lcg = (lcg * 1664525U) + 1013904223U;
+
+        /*Triangle wave at 1/64 of the sample rate*/
+        tri += step;
+        if((tri >= 16384) || (tri <= -16384))
+        {
+            step = -step;
+        }
+
+        dspBenchIn[i] = (int16_t)(tri + ((int32_t)(lcg >> 20) - 2048));
+    }
+}
+
+/**
+ * @brief Time the real FFT on a windowed ADC-style capture
+ *
+ * @param[out] result FFT fields are filled in
+ *
+ * @return void
+ */
+static void dspBenchFft(dspBenchResult_t *result)
+{
+    int16_t *buf = (int16_t *)dspBenchFftBuf;
+    uint32_t start;
+
+    /*12-bit samples built from the block input*/
+    for(uint32_t i = 0; i < DSP_BENCH_FFT_SIZE; i++)
+    {
+        dspBenchFftBuf[i] = (uint16_t)(2048 + (dspBenchIn[i % DSP_BENCH_BLOCK] >> 4));
+    }
+    fftPrepareQ15(dspBenchFftBuf, 1, buf, DSP_BENCH_FFT_SIZE, FFT_WINDOW_HANN);
+
+#ifdef FFT_ENABLE_F32
+    for(uint32_t i = 0; i < DSP_BENCH_FFT_SIZE; i++)
+    {
+        dspBenchFftF32[i] = (float)buf[i];
+    }
+#endif
+
+    start = DWT->CYCCNT;
+    fftRealQ15(buf, DSP_BENCH_FFT_SIZE);
+    result->fftQ15 = DWT->CYCCNT - start;
+
+#ifdef FFT_ENABLE_F32
+    start = DWT->CYCCNT;
+    fftRealF32(dspBenchFftF32, DSP_BENCH_FFT_SIZE);
+    result->fftF32 = DWT->CYCCNT - start;
+#endif
+}
+
+/**
+ * @brief Run the benchmark
+ *
+ * @return void
+ */
+void dspBenchRun(dspBenchResult_t *result)
+{
+    int16_t biquadState[4U * DSP_BENCH_STAGES];
+    dspFirQ15_t fir;
+    dspBiquadQ15_t biquad;
+    dspDecimQ15_t decim;
+    uint32_t start;
+    uint32_t n;
+    uint32_t diff = 0;
+
+    dspBenchCounterInit();
+    dspBenchFill();
+
+    /*Saturating add*/
+    start = DWT->CYCCNT;
+    dspAddQ15(dspBenchIn, dspBenchIn, dspBenchOut, DSP_BENCH_BLOCK);
+    result->add.simd = dspBenchPerSample(DWT->CYCCNT - start);
+
+    start = DWT->CYCCNT;
+    dspBenchAddRef(dspBenchIn, dspBenchIn, dspBenchRefOut, DSP_BENCH_BLOCK);
+    result->add.ref = dspBenchPerSample(DWT->CYCCNT - start);
+    diff = dspBenchDiff(dspBenchOut, dspBenchRefOut, DSP_BENCH_BLOCK, diff);
+
+    /*FIR*/
+    dspFirQ15Init(&fir, DSP_BENCH_TAPS, dspBenchFir, dspBenchState);
+    start = DWT->CYCCNT;
+    dspFirQ15(&fir, dspBenchIn, dspBenchOut, DSP_BENCH_BLOCK);
+    result->fir.simd = dspBenchPerSample(DWT->CYCCNT - start);
+
+    dspFirQ15Init(&fir, DSP_BENCH_TAPS, dspBenchFir, dspBenchState);
+    start = DWT->CYCCNT;
+    dspFirQ15Ref(&fir, dspBenchIn, dspBenchRefOut, DSP_BENCH_BLOCK);
+    result->fir.ref = dspBenchPerSample(DWT->CYCCNT - start);
+    diff = dspBenchDiff(dspBenchOut, dspBenchRefOut, DSP_BENCH_BLOCK, diff);
+
+    /*Biquad cascade*/
+    dspBiquadQ15Init(&biquad, DSP_BENCH_STAGES, dspBenchBiquad, biquadState, 1);
+    start = DWT->CYCCNT;
+    dspBiquadQ15(&biquad, dspBenchIn, dspBenchOut, DSP_BENCH_BLOCK);
+    result->biquad.simd = dspBenchPerSample(DWT->CYCCNT - start);
+
+    dspBiquadQ15Init(&biquad, DSP_BENCH_STAGES, dspBenchBiquad, biquadState, 1);
+    start = DWT->CYCCNT;
+    dspBiquadQ15Ref(&biquad, dspBenchIn, dspBenchRefOut, DSP_BENCH_BLOCK);
+    result->biquad.ref = dspBenchPerSample(DWT->CYCCNT - start);
+    diff = dspBenchDiff(dspBenchOut, dspBenchRefOut, DSP_BENCH_BLOCK, diff);
+
+    /*Decimation (cost per input sample)*/
+    dspDecimQ15Init(&decim, DSP_BENCH_FACTOR, DSP_BENCH_TAPS, dspBenchFir, dspBenchState);
+    start = DWT->CYCCNT;
+    n = dspDecimQ15(&decim, dspBenchIn, dspBenchOut, DSP_BENCH_BLOCK);
+    result->decim.simd = dspBenchPerSample(DWT->CYCCNT - start);
+
+    dspDecimQ15Init(&decim, DSP_BENCH_FACTOR, DSP_BENCH_TAPS, dspBenchFir, dspBenchState);
+    start = DWT->CYCCNT;
+    n = dspDecimQ15Ref(&decim, dspBenchIn, dspBenchRefOut, DSP_BENCH_BLOCK);
+    result->decim.ref = dspBenchPerSample(DWT->CYCCNT - start);
+    diff = dspBenchDiff(dspBenchOut, dspBenchRefOut, n, diff);
+
+    result->maxDiff = diff;
+
+    /*Real FFT*/
+    dspBenchFft(result);
+}
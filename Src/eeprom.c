@@ -0,0 +1,500 @@
+/**
+ * @file eeprom.c
+ * @brief 24Cxx I2C EEPROM driver implementation
+ *
+ * Every bus access is one scheduler job waited for in place until the
+ * scheduler releases it (i2cSchedBusy()), retries included; the wait
+ * keeps calling i2cSchedPoll() so the job deadline is enforced.
+ *
+ * The read cache only ever holds bytes the device has acknowledged:
+ * cached lines are updated after a page write succeeds, and a line
+ * overlapping the pending page is flushed before it is served.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "eeprom.h"
+#include "timer.h"
+
+#define EEPROM_LINE_NONE        0xFFFFU
+
+/**
+ * @brief One read cache line
+ */
+typedef struct
+{
+    uint16_t tag;                       /**< Line number, EEPROM_LINE_NONE if empty */
+    uint8_t data[EEPROM_CACHE_LINE];    /**< Cached bytes */
+} eepromLine_t;
+
+static i2cJob_t eepromJob;
+static eepromLine_t eepromCache[EEPROM_CACHE_LINES];
+
+/*Coalescing buffer: bytes [pendLo, pendHi) of page pendPage are valid*/
+static uint8_t eepromPage[EEPROM_PAGE_SIZE];
+static uint8_t eepromPending;
+static uint16_t eepromPendPage;
+static uint16_t eepromPendLo;
+static uint16_t eepromPendHi;
+
+/*Set after a page write until the device ACKs its address again*/
+static uint8_t eepromBusy;
+static uint32_t eepromWriteStart;
+
+static eepromStats_t eepromStats;
+
+/**
+ * @brief Copy bytes
+ *
+ * @param[out] dst Destination
+ * @param[in] src Source
+ * @param[in] len Number of bytes
+ *
+ * @return void
+ */
+static void eepromCopy(uint8_t *dst, const uint8_t *src, uint16_t len)
+{
+    while(len--)
+    {
+        *dst++ = *src++;
+    }
+}
+
+/**
+ * @brief Run one transfer on the bus and wait for it
+ *
+ * @param[in] addr Memory address (ignored for a probe)
+ * @param[in] probe 1 to send only the device address
+ * @param[in] tx Bytes to write after the memory address
+ * @param[in] txLen Number of bytes to write
+ * @param[out] rx Destination of the read bytes
+ * @param[in] rxLen Number of bytes to read
+ *
+ * @return Transfer status
+ */
+static i2cStatus_t eepromTransfer(uint16_t addr, uint8_t probe, const uint8_t *tx, uint16_t txLen,
+                                  uint8_t *rx, uint16_t rxLen)
+{
+    i2cTransfer_t *xfer = &eepromJob.xfer;
+    uint32_t start;
+
+#if (EEPROM_ADDR_BYTES == 2U)
+    xfer->addr = EEPROM_I2C_ADDR;
+    xfer->header[0] = (uint8_t)(addr >> 8);
+    xfer->header[1] = (uint8_t)addr;
+#else
+    /*Small devices carry A8-A10 in the device address*/
+    xfer->addr = (uint8_t)(EEPROM_I2C_ADDR | ((addr >> 8) & 0x7U));
+    xfer->header[0] = (uint8_t)addr;
+    xfer->header[1] = 0;
+#endif
+
+    xfer->headerLen = probe ? 0U : EEPROM_ADDR_BYTES;
+    xfer->txBuf = tx;
+    xfer->txLen = txLen;
+    xfer->rxBuf = rx;
+    xfer->rxLen = rxLen;
+
+    eepromJob.priority = I2C_SCHED_PRIO_NORMAL;
+    eepromJob.retries = probe ? 0U : 1U;
+    eepromJob.timeoutUs = EEPROM_XFER_TIMEOUT_US;
+    eepromJob.done = 0;
+
+    /*A full queue drains as the other jobs finish*/
+    start = timGetMicros();
+    while(!i2cSchedSubmit(&eepromJob))
+    {
+        if((timGetMicros() - start) >= EEPROM_XFER_TIMEOUT_US)
+        {
+            return I2C_ERR_TIMEOUT;
+        }
+        i2cSchedPoll();
+    }
+
+    eepromStats.busTransactions++;
+
+    /*Released only after the last retry, the buffers are free again*/
+    while(i2cSchedBusy(&eepromJob))
+    {
+        i2cSchedPoll();
+    }
+
+    return xfer->status;
+}
+
+/**
+ * @brief Wait for the end of the internal write cycle (ACK polling)
+ *
+ * @return EEPROM_OK or EEPROM_ERR_TIMEOUT
+ */
+static eepromStatus_t eepromWaitReady(void)
+{
+    while(eepromBusy)
+    {
+        if(eepromTransfer(0, 1, 0, 0, 0, 0) == I2C_OK)
+        {
+            eepromBusy = 0;
+        }
+        else
+        {
+            eepromStats.ackPolls++;
+
+            if((timGetMicros() - eepromWriteStart) >= EEPROM_WRITE_TIMEOUT_US)
+            {
+                eepromBusy = 0;
+                return EEPROM_ERR_TIMEOUT;
+            }
+        }
+    }
+
+    return EEPROM_OK;
+}
+
+/**
+ * @brief Update the cached copies of written bytes
+ *
+ * @param[in] addr First address
+ * @param[in] data Source
+ * @param[in] len Number of bytes
+ *
+ * @return void
+ */
+static void eepromCacheUpdate(uint16_t addr, const uint8_t *data, uint16_t len)
+{
+    uint16_t tag;
+    uint16_t offset;
+    uint16_t n;
+    eepromLine_t *line;
+
+    while(len)
+    {
+        tag = addr / EEPROM_CACHE_LINE;
+        offset = addr % EEPROM_CACHE_LINE;
+        n = EEPROM_CACHE_LINE - offset;
+        n = (n > len) ? len : n;
+        line = &eepromCache[tag & (EEPROM_CACHE_LINES - 1U)];
+
+        if(line->tag == tag)
+        {
+            eepromCopy(&line->data[offset], data, n);
+        }
+
+        addr += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Program bytes inside one page
+ *
+ * @param[in] addr First address
+ * @param[in] data Source
+ * @param[in] len Number of bytes (does not cross a page)
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+static eepromStatus_t eepromPageWrite(uint16_t addr, const uint8_t *data, uint16_t len)
+{
+    eepromStatus_t status = eepromWaitReady();
+
+    if(status != EEPROM_OK)
+    {
+        return status;
+    }
+
+    if(eepromTransfer(addr, 0, data, len, 0, 0) != I2C_OK)
+    {
+        return EEPROM_ERR_BUS;
+    }
+
+    eepromStats.pageWrites++;
+    eepromStats.bytesWritten += len;
+
+    /*Write-through once the device has taken the data*/
+    eepromCacheUpdate(addr, data, len);
+
+    /*Do not wait here: the next access polls for the end of the cycle*/
+    eepromBusy = 1;
+    eepromWriteStart = timGetMicros();
+
+    return EEPROM_OK;
+}
+
+/**
+ * @brief Program the coalescing buffer
+ *
+ * The buffer stays pending after an error, so bytes already reported as
+ * written are programmed by the next flush instead of being lost.
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+static eepromStatus_t eepromFlushPending(void)
+{
+    uint16_t base = eepromPendPage * EEPROM_PAGE_SIZE;
+    eepromStatus_t status;
+
+    if(!eepromPending)
+    {
+        return EEPROM_OK;
+    }
+
+    status = eepromPageWrite(eepromPendLo, &eepromPage[eepromPendLo - base],
+                             eepromPendHi - eepromPendLo);
+
+    if(status == EEPROM_OK)
+    {
+        eepromPending = 0;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Flush the coalescing buffer if it overlaps a range
+ *
+ * @param[in] addr First address
+ * @param[in] len Number of bytes
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+static eepromStatus_t eepromFlushOverlap(uint16_t addr, uint16_t len)
+{
+    if(eepromPending && (addr < eepromPendHi) && ((uint32_t)addr + len > eepromPendLo))
+    {
+        return eepromFlushPending();
+    }
+
+    return EEPROM_OK;
+}
+
+/**
+ * @brief Merge a write inside one page into the coalescing buffer
+ *
+ * @param[in] addr First address
+ * @param[in] data Source
+ * @param[in] len Number of bytes (does not cross a page)
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+static eepromStatus_t eepromCoalesce(uint16_t addr, const uint8_t *data, uint16_t len)
+{
+    uint16_t page = addr / EEPROM_PAGE_SIZE;
+    uint16_t base = page * EEPROM_PAGE_SIZE;
+    uint16_t end = addr + len;
+    eepromStatus_t status;
+
+    /*Another page, or a gap that would need unknown bytes*/
+    if(eepromPending && ((page != eepromPendPage) || (addr > eepromPendHi) || (end < eepromPendLo)))
+    {
+        status = eepromFlushPending();
+
+        if(status != EEPROM_OK)
+        {
+            return status;
+        }
+    }
+
+    if(eepromPending)
+    {
+        eepromStats.coalescedWrites++;
+        eepromPendLo = (addr < eepromPendLo) ? addr : eepromPendLo;
+        eepromPendHi = (end > eepromPendHi) ? end : eepromPendHi;
+    }
+    else
+    {
+        eepromPending = 1;
+        eepromPendPage = page;
+        eepromPendLo = addr;
+        eepromPendHi = end;
+    }
+
+    eepromCopy(&eepromPage[addr - base], data, len);
+
+    /*Page complete: no reason to wait*/
+    if((eepromPendLo == base) && (eepromPendHi == base + EEPROM_PAGE_SIZE))
+    {
+        return eepromFlushPending();
+    }
+
+    return EEPROM_OK;
+}
+
+/**
+ * @brief Reset the driver state
+ *
+ * @return void
+ */
+void eepromInit(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < EEPROM_CACHE_LINES; i++)
+    {
+        eepromCache[i].tag = EEPROM_LINE_NONE;
+    }
+
+    eepromPending = 0;
+    eepromBusy = 0;
+    eepromJob.next = 0;
+}
+
+/**
+ * @brief Read bytes
+ *
+ * @return EEPROM_OK, EEPROM_ERR_RANGE, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+eepromStatus_t eepromRead(uint16_t addr, uint8_t *data, uint16_t len)
+{
+    eepromStatus_t status;
+    eepromLine_t *line;
+    uint16_t tag;
+    uint16_t offset;
+    uint16_t n;
+
+    if(((uint32_t)addr + len) > EEPROM_SIZE)
+    {
+        return EEPROM_ERR_RANGE;
+    }
+
+    /*Long reads: one burst, cache untouched*/
+    if(len >= EEPROM_CACHE_BYPASS)
+    {
+        status = eepromFlushOverlap(addr, len);
+
+        if(status == EEPROM_OK)
+        {
+            status = eepromWaitReady();
+        }
+
+        if(status != EEPROM_OK)
+        {
+            return status;
+        }
+
+        return (eepromTransfer(addr, 0, 0, 0, data, len) == I2C_OK) ? EEPROM_OK : EEPROM_ERR_BUS;
+    }
+
+    while(len)
+    {
+        tag = addr / EEPROM_CACHE_LINE;
+        offset = addr % EEPROM_CACHE_LINE;
+        n = EEPROM_CACHE_LINE - offset;
+        n = (n > len) ? len : n;
+        line = &eepromCache[tag & (EEPROM_CACHE_LINES - 1U)];
+
+        /*The device must hold the latest data before the line is used*/
+        status = eepromFlushOverlap(tag * EEPROM_CACHE_LINE, EEPROM_CACHE_LINE);
+
+        if(status != EEPROM_OK)
+        {
+            return status;
+        }
+
+        if(line->tag == tag)
+        {
+            eepromStats.cacheHits++;
+        }
+        else
+        {
+            eepromStats.cacheMisses++;
+
+            status = eepromWaitReady();
+
+            if(status != EEPROM_OK)
+            {
+                return status;
+            }
+
+            line->tag = EEPROM_LINE_NONE;
+
+            if(eepromTransfer(tag * EEPROM_CACHE_LINE, 0, 0, 0, line->data, EEPROM_CACHE_LINE) != I2C_OK)
+            {
+                return EEPROM_ERR_BUS;
+            }
+
+            line->tag = tag;
+        }
+
+        eepromCopy(data, &line->data[offset], n);
+
+        addr += n;
+        data += n;
+        len -= n;
+    }
+
+    return EEPROM_OK;
+}
+
+/**
+ * @brief Write bytes
+ *
+ * @return EEPROM_OK, EEPROM_ERR_RANGE, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+eepromStatus_t eepromWrite(uint16_t addr, const uint8_t *data, uint16_t len)
+{
+    eepromStatus_t status = EEPROM_OK;
+    uint16_t n;
+
+    if(((uint32_t)addr + len) > EEPROM_SIZE)
+    {
+        return EEPROM_ERR_RANGE;
+    }
+
+    while(len && (status == EEPROM_OK))
+    {
+        /*Split on page boundaries*/
+        n = EEPROM_PAGE_SIZE - (addr % EEPROM_PAGE_SIZE);
+        n = (n > len) ? len : n;
+
+        if(n == EEPROM_PAGE_SIZE)
+        {
+            status = eepromPageWrite(addr, data, n);
+
+            /*Whole page: a pending write to it is now overwritten*/
+            if((status == EEPROM_OK) && eepromPending && (eepromPendPage == (addr / EEPROM_PAGE_SIZE)))
+            {
+                eepromPending = 0;
+            }
+        }
+        else
+        {
+            status = eepromCoalesce(addr, data, n);
+        }
+
+        addr += n;
+        data += n;
+        len -= n;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Program the pending page and wait for the write cycle
+ *
+ * @return EEPROM_OK, EEPROM_ERR_BUS or EEPROM_ERR_TIMEOUT
+ */
+eepromStatus_t eepromFlush(void)
+{
+    eepromStatus_t status = eepromFlushPending();
+
+    if(status != EEPROM_OK)
+    {
+        return status;
+    }
+
+    return eepromWaitReady();
+}
+
+/**
+ * @brief Copy the driver counters
+ *
+ * @return void
+ */
+void eepromGetStats(eepromStats_t *stats)
+{
+    *stats = eepromStats;
+}
@@ -38,3 +38,42 @@ void pc13ExtiInit(void)
     /*Enable global interrupt*/
     __enable_irq();
 }
+
+/**
+ * @brief Initialize EXTI1 on PE1 pin for rising edge interrupt
+ * 
+ * Configuration:
+ * - PE1 as input pin
+ * - Rising edge trigger
+ * - EXTI1 interrupt enabled in NVIC
+ */
+void pe1ExtiInit(void)
+{
+    /*Disable global interrupts*/
+    __disable_irq();
+
+    /*Enable clock access for GPIOE*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOEEN;
+
+    /*Set PE1 as input (clear MODER bits)*/
+    GPIOE->MODER &= ~(GPIO_MODER_MODER1_0 | GPIO_MODER_MODER1_1);
+
+    /*Enable clock access to SYSCFG*/
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+
+    /*Select PORTE for EXTI1 (use EXTICR[0] for EXTI1)*/
+    SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI1;
+    SYSCFG->EXTICR[0] |= SYSCFG_EXTICR1_EXTI1_PE;
+
+    /*Unmask EXTI1 interrupt*/
+    EXTI->IMR |= EXTI_IMR_MR1;
+
+    /*Select rising edge trigger for EXTI1*/
+    EXTI->RTSR |= EXTI_RTSR_TR1;
+
+    /*Enable EXTI1 line in NVIC*/
+    NVIC_EnableIRQ(EXTI1_IRQn);
+
+    /*Enable global interrupt*/
+    __enable_irq();
+}
@@ -0,0 +1,798 @@
+/**
+ * @file fft.c
+ * @brief Fixed-point real FFT and spectral analysis implementation
+ *
+ * Angles are expressed in 1/2048 of a turn, so every twiddle of every
+ * supported size is an entry of the quarter-wave table (possibly
+ * mirrored or negated).
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "fft.h"
+
+/** Angle units per turn */
+#define FFT_TURN                2048U
+
+/** log2 of the bit-reversal table length */
+#define FFT_REV_BITS            10U
+
+/** sin(2 * pi * k / 2048) in Q15 for k = 0..512 */
+static const int16_t fftSinTable[(FFT_TURN / 4U) + 1U] =
+{
+    0, 101, 201, 302, 402, 503, 603, 704,
+    804, 905, 1005, 1106, 1206, 1307, 1407, 1507,
+    1608, 1708, 1809, 1909, 2009, 2110, 2210, 2310,
+    2411, 2511, 2611, 2711, 2811, 2912, 3012, 3112,
+    3212, 3312, 3412, 3512, 3612, 3712, 3812, 3911,
+    4011, 4111, 4211, 4310, 4410, 4510, 4609, 4709,
+    4808, 4907, 5007, 5106, 5205, 5305, 5404, 5503,
+    5602, 5701, 5800, 5899, 5998, 6097, 6195, 6294,
+    6393, 6491, 6590, 6688, 6787, 6885, 6983, 7081,
+    7180, 7278, 7376, 7473, 7571, 7669, 7767, 7864,
+    7962, 8059, 8157, 8254, 8351, 8449, 8546, 8643,
+    8740, 8836, 8933, 9030, 9127, 9223, 9319, 9416,
+    9512, 9608, 9704, 9800, 9896, 9992, 10088, 10183,
+    10279, 10374, 10469, 10565, 10660, 10755, 10850, 10945,
+    11039, 11134, 11228, 11323, 11417, 11511, 11605, 11699,
+    11793, 11887, 11980, 12074, 12167, 12261, 12354, 12447,
+    12540, 12633, 12725, 12818, 12910, 13003, 13095, 13187,
+    13279, 13371, 13463, 13554, 13646, 13737, 13828, 13919,
+    14010, 14101, 14192, 14282, 14373, 14463, 14553, 14643,
+    14733, 14823, 14912, 15002, 15091, 15180, 15269, 15358,
+    15447, 15535, 15624, 15712, 15800, 15888, 15976, 16064,
+    16151, 16239, 16326, 16413, 16500, 16587, 16673, 16760,
+    16846, 16932, 17018, 17104, 17190, 17275, 17361, 17446,
+    17531, 17616, 17700, 17785, 17869, 17953, 18037, 18121,
+    18205, 18288, 18372, 18455, 18538, 18621, 18703, 18786,
+    18868, 18950, 19032, 19114, 19195, 19277, 19358, 19439,
+    19520, 19601, 19681, 19761, 19841, 19921, 20001, 20081,
+    20160, 20239, 20318, 20397, 20475, 20554, 20632, 20710,
+    20788, 20865, 20943, 21020, 21097, 21174, 21251, 21327,
+    21403, 21479, 21555, 21631, 21706, 21781, 21856, 21931,
+    22006, 22080, 22154, 22228, 22302, 22375, 22449, 22522,
+    22595, 22668, 22740, 22812, 22884, 22956, 23028, 23099,
+    23170, 23241, 23312, 23383, 23453, 23523, 23593, 23663,
+    23732, 23801, 23870, 23939, 24008, 24076, 24144, 24212,
+    24279, 24347, 24414, 24481, 24548, 24614, 24680, 24746,
+    24812, 24878, 24943, 25008, 25073, 25138, 25202, 25266,
+    25330, 25394, 25457, 25520, 25583, 25646, 25708, 25771,
+    25833, 25894, 25956, 26017, 26078, 26139, 26199, 26259,
+    26320, 26379, 26439, 26498, 26557, 26616, 26674, 26733,
+    26791, 26848, 26906, 26963, 27020, 27077, 27133, 27190,
+    27246, 27301, 27357, 27412, 27467, 27522, 27576, 27630,
+    27684, 27738, 27791, 27844, 27897, 27950, 28002, 28054,
+    28106, 28158, 28209, 28260, 28311, 28361, 28411, 28461,
+    28511, 28560, 28610, 28658, 28707, 28755, 28803, 28851,
+    28899, 28946, 28993, 29040, 29086, 29132, 29178, 29224,
+    29269, 29314, 29359, 29404, 29448, 29492, 29535, 29579,
+    29622, 29665, 29707, 29750, 29792, 29833, 29875, 29916,
+    29957, 29997, 30038, 30078, 30118, 30157, 30196, 30235,
+    30274, 30312, 30350, 30388, 30425, 30462, 30499, 30536,
+    30572, 30608, 30644, 30680, 30715, 30750, 30784, 30819,
+    30853, 30886, 30920, 30953, 30986, 31018, 31050, 31082,
+    31114, 31146, 31177, 31207, 31238, 31268, 31298, 31328,
+    31357, 31386, 31415, 31443, 31471, 31499, 31527, 31554,
+    31581, 31608, 31634, 31660, 31686, 31711, 31737, 31761,
+    31786, 31810, 31834, 31858, 31881, 31904, 31927, 31950,
+    31972, 31994, 32015, 32037, 32058, 32078, 32099, 32119,
+    32138, 32158, 32177, 32196, 32214, 32233, 32251, 32268,
+    32286, 32303, 32319, 32336, 32352, 32368, 32383, 32398,
+    32413, 32428, 32442, 32456, 32470, 32483, 32496, 32509,
+    32522, 32534, 32546, 32557, 32568, 32579, 32590, 32600,
+    32610, 32620, 32629, 32638, 32647, 32656, 32664, 32672,
+    32679, 32686, 32693, 32700, 32706, 32712, 32718, 32723,
+    32729, 32733, 32738, 32742, 32746, 32749, 32753, 32756,
+    32758, 32760, 32762, 32764, 32766, 32767, 32767, 32767,
+    32767
+};
+
+/** 10-bit bit reversal; shift right for smaller sizes */
+static const uint16_t fftRevTable[1U << FFT_REV_BITS] =
+{
+    0, 512, 256, 768, 128, 640, 384, 896, 64, 576, 320, 832, 192, 704, 448, 960,
+    32, 544, 288, 800, 160, 672, 416, 928, 96, 608, 352, 864, 224, 736, 480, 992,
+    16, 528, 272, 784, 144, 656, 400, 912, 80, 592, 336, 848, 208, 720, 464, 976,
+    48, 560, 304, 816, 176, 688, 432, 944, 112, 624, 368, 880, 240, 752, 496, 1008,
+    8, 520, 264, 776, 136, 648, 392, 904, 72, 584, 328, 840, 200, 712, 456, 968,
+    40, 552, 296, 808, 168, 680, 424, 936, 104, 616, 360, 872, 232, 744, 488, 1000,
+    24, 536, 280, 792, 152, 664, 408, 920, 88, 600, 344, 856, 216, 728, 472, 984,
+    56, 568, 312, 824, 184, 696, 440, 952, 120, 632, 376, 888, 248, 760, 504, 1016,
+    4, 516, 260, 772, 132, 644, 388, 900, 68, 580, 324, 836, 196, 708, 452, 964,
+    36, 548, 292, 804, 164, 676, 420, 932, 100, 612, 356, 868, 228, 740, 484, 996,
+    20, 532, 276, 788, 148, 660, 404, 916, 84, 596, 340, 852, 212, 724, 468, 980,
+    52, 564, 308, 820, 180, 692, 436, 948, 116, 628, 372, 884, 244, 756, 500, 1012,
+    12, 524, 268, 780, 140, 652, 396, 908, 76, 588, 332, 844, 204, 716, 460, 972,
+    44, 556, 300, 812, 172, 684, 428, 940, 108, 620, 364, 876, 236, 748, 492, 1004,
+    28, 540, 284, 796, 156, 668, 412, 924, 92, 604, 348, 860, 220, 732, 476, 988,
+    60, 572, 316, 828, 188, 700, 444, 956, 124, 636, 380, 892, 252, 764, 508, 1020,
+    2, 514, 258, 770, 130, 642, 386, 898, 66, 578, 322, 834, 194, 706, 450, 962,
+    34, 546, 290, 802, 162, 674, 418, 930, 98, 610, 354, 866, 226, 738, 482, 994,
+    18, 530, 274, 786, 146, 658, 402, 914, 82, 594, 338, 850, 210, 722, 466, 978,
+    50, 562, 306, 818, 178, 690, 434, 946, 114, 626, 370, 882, 242, 754, 498, 1010,
+    10, 522, 266, 778, 138, 650, 394, 906, 74, 586, 330, 842, 202, 714, 458, 970,
+    42, 554, 298, 810, 170, 682, 426, 938, 106, 618, 362, 874, 234, 746, 490, 1002,
+    26, 538, 282, 794, 154, 666, 410, 922, 90, 602, 346, 858, 218, 730, 474, 986,
+    58, 570, 314, 826, 186, 698, 442, 954, 122, 634, 378, 890, 250, 762, 506, 1018,
+    6, 518, 262, 774, 134, 646, 390, 902, 70, 582, 326, 838, 198, 710, 454, 966,
+    38, 550, 294, 806, 166, 678, 422, 934, 102, 614, 358, 870, 230, 742, 486, 998,
+    22, 534, 278, 790, 150, 662, 406, 918, 86, 598, 342, 854, 214, 726, 470, 982,
+    54, 566, 310, 822, 182, 694, 438, 950, 118, 630, 374, 886, 246, 758, 502, 1014,
+    14, 526, 270, 782, 142, 654, 398, 910, 78, 590, 334, 846, 206, 718, 462, 974,
+    46, 558, 302, 814, 174, 686, 430, 942, 110, 622, 366, 878, 238, 750, 494, 1006,
+    30, 542, 286, 798, 158, 670, 414, 926, 94, 606, 350, 862, 222, 734, 478, 990,
+    62, 574, 318, 830, 190, 702, 446, 958, 126, 638, 382, 894, 254, 766, 510, 1022,
+    1, 513, 257, 769, 129, 641, 385, 897, 65, 577, 321, 833, 193, 705, 449, 961,
+    33, 545, 289, 801, 161, 673, 417, 929, 97, 609, 353, 865, 225, 737, 481, 993,
+    17, 529, 273, 785, 145, 657, 401, 913, 81, 593, 337, 849, 209, 721, 465, 977,
+    49, 561, 305, 817, 177, 689, 433, 945, 113, 625, 369, 881, 241, 753, 497, 1009,
+    9, 521, 265, 777, 137, 649, 393, 905, 73, 585, 329, 841, 201, 713, 457, 969,
+    41, 553, 297, 809, 169, 681, 425, 937, 105, 617, 361, 873, 233, 745, 489, 1001,
+    25, 537, 281, 793, 153, 665, 409, 921, 89, 601, 345, 857, 217, 729, 473, 985,
+    57, 569, 313, 825, 185, 697, 441, 953, 121, 633, 377, 889, 249, 761, 505, 1017,
+    5, 517, 261, 773, 133, 645, 389, 901, 69, 581, 325, 837, 197, 709, 453, 965,
+    37, 549, 293, 805, 165, 677, 421, 933, 101, 613, 357, 869, 229, 741, 485, 997,
+    21, 533, 277, 789, 149, 661, 405, 917, 85, 597, 341, 853, 213, 725, 469, 981,
+    53, 565, 309, 821, 181, 693, 437, 949, 117, 629, 373, 885, 245, 757, 501, 1013,
+    13, 525, 269, 781, 141, 653, 397, 909, 77, 589, 333, 845, 205, 717, 461, 973,
+    45, 557, 301, 813, 173, 685, 429, 941, 109, 621, 365, 877, 237, 749, 493, 1005,
+    29, 541, 285, 797, 157, 669, 413, 925, 93, 605, 349, 861, 221, 733, 477, 989,
+    61, 573, 317, 829, 189, 701, 445, 957, 125, 637, 381, 893, 253, 765, 509, 1021,
+    3, 515, 259, 771, 131, 643, 387, 899, 67, 579, 323, 835, 195, 707, 451, 963,
+    35, 547, 291, 803, 163, 675, 419, 931, 99, 611, 355, 867, 227, 739, 483, 995,
+    19, 531, 275, 787, 147, 659, 403, 915, 83, 595, 339, 851, 211, 723, 467, 979,
+    51, 563, 307, 819, 179, 691, 435, 947, 115, 627, 371, 883, 243, 755, 499, 1011,
+    11, 523, 267, 779, 139, 651, 395, 907, 75, 587, 331, 843, 203, 715, 459, 971,
+    43, 555, 299, 811, 171, 683, 427, 939, 107, 619, 363, 875, 235, 747, 491, 1003,
+    27, 539, 283, 795, 155, 667, 411, 923, 91, 603, 347, 859, 219, 731, 475, 987,
+    59, 571, 315, 827, 187, 699, 443, 955, 123, 635, 379, 891, 251, 763, 507, 1019,
+    7, 519, 263, 775, 135, 647, 391, 903, 71, 583, 327, 839, 199, 711, 455, 967,
+    39, 551, 295, 807, 167, 679, 423, 935, 103, 615, 359, 871, 231, 743, 487, 999,
+    23, 535, 279, 791, 151, 663, 407, 919, 87, 599, 343, 855, 215, 727, 471, 983,
+    55, 567, 311, 823, 183, 695, 439, 951, 119, 631, 375, 887, 247, 759, 503, 1015,
+    15, 527, 271, 783, 143, 655, 399, 911, 79, 591, 335, 847, 207, 719, 463, 975,
+    47, 559, 303, 815, 175, 687, 431, 943, 111, 623, 367, 879, 239, 751, 495, 1007,
+    31, 543, 287, 799, 159, 671, 415, 927, 95, 607, 351, 863, 223, 735, 479, 991,
+    63, 575, 319, 831, 191, 703, 447, 959, 127, 639, 383, 895, 255, 767, 511, 1023
+};
+
+/**
+ * @brief Cosine and sine of an angle
+ *
+ * @param[in] k Angle in 1/2048 turn (0-2047)
+ * @param[out] c cos in Q15
+ * @param[out] s sin in Q15
+ *
+ * @return void
+ */
+static void fftSinCos(uint32_t k, int32_t *c, int32_t *s)
+{
+    uint32_t r = k & ((FFT_TURN / 4U) - 1U);
+    int32_t a = fftSinTable[r];
+    int32_t b = fftSinTable[(FFT_TURN / 4U) - r];
+
+    switch((k >> 9) & 3U)
+    {
+        case 0:
+            *s = a;
+            *c = b;
+            break;
+
+        case 1:
+            *s = b;
+            *c = -a;
+            break;
+
+        case 2:
+            *s = -a;
+            *c = -b;
+            break;
+
+        default:
+            *s = -b;
+            *c = a;
+            break;
+    }
+}
+
+/**
+ * @brief log2 of a supported transform size
+ *
+ * @param[in] n Transform size
+ *
+ * @return log2(n), 0 if n is not supported
+ */
+static uint32_t fftLog2(uint32_t n)
+{
+    uint32_t bits = 0;
+
+    if((n < FFT_MIN_SIZE) || (n > FFT_MAX_SIZE) || (n & (n - 1U)))
+    {
+        return 0;
+    }
+
+    while((1U << bits) < n)
+    {
+        bits++;
+    }
+
+    return bits;
+}
+
+/**
+ * @brief Saturate to Q15
+ *
+ * @param[in] x Value
+ *
+ * @return x clipped to [-32768, 32767]
+ */
+static int16_t fftSat(int32_t x)
+{
+    if(x > 32767)
+    {
+        return 32767;
+    }
+    if(x < -32768)
+    {
+        return -32768;
+    }
+    return (int16_t)x;
+}
+
+/**
+ * @brief Store t * W, W = cos - i sin (Q15)
+ *
+ * @param[out] d Destination (re, im)
+ * @param[in] tr Real part
+ * @param[in] ti Imaginary part
+ * @param[in] c cos
+ * @param[in] s sin
+ *
+ * @return void
+ */
+static void fftStoreRot(int16_t *d, int32_t tr, int32_t ti, int32_t c, int32_t s)
+{
+    d[0] = fftSat(((tr * c) + (ti * s)) >> 15);
+    d[1] = fftSat(((ti * c) - (tr * s)) >> 15);
+}
+
+/**
+ * @brief Swap complex points into natural order
+ *
+ * @param[in,out] d m complex points
+ * @param[in] m Number of points
+ * @param[in] log2m log2(m)
+ *
+ * @return void
+ */
+static void fftBitReverseQ15(int16_t *d, uint32_t m, uint32_t log2m)
+{
+    uint32_t shift = FFT_REV_BITS - log2m;
+    uint32_t j;
+    int16_t t;
+
+    for(uint32_t i = 1; i < m; i++)
+    {
+        j = fftRevTable[i] >> shift;
+
+        if(i < j)
+        {
+            t = d[2U * i];
+            d[2U * i] = d[2U * j];
+            d[2U * j] = t;
+            t = d[(2U * i) + 1U];
+            d[(2U * i) + 1U] = d[(2U * j) + 1U];
+            d[(2U * j) + 1U] = t;
+        }
+    }
+}
+
+/**
+ * @brief Complex FFT in place, scaled by 1/m
+ *
+ * @param[in,out] d m complex points (re, im interleaved)
+ * @param[in] m Number of points
+ * @param[in] log2m log2(m)
+ *
+ * @return void
+ */
+static void fftComplexQ15(int16_t *d, uint32_t m, uint32_t log2m)
+{
+    uint32_t span = m;
+    uint32_t q;
+    uint32_t step;
+    int32_t c1, s1, c2, s2, c3, s3;
+    int32_t ar, ai, br, bi, cr, ci, dr, di;
+    int32_t s0r, s0i, d0r, d0i, s1r, s1i, d1r, d1i;
+    int16_t *p;
+
+    /*Odd number of radix-2 steps: one radix-2 stage first*/
+    if(log2m & 1U)
+    {
+        q = m / 2U;
+        step = FFT_TURN / m;
+
+        for(uint32_t j = 0; j < q; j++)
+        {
+            fftSinCos(j * step, &c1, &s1);
+            p = &d[2U * j];
+
+            ar = p[0];
+            ai = p[1];
+            br = p[2U * q];
+            bi = p[(2U * q) + 1U];
+
+            p[0] = (int16_t)((ar + br) >> 1);
+            p[1] = (int16_t)((ai + bi) >> 1);
+            fftStoreRot(&p[2U * q], (ar - br) >> 1, (ai - bi) >> 1, c1, s1);
+        }
+
+        span = q;
+    }
+
+    /*Radix-4 (radix-2^2) stages: same output order as two radix-2 stages*/
+    while(span >= 4U)
+    {
+        q = span / 4U;
+        step = FFT_TURN / span;
+
+        for(uint32_t j = 0; j < q; j++)
+        {
+            fftSinCos(j * step, &c1, &s1);
+            fftSinCos(2U * j * step, &c2, &s2);
+            fftSinCos(3U * j * step, &c3, &s3);
+
+            for(uint32_t g = j; g < m; g += span)
+            {
+                p = &d[2U * g];
+
+                ar = p[0];
+                ai = p[1];
+                br = p[2U * q];
+                bi = p[(2U * q) + 1U];
+                cr = p[4U * q];
+                ci = p[(4U * q) + 1U];
+                dr = p[6U * q];
+                di = p[(6U * q) + 1U];
+
+                s0r = ar + cr;
+                s0i = ai + ci;
+                d0r = ar - cr;
+                d0i = ai - ci;
+                s1r = br + dr;
+                s1i = bi + di;
+                d1r = br - dr;
+                d1i = bi - di;
+
+                p[0] = (int16_t)((s0r + s1r) >> 2);
+                p[1] = (int16_t)((s0i + s1i) >> 2);
+                fftStoreRot(&p[2U * q], (s0r - s1r) >> 2, (s0i - s1i) >> 2, c2, s2);
+                /*(a - c) - i(b - d)*/
+                fftStoreRot(&p[4U * q], (d0r + d1i) >> 2, (d0i - d1r) >> 2, c1, s1);
+                /*(a - c) + i(b - d)*/
+                fftStoreRot(&p[6U * q], (d0r - d1i) >> 2, (d0i + d1r) >> 2, c3, s3);
+            }
+        }
+
+        span = q;
+    }
+
+    fftBitReverseQ15(d, m, log2m);
+}
+
+/**
+ * @brief Window 12-bit ADC results and convert them to FFT input
+ *
+ * The window is computed from the sine table, no per-size table is
+ * needed. Safe in place for any stride.
+ *
+ * @return void
+ */
+void fftPrepareQ15(const uint16_t *src, uint32_t stride, int16_t *dst, uint32_t n, fftWindow_t window)
+{
+    uint32_t step = FFT_TURN / n;
+    int32_t x;
+    int32_t c;
+    int32_t s;
+    int32_t w;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        x = ((int32_t)src[i * stride] - 2048) * 8;
+
+        if(window != FFT_WINDOW_RECT)
+        {
+            fftSinCos((i * step) & (FFT_TURN - 1U), &c, &s);
+
+            if(window == FFT_WINDOW_HANN)
+            {
+                /*0.5 - 0.5 cos*/
+                w = (32768 - c) >> 1;
+            }
+            else
+            {
+                /*0.54 - 0.46 cos*/
+                w = 17695 - ((15073 * c) >> 15);
+            }
+
+            x = (x * w) >> 15;
+        }
+
+        dst[i] = (int16_t)x;
+    }
+}
+
+/**
+ * @brief In-place real FFT, Q15
+ *
+ * Split step, for 1 <= k <= n/4 with Z the n/2-point FFT:
+ * E = (Z[k] + conj(Z[n/2-k])) / 2, O = (Z[k] - conj(Z[n/2-k])) / 2,
+ * T = -i W^k O, X[k] = E + T, X[n/2-k] = conj(E - T).
+ *
+ * @return 1 on success, 0 if n is not a supported size
+ */
+uint8_t fftRealQ15(int16_t *buf, uint32_t n)
+{
+    uint32_t log2n = fftLog2(n);
+    uint32_t m = n / 2U;
+    int32_t zr, zi, yr, yi;
+    int32_t er, ei, odr, odi, tr, ti;
+    int32_t c, s;
+
+    if(!log2n)
+    {
+        return 0;
+    }
+
+    fftComplexQ15(buf, m, log2n - 1U);
+
+    /*DC and Nyquist are real, packed into bin 0*/
+    zr = buf[0];
+    zi = buf[1];
+    buf[0] = (int16_t)((zr + zi) >> 1);
+    buf[1] = (int16_t)((zr - zi) >> 1);
+
+    for(uint32_t k = 1; k <= (m / 2U); k++)
+    {
+        zr = buf[2U * k];
+        zi = buf[(2U * k) + 1U];
+        yr = buf[2U * (m - k)];
+        yi = -(int32_t)buf[(2U * (m - k)) + 1U];
+
+        er = (zr + yr) >> 1;
+        ei = (zi + yi) >> 1;
+        odr = (zr - yr) >> 1;
+        odi = (zi - yi) >> 1;
+
+        /*W^k O with W = exp(-2 pi i k / n)*/
+        fftSinCos(k * (FFT_TURN / n), &c, &s);
+        tr = ((odr * c) + (odi * s)) >> 15;
+        ti = ((odi * c) - (odr * s)) >> 15;
+
+        /*Multiply by -i: (tr, ti) -> (ti, -tr), then halve*/
+        buf[2U * (m - k)] = fftSat((er - ti) >> 1);
+        buf[(2U * (m - k)) + 1U] = fftSat(-(ei + tr) >> 1);
+        buf[2U * k] = fftSat((er + ti) >> 1);
+        buf[(2U * k) + 1U] = fftSat((ei - tr) >> 1);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Integer square root
+ *
+ * @param[in] x Value
+ *
+ * @return floor(sqrt(x))
+ */
+static uint32_t fftSqrt(uint32_t x)
+{
+    uint32_t r = 0;
+    uint32_t bit = 1UL << 30;
+
+    while(bit > x)
+    {
+        bit >>= 2;
+    }
+
+    while(bit)
+    {
+        if(x >= (r + bit))
+        {
+            x -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return r;
+}
+
+/**
+ * @brief Magnitudes of the packed spectrum
+ *
+ * Safe in place: mag[k] is written after spec[2k], spec[2k + 1] are read.
+ *
+ * @return void
+ */
+void fftMagnitudeQ15(const int16_t *spec, uint16_t *mag, uint32_t n)
+{
+    int32_t re;
+    int32_t im;
+    int32_t dc = spec[0];
+
+    mag[0] = (uint16_t)((dc < 0) ? -dc : dc);
+
+    for(uint32_t k = 1; k < (n / 2U); k++)
+    {
+        re = spec[2U * k];
+        im = spec[(2U * k) + 1U];
+        mag[k] = (uint16_t)fftSqrt((uint32_t)((re * re) + (im * im)));
+    }
+}
+
+/**
+ * @brief Find the largest local maxima of a magnitude spectrum
+ *
+ * @return Number of peaks found
+ */
+uint32_t fftFindPeaks(const uint16_t *mag, uint32_t bins, fftPeak_t *peaks, uint32_t maxPeaks, uint16_t threshold)
+{
+    uint32_t count = 0;
+    uint32_t pos;
+    int32_t l, c, r;
+    int32_t den;
+    int32_t delta;
+
+    for(uint32_t k = 1; (k + 1U) < bins; k++)
+    {
+        c = mag[k];
+        l = mag[k - 1U];
+        r = mag[k + 1U];
+
+        if((c < threshold) || (c <= l) || (c < r))
+        {
+            continue;
+        }
+
+        /*Insertion point, largest first*/
+        pos = count;
+        while((pos > 0U) && (peaks[pos - 1U].mag < c))
+        {
+            pos--;
+        }
+        if(pos >= maxPeaks)
+        {
+            continue;
+        }
+        if(count < maxPeaks)
+        {
+            count++;
+        }
+        for(uint32_t i = count - 1U; i > pos; i--)
+        {
+            peaks[i] = peaks[i - 1U];
+        }
+
+        /*Vertex of the parabola through the three bins, +-0.5 bin*/
+        den = (2 * c) - l - r;
+        delta = den ? ((r - l) * 128) / den : 0;
+        if(delta > 128)
+        {
+            delta = 128;
+        }
+        if(delta < -128)
+        {
+            delta = -128;
+        }
+
+        peaks[pos].bin = (uint16_t)k;
+        peaks[pos].mag = (uint16_t)c;
+        peaks[pos].binQ8 = (uint32_t)((int32_t)(k * 256U) + delta);
+    }
+
+    return count;
+}
+
+#ifdef FFT_ENABLE_F32
+
+#if defined(__arm__) && !defined(__ARM_FP)
+#error "FFT_ENABLE_F32 needs the FPU (-mfpu=fpv4-sp-d16 -mfloat-abi=hard)"
+#endif
+
+/**
+ * @brief Cosine and sine of an angle, float
+ *
+ * @param[in] k Angle in 1/2048 turn (0-2047)
+ * @param[out] c cos
+ * @param[out] s sin
+ *
+ * @return void
+ */
+static void fftSinCosF32(uint32_t k, float *c, float *s)
+{
+    int32_t ci;
+    int32_t si;
+
+    fftSinCos(k, &ci, &si);
+
+    *c = (float)ci * (1.0f / 32768.0f);
+    *s = (float)si * (1.0f / 32768.0f);
+}
+
+/**
+ * @brief Complex FFT in place, float, no scaling
+ *
+ * Same stage structure as fftComplexQ15().
+ *
+ * @return void
+ */
+static void fftComplexF32(float *d, uint32_t m, uint32_t log2m)
+{
+    uint32_t span = m;
+    uint32_t q;
+    uint32_t step;
+    uint32_t j2;
+    float c1, s1, c2, s2, c3, s3;
+    float ar, ai, br, bi, cr, ci, dr, di;
+    float s0r, s0i, d0r, d0i, s1r, s1i, d1r, d1i;
+    float tr, ti;
+    float t;
+    float *p;
+
+    if(log2m & 1U)
+    {
+        q = m / 2U;
+        step = FFT_TURN / m;
+
+        for(uint32_t j = 0; j < q; j++)
+        {
+            fftSinCosF32(j * step, &c1, &s1);
+            p = &d[2U * j];
+
+            ar = p[0];
+            ai = p[1];
+            br = p[2U * q];
+            bi = p[(2U * q) + 1U];
+
+            p[0] = ar + br;
+            p[1] = ai + bi;
+            tr = ar - br;
+            ti = ai - bi;
+            p[2U * q] = (tr * c1) + (ti * s1);
+            p[(2U * q) + 1U] = (ti * c1) - (tr * s1);
+        }
+
+        span = q;
+    }
+
+    while(span >= 4U)
+    {
+        q = span / 4U;
+        step = FFT_TURN / span;
+
+        for(uint32_t j = 0; j < q; j++)
+        {
+            fftSinCosF32(j * step, &c1, &s1);
+            fftSinCosF32(2U * j * step, &c2, &s2);
+            fftSinCosF32(3U * j * step, &c3, &s3);
+
+            for(uint32_t g = j; g < m; g += span)
+            {
+                p = &d[2U * g];
+
+                ar = p[0];
+                ai = p[1];
+                br = p[2U * q];
+                bi = p[(2U * q) + 1U];
+                cr = p[4U * q];
+                ci = p[(4U * q) + 1U];
+                dr = p[6U * q];
+                di = p[(6U * q) + 1U];
+
+                s0r = ar + cr;
+                s0i = ai + ci;
+                d0r = ar - cr;
+                d0i = ai - ci;
+                s1r = br + dr;
+                s1i = bi + di;
+                d1r = br - dr;
+                d1i = bi - di;
+
+                p[0] = s0r + s1r;
+                p[1] = s0i + s1i;
+
+                tr = s0r - s1r;
+                ti = s0i - s1i;
+                p[2U * q] = (tr * c2) + (ti * s2);
+                p[(2U * q) + 1U] = (ti * c2) - (tr * s2);
+
+                tr = d0r + d1i;
+                ti = d0i - d1r;
+                p[4U * q] = (tr * c1) + (ti * s1);
+                p[(4U * q) + 1U] = (ti * c1) - (tr * s1);
+
+                tr = d0r - d1i;
+                ti = d0i + d1r;
+                p[6U * q] = (tr * c3) + (ti * s3);
+                p[(6U * q) + 1U] = (ti * c3) - (tr * s3);
+            }
+        }
+
+        span = q;
+    }
+
+    for(uint32_t i = 1; i < m; i++)
+    {
+        j2 = fftRevTable[i] >> (FFT_REV_BITS - log2m);
+
+        if(i < j2)
+        {
+            t = d[2U * i];
+            d[2U * i] = d[2U * j2];
+            d[2U * j2] = t;
+            t = d[(2U * i) + 1U];
+            d[(2U * i) + 1U] = d[(2U * j2) + 1U];
+            d[(2U * j2) + 1U] = t;
+        }
+    }
+}
+
+/**
+ * @brief In-place real FFT, float32
+ *
+ * @return 1 on success, 0 if n is not a supported size
+ */
+uint8_t fftRealF32(float *buf, uint32_t n)
+{
+    uint32_t log2n = fftLog2(n);
+    uint32_t m = n / 2U;
+    float zr, zi, yr, yi;
+    float er, ei, odr, odi, tr, ti;
+    float c, s;
+
+    if(!log2n)
+    {
+        return 0;
+    }
+
+    fftComplexF32(buf, m, log2n - 1U);
+
+    zr = buf[0];
+    zi = buf[1];
+    buf[0] = zr + zi;
+    buf[1] = zr - zi;
+
+    for(uint32_t k = 1; k <= (m / 2U); k++)
+    {
+        zr = buf[2U * k];
+        zi = buf[(2U * k) + 1U];
+        yr = buf[2U * (m - k)];
+        yi = -buf[(2U * (m - k)) + 1U];
+
+        er = 0.5f * (zr + yr);
+        ei = 0.5f * (zi + yi);
+        odr = 0.5f * (zr - yr);
+        odi = 0.5f * (zi - yi);
+
+        fftSinCosF32(k * (FFT_TURN / n), &c, &s);
+        tr = (odr * c) + (odi * s);
+        ti = (odi * c) - (odr * s);
+
+        buf[2U * (m - k)] = er - ti;
+        buf[(2U * (m - k)) + 1U] = -(ei + tr);
+        buf[2U * k] = er + ti;
+        buf[(2U * k) + 1U] = ei - tr;
+    }
+
+    return 1;
+}
+
+#endif
@@ -5,11 +5,59 @@
  * Implementation of I2C1 peripheral driver providing byte and burst
  * read/write operations for I2C slave devices.
  * 
+ * The master sequence is a state machine advanced by the event
+ * interrupt (SB, ADDR, TXE, RXNE, BTF). Reads follow the reference
+ * manual procedures for 1, 2 and 3+ bytes so that NACK and STOP are
+ * placed on the right byte. Errors (AF, ARLO, BERR, OVR) end the
+ * transfer from the error interrupt.
+ * 
+ * Long sections are handed to DMA1: on writes the header goes out by
+ * interrupt, then the stream feeds DR and the event interrupt is only
+ * re-enabled at DMA TC to catch the final BTF; on reads DMAEN and LAST
+ * are set before ADDR is cleared and the DMA TC interrupt sends STOP.
+ * 
  * @author Bare Metal STM32
  * @date 2026
  */
 
 #include "i2c.h"
+#include "dma.h"
+#include "clock.h"
+#include "timer.h"
+
+/*I2C1 requests: RX on DMA1 Stream0, TX on DMA1 Stream7, channel 1*/
+#define I2C_DMA_RX_STREAM   0U
+#define I2C_DMA_TX_STREAM   7U
+#define I2C_DMA_CHANNEL     1U
+
+/*Bounded wait for the previous STOP to leave the bus (in loop passes)*/
+#define I2C_STOP_SPIN       1000U
+
+/*Half SCL period of the recovery clock (5 us = 100 kHz)*/
+#define I2C_RECOVERY_HALF_US    5U
+#define I2C_RECOVERY_PULSES     9U
+
+#define I2C_IT_ALL          (I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN | I2C_CR2_ITERREN)
+#define I2C_SR1_ERRORS      (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)
+
+/**
+ * @brief Phase of the running transfer
+ */
+typedef enum
+{
+    I2C_PHASE_WRITE = 0,    /**< Address+W, header and tx bytes */
+    I2C_PHASE_READ          /**< Address+R and rx bytes */
+} i2cPhase_t;
+
+static i2cTransfer_t *volatile i2cCurrent;
+static i2cPhase_t i2cPhase;
+static uint16_t i2cTxIndex;
+static uint16_t i2cRxIndex;
+static uint8_t i2cDmaActive;
+static i2cTransfer_t i2cAsyncXfer;
+static uint32_t i2cSpeedHz = I2C1_SPEED;
+static i2cIrqHook_t i2cSlaveEvHook;
+static i2cIrqHook_t i2cSlaveErHook;
 
 /**
  * @brief Initialize I2C1 peripheral.
@@ -20,15 +68,13 @@
  * 3. Set pins to open-drain output with pull-up resistors
  * 4. Enable I2C1 peripheral clock
  * 5. Reset I2C1 module
- * 6. Configure I2C clock frequency to 100 kHz
- * 7. Set rise time for standard mode
- * 8. Enable I2C1 peripheral
+ * 6. Configure I2C clock frequency and rise time from PCLK1
+ * 7. Enable I2C1 peripheral
+ * 8. Enable the I2C1 event and error interrupts in the NVIC
  * 
  * @details
  * - GPIO Configuration: PB8 (SCL) and PB9 (SDA)
- * - I2C Clock: 100 kHz (standard mode)
- * - CCR value: 80 (calculated from FPCLK1=16MHz, FSCL=100kHz)
- * - Rise time: 17 (for standard mode)
+ * - I2C Clock: I2C1_SPEED (e.g. CCR = 80, TRISE = 17 for 100 kHz at 16 MHz)
  * - Output type: Open-drain with pull-ups (required for I2C)
  * 
  * @return void
@@ -60,12 +106,12 @@ void i2c1Init(void)
     /*Set PB8 and PB9 alternate function type to I2C (AF4)*/
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL8_0);
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL8_1);
-    GPIOB->AFR[1] |= ~(GPIO_AFRH_AFSEL8_2);
+    GPIOB->AFR[1] |= (GPIO_AFRH_AFSEL8_2);
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL8_3);
 
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL9_0);
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL9_1);
-    GPIOB->AFR[1] |= ~(GPIO_AFRH_AFSEL9_2);
+    GPIOB->AFR[1] |= (GPIO_AFRH_AFSEL9_2);
     GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL9_3);
 
     /*Enable clock access to I2C*/
@@ -77,222 +123,717 @@ void i2c1Init(void)
     /*Come out of reset mode*/
     I2C1->CR1 &= ~(I2C_CR1_SWRST);
 
-    /*Set Peripheral clock frequency*/
-    I2C1->CR2 |= (1U<<4); //16MHz
+    /*Time base for deadlines and bus recovery*/
+    tim5TimebaseInit();
+
+    /*Set clock, rise time and enable I2C1 module*/
+    i2cCurrent = 0;
+    i2c1SetSpeed(I2C1_SPEED);
+
+    /*Event and error interrupts are enabled per transfer*/
+    NVIC_EnableIRQ(I2C1_EV_IRQn);
+    NVIC_EnableIRQ(I2C1_ER_IRQn);
+    NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+    NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+}
+
+
+/**
+ * @brief Integer division rounded up
+ * 
+ * @param[in] num Dividend
+ * @param[in] den Divisor (not zero)
+ * 
+ * @return ceil(num / den)
+ */
+static uint32_t i2cDivCeil(uint32_t num, uint32_t den)
+{
+    return (num + den - 1U) / den;
+}
+
+/**
+ * @brief Largest of a value and a lower bound
+ * 
+ * @param[in] value Value
+ * @param[in] min Lower bound
+ * 
+ * @return value or min
+ */
+static uint32_t i2cAtLeast(uint32_t value, uint32_t min)
+{
+    return (value < min) ? min : value;
+}
+
+/**
+ * @brief Compute the clock registers for a bus speed
+ * 
+ * @details
+ * - Sm: Thigh = Tlow = CCR * Tpclk1, SCL = PCLK1 / (2 * CCR),
+ *   CCR >= 4, Tlow >= 4.7 us, TRISE = 1000 ns * PCLK1 + 1
+ * - Fm DUTY=0: Tlow = 2 * Thigh, SCL = PCLK1 / (3 * CCR)
+ * - Fm DUTY=1: Tlow = 16/9 * Thigh, SCL = PCLK1 / (25 * CCR)
+ * - Fm: Tlow >= 1.3 us, Thigh >= 0.6 us, TRISE = 300 ns * PCLK1 + 1
+ * 
+ * @return 1 on success, 0 if PCLK1 does not allow the requested mode
+ */
+uint8_t i2cComputeTiming(uint32_t pclk1, uint32_t sclHz, i2cTiming_t *timing)
+{
+    uint32_t freq = pclk1 / 1000000U;
+    uint32_t ccr;
+    uint32_t ccr16;
+    uint32_t scl16;
+
+    if((freq < 2U) || (freq > 50U) || (sclHz == 0U))
+    {
+        return 0;
+    }
+
+    /*No Fm+ on this peripheral*/
+    if(sclHz > I2C_SPEED_FAST)
+    {
+        sclHz = I2C_SPEED_FAST;
+    }
+
+    timing->freq = (uint16_t)freq;
+
+    if(sclHz <= I2C_SPEED_STANDARD)
+    {
+        ccr = i2cDivCeil(pclk1, 2U * sclHz);
+        ccr = i2cAtLeast(ccr, i2cDivCeil(47U * freq, 10U));
+        ccr = i2cAtLeast(ccr, 4U);
+
+        if(ccr > I2C_CCR_CCR)
+        {
+            return 0;
+        }
+
+        timing->ccr = (uint16_t)ccr;
+        timing->trise = (uint16_t)(freq + 1U);
+        timing->sclHz = pclk1 / (2U * ccr);
+
+        return 1;
+    }
+
+    /*Fast mode needs PCLK1 >= 4 MHz*/
+    if(freq < 4U)
+    {
+        return 0;
+    }
+
+    /*Duty 2:1*/
+    ccr = i2cDivCeil(pclk1, 3U * sclHz);
+    ccr = i2cAtLeast(ccr, i2cDivCeil(13U * freq, 20U));
+    ccr = i2cAtLeast(ccr, i2cDivCeil(6U * freq, 10U));
+    ccr = i2cAtLeast(ccr, 1U);
+
+    /*Duty 16:9*/
+    ccr16 = i2cDivCeil(pclk1, 25U * sclHz);
+    ccr16 = i2cAtLeast(ccr16, i2cDivCeil(13U * freq, 160U));
+    ccr16 = i2cAtLeast(ccr16, i2cDivCeil(6U * freq, 90U));
+    ccr16 = i2cAtLeast(ccr16, 1U);
+    scl16 = pclk1 / (25U * ccr16);
+
+    if(scl16 > (pclk1 / (3U * ccr)))
+    {
+        timing->ccr = (uint16_t)(I2C_CCR_FS | I2C_CCR_DUTY | ccr16);
+        timing->sclHz = scl16;
+    }
+    else
+    {
+        timing->ccr = (uint16_t)(I2C_CCR_FS | ccr);
+        timing->sclHz = pclk1 / (3U * ccr);
+    }
+
+    timing->trise = (uint16_t)(((freq * 3U) / 10U) + 1U);
 
-    /*Set I2C to standard mode, 100kHz clock*/
-    I2C1->CCR |= (1U<<12); // CCR=(FPCLK1)/​​(2×FSCL) = (16000000)/(2×100000)​ ​= 80​
+    return 1;
+}
 
-    /*Set rise time*/
-    I2C1->TRISE = 17; //T(RISE)=F(PCLK1)​×t(rise)​+1 = 16MHzx(1000ns)+1=17​
+/**
+ * @brief Change the I2C1 bus speed
+ * 
+ * @return Achieved SCL frequency in Hz, 0 if not possible or busy
+ */
+uint32_t i2c1SetSpeed(uint32_t sclHz)
+{
+    i2cTiming_t timing;
+
+    if(i2cCurrent || !i2cComputeTiming(clockGetPclk1(), sclHz, &timing))
+    {
+        return 0;
+    }
+
+    /*CCR and TRISE can only be written with the peripheral disabled*/
+    I2C1->CR1 &= ~I2C_CR1_PE;
+
+    I2C1->CR2 = (I2C1->CR2 & ~I2C_CR2_FREQ) | timing.freq;
+    I2C1->CCR = timing.ccr;
+    I2C1->TRISE = timing.trise;
 
-    /*Enable I2C1 module*/
     I2C1->CR1 |= I2C_CR1_PE;
+
+    i2cSpeedHz = sclHz;
+
+    return timing.sclHz;
 }
 
+/**
+ * @brief Finish the running transfer
+ * 
+ * Disables the transfer interrupts, releases the engine and calls the
+ * completion callback, which may submit the next transfer.
+ * 
+ * @param[in] status Final status
+ * 
+ * @return void
+ */
+static void i2cFinish(i2cStatus_t status)
+{
+    i2cTransfer_t *xfer = i2cCurrent;
+
+    /*Stop a DMA section cut short by an error*/
+    if(i2cDmaActive)
+    {
+        dmaStreamStop(DMA1, I2C_DMA_RX_STREAM);
+        dmaStreamStop(DMA1, I2C_DMA_TX_STREAM);
+        i2cDmaActive = 0;
+    }
+
+    I2C1->CR2 &= ~(I2C_IT_ALL | I2C_CR2_DMAEN | I2C_CR2_LAST);
+    I2C1->CR1 &= ~(I2C_CR1_POS | I2C_CR1_ACK);
+
+    i2cCurrent = 0;
+    xfer->status = status;
+
+    if(xfer->callback)
+    {
+        xfer->callback(xfer);
+    }
+}
 
 /**
- * @brief Read a single byte from I2C slave device.
+ * @brief Number of bytes sent in the write phase (header + tx)
  * 
- * Performs a write-restart-read I2C transaction to read one byte from
- * a specific memory address on the slave device. The sequence:
- * 1. Waits for I2C bus to be free
- * 2. Sends START condition and slave address with write bit
- * 3. Sends memory address
- * 4. Sends RESTART condition
- * 5. Sends slave address with read bit
- * 6. Disables ACK to indicate last byte
- * 7. Receives byte and sends STOP condition
+ * @param[in] xfer Transfer
  * 
- * @param[in] saddr 7-bit slave device address (will be shifted left by 1 for R/W bit)
- * @param[in] msddr Memory address to read from (1 byte address)
- * @param[out] data Pointer to uint8_t variable to store received byte
+ * @return Byte count
+ */
+static uint16_t i2cWriteLength(const i2cTransfer_t *xfer)
+{
+    return (uint16_t)(xfer->headerLen + xfer->txLen);
+}
+
+/**
+ * @brief Next byte of the write phase
+ * 
+ * @param[in] xfer Transfer
+ * 
+ * @return Header byte first, then tx buffer bytes
+ */
+static uint8_t i2cNextTxByte(const i2cTransfer_t *xfer)
+{
+    uint16_t i = i2cTxIndex++;
+
+    if(i < xfer->headerLen)
+    {
+        return xfer->header[i];
+    }
+
+    return xfer->txBuf[i - xfer->headerLen];
+}
+
+/**
+ * @brief Hand the read section to DMA1 Stream0
+ * 
+ * Called with ADDR still set: DMAEN and LAST must be on before ADDR is
+ * cleared so the peripheral NACKs the last byte by itself.
+ * 
+ * @param[in] xfer Transfer
  * 
  * @return void
+ */
+static void i2cStartRxDma(const i2cTransfer_t *xfer)
+{
+    dmaStreamConfig(DMA1, I2C_DMA_RX_STREAM, I2C_DMA_CHANNEL,
+                    DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE,
+                    &I2C1->DR, xfer->rxBuf, xfer->rxLen);
+    dmaStreamStart(DMA1, I2C_DMA_RX_STREAM);
+    i2cDmaActive = 1;
+
+    /*Only the DMA and error interrupts until the end*/
+    I2C1->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+    I2C1->CR2 |= I2C_CR2_DMAEN | I2C_CR2_LAST;
+}
+
+/**
+ * @brief Hand the tx buffer to DMA1 Stream7 once the header is sent
  * 
- * @note This function is blocking and does not return until byte is received
- * @note Suitable for reading from EEPROM and similar devices with 1-byte addressing
- * @warning Caller must ensure data pointer is valid and points to writable memory
- * @see i2c1BurstRead for reading multiple consecutive bytes
+ * @param[in] xfer Transfer
+ * 
+ * @return void
  */
-void i2c1ByteRead(uint8_t saddr, char msddr, char* data)
+static void i2cStartTxDma(const i2cTransfer_t *xfer)
 {
-    volatile int tmp;
+    dmaStreamConfig(DMA1, I2C_DMA_TX_STREAM, I2C_DMA_CHANNEL,
+                    DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE,
+                    &I2C1->DR, (void *)xfer->txBuf, xfer->txLen);
+    dmaStreamStart(DMA1, I2C_DMA_TX_STREAM);
+    i2cDmaActive = 1;
+
+    /*DMA owns the rest of the write phase*/
+    i2cTxIndex = i2cWriteLength(xfer);
+
+    /*Event interrupt comes back at DMA TC for the final BTF*/
+    I2C1->CR2 &= ~(I2C_CR2_ITEVTEN | I2C_CR2_ITBUFEN);
+    I2C1->CR2 |= I2C_CR2_DMAEN;
+}
 
-    /*Wait until bus not busy*/
-    while(!(I2C1->SR2 & I2C_SR2_BUSY)){}
+/**
+ * @brief Handle ADDR in the read phase
+ * 
+ * Sets ACK/POS/STOP as required by the reference manual for 1, 2 and
+ * 3 or more bytes before ADDR is cleared.
+ * 
+ * @param[in] xfer Transfer
+ * 
+ * @return void
+ */
+static void i2cAddrRead(const i2cTransfer_t *xfer)
+{
+    volatile uint32_t tmp;
 
-    /*Generate start condition*/
-    I2C1->CR1 |= I2C_SR1_SB;
+    if(xfer->rxLen == 1U)
+    {
+        /*NACK the only byte and STOP right after it*/
+        I2C1->CR1 &= ~I2C_CR1_ACK;
+        tmp = I2C1->SR2;
+        I2C1->CR1 |= I2C_CR1_STOP;
+    }
+    else if(xfer->rxLen == 2U)
+    {
+        /*NACK applies to the second byte, wait for both (BTF)*/
+        I2C1->CR1 &= ~I2C_CR1_ACK;
+        I2C1->CR1 |= I2C_CR1_POS;
+        tmp = I2C1->SR2;
+        I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+    }
+    else if(xfer->rxLen >= I2C_DMA_THRESHOLD)
+    {
+        I2C1->CR1 |= I2C_CR1_ACK;
+        i2cStartRxDma(xfer);
+        tmp = I2C1->SR2;
+    }
+    else
+    {
+        I2C1->CR1 |= I2C_CR1_ACK;
+        tmp = I2C1->SR2;
 
-    /*Wait until start flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_SB)){}
+        /*With 3 bytes left the last ones are handled on BTF*/
+        if(xfer->rxLen == 3U)
+        {
+            I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+        }
+    }
+
+    (void)tmp;
+}
 
-    /*Transmit slave address + Write*/
-    I2C1->DR = (saddr << 1); //Write operation
+/**
+ * @brief Handle RXNE/BTF in the read phase
+ * 
+ * @param[in] xfer Transfer
+ * @param[in] sr1 Status register snapshot
+ * 
+ * @return void
+ */
+static void i2cReceive(i2cTransfer_t *xfer, uint32_t sr1)
+{
+    uint16_t left = xfer->rxLen - i2cRxIndex;
 
-    /*Wait until addr flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+    if(left == 1U)
+    {
+        /*Single byte read, STOP already requested*/
+        if(sr1 & I2C_SR1_RXNE)
+        {
+            xfer->rxBuf[i2cRxIndex++] = (uint8_t)I2C1->DR;
+            i2cFinish(I2C_OK);
+        }
+    }
+    else if(left == 2U)
+    {
+        /*Last two bytes in DR and shift register*/
+        if(sr1 & I2C_SR1_BTF)
+        {
+            I2C1->CR1 |= I2C_CR1_STOP;
+            xfer->rxBuf[i2cRxIndex++] = (uint8_t)I2C1->DR;
+            xfer->rxBuf[i2cRxIndex++] = (uint8_t)I2C1->DR;
+            i2cFinish(I2C_OK);
+        }
+    }
+    else if(left == 3U)
+    {
+        /*Byte N-2 in DR, N-1 in the shift register: NACK byte N*/
+        if(sr1 & I2C_SR1_BTF)
+        {
+            I2C1->CR1 &= ~I2C_CR1_ACK;
+            xfer->rxBuf[i2cRxIndex++] = (uint8_t)I2C1->DR;
+        }
+    }
+    else if(sr1 & I2C_SR1_RXNE)
+    {
+        xfer->rxBuf[i2cRxIndex++] = (uint8_t)I2C1->DR;
 
-    /*Clear addr flag*/
-    tmp = I2C1->SR2;
+        if((xfer->rxLen - i2cRxIndex) == 3U)
+        {
+            I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+        }
+    }
+}
 
-    /*Send memory address*/
-    I2C1->DR = msddr;
+/**
+ * @brief Handle TXE/BTF in the write phase
+ * 
+ * @param[in] xfer Transfer
+ * @param[in] sr1 Status register snapshot
+ * 
+ * @return void
+ */
+static void i2cTransmit(i2cTransfer_t *xfer, uint32_t sr1)
+{
+    if(i2cTxIndex < i2cWriteLength(xfer))
+    {
+        if(sr1 & I2C_SR1_TXE)
+        {
+            /*Header sent: long tx buffers go by DMA*/
+            if((i2cTxIndex == xfer->headerLen) && (xfer->txLen >= I2C_DMA_THRESHOLD))
+            {
+                i2cStartTxDma(xfer);
+                return;
+            }
+
+            I2C1->DR = i2cNextTxByte(xfer);
+
+            /*Last byte loaded: only BTF is of interest now*/
+            if(i2cTxIndex == i2cWriteLength(xfer))
+            {
+                I2C1->CR2 &= ~I2C_CR2_ITBUFEN;
+            }
+        }
+    }
+    else if(sr1 & I2C_SR1_BTF)
+    {
+        if(xfer->rxLen)
+        {
+            /*Repeated start for the read phase*/
+            i2cPhase = I2C_PHASE_READ;
+            I2C1->CR2 |= I2C_CR2_ITBUFEN;
+            I2C1->CR1 |= I2C_CR1_START;
+        }
+        else
+        {
+            I2C1->CR1 |= I2C_CR1_STOP;
+            i2cFinish(I2C_OK);
+        }
+    }
+}
 
-    /*Wait until transmit empty*/
-    while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+/**
+ * @brief Start an interrupt-driven transfer
+ * 
+ * @return 1 if the transfer was started, 0 if another one is running
+ */
+uint8_t i2c1Submit(i2cTransfer_t *xfer)
+{
+    uint32_t primask;
+    uint32_t spin;
 
-    /*Generate restart*/
-    I2C1->CR1 |= I2C_CR1_START;
+    /*Claim the engine atomically: completion callbacks submit from interrupts*/
+    primask = __get_PRIMASK();
+    __disable_irq();
 
-    /*Wait until start flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_SB)){}
+    if(i2cCurrent)
+    {
+        __set_PRIMASK(primask);
+        return 0;
+    }
 
-    /*Transmit slave address + Read*/
-    I2C1->DR = (saddr << 1) | 1; //Read operation
+    xfer->status = I2C_PENDING;
+    i2cCurrent = xfer;
 
-    /*Wait until addr flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+    __set_PRIMASK(primask);
 
-    /*Disable Acknowledge*/
-    I2C1->CR1 &= ~I2C_CR1_ACK;
+    /*The STOP of the previous transfer clears itself within a few SCL periods*/
+    for(spin = 0; (spin < I2C_STOP_SPIN) && (I2C1->CR1 & I2C_CR1_STOP); spin++){}
 
-    /*Clear addr flag*/
-    tmp = I2C1->SR2;
+    i2cTxIndex = 0;
+    i2cRxIndex = 0;
+    i2cPhase = ((i2cWriteLength(xfer) == 0U) && xfer->rxLen) ? I2C_PHASE_READ : I2C_PHASE_WRITE;
 
-    /*Generate stop after data received*/
-    I2C1->CR1 |= I2C_CR1_STOP;
+    I2C1->CR1 &= ~I2C_CR1_POS;
+    I2C1->SR1 &= ~I2C_SR1_ERRORS;
+    I2C1->CR2 |= I2C_IT_ALL;
 
-    /*Wait until RXNE flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+    /*Generate start condition*/
+    I2C1->CR1 |= I2C_CR1_START;
 
-    /*Read data from DR*/
-    *data++ = I2C1->DR;
+    return 1;
 }
 
+/**
+ * @brief Check whether a transfer is in progress
+ * 
+ * @return 1 if busy, 0 otherwise
+ */
+uint8_t i2c1IsBusy(void)
+{
+    return (i2cCurrent != 0);
+}
 
 /**
- * @brief Read multiple consecutive bytes from I2C slave device in burst mode.
+ * @brief Busy wait using the TIM5 time base
  * 
- * Performs a write-restart-read I2C transaction to read multiple consecutive
- * bytes from a starting memory address. The sequence:
- * 1. Waits for I2C bus to be free
- * 2. Sends START condition and slave address with write bit
- * 3. Sends starting memory address
- * 4. Sends RESTART condition
- * 5. Sends slave address with read bit
- * 6. For each byte received:
- *    - Generates ACK for all bytes except the last
- *    - Generates NACK and STOP for the final byte
+ * @param[in] us Delay in microseconds
  * 
- * @param[in] saddr 7-bit slave device address (will be shifted left by 1 for R/W bit)
- * @param[in] maddr Starting memory address to read from
- * @param[in] n Number of bytes to read (must be > 0)
- * @param[out] data Pointer to buffer to store received bytes (must be at least n bytes)
+ * @return void
+ */
+static void i2cDelayUs(uint32_t us)
+{
+    uint32_t start = timGetMicros();
+
+    while((timGetMicros() - start) < us){}
+}
+
+/**
+ * @brief Reset the peripheral and restore the bus speed
+ * 
+ * SWRST also clears a BUSY flag left set by a stuck bus.
  * 
  * @return void
+ */
+static void i2cReset(void)
+{
+    I2C1->CR1 |= I2C_CR1_SWRST;
+    I2C1->CR1 &= ~(I2C_CR1_SWRST);
+
+    i2c1SetSpeed(i2cSpeedHz);
+}
+
+/**
+ * @brief Abort the running transfer
  * 
- * @note This function is blocking and does not return until all bytes are received
- * @note Suitable for reading from EEPROM and similar devices
- * @note Automatically handles ACK/NACK signaling for burst reads
- * @warning Caller must ensure data buffer has sufficient size for n bytes
- * @warning If n == 0, behavior is undefined; ensure n > 0
- * @see i2c1ByteRead for reading single byte
+ * @return void
  */
-void i2c1BurstRead(char saddr, char maddr, int n, char* data)
+void i2c1Abort(void)
 {
-    volatile int tmp;
+    i2cTransfer_t *xfer = i2cCurrent;
 
-    /*Wait until bus not busy*/
-    while(!(I2C1->SR2 & I2C_SR2_BUSY)){}
+    I2C1->CR2 &= ~(I2C_IT_ALL | I2C_CR2_DMAEN | I2C_CR2_LAST);
 
-    /*Generate start*/
-    I2C1->CR1 |= I2C_SR1_SB;
+    if(i2cDmaActive)
+    {
+        dmaStreamStop(DMA1, I2C_DMA_RX_STREAM);
+        dmaStreamStop(DMA1, I2C_DMA_TX_STREAM);
+        i2cDmaActive = 0;
+    }
 
-    /*Wait until start flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_SB)){}
+    i2cCurrent = 0;
 
-    /*Transmit slave address + Write*/
-    I2C1->DR = (saddr << 1); //Write operation
+    if(xfer)
+    {
+        xfer->status = I2C_ERR_TIMEOUT;
+    }
 
-    /*Wait until address flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+    i2cReset();
+}
 
-    /*Clear addr flag*/
-    tmp = I2C1->SR2;
+/**
+ * @brief Free a bus held low by a slave
+ * 
+ * @return 1 if SDA is released, 0 otherwise
+ */
+uint8_t i2c1BusRecover(void)
+{
+    uint32_t pulse;
+    uint8_t released;
 
-    /*Wait until transmitter empty*/
-    while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+    if(i2cCurrent)
+    {
+        return 0;
+    }
 
-    /*Send memory address*/
-    I2C1->DR = maddr;
+    I2C1->CR1 &= ~I2C_CR1_PE;
 
-    /*Wait until transmit empty*/
-    while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+    /*Release both lines, then switch PB8/PB9 to open-drain outputs*/
+    GPIOB->BSRR = GPIO_BSRR_BS8 | GPIO_BSRR_BS9;
+    GPIOB->MODER &= ~(GPIO_MODER_MODER8 | GPIO_MODER_MODER9);
+    GPIOB->MODER |= GPIO_MODER_MODER8_0 | GPIO_MODER_MODER9_0;
+    i2cDelayUs(I2C_RECOVERY_HALF_US);
 
-    /*Generate restart*/
-    I2C1->CR1 |= I2C_CR1_START;
+    /*Clock out the rest of the byte the slave is sending*/
+    for(pulse = 0; (pulse < I2C_RECOVERY_PULSES) && !(GPIOB->IDR & GPIO_IDR_ID9); pulse++)
+    {
+        GPIOB->BSRR = GPIO_BSRR_BR8;
+        i2cDelayUs(I2C_RECOVERY_HALF_US);
+        GPIOB->BSRR = GPIO_BSRR_BS8;
+        i2cDelayUs(I2C_RECOVERY_HALF_US);
+    }
 
-    /*Wait until start flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_SB)){}
+    /*STOP condition: SDA rises while SCL is high*/
+    GPIOB->BSRR = GPIO_BSRR_BR8;
+    i2cDelayUs(I2C_RECOVERY_HALF_US);
+    GPIOB->BSRR = GPIO_BSRR_BR9;
+    i2cDelayUs(I2C_RECOVERY_HALF_US);
+    GPIOB->BSRR = GPIO_BSRR_BS8;
+    i2cDelayUs(I2C_RECOVERY_HALF_US);
+    GPIOB->BSRR = GPIO_BSRR_BS9;
+    i2cDelayUs(I2C_RECOVERY_HALF_US);
 
-    /*Transmit slave address + Read*/
-    I2C1->DR = (saddr << 1) | 1; //Read operation
+    released = ((GPIOB->IDR & GPIO_IDR_ID9) != 0U);
 
-    /*Wait until addr flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+    /*Back to AF4 (I2C1)*/
+    GPIOB->MODER &= ~(GPIO_MODER_MODER8 | GPIO_MODER_MODER9);
+    GPIOB->MODER |= GPIO_MODER_MODER8_1 | GPIO_MODER_MODER9_1;
 
-    /*Clear addr flag*/
-    tmp = I2C1->SR2;
+    i2cReset();
 
-    /*Enable Acknowledge*/
-    I2C1->CR1 |= I2C_CR1_ACK;
+    return released;
+}
 
-    while(n > 0U)
-    {
-        /*if one byte*/
-        if(n == 1U)
-        {
-            /*Disable Acknowledge*/
-            I2C1->CR1 &= ~I2C_CR1_ACK;
+/**
+ * @brief Run a transfer and wait for its status
+ * 
+ * Both the wait for the engine and the wait for the transfer end at
+ * I2C_BLOCKING_TIMEOUT_US. A transfer that overruns its deadline is
+ * aborted and the bus is recovered.
+ * 
+ * @param[in,out] xfer Transfer descriptor (callback is cleared)
+ * 
+ * @return Final status
+ */
+static i2cStatus_t i2cRunBlocking(i2cTransfer_t *xfer)
+{
+    uint32_t start = timGetMicros();
 
-            /*Generate Stop*/
-            I2C1->CR1 |= I2C_CR1_STOP;
+    xfer->callback = 0;
 
-            /*Wait for RXNE flag is set*/
-            while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+    /*Wait for the engine*/
+    while(!i2c1Submit(xfer))
+    {
+        if((timGetMicros() - start) >= I2C_BLOCKING_TIMEOUT_US)
+        {
+            xfer->status = I2C_ERR_TIMEOUT;
+            return xfer->status;
+        }
+    }
 
-            /*Read data from DR*/
-            *data++ = I2C1->DR;
+    /*Wait for the transfer*/
+    while(xfer->status == I2C_PENDING)
+    {
+        if((timGetMicros() - start) >= I2C_BLOCKING_TIMEOUT_US)
+        {
+            i2c1Abort();
+            i2c1BusRecover();
             break;
         }
-        else
-        {
-            /*Wait for RXNE flag is set*/
-            while(!(I2C1->SR1 & I2C_SR1_RXNE)){}
+    }
 
-            /*Read data from DR*/
-            *data++ = I2C1->DR;
-            n--;
+    return xfer->status;
+}
 
-        }
+/**
+ * @brief Fill a descriptor for a memory-addressed transfer
+ * 
+ * @param[out] xfer Descriptor to fill
+ * @param[in] saddr 7-bit slave address
+ * @param[in] maddr Memory address sent as a 1-byte header
+ * 
+ * @return void
+ */
+static void i2cSetupMemTransfer(i2cTransfer_t *xfer, uint8_t saddr, uint8_t maddr)
+{
+    xfer->addr = saddr;
+    xfer->headerLen = 1;
+    xfer->header[0] = maddr;
+    xfer->header[1] = 0;
+    xfer->txBuf = 0;
+    xfer->txLen = 0;
+    xfer->rxBuf = 0;
+    xfer->rxLen = 0;
+    xfer->callback = 0;
+    xfer->context = 0;
+}
+
+/**
+ * @brief Read a single byte from I2C slave device.
+ * 
+ * Runs a write-restart-read transfer: START, slave address + W, memory
+ * address, repeated START, slave address + R, one byte with NACK, STOP.
+ * 
+ * @param[in] saddr 7-bit slave device address (will be shifted left by 1 for R/W bit)
+ * @param[in] msddr Memory address to read from (1 byte address)
+ * @param[out] data Pointer to uint8_t variable to store received byte
+ * 
+ * @return void
+ * 
+ * @note This function is blocking and does not return until the transfer has ended
+ * @note Suitable for reading from EEPROM and similar devices with 1-byte addressing
+ * @warning Caller must ensure data pointer is valid and points to writable memory
+ * @see i2c1BurstRead for reading multiple consecutive bytes
+ */
+void i2c1ByteRead(uint8_t saddr, char msddr, char* data)
+{
+    i2cTransfer_t xfer;
+
+    i2cSetupMemTransfer(&xfer, saddr, (uint8_t)msddr);
+    xfer.rxBuf = (uint8_t *)data;
+    xfer.rxLen = 1;
+
+    i2cRunBlocking(&xfer);
+}
+
+
+/**
+ * @brief Read multiple consecutive bytes from I2C slave device in burst mode.
+ * 
+ * Runs a write-restart-read transfer: START, slave address + W, start
+ * address, repeated START, slave address + R, then n bytes. All bytes
+ * are ACKed except the last one, which is followed by STOP.
+ * 
+ * @param[in] saddr 7-bit slave device address (will be shifted left by 1 for R/W bit)
+ * @param[in] maddr Starting memory address to read from
+ * @param[in] n Number of bytes to read (must be > 0)
+ * @param[out] data Pointer to buffer to store received bytes (must be at least n bytes)
+ * 
+ * @return void
+ * 
+ * @note This function is blocking and does not return until the transfer has ended
+ * @note Suitable for reading from EEPROM and similar devices
+ * @warning Caller must ensure data buffer has sufficient size for n bytes
+ * @warning If n <= 0, nothing is read
+ * @see i2c1ByteRead for reading single byte
+ */
+void i2c1BurstRead(char saddr, char maddr, int n, char* data)
+{
+    i2cTransfer_t xfer;
+
+    if(n <= 0)
+    {
+        return;
     }
 
+    i2cSetupMemTransfer(&xfer, (uint8_t)saddr, (uint8_t)maddr);
+    xfer.rxBuf = (uint8_t *)data;
+    xfer.rxLen = (uint16_t)n;
+
+    i2cRunBlocking(&xfer);
 }
 
 
 /**
  * @brief Write multiple consecutive bytes to I2C slave device in burst mode.
  * 
- * Performs an I2C write transaction to transmit multiple consecutive bytes
- * to a starting memory address on the slave device. The sequence:
- * 1. Waits for I2C bus to be free
- * 2. Sends START condition and slave address with write bit
- * 3. Sends starting memory address
- * 4. Transmits all n bytes consecutively
- * 5. Waits for byte transfer finished (BTF)
- * 6. Sends STOP condition
+ * Runs a write transfer: START, slave address + W, start address, the
+ * n data bytes, STOP after the last byte has left the shift register.
  * 
  * @param[in] saddr 7-bit slave device address (will be shifted left by 1 for R/W bit)
  * @param[in] maddr Starting memory address to write to
@@ -301,53 +842,252 @@ void i2c1BurstRead(char saddr, char maddr, int n, char* data)
  * 
  * @return void
  * 
- * @note This function is blocking and does not return until all bytes are transmitted
+ * @note This function is blocking and does not return until the transfer has ended
  * @note Suitable for writing to EEPROM and similar devices
  * @warning Caller must ensure data buffer has at least n valid bytes
- * @warning If n == 0, behavior is undefined; ensure n > 0
  * @warning Some EEPROM devices have page write limits; writing beyond page boundary may fail
  * @see i2c1BurstRead for reading burst of bytes
  */
 void i2c1BurstWrite(char saddr, char maddr, int n, char* data)
 {
-    volatile int tmp;
+    i2cTransfer_t xfer;
 
-    /*Wait until bus not busy*/
-    while(!(I2C1->SR2 & I2C_SR2_BUSY)){}
+    i2cSetupMemTransfer(&xfer, (uint8_t)saddr, (uint8_t)maddr);
+    xfer.txBuf = (const uint8_t *)data;
+    xfer.txLen = (n > 0) ? (uint16_t)n : 0U;
 
-    /*Generate start*/
-    I2C1->CR1 |= I2C_SR1_SB;
+    i2cRunBlocking(&xfer);
+}
 
-    /*Wait until start flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_SB)){}
+/**
+ * @brief Route the I2C1 interrupts to another driver (slave mode)
+ * 
+ * @return void
+ */
+void i2c1SetSlaveHooks(i2cIrqHook_t ev, i2cIrqHook_t er)
+{
+    i2cSlaveEvHook = ev;
+    i2cSlaveErHook = er;
+}
 
-    /*Transmit slave address*/
-    I2C1->DR = (saddr << 1); //Write operation
+/**
+ * @brief Start a burst read and return immediately
+ * 
+ * @return 1 if the transfer was started, 0 if the bus is busy or n <= 0
+ */
+uint8_t i2c1BurstReadAsync(char saddr, char maddr, int n, char* data, i2cCallback_t callback)
+{
+    /*The shared descriptor may still be in flight*/
+    if((n <= 0) || i2c1IsBusy())
+    {
+        return 0;
+    }
 
-    /*Wait until address flag is set*/
-    while(!(I2C1->SR1 & I2C_SR1_ADDR)){}
+    i2cSetupMemTransfer(&i2cAsyncXfer, (uint8_t)saddr, (uint8_t)maddr);
+    i2cAsyncXfer.rxBuf = (uint8_t *)data;
+    i2cAsyncXfer.rxLen = (uint16_t)n;
+    i2cAsyncXfer.callback = callback;
 
-    /*Clear addr flag*/
-    tmp = I2C1->SR2;
+    return i2c1Submit(&i2cAsyncXfer);
+}
 
-    /*Wait until data register empty*/
-    while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+/**
+ * @brief Start a burst write and return immediately
+ * 
+ * @return 1 if the transfer was started, 0 if the bus is busy
+ */
+uint8_t i2c1BurstWriteAsync(char saddr, char maddr, int n, char* data, i2cCallback_t callback)
+{
+    if(i2c1IsBusy())
+    {
+        return 0;
+    }
+
+    i2cSetupMemTransfer(&i2cAsyncXfer, (uint8_t)saddr, (uint8_t)maddr);
+    i2cAsyncXfer.txBuf = (const uint8_t *)data;
+    i2cAsyncXfer.txLen = (n > 0) ? (uint16_t)n : 0U;
+    i2cAsyncXfer.callback = callback;
 
-    /*Send memory address*/
-    I2C1->DR = maddr;
+    return i2c1Submit(&i2cAsyncXfer);
+}
 
-    for(int i = 0; i < n; i++)
+/**
+ * @brief I2C1 event interrupt handler
+ * 
+ * @return void
+ */
+void I2C1_EV_IRQHandler(void)
+{
+    i2cTransfer_t *xfer = i2cCurrent;
+    uint32_t sr1;
+    volatile uint32_t tmp;
+
+    if(i2cSlaveEvHook)
     {
-        /*Wait until data register empty*/
-        while(!(I2C1->SR1 & I2C_SR1_TXE)){}
+        i2cSlaveEvHook();
+        return;
+    }
 
-        /*Transmit memory address*/
-        I2C1->DR = *data++;
+    sr1 = I2C1->SR1;
+
+    if(!xfer)
+    {
+        I2C1->CR2 &= ~I2C_IT_ALL;
+        return;
+    }
+
+    /*START sent: send the address with the direction of the phase*/
+    if(sr1 & I2C_SR1_SB)
+    {
+        I2C1->DR = (uint8_t)((xfer->addr << 1) | ((i2cPhase == I2C_PHASE_READ) ? 1U : 0U));
+        return;
+    }
+
+    /*Address acknowledged*/
+    if(sr1 & I2C_SR1_ADDR)
+    {
+        if(i2cPhase == I2C_PHASE_READ)
+        {
+            i2cAddrRead(xfer);
+        }
+        else
+        {
+            tmp = I2C1->SR2;
+            (void)tmp;
+
+            /*Probe only: the slave answered*/
+            if(i2cWriteLength(xfer) == 0U)
+            {
+                I2C1->CR1 |= I2C_CR1_STOP;
+                i2cFinish(I2C_OK);
+            }
+        }
+        return;
+    }
+
+    if(i2cPhase == I2C_PHASE_READ)
+    {
+        i2cReceive(xfer, sr1);
+    }
+    else
+    {
+        i2cTransmit(xfer, sr1);
+    }
+}
+
+/**
+ * @brief I2C1 error interrupt handler
+ * 
+ * Clears the error flags and ends the transfer. A STOP is generated
+ * after a NACK or a bus error; after an arbitration loss the hardware
+ * has already released the bus.
+ * 
+ * @return void
+ */
+void I2C1_ER_IRQHandler(void)
+{
+    uint32_t sr1;
+    i2cStatus_t status;
+
+    if(i2cSlaveErHook)
+    {
+        i2cSlaveErHook();
+        return;
     }
 
-    /*Wait until tranfer finished*/
-    while(!(I2C1->SR1 & I2C_SR1_BTF)){}
+    sr1 = I2C1->SR1;
+    I2C1->SR1 = ~(sr1 & I2C_SR1_ERRORS) & 0xFFFFU;
+
+    if(!i2cCurrent)
+    {
+        return;
+    }
+
+    if(sr1 & I2C_SR1_ARLO)
+    {
+        status = I2C_ERR_ARLO;
+    }
+    else
+    {
+        I2C1->CR1 |= I2C_CR1_STOP;
+
+        if(sr1 & I2C_SR1_AF)
+        {
+            status = I2C_ERR_NACK;
+        }
+        else if(sr1 & I2C_SR1_BERR)
+        {
+            status = I2C_ERR_BUS;
+        }
+        else
+        {
+            status = I2C_ERR_OVR;
+        }
+    }
+
+    i2cFinish(status);
+}
+
+/**
+ * @brief DMA1 Stream0 interrupt handler (I2C1 RX complete)
+ * 
+ * The last byte has been NACKed (LAST bit) and stored: send STOP.
+ * 
+ * @return void
+ */
+void DMA1_Stream0_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA1, I2C_DMA_RX_STREAM);
+
+    dmaClearFlags(DMA1, I2C_DMA_RX_STREAM, flags);
+
+    if(!i2cCurrent)
+    {
+        return;
+    }
 
-    /*Generate stop*/
     I2C1->CR1 |= I2C_CR1_STOP;
-}
\ No newline at end of file
+
+    if(flags & DMA_FLAG_TE)
+    {
+        i2cFinish(I2C_ERR_DMA);
+    }
+    else if(flags & DMA_FLAG_TC)
+    {
+        i2cDmaActive = 0;
+        i2cRxIndex = i2cCurrent->rxLen;
+        i2cFinish(I2C_OK);
+    }
+}
+
+/**
+ * @brief DMA1 Stream7 interrupt handler (I2C1 TX complete)
+ * 
+ * The last byte is in DR: give control back to the event interrupt,
+ * which sends STOP or the repeated START on BTF.
+ * 
+ * @return void
+ */
+void DMA1_Stream7_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA1, I2C_DMA_TX_STREAM);
+
+    dmaClearFlags(DMA1, I2C_DMA_TX_STREAM, flags);
+
+    if(!i2cCurrent)
+    {
+        return;
+    }
+
+    if(flags & DMA_FLAG_TE)
+    {
+        I2C1->CR1 |= I2C_CR1_STOP;
+        i2cFinish(I2C_ERR_DMA);
+    }
+    else if(flags & DMA_FLAG_TC)
+    {
+        i2cDmaActive = 0;
+        I2C1->CR2 &= ~I2C_CR2_DMAEN;
+        I2C1->CR2 |= I2C_CR2_ITEVTEN;
+    }
+}
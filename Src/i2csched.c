@@ -0,0 +1,408 @@
+/**
+ * @file i2csched.c
+ * @brief Priority scheduler for shared I2C1 transfers implementation
+ *
+ * The queue is a singly linked list sorted by priority. It is changed
+ * by clients (main loop or interrupts) and by the I2C completion
+ * interrupt, so every change is made with interrupts masked; client
+ * callbacks always run with interrupts enabled again.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "i2csched.h"
+#include "timer.h"
+
+static i2cJob_t *i2cSchedHead;
+static i2cJob_t *volatile i2cSchedCurrent;
+static volatile uint8_t i2cSchedRecover;
+static uint32_t i2cSchedQueued;
+static i2cSchedStats_t i2cSchedStats;
+
+static void i2cSchedDispatch(void);
+
+/**
+ * @brief Mask interrupts
+ *
+ * @return Previous PRIMASK, for i2cSchedUnlock()
+ */
+static uint32_t i2cSchedLock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+
+    return primask;
+}
+
+/**
+ * @brief Restore the interrupt mask saved by i2cSchedLock()
+ *
+ * @param[in] primask Saved PRIMASK
+ *
+ * @return void
+ */
+static void i2cSchedUnlock(uint32_t primask)
+{
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Check whether a job has passed its deadline
+ *
+ * @param[in] job Job
+ * @param[in] now Current time in microseconds
+ *
+ * @return 1 if expired, 0 otherwise
+ */
+static uint8_t i2cSchedExpired(const i2cJob_t *job, uint32_t now)
+{
+    return ((int32_t)(now - job->deadline) >= 0);
+}
+
+/**
+ * @brief Insert a job in priority order
+ *
+ * @param[in] job Job to insert
+ * @param[in] first 1 to go ahead of jobs of the same priority (retry),
+ *            0 to go behind them
+ *
+ * @return void
+ * @note Interrupts must be masked
+ */
+static void i2cSchedInsert(i2cJob_t *job, uint8_t first)
+{
+    i2cJob_t **link = &i2cSchedHead;
+
+    while(*link && (((*link)->priority < job->priority) ||
+                    (!first && ((*link)->priority == job->priority))))
+    {
+        link = &(*link)->next;
+    }
+
+    job->next = *link;
+    *link = job;
+
+    i2cSchedQueued++;
+
+    if(i2cSchedQueued > i2cSchedStats.maxQueueDepth)
+    {
+        i2cSchedStats.maxQueueDepth = i2cSchedQueued;
+    }
+}
+
+/**
+ * @brief Check whether a job is queued or running
+ *
+ * @param[in] job Job
+ *
+ * @return 1 if the scheduler owns the job
+ * @note Interrupts must be masked
+ */
+static uint8_t i2cSchedOwns(const i2cJob_t *job)
+{
+    const i2cJob_t *it;
+
+    if(job == i2cSchedCurrent)
+    {
+        return 1;
+    }
+
+    for(it = i2cSchedHead; it; it = it->next)
+    {
+        if(it == job)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Report a finished job
+ *
+ * @param[in] job Job
+ * @param[in] status Final status
+ *
+ * @return void
+ */
+static void i2cSchedFinish(i2cJob_t *job, i2cStatus_t status)
+{
+    uint32_t latency = timGetMicros() - (job->deadline - job->timeoutUs);
+
+    job->xfer.status = status;
+
+    if(status == I2C_OK)
+    {
+        i2cSchedStats.completed++;
+    }
+    else
+    {
+        i2cSchedStats.failed++;
+
+        if(status == I2C_ERR_TIMEOUT)
+        {
+            i2cSchedStats.timeouts++;
+        }
+    }
+
+    if(latency > i2cSchedStats.maxLatencyUs)
+    {
+        i2cSchedStats.maxLatencyUs = latency;
+    }
+
+    if(job->done)
+    {
+        job->done(job);
+    }
+}
+
+/**
+ * @brief Retry or finish a job after an attempt
+ *
+ * @param[in] job Job that just ran
+ * @param[in] status Result of the attempt
+ *
+ * @return void
+ */
+static void i2cSchedResult(i2cJob_t *job, i2cStatus_t status)
+{
+    uint32_t primask;
+
+    /*A stuck bus must be freed before anything else runs*/
+    if((status == I2C_ERR_BUS) || (status == I2C_ERR_TIMEOUT))
+    {
+        i2cSchedRecover = 1;
+    }
+
+    if((status != I2C_OK) && (job->attempts <= job->retries) &&
+       !i2cSchedExpired(job, timGetMicros()))
+    {
+        i2cSchedStats.retries++;
+
+        /*Queued again: the caller must not see the failed attempt*/
+        primask = i2cSchedLock();
+        job->xfer.status = I2C_PENDING;
+        i2cSchedInsert(job, 1);
+        i2cSchedUnlock(primask);
+        return;
+    }
+
+    i2cSchedFinish(job, status);
+}
+
+/**
+ * @brief I2C completion callback (interrupt context)
+ *
+ * @param[in] xfer Finished transfer
+ *
+ * @return void
+ */
+static void i2cSchedOnComplete(i2cTransfer_t *xfer)
+{
+    i2cJob_t *job = (i2cJob_t *)xfer->context;
+
+    i2cSchedCurrent = 0;
+    i2cSchedResult(job, xfer->status);
+    i2cSchedDispatch();
+}
+
+/**
+ * @brief Start the first queued job if the bus is free
+ *
+ * Jobs whose deadline has already passed are finished with
+ * I2C_ERR_TIMEOUT on the way.
+ *
+ * @return void
+ */
+static void i2cSchedDispatch(void)
+{
+    uint32_t primask;
+    i2cJob_t *job;
+
+    for(;;)
+    {
+        primask = i2cSchedLock();
+
+        if(i2cSchedCurrent || i2cSchedRecover || !i2cSchedHead || i2c1IsBusy())
+        {
+            i2cSchedUnlock(primask);
+            return;
+        }
+
+        job = i2cSchedHead;
+        i2cSchedHead = job->next;
+        job->next = 0;
+        i2cSchedQueued--;
+
+        if(!i2cSchedExpired(job, timGetMicros()))
+        {
+            job->attempts++;
+            job->xfer.callback = i2cSchedOnComplete;
+            job->xfer.context = job;
+            i2cSchedCurrent = job;
+            i2c1Submit(&job->xfer);
+
+            i2cSchedUnlock(primask);
+            return;
+        }
+
+        i2cSchedUnlock(primask);
+        i2cSchedFinish(job, I2C_ERR_TIMEOUT);
+    }
+}
+
+/**
+ * @brief Initialize I2C1 and the scheduler
+ *
+ * @return void
+ */
+void i2cSchedInit(void)
+{
+    i2c1Init();
+
+    i2cSchedHead = 0;
+    i2cSchedCurrent = 0;
+    i2cSchedRecover = 0;
+    i2cSchedQueued = 0;
+}
+
+/**
+ * @brief Queue a job
+ *
+ * @return 1 if queued, 0 if the job is already queued or running
+ */
+uint8_t i2cSchedSubmit(i2cJob_t *job)
+{
+    uint32_t primask = i2cSchedLock();
+
+    if(i2cSchedOwns(job))
+    {
+        i2cSchedUnlock(primask);
+        return 0;
+    }
+
+    job->deadline = timGetMicros() + job->timeoutUs;
+    job->attempts = 0;
+    job->xfer.status = I2C_PENDING;
+
+    i2cSchedInsert(job, 0);
+    i2cSchedStats.submitted++;
+
+    i2cSchedUnlock(primask);
+
+    i2cSchedDispatch();
+
+    return 1;
+}
+
+/**
+ * @brief Enforce deadlines and run bus recovery
+ *
+ * @return void
+ */
+void i2cSchedPoll(void)
+{
+    uint32_t now = timGetMicros();
+    uint32_t primask;
+    i2cJob_t *job;
+    i2cJob_t *expired = 0;
+    i2cJob_t **link;
+
+    /*Running job past its deadline: abort it*/
+    primask = i2cSchedLock();
+    job = i2cSchedCurrent;
+
+    if(job && i2cSchedExpired(job, now))
+    {
+        i2c1Abort();
+        i2cSchedCurrent = 0;
+    }
+    else
+    {
+        job = 0;
+    }
+
+    /*Take the expired jobs out of the queue*/
+    link = &i2cSchedHead;
+
+    while(*link)
+    {
+        if(i2cSchedExpired(*link, now))
+        {
+            i2cJob_t *it = *link;
+
+            *link = it->next;
+            it->next = expired;
+            expired = it;
+            i2cSchedQueued--;
+        }
+        else
+        {
+            link = &(*link)->next;
+        }
+    }
+
+    i2cSchedUnlock(primask);
+
+    if(job)
+    {
+        i2cSchedResult(job, I2C_ERR_TIMEOUT);
+    }
+
+    while(expired)
+    {
+        job = expired;
+        expired = job->next;
+        job->next = 0;
+        i2cSchedFinish(job, I2C_ERR_TIMEOUT);
+    }
+
+    /*Free the bus before the next job*/
+    if(i2cSchedRecover && !i2cSchedCurrent && !i2c1IsBusy())
+    {
+        i2c1BusRecover();
+        i2cSchedStats.recoveries++;
+        i2cSchedRecover = 0;
+    }
+
+    i2cSchedDispatch();
+}
+
+/**
+ * @brief Number of jobs queued or running
+ *
+ * @return Job count
+ */
+uint32_t i2cSchedPending(void)
+{
+    return i2cSchedQueued + (i2cSchedCurrent ? 1U : 0U);
+}
+
+/**
+ * @brief Check whether the scheduler still owns a job
+ *
+ * @return 1 if the job is queued or running
+ */
+uint8_t i2cSchedBusy(const i2cJob_t *job)
+{
+    uint32_t primask = i2cSchedLock();
+    uint8_t owned = i2cSchedOwns(job);
+
+    i2cSchedUnlock(primask);
+
+    return owned;
+}
+
+/**
+ * @brief Copy the scheduler counters
+ *
+ * @return void
+ */
+void i2cSchedGetStats(i2cSchedStats_t *stats)
+{
+    *stats = i2cSchedStats;
+}
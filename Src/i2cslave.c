@@ -0,0 +1,547 @@
+/**
+ * @file i2cslave.c
+ * @brief I2C1/I2C2/I2C3 slave register-file driver implementation
+ *
+ * The event interrupt only sees ADDR and STOPF: on ADDR the direction
+ * bit selects the DMA stream to arm (RX into a scratch buffer, TX
+ * circular from the register pointer), on STOPF (or AF, when the master
+ * NACKs the end of a read) the transfer is closed. A received pointer
+ * and data are applied to the register file when the write ends, either
+ * by STOP or by the repeated START of a following read.
+ *
+ * After a read the peripheral is reset and reconfigured, which drops
+ * the byte the TX stream had already loaded into DR, so the next read
+ * starts exactly at the register pointer.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "i2cslave.h"
+#include "i2c.h"
+#include "i2csched.h"
+#include "dma.h"
+#include "clock.h"
+
+/** Pointer byte + whole register file, plus one so a full write never wraps */
+#define I2C_SLAVE_RX_SIZE       (I2C_SLAVE_REG_SIZE + 2U)
+
+/** OAR1 bit 14 must be kept at 1 by software */
+#define I2C_SLAVE_OAR1_BIT14    (1U<<14)
+
+#define I2C_SLAVE_SR1_ERRORS    (I2C_SR1_AF | I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)
+
+/**
+ * @brief Fixed hardware resources of a slave port
+ */
+typedef struct
+{
+    I2C_TypeDef *i2c;               /**< I2C peripheral */
+    uint32_t rccBit;                /**< Clock enable bit in APB1ENR */
+    GPIO_TypeDef *sclPort;          /**< SCL GPIO port */
+    uint8_t sclPin;                 /**< SCL pin number */
+    uint8_t sclAf;                  /**< SCL alternate function */
+    GPIO_TypeDef *sdaPort;          /**< SDA GPIO port */
+    uint8_t sdaPin;                 /**< SDA pin number */
+    uint8_t sdaAf;                  /**< SDA alternate function */
+    uint8_t rxStream;               /**< DMA1 RX stream index */
+    uint8_t rxChannel;              /**< DMA1 RX request channel */
+    uint8_t txStream;               /**< DMA1 TX stream index */
+    uint8_t txChannel;              /**< DMA1 TX request channel */
+    IRQn_Type evIrq;                /**< Event interrupt */
+    IRQn_Type erIrq;                /**< Error interrupt */
+} i2cSlaveHw_t;
+
+static const i2cSlaveHw_t i2cSlaveHw[I2C_SLAVE_PORT_COUNT] =
+{
+    {I2C1, RCC_APB1ENR_I2C1EN, GPIOB, 8U, 4U, GPIOB, 9U, 4U, 0U, 1U, 7U, 1U, I2C1_EV_IRQn, I2C1_ER_IRQn},
+    {I2C2, RCC_APB1ENR_I2C2EN, GPIOB, 10U, 4U, GPIOB, 3U, 9U, 2U, 7U, 7U, 7U, I2C2_EV_IRQn, I2C2_ER_IRQn},
+    {I2C3, RCC_APB1ENR_I2C3EN, GPIOA, 8U, 4U, GPIOB, 4U, 9U, 1U, 1U, 4U, 3U, I2C3_EV_IRQn, I2C3_ER_IRQn}
+};
+
+static uint8_t i2cSlaveRegs[I2C_SLAVE_PORT_COUNT][2][I2C_SLAVE_REG_SIZE];
+static uint8_t i2cSlaveRx[I2C_SLAVE_PORT_COUNT][I2C_SLAVE_RX_SIZE];
+static uint8_t i2cSlaveOwnAddr[I2C_SLAVE_PORT_COUNT];
+static volatile uint8_t i2cSlaveFront[I2C_SLAVE_PORT_COUNT];
+static volatile uint8_t i2cSlaveSwapPending[I2C_SLAVE_PORT_COUNT];
+static volatile uint8_t i2cSlaveBusy[I2C_SLAVE_PORT_COUNT];
+static uint8_t i2cSlaveRxActive[I2C_SLAVE_PORT_COUNT];
+static uint8_t i2cSlaveTxActive[I2C_SLAVE_PORT_COUNT];
+static uint8_t i2cSlavePtr[I2C_SLAVE_PORT_COUNT];
+static i2cSlaveWriteCallback_t i2cSlaveCallback[I2C_SLAVE_PORT_COUNT];
+static volatile uint32_t i2cSlaveTransactions[I2C_SLAVE_PORT_COUNT];
+static volatile uint32_t i2cSlaveErrors[I2C_SLAVE_PORT_COUNT];
+
+/**
+ * @brief Configure one pin as open-drain alternate function with pull-up
+ *
+ * @param[in] gpio GPIO port
+ * @param[in] pin Pin number (0-15)
+ * @param[in] af Alternate function number
+ *
+ * @return void
+ */
+static void i2cSlavePinInit(GPIO_TypeDef *gpio, uint8_t pin, uint8_t af)
+{
+    uint32_t shift2 = pin * 2U;
+    uint32_t shift4 = (pin & 7U) * 4U;
+
+    gpio->MODER &= ~(3U << shift2);
+    gpio->MODER |= (2U << shift2);
+    gpio->OTYPER |= (1U << pin);
+    gpio->OSPEEDR |= (3U << shift2);
+    gpio->PUPDR &= ~(3U << shift2);
+    gpio->PUPDR |= (1U << shift2);
+    gpio->AFR[pin >> 3] &= ~(0xFU << shift4);
+    gpio->AFR[pin >> 3] |= ((uint32_t)af << shift4);
+}
+
+/**
+ * @brief Reset the peripheral and configure it as slave
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveConfigure(i2cSlavePort_t port)
+{
+    I2C_TypeDef *i2c = i2cSlaveHw[port].i2c;
+
+    /*Reset drops any byte left in DR*/
+    i2c->CR1 |= I2C_CR1_SWRST;
+    i2c->CR1 &= ~(I2C_CR1_SWRST);
+
+    /*Address match and STOP through the event interrupt, data by DMA*/
+    i2c->CR2 = (clockGetPclk1() / 1000000U) | I2C_CR2_ITEVTEN | I2C_CR2_ITERREN | I2C_CR2_DMAEN;
+    i2c->OAR1 = I2C_SLAVE_OAR1_BIT14 | ((uint32_t)i2cSlaveOwnAddr[port] << 1);
+
+    /*ACK is cleared by hardware while PE = 0*/
+    i2c->CR1 = I2C_CR1_PE;
+    i2c->CR1 |= I2C_CR1_ACK;
+}
+
+/**
+ * @brief Make the back copy the one served to the master
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveSwap(i2cSlavePort_t port)
+{
+    uint8_t front = i2cSlaveFront[port] ^ 1U;
+    uint8_t *src = i2cSlaveRegs[port][front];
+    uint8_t *dst = i2cSlaveRegs[port][front ^ 1U];
+
+    for(uint32_t i = 0; i < I2C_SLAVE_RO_SIZE; i++)
+    {
+        dst[i] = src[i];
+    }
+
+    i2cSlaveFront[port] = front;
+    i2cSlaveSwapPending[port] = 0;
+}
+
+/**
+ * @brief Apply the bytes received by a write transfer
+ *
+ * @param[in] port Port
+ * @param[in] apply 0 to drop the data (bus error)
+ *
+ * @return void
+ */
+static void i2cSlaveFinishWrite(i2cSlavePort_t port, uint8_t apply)
+{
+    const i2cSlaveHw_t *hw = &i2cSlaveHw[port];
+    const uint8_t *rx = i2cSlaveRx[port];
+    uint32_t count = I2C_SLAVE_RX_SIZE - dmaGetStream(DMA1, hw->rxStream)->NDTR;
+    uint8_t overflow = ((dmaGetFlags(DMA1, hw->rxStream) & DMA_FLAG_TC) != 0U);
+    uint8_t accepted = 0;
+    uint32_t a;
+
+    dmaStreamStop(DMA1, hw->rxStream);
+    i2cSlaveRxActive[port] = 0;
+
+    if(!apply || overflow)
+    {
+        i2cSlaveErrors[port]++;
+        return;
+    }
+
+    if(count == 0U)
+    {
+        return;
+    }
+
+    i2cSlavePtr[port] = (rx[0] < I2C_SLAVE_REG_SIZE) ? rx[0] : 0U;
+
+    /*Store into both copies so a later swap keeps master data*/
+    for(uint32_t i = 1; i < count; i++)
+    {
+        a = i2cSlavePtr[port] + i - 1U;
+        if(a >= I2C_SLAVE_REG_SIZE)
+        {
+            break;
+        }
+        if(a >= I2C_SLAVE_RO_SIZE)
+        {
+            i2cSlaveRegs[port][0][a] = rx[i];
+            i2cSlaveRegs[port][1][a] = rx[i];
+            accepted++;
+        }
+    }
+
+    if(accepted && i2cSlaveCallback[port])
+    {
+        i2cSlaveCallback[port](port, i2cSlavePtr[port], accepted);
+    }
+}
+
+/**
+ * @brief Close the transfer in progress
+ *
+ * @param[in] port Port
+ * @param[in] error 1 if a bus error ended the transfer
+ *
+ * @return void
+ */
+static void i2cSlaveEndOfTransfer(i2cSlavePort_t port, uint8_t error)
+{
+    if(i2cSlaveRxActive[port])
+    {
+        i2cSlaveFinishWrite(port, !error);
+    }
+
+    if(i2cSlaveTxActive[port])
+    {
+        dmaStreamStop(DMA1, i2cSlaveHw[port].txStream);
+        i2cSlaveTxActive[port] = 0;
+        i2cSlaveConfigure(port);
+    }
+
+    i2cSlaveBusy[port] = 0;
+    i2cSlaveTransactions[port]++;
+
+    if(i2cSlaveSwapPending[port])
+    {
+        i2cSlaveSwap(port);
+    }
+}
+
+/**
+ * @brief Event interrupt of a port (ADDR and STOPF)
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveEvent(i2cSlavePort_t port)
+{
+    const i2cSlaveHw_t *hw = &i2cSlaveHw[port];
+    I2C_TypeDef *i2c = hw->i2c;
+    uint32_t sr1 = i2c->SR1;
+    uint32_t sr2;
+    uint8_t ptr;
+
+    if(sr1 & I2C_SR1_ADDR)
+    {
+        /*Reading SR2 clears ADDR; SCL is stretched until DMA serves DR*/
+        sr2 = i2c->SR2;
+
+        /*Repeated START after a pointer write*/
+        if(i2cSlaveRxActive[port])
+        {
+            i2cSlaveFinishWrite(port, 1);
+        }
+
+        i2cSlaveBusy[port] = 1;
+
+        if(sr2 & I2C_SR2_TRA)
+        {
+            ptr = i2cSlavePtr[port];
+            dmaStreamConfig(DMA1, hw->txStream, hw->txChannel,
+                            DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_PL_1,
+                            &i2c->DR, &i2cSlaveRegs[port][i2cSlaveFront[port]][ptr],
+                            I2C_SLAVE_REG_SIZE - ptr);
+            dmaStreamStart(DMA1, hw->txStream);
+            i2cSlaveTxActive[port] = 1;
+        }
+        else
+        {
+            dmaStreamConfig(DMA1, hw->rxStream, hw->rxChannel,
+                            DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_PL_1,
+                            &i2c->DR, i2cSlaveRx[port], I2C_SLAVE_RX_SIZE);
+            dmaStreamStart(DMA1, hw->rxStream);
+            i2cSlaveRxActive[port] = 1;
+        }
+    }
+
+    if(sr1 & I2C_SR1_STOPF)
+    {
+        /*STOPF is cleared by the SR1 read above followed by a CR1 write*/
+        i2c->CR1 |= I2C_CR1_PE;
+
+        i2cSlaveEndOfTransfer(port, 0);
+    }
+}
+
+/**
+ * @brief Error interrupt of a port
+ *
+ * AF is the normal end of a read (master NACKs the last byte); the
+ * other flags are bus errors and drop a write in progress.
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveError(i2cSlavePort_t port)
+{
+    I2C_TypeDef *i2c = i2cSlaveHw[port].i2c;
+    uint32_t sr1 = i2c->SR1;
+    uint8_t error = ((sr1 & (I2C_SR1_ARLO | I2C_SR1_BERR | I2C_SR1_OVR)) != 0U);
+
+    i2c->SR1 = ~(sr1 & I2C_SLAVE_SR1_ERRORS) & 0xFFFFU;
+
+    if(error && !i2cSlaveRxActive[port])
+    {
+        i2cSlaveErrors[port]++;
+    }
+
+    i2cSlaveEndOfTransfer(port, error);
+}
+
+/**
+ * @brief I2C1 event hook (installed in i2c.c)
+ *
+ * @return void
+ */
+static void i2cSlave1Event(void)
+{
+    i2cSlaveEvent(I2C_SLAVE_PORT1);
+}
+
+/**
+ * @brief I2C1 error hook (installed in i2c.c)
+ *
+ * @return void
+ */
+static void i2cSlave1Error(void)
+{
+    i2cSlaveError(I2C_SLAVE_PORT1);
+}
+
+/**
+ * @brief Mask the interrupts of a port
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveLock(i2cSlavePort_t port)
+{
+    NVIC_DisableIRQ(i2cSlaveHw[port].evIrq);
+    NVIC_DisableIRQ(i2cSlaveHw[port].erIrq);
+}
+
+/**
+ * @brief Unmask the interrupts of a port
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void i2cSlaveUnlock(i2cSlavePort_t port)
+{
+    NVIC_EnableIRQ(i2cSlaveHw[port].evIrq);
+    NVIC_EnableIRQ(i2cSlaveHw[port].erIrq);
+}
+
+/**
+ * @brief Initialize a port as I2C slave
+ *
+ * @return 1 if the port is set up, 0 if I2C1 is in use by the master
+ */
+uint8_t i2cSlaveInit(i2cSlavePort_t port, uint8_t ownAddr)
+{
+    const i2cSlaveHw_t *hw = &i2cSlaveHw[port];
+    uint32_t primask;
+
+    /*I2C1 vectors belong to the master engine unless hooked: only take
+      them when no transfer is running or queued*/
+    if(port == I2C_SLAVE_PORT1)
+    {
+        primask = __get_PRIMASK();
+        __disable_irq();
+
+        if(i2c1IsBusy() || i2cSchedPending())
+        {
+            __set_PRIMASK(primask);
+            return 0;
+        }
+
+        i2c1SetSlaveHooks(i2cSlave1Event, i2cSlave1Error);
+
+        __set_PRIMASK(primask);
+    }
+
+    /*Enable clock access to the GPIO ports and the I2C*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_GPIOBEN;
+    RCC->APB1ENR |= hw->rccBit;
+
+    i2cSlavePinInit(hw->sclPort, hw->sclPin, hw->sclAf);
+    i2cSlavePinInit(hw->sdaPort, hw->sdaPin, hw->sdaAf);
+
+    for(uint32_t i = 0; i < I2C_SLAVE_REG_SIZE; i++)
+    {
+        i2cSlaveRegs[port][0][i] = 0;
+        i2cSlaveRegs[port][1][i] = 0;
+    }
+    i2cSlaveFront[port] = 0;
+    i2cSlaveSwapPending[port] = 0;
+    i2cSlaveBusy[port] = 0;
+    i2cSlaveRxActive[port] = 0;
+    i2cSlaveTxActive[port] = 0;
+    i2cSlavePtr[port] = 0;
+    i2cSlaveOwnAddr[port] = ownAddr & 0x7FU;
+
+    i2cSlaveConfigure(port);
+
+#ifdef I2C_SLAVE_IRQ_PRIORITY
+    NVIC_SetPriority(hw->evIrq, I2C_SLAVE_IRQ_PRIORITY);
+    NVIC_SetPriority(hw->erIrq, I2C_SLAVE_IRQ_PRIORITY);
+#endif
+    i2cSlaveUnlock(port);
+
+    return 1;
+}
+
+/**
+ * @brief Write into the back copy of the read-only area
+ *
+ * @return void
+ */
+void i2cSlaveUpdate(i2cSlavePort_t port, uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    uint8_t *back;
+
+    /*Keep the interrupt from swapping in the middle of the update*/
+    i2cSlaveLock(port);
+
+    back = i2cSlaveRegs[port][i2cSlaveFront[port] ^ 1U];
+    for(uint32_t i = 0; (i < len) && ((addr + i) < I2C_SLAVE_RO_SIZE); i++)
+    {
+        back[addr + i] = data[i];
+    }
+
+    i2cSlaveUnlock(port);
+}
+
+/**
+ * @brief Publish the back copy to the master
+ *
+ * @return void
+ */
+void i2cSlaveCommit(i2cSlavePort_t port)
+{
+    i2cSlaveLock(port);
+
+    if(!i2cSlaveBusy[port])
+    {
+        /*No transfer addressed to us: publish now*/
+        i2cSlaveSwap(port);
+    }
+    else
+    {
+        /*Transfer in progress: publish when it ends*/
+        i2cSlaveSwapPending[port] = 1;
+    }
+
+    i2cSlaveUnlock(port);
+}
+
+/**
+ * @brief Read registers
+ *
+ * @return void
+ */
+void i2cSlaveRead(i2cSlavePort_t port, uint8_t addr, uint8_t *data, uint8_t len)
+{
+    const uint8_t *front = i2cSlaveRegs[port][i2cSlaveFront[port]];
+
+    for(uint32_t i = 0; (i < len) && ((addr + i) < I2C_SLAVE_REG_SIZE); i++)
+    {
+        data[i] = front[addr + i];
+    }
+}
+
+/**
+ * @brief Register the master-write notification
+ *
+ * @return void
+ */
+void i2cSlaveSetWriteCallback(i2cSlavePort_t port, i2cSlaveWriteCallback_t callback)
+{
+    i2cSlaveCallback[port] = callback;
+}
+
+/**
+ * @brief Number of transfers addressed to a port
+ *
+ * @return Transfer count
+ */
+uint32_t i2cSlaveGetTransactions(i2cSlavePort_t port)
+{
+    return i2cSlaveTransactions[port];
+}
+
+/**
+ * @brief Number of bus errors and discarded writes on a port
+ *
+ * @return Error count
+ */
+uint32_t i2cSlaveGetErrors(i2cSlavePort_t port)
+{
+    return i2cSlaveErrors[port];
+}
+
+/**
+ * @brief I2C2 event interrupt handler
+ *
+ * @return void
+ */
+void I2C2_EV_IRQHandler(void)
+{
+    i2cSlaveEvent(I2C_SLAVE_PORT2);
+}
+
+/**
+ * @brief I2C2 error interrupt handler
+ *
+ * @return void
+ */
+void I2C2_ER_IRQHandler(void)
+{
+    i2cSlaveError(I2C_SLAVE_PORT2);
+}
+
+/**
+ * @brief I2C3 event interrupt handler
+ *
+ * @return void
+ */
+void I2C3_EV_IRQHandler(void)
+{
+    i2cSlaveEvent(I2C_SLAVE_PORT3);
+}
+
+/**
+ * @brief I2C3 error interrupt handler
+ *
+ * @return void
+ */
+void I2C3_ER_IRQHandler(void)
+{
+    i2cSlaveError(I2C_SLAVE_PORT3);
+}
@@ -0,0 +1,432 @@
+/**
+ * @file l3gd20.c
+ * @brief L3GD20 gyroscope streaming driver implementation for STM32F411
+ *
+ * Register setup is done with the blocking spi1Transmit()/spi1Receive()
+ * functions. Streaming is interrupt driven: the FIFO watermark edge on
+ * PE1 starts a full-duplex SPI1 DMA burst, and the RX DMA complete
+ * interrupt unpacks the batch into the ring buffer.
+ *
+ * SPI1 is shared with the external flash. Every transfer holds the bus
+ * lock from spi.h; a watermark edge that finds the bus taken marks the
+ * burst deferred, and the release callback re-enters the EXTI1 handler
+ * (software pending) to start it once the flash command is done.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "l3gd20.h"
+#include "spi.h"
+#include "dma.h"
+#include "exti.h"
+#include "timer.h"
+
+#define L3GD20_WHO_AM_I         0x0FU
+#define L3GD20_CTRL_REG1        0x20U
+#define L3GD20_CTRL_REG3        0x22U
+#define L3GD20_CTRL_REG4        0x23U
+#define L3GD20_CTRL_REG5        0x24U
+#define L3GD20_OUT_X_L          0x28U
+#define L3GD20_FIFO_CTRL_REG    0x2EU
+
+#define L3GD20_ID               0xD4U
+#define I3G4250D_ID             0xD3U
+
+#define SPI_ADDR_READ           (1U<<7)
+#define SPI_ADDR_AUTOINC        (1U<<6)
+
+#define CTRL1_ODR760_BW100_XYZ  0xFFU   // DR=11, BW=11, PD=1, Zen=Yen=Xen=1
+#define CTRL3_I2_WTM            (1U<<2)
+#define CTRL4_FS_250DPS         0x00U
+#define CTRL5_FIFO_EN           (1U<<6)
+#define FIFO_MODE_BYPASS        (0U<<5)
+#define FIFO_MODE_STREAM        (2U<<5)
+
+#define L3GD20_BYTES_PER_SAMPLE 6U
+#define L3GD20_BURST_LEN        (1U + (L3GD20_BYTES_PER_SAMPLE * L3GD20_FIFO_WATERMARK))
+
+/*SPI1 DMA requests: RX = DMA2 Stream2, TX = DMA2 Stream3, both channel 3*/
+#define L3GD20_DMA_RX_STREAM    2U
+#define L3GD20_DMA_TX_STREAM    3U
+#define L3GD20_DMA_CHANNEL      3U
+
+static uint8_t l3gd20TxBuf[L3GD20_BURST_LEN];
+static uint8_t l3gd20RxBuf[L3GD20_BURST_LEN];
+
+static l3gd20Sample_t l3gd20Ring[L3GD20_RING_SIZE];
+static volatile uint32_t l3gd20RingHead;
+static volatile uint32_t l3gd20RingTail;
+static volatile uint32_t l3gd20Dropped;
+
+static volatile uint8_t l3gd20Busy;
+static volatile uint8_t l3gd20Deferred;
+static uint32_t l3gd20EdgeTime;
+static uint32_t l3gd20BatchTime;
+static uint32_t l3gd20LastEdge;
+static uint8_t l3gd20HaveEdge;
+/** Measured sample period in 1/256 microsecond */
+static uint32_t l3gd20PeriodQ8;
+
+/**
+ * @brief Select the gyroscope (PE3 low)
+ *
+ * @return void
+ */
+static void l3gd20CsEnable(void)
+{
+    GPIOE->BSRR = GPIO_BSRR_BR3;
+}
+
+/**
+ * @brief Deselect the gyroscope (PE3 high)
+ *
+ * @return void
+ */
+static void l3gd20CsDisable(void)
+{
+    GPIOE->BSRR = GPIO_BSRR_BS3;
+}
+
+/**
+ * @brief Write one sensor register (blocking)
+ *
+ * @param[in] reg Register address
+ * @param[in] value Value to write
+ *
+ * @return void
+ */
+static void l3gd20WriteReg(uint8_t reg, uint8_t value)
+{
+    uint8_t frame[2];
+
+    frame[0] = reg & 0x3FU;
+    frame[1] = value;
+
+    spi1Lock();
+    l3gd20CsEnable();
+    spi1Transmit(frame, 2);
+    l3gd20CsDisable();
+    spi1Unlock();
+}
+
+/**
+ * @brief Read one sensor register (blocking)
+ *
+ * @param[in] reg Register address
+ *
+ * @return Register value
+ */
+static uint8_t l3gd20ReadReg(uint8_t reg)
+{
+    uint8_t cmd = (reg & 0x3FU) | SPI_ADDR_READ;
+    uint8_t value;
+
+    spi1Lock();
+    l3gd20CsEnable();
+    spi1Transmit(&cmd, 1);
+    spi1Receive(&value, 1);
+    l3gd20CsDisable();
+    spi1Unlock();
+
+    return value;
+}
+
+/**
+ * @brief Refine the sample period from the watermark edge spacing
+ *
+ * Each edge follows exactly L3GD20_FIFO_WATERMARK new samples, so the
+ * edge interval divided by the watermark is one sample period. The
+ * estimate tracks the sensor's real ODR with a 1/8 smoothing factor.
+ *
+ * @param[in] now Edge timestamp in microseconds
+ *
+ * @return void
+ */
+static void l3gd20UpdatePeriod(uint32_t now)
+{
+    uint32_t nominal = (1000000U << 8) / L3GD20_ODR_HZ;
+    uint32_t measured;
+
+    if(l3gd20HaveEdge)
+    {
+        measured = ((now - l3gd20LastEdge) << 8) / L3GD20_FIFO_WATERMARK;
+
+        /*Ignore intervals distorted by a missed or restarted batch*/
+        if((measured > (nominal / 2U)) && (measured < (nominal * 2U)))
+        {
+            l3gd20PeriodQ8 = (uint32_t)((int32_t)l3gd20PeriodQ8 +
+                             (((int32_t)measured - (int32_t)l3gd20PeriodQ8) / 8));
+        }
+    }
+
+    l3gd20LastEdge = now;
+    l3gd20HaveEdge = 1;
+}
+
+/**
+ * @brief Start a DMA burst that drains one watermark batch
+ *
+ * @param[in] timestamp Time at which the newest sample was latched
+ *
+ * @return void
+ * @note The caller owns the SPI1 bus lock
+ */
+static void l3gd20StartBurst(uint32_t timestamp)
+{
+    volatile uint32_t tmp;
+
+    l3gd20BatchTime = timestamp;
+    l3gd20Busy = 1;
+
+    /*Drop a stale byte left by a blocking transfer*/
+    tmp = SPI1->DR;
+    (void)tmp;
+
+    dmaClearFlags(DMA2, L3GD20_DMA_RX_STREAM, DMA_FLAG_ALL);
+    dmaClearFlags(DMA2, L3GD20_DMA_TX_STREAM, DMA_FLAG_ALL);
+    dmaGetStream(DMA2, L3GD20_DMA_RX_STREAM)->NDTR = L3GD20_BURST_LEN;
+    dmaGetStream(DMA2, L3GD20_DMA_TX_STREAM)->NDTR = L3GD20_BURST_LEN;
+
+    l3gd20CsEnable();
+
+    /*RX request first so no received byte is missed, TX request starts the clock*/
+    SPI1->CR2 |= SPI_CR2_RXDMAEN;
+    dmaStreamStart(DMA2, L3GD20_DMA_RX_STREAM);
+    dmaStreamStart(DMA2, L3GD20_DMA_TX_STREAM);
+    SPI1->CR2 |= SPI_CR2_TXDMAEN;
+}
+
+/**
+ * @brief SPI1 release callback
+ *
+ * A burst deferred while another driver held the bus is started from the
+ * EXTI1 handler, so it never races with a real watermark edge.
+ *
+ * @return void
+ */
+static void l3gd20BusReleased(void)
+{
+    if(l3gd20Deferred)
+    {
+        NVIC_SetPendingIRQ(EXTI1_IRQn);
+    }
+}
+
+/**
+ * @brief Unpack the received batch into the ring buffer
+ *
+ * The newest sample gets the batch timestamp; older samples are spaced
+ * backwards by the measured sample period.
+ *
+ * @return void
+ */
+static void l3gd20PushBatch(void)
+{
+    const uint8_t *p = &l3gd20RxBuf[1];
+    l3gd20Sample_t *s;
+    uint32_t next;
+
+    for(uint32_t i = 0; i < L3GD20_FIFO_WATERMARK; i++, p += L3GD20_BYTES_PER_SAMPLE)
+    {
+        next = (l3gd20RingHead + 1U) & (L3GD20_RING_SIZE - 1U);
+        if(next == l3gd20RingTail)
+        {
+            l3gd20Dropped++;
+            continue;
+        }
+
+        s = &l3gd20Ring[l3gd20RingHead];
+        s->timestamp = l3gd20BatchTime - (((L3GD20_FIFO_WATERMARK - 1U - i) * l3gd20PeriodQ8) >> 8);
+        s->x = (int16_t)(p[0] | (p[1] << 8));
+        s->y = (int16_t)(p[2] | (p[3] << 8));
+        s->z = (int16_t)(p[4] | (p[5] << 8));
+
+        l3gd20RingHead = next;
+    }
+}
+
+/**
+ * @brief Initialize the gyroscope in FIFO streaming mode
+ *
+ * @return 1 if the sensor was found, 0 otherwise
+ */
+uint8_t l3gd20Init(void)
+{
+    uint8_t id;
+
+    tim5TimebaseInit();
+
+    /*Configure SPI1 pins and peripheral*/
+    spiInit();
+    spi1Config();
+
+    /*Set PE3 as output for the gyroscope chip select*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOEEN;
+    GPIOE->MODER &= ~GPIO_MODER_MODER3_1;
+    GPIOE->MODER |= GPIO_MODER_MODER3_0;
+    l3gd20CsDisable();
+
+    /*Check the device identity*/
+    id = l3gd20ReadReg(L3GD20_WHO_AM_I);
+    if((id != L3GD20_ID) && (id != I3G4250D_ID))
+    {
+        return 0;
+    }
+
+    /*760 Hz output, 100 Hz cut-off, all axes, 250 dps full scale*/
+    l3gd20WriteReg(L3GD20_CTRL_REG1, CTRL1_ODR760_BW100_XYZ);
+    l3gd20WriteReg(L3GD20_CTRL_REG4, CTRL4_FS_250DPS);
+
+    /*Bypass mode empties the FIFO, then stream with the watermark*/
+    l3gd20WriteReg(L3GD20_FIFO_CTRL_REG, FIFO_MODE_BYPASS);
+    l3gd20WriteReg(L3GD20_CTRL_REG5, CTRL5_FIFO_EN);
+    l3gd20WriteReg(L3GD20_FIFO_CTRL_REG, FIFO_MODE_STREAM | (L3GD20_FIFO_WATERMARK & 0x1FU));
+
+    /*Route the FIFO watermark to INT2*/
+    l3gd20WriteReg(L3GD20_CTRL_REG3, CTRL3_I2_WTM);
+
+    /*Burst command: read from OUT_X_L with auto-increment, the rest is clock filler*/
+    l3gd20TxBuf[0] = L3GD20_OUT_X_L | SPI_ADDR_READ | SPI_ADDR_AUTOINC;
+
+    /*Configure the SPI1 DMA streams*/
+    dmaStreamConfig(DMA2, L3GD20_DMA_RX_STREAM, L3GD20_DMA_CHANNEL,
+                    DMA_SxCR_MINC | DMA_SxCR_PL_1 | DMA_SxCR_TCIE | DMA_SxCR_TEIE,
+                    &SPI1->DR, l3gd20RxBuf, L3GD20_BURST_LEN);
+    dmaStreamConfig(DMA2, L3GD20_DMA_TX_STREAM, L3GD20_DMA_CHANNEL,
+                    DMA_SxCR_MINC | DMA_SxCR_PL_1 | DMA_SxCR_DIR_0,
+                    &SPI1->DR, l3gd20TxBuf, L3GD20_BURST_LEN);
+    NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+
+    l3gd20PeriodQ8 = (1000000U << 8) / L3GD20_ODR_HZ;
+    l3gd20HaveEdge = 0;
+    l3gd20Busy = 0;
+    l3gd20Deferred = 0;
+    spi1SetReleaseCallback(l3gd20BusReleased);
+
+    /*Watermark interrupt on PE1*/
+    pe1ExtiInit();
+
+    /*Watermark already reached: no edge will come, drain now*/
+    if(GPIOE->IDR & GPIO_IDR_ID1)
+    {
+        l3gd20EdgeTime = timGetMicros();
+        l3gd20Deferred = 1;
+        NVIC_SetPendingIRQ(EXTI1_IRQn);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Pop the oldest sample from the ring buffer
+ *
+ * @param[out] sample Destination
+ *
+ * @return 1 if a sample was returned, 0 if empty
+ */
+uint8_t l3gd20ReadSample(l3gd20Sample_t *sample)
+{
+    uint32_t tail = l3gd20RingTail;
+
+    if(tail == l3gd20RingHead)
+    {
+        return 0;
+    }
+
+    *sample = l3gd20Ring[tail];
+    l3gd20RingTail = (tail + 1U) & (L3GD20_RING_SIZE - 1U);
+    return 1;
+}
+
+/**
+ * @brief Number of samples lost because the ring buffer was full
+ *
+ * @return Dropped sample count
+ */
+uint32_t l3gd20GetDropped(void)
+{
+    return l3gd20Dropped;
+}
+
+/**
+ * @brief EXTI1 interrupt handler (PE1, FIFO watermark)
+ *
+ * Timestamps the edge and starts draining the FIFO if SPI1 is free.
+ * Also entered without an edge (EXTI pending bit clear) when the bus is
+ * released with a burst deferred.
+ *
+ * @return void
+ */
+void EXTI1_IRQHandler(void)
+{
+    uint32_t now = timGetMicros();
+
+    if(EXTI->PR & EXTI_PR_PR1)
+    {
+        /*Clear pending flag*/
+        EXTI->PR = EXTI_PR_PR1;
+
+        l3gd20UpdatePeriod(now);
+
+        if(!l3gd20Busy)
+        {
+            l3gd20EdgeTime = now;
+            l3gd20Deferred = 1;
+        }
+    }
+
+    /*The batch read is the one present at the edge: keep its timestamp*/
+    if(l3gd20Deferred && spi1TryLock())
+    {
+        l3gd20Deferred = 0;
+        l3gd20StartBurst(l3gd20EdgeTime);
+    }
+}
+
+/**
+ * @brief DMA2 Stream2 interrupt handler (SPI1 RX complete)
+ *
+ * Ends the burst, stores the samples and restarts immediately if the
+ * watermark line is still high (more samples arrived during the read),
+ * keeping the SPI1 bus; otherwise the bus is released. A restarted batch
+ * had no edge of its own: the FIFO hands out samples in order, so its
+ * newest sample is one batch of sample periods after the previous one.
+ *
+ * @return void
+ */
+void DMA2_Stream2_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA2, L3GD20_DMA_RX_STREAM);
+
+    dmaClearFlags(DMA2, L3GD20_DMA_RX_STREAM, flags);
+
+    if(!(flags & (DMA_FLAG_TC | DMA_FLAG_TE)))
+    {
+        return;
+    }
+
+    /*Wait for the last frame to leave the shift register*/
+    while(SPI1->SR & SPI_SR_BSY){}
+
+    l3gd20CsDisable();
+    SPI1->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+
+    if(flags & DMA_FLAG_TC)
+    {
+        l3gd20PushBatch();
+    }
+
+    l3gd20Busy = 0;
+
+    if(GPIOE->IDR & GPIO_IDR_ID1)
+    {
+        /*No edge for this batch: it directly follows the one just read*/
+        l3gd20StartBurst(l3gd20BatchTime + ((L3GD20_FIFO_WATERMARK * l3gd20PeriodQ8) >> 8));
+    }
+    else
+    {
+        spi1Unlock();
+    }
+}
@@ -0,0 +1,673 @@
+/**
+ * @file lcd.c
+ * @brief ILI9341/ST7789 SPI display driver implementation
+ *
+ * Commands are written with blocking 8-bit SPI2 transfers. Pixel data
+ * is streamed line by line with DMA1 Stream4 in 16-bit frame mode; the
+ * transfer-complete interrupt starts the next line (already expanded)
+ * and then expands the following one into the buffer just released.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "lcd.h"
+#include "dma.h"
+#include "systick.h"
+
+#define LCD_CMD_SWRESET     0x01U
+#define LCD_CMD_SLPOUT      0x11U
+#define LCD_CMD_INVON       0x21U
+#define LCD_CMD_DISPON      0x29U
+#define LCD_CMD_CASET       0x2AU
+#define LCD_CMD_RASET       0x2BU
+#define LCD_CMD_RAMWR       0x2CU
+#define LCD_CMD_MADCTL      0x36U
+#define LCD_CMD_COLMOD      0x3AU
+
+#define LCD_COLMOD_16BIT    0x55U
+
+#define LCD_TILE_COLS       ((LCD_WIDTH + LCD_TILE_SIZE - 1U) / LCD_TILE_SIZE)
+#define LCD_TILE_ROWS       ((LCD_HEIGHT + LCD_TILE_SIZE - 1U) / LCD_TILE_SIZE)
+#define LCD_FB_STRIDE       (LCD_WIDTH / 2U)
+
+/*SPI2_TX request: DMA1 Stream4, channel 0*/
+#define LCD_DMA_STREAM      4U
+#define LCD_DMA_CHANNEL     0U
+
+/** 4 bpp framebuffer, even pixel in the low nibble */
+static uint8_t lcdFb[LCD_FB_STRIDE * LCD_HEIGHT];
+/** Expanded RGB565 line buffers (ping-pong) */
+static uint16_t lcdLineBuf[2][LCD_WIDTH];
+
+static uint16_t lcdPalette[LCD_PALETTE_SIZE] =
+{
+    0x0000U, 0xFFFFU, 0xF800U, 0x07E0U, 0x001FU, 0xFFE0U, 0x07FFU, 0xF81FU,
+    0x8410U, 0x4208U, 0xFD20U, 0x8000U, 0x0400U, 0x0010U, 0xC618U, 0x2104U
+};
+
+/** Tiles changed by drawing since the last flush (bit = tile column) */
+static uint16_t lcdDirty[LCD_TILE_ROWS];
+/** Tiles still to be sent by the running flush */
+static uint16_t lcdFlushMap[LCD_TILE_ROWS];
+
+static volatile uint8_t lcdBusy;
+static uint16_t lcdScanRow;
+static uint16_t lcdRectX0;
+static uint16_t lcdRectX1;
+static uint16_t lcdRectY0;
+static uint16_t lcdRectY1;
+static uint16_t lcdLine;
+static volatile uint32_t lcdBytesSent;
+
+/**
+ * @brief Select the panel (PB12 low)
+ *
+ * @return void
+ */
+static void lcdCsEnable(void)
+{
+    GPIOB->BSRR = GPIO_BSRR_BR12;
+}
+
+/**
+ * @brief Deselect the panel (PB12 high)
+ *
+ * @return void
+ */
+static void lcdCsDisable(void)
+{
+    GPIOB->BSRR = GPIO_BSRR_BS12;
+}
+
+/**
+ * @brief Mark the following bytes as a command (PB1 low)
+ *
+ * @return void
+ */
+static void lcdDcCommand(void)
+{
+    GPIOB->BSRR = GPIO_BSRR_BR1;
+}
+
+/**
+ * @brief Mark the following bytes as data (PB1 high)
+ *
+ * @return void
+ */
+static void lcdDcData(void)
+{
+    GPIOB->BSRR = GPIO_BSRR_BS1;
+}
+
+/**
+ * @brief Wait until SPI2 has shifted out everything
+ *
+ * @return void
+ */
+static void lcdSpiWaitIdle(void)
+{
+    while(!(SPI2->SR & SPI_SR_TXE)){}
+    while(SPI2->SR & SPI_SR_BSY){}
+}
+
+/**
+ * @brief Switch SPI2 between 8-bit and 16-bit frames
+ *
+ * DFF may only change while the SPI is disabled.
+ *
+ * @param[in] wide 1 for 16-bit frames, 0 for 8-bit frames
+ *
+ * @return void
+ */
+static void lcdSpiFrame16(uint8_t wide)
+{
+    lcdSpiWaitIdle();
+    SPI2->CR1 &= ~SPI_CR1_SPE;
+    if(wide)
+    {
+        SPI2->CR1 |= SPI_CR1_DFF;
+    }
+    else
+    {
+        SPI2->CR1 &= ~SPI_CR1_DFF;
+    }
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+
+/**
+ * @brief Send bytes on SPI2 (blocking, 8-bit frames)
+ *
+ * @param[in] data Bytes to send
+ * @param[in] size Number of bytes
+ *
+ * @return void
+ */
+static void lcdSpiWrite(const uint8_t *data, uint32_t size)
+{
+    for(uint32_t i = 0; i < size; i++)
+    {
+        while(!(SPI2->SR & SPI_SR_TXE)){}
+        SPI2->DR = data[i];
+    }
+    lcdSpiWaitIdle();
+}
+
+/**
+ * @brief Send a command and its parameters
+ *
+ * @param[in] cmd Command byte
+ * @param[in] params Parameter bytes (may be 0 when size is 0)
+ * @param[in] size Number of parameter bytes
+ *
+ * @return void
+ * @note Leaves D/C high so pixel data can follow
+ */
+static void lcdWriteCmd(uint8_t cmd, const uint8_t *params, uint32_t size)
+{
+    lcdDcCommand();
+    lcdSpiWrite(&cmd, 1);
+    lcdDcData();
+    if(size)
+    {
+        lcdSpiWrite(params, size);
+    }
+    lcdBytesSent += 1U + size;
+}
+
+/**
+ * @brief Mark the tiles covering a pixel area dirty
+ *
+ * @param[in] x0 Left column
+ * @param[in] y0 Top row
+ * @param[in] x1 Right column (inclusive)
+ * @param[in] y1 Bottom row (inclusive)
+ *
+ * @return void
+ */
+static void lcdMarkDirty(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+    uint16_t c0 = x0 / LCD_TILE_SIZE;
+    uint16_t c1 = x1 / LCD_TILE_SIZE;
+    uint16_t mask = (uint16_t)(((1U << (c1 - c0 + 1U)) - 1U) << c0);
+
+    for(uint16_t r = y0 / LCD_TILE_SIZE; r <= (y1 / LCD_TILE_SIZE); r++)
+    {
+        lcdDirty[r] |= mask;
+    }
+}
+
+/**
+ * @brief Write one pixel into the framebuffer without dirty marking
+ *
+ * @return void
+ */
+static void lcdPutPixel(uint16_t x, uint16_t y, uint8_t color)
+{
+    uint8_t *p = &lcdFb[(y * LCD_FB_STRIDE) + (x >> 1)];
+
+    if(x & 1U)
+    {
+        *p = (uint8_t)((*p & 0x0FU) | ((color & 0x0FU) << 4));
+    }
+    else
+    {
+        *p = (uint8_t)((*p & 0xF0U) | (color & 0x0FU));
+    }
+}
+
+/**
+ * @brief Take the next rectangle out of the flush map
+ *
+ * Finds the first horizontal run of dirty tiles and extends it down
+ * over the following tile rows that have the same run dirty.
+ *
+ * @return 1 if a rectangle was found, 0 when the flush map is empty
+ */
+static uint8_t lcdNextRect(void)
+{
+    uint16_t map;
+    uint16_t run;
+    uint16_t c0;
+    uint16_t c1;
+    uint16_t r1;
+
+    for(; lcdScanRow < LCD_TILE_ROWS; lcdScanRow++)
+    {
+        map = lcdFlushMap[lcdScanRow];
+        if(map == 0U)
+        {
+            continue;
+        }
+
+        c0 = (uint16_t)__builtin_ctz(map);
+        c1 = c0;
+        while(((c1 + 1U) < LCD_TILE_COLS) && (map & (1U << (c1 + 1U))))
+        {
+            c1++;
+        }
+        run = (uint16_t)(((1U << (c1 - c0 + 1U)) - 1U) << c0);
+        lcdFlushMap[lcdScanRow] &= (uint16_t)~run;
+
+        r1 = lcdScanRow;
+        while(((r1 + 1U) < LCD_TILE_ROWS) && ((lcdFlushMap[r1 + 1U] & run) == run))
+        {
+            r1++;
+            lcdFlushMap[r1] &= (uint16_t)~run;
+        }
+
+        lcdRectX0 = c0 * LCD_TILE_SIZE;
+        lcdRectX1 = ((c1 + 1U) * LCD_TILE_SIZE) - 1U;
+        lcdRectY0 = lcdScanRow * LCD_TILE_SIZE;
+        lcdRectY1 = ((r1 + 1U) * LCD_TILE_SIZE) - 1U;
+        if(lcdRectX1 >= LCD_WIDTH)
+        {
+            lcdRectX1 = LCD_WIDTH - 1U;
+        }
+        if(lcdRectY1 >= LCD_HEIGHT)
+        {
+            lcdRectY1 = LCD_HEIGHT - 1U;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Expand one framebuffer line of the current rectangle to RGB565
+ *
+ * @param[out] dst Line buffer
+ * @param[in] y Row to expand
+ *
+ * @return void
+ */
+static void lcdExpandLine(uint16_t *dst, uint16_t y)
+{
+    const uint8_t *src = &lcdFb[y * LCD_FB_STRIDE];
+
+    for(uint16_t x = lcdRectX0; x <= lcdRectX1; x++)
+    {
+        *dst++ = lcdPalette[(src[x >> 1] >> ((x & 1U) << 2)) & 0x0FU];
+    }
+}
+
+/**
+ * @brief Send one expanded line by DMA
+ *
+ * @param[in] buf Line buffer index
+ *
+ * @return void
+ */
+static void lcdSendLine(uint32_t buf)
+{
+    DMA_Stream_TypeDef *s = dmaGetStream(DMA1, LCD_DMA_STREAM);
+    uint16_t width = (uint16_t)(lcdRectX1 - lcdRectX0 + 1U);
+
+    dmaClearFlags(DMA1, LCD_DMA_STREAM, DMA_FLAG_ALL);
+    s->M0AR = (uint32_t)lcdLineBuf[buf];
+    s->NDTR = width;
+    dmaStreamStart(DMA1, LCD_DMA_STREAM);
+
+    lcdBytesSent += 2U * width;
+}
+
+/**
+ * @brief Open the next rectangle, or end the flush
+ *
+ * @return void
+ */
+static void lcdStartRect(void)
+{
+    uint8_t window[4];
+    volatile uint32_t tmp;
+
+    lcdSpiFrame16(0);
+
+    if(!lcdNextRect())
+    {
+        lcdCsDisable();
+        SPI2->CR2 &= ~SPI_CR2_TXDMAEN;
+
+        /*Clear OVR left by the unused receive side*/
+        tmp = SPI2->DR;
+        tmp = SPI2->SR;
+        (void)tmp;
+
+        lcdBusy = 0;
+        return;
+    }
+
+    /*Set the address window*/
+    window[0] = (uint8_t)(lcdRectX0 >> 8);
+    window[1] = (uint8_t)(lcdRectX0);
+    window[2] = (uint8_t)(lcdRectX1 >> 8);
+    window[3] = (uint8_t)(lcdRectX1);
+    lcdWriteCmd(LCD_CMD_CASET, window, 4);
+
+    window[0] = (uint8_t)(lcdRectY0 >> 8);
+    window[1] = (uint8_t)(lcdRectY0);
+    window[2] = (uint8_t)(lcdRectY1 >> 8);
+    window[3] = (uint8_t)(lcdRectY1);
+    lcdWriteCmd(LCD_CMD_RASET, window, 4);
+
+    lcdWriteCmd(LCD_CMD_RAMWR, 0, 0);
+
+    /*Pixels go out as 16-bit frames, MSB first as the panel expects*/
+    lcdSpiFrame16(1);
+
+    /*Both buffers are filled before the first DMA so the ISR never races the expansion*/
+    lcdLine = lcdRectY0;
+    lcdExpandLine(lcdLineBuf[0], lcdLine);
+    if(lcdLine < lcdRectY1)
+    {
+        lcdExpandLine(lcdLineBuf[1], lcdLine + 1U);
+    }
+    lcdSendLine(0);
+}
+
+/**
+ * @brief Configure PB0/PB1/PB12 as outputs and PB13/PB15 as SPI2
+ *
+ * @return void
+ */
+static void lcdGpioInit(void)
+{
+    /*Enable clock access to GPIOB*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+
+    /*PB0, PB1, PB12 general purpose output*/
+    GPIOB->MODER &= ~(GPIO_MODER_MODER0_1 | GPIO_MODER_MODER1_1 | GPIO_MODER_MODER12_1);
+    GPIOB->MODER |= (GPIO_MODER_MODER0_0 | GPIO_MODER_MODER1_0 | GPIO_MODER_MODER12_0);
+
+    /*PB13, PB15 alternate function*/
+    GPIOB->MODER &= ~(GPIO_MODER_MODER13_0 | GPIO_MODER_MODER15_0);
+    GPIOB->MODER |= (GPIO_MODER_MODER13_1 | GPIO_MODER_MODER15_1);
+
+    /*PB13, PB15 alternate function type to SPI2 (AF5)*/
+    GPIOB->AFR[1] &= ~(GPIO_AFRH_AFSEL13 | GPIO_AFRH_AFSEL15);
+    GPIOB->AFR[1] |= (GPIO_AFRH_AFSEL13_0 | GPIO_AFRH_AFSEL13_2);
+    GPIOB->AFR[1] |= (GPIO_AFRH_AFSEL15_0 | GPIO_AFRH_AFSEL15_2);
+
+    /*Idle levels: deselected, data, out of reset*/
+    lcdCsDisable();
+    lcdDcData();
+    GPIOB->BSRR = GPIO_BSRR_BS0;
+}
+
+/**
+ * @brief Configure SPI2 as transmit master
+ *
+ * - Clock prescaler fPCLK/2 (8 MHz)
+ * - CPOL = 0, CPHA = 0, MSB first, 8-bit frames
+ * - Software slave management (SSM = 1, SSI = 1)
+ *
+ * @return void
+ */
+static void lcdSpiInit(void)
+{
+    /*Enable clock access to SPI2*/
+    RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+
+    SPI2->CR1 = SPI_CR1_MSTR | SPI_CR1_SSM | SPI_CR1_SSI;
+    SPI2->CR2 = 0;
+
+    /*Enable SPI module*/
+    SPI2->CR1 |= SPI_CR1_SPE;
+}
+
+/**
+ * @brief Initialize SPI2, the control pins and the panel
+ *
+ * @return void
+ */
+void lcdInit(void)
+{
+    uint8_t param;
+
+    lcdGpioInit();
+    lcdSpiInit();
+
+    /*Hardware reset*/
+    GPIOB->BSRR = GPIO_BSRR_BR0;
+    systickMsecDelay(10);
+    GPIOB->BSRR = GPIO_BSRR_BS0;
+    systickMsecDelay(120);
+
+    lcdCsEnable();
+
+    lcdWriteCmd(LCD_CMD_SWRESET, 0, 0);
+    systickMsecDelay(120);
+
+    lcdWriteCmd(LCD_CMD_SLPOUT, 0, 0);
+    systickMsecDelay(120);
+
+    param = LCD_COLMOD_16BIT;
+    lcdWriteCmd(LCD_CMD_COLMOD, &param, 1);
+
+    param = LCD_MADCTL;
+    lcdWriteCmd(LCD_CMD_MADCTL, &param, 1);
+
+    if(LCD_INVERT)
+    {
+        lcdWriteCmd(LCD_CMD_INVON, 0, 0);
+    }
+
+    lcdWriteCmd(LCD_CMD_DISPON, 0, 0);
+
+    lcdCsDisable();
+
+    /*Pixel DMA: memory to SPI2, 16-bit items*/
+    dmaStreamConfig(DMA1, LCD_DMA_STREAM, LCD_DMA_CHANNEL,
+                    DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_PSIZE_0 | DMA_SxCR_MSIZE_0 |
+                    DMA_SxCR_PL_0 | DMA_SxCR_TCIE | DMA_SxCR_TEIE,
+                    &SPI2->DR, lcdLineBuf[0], 0);
+    NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+
+    lcdBusy = 0;
+    lcdFillRect(0, 0, LCD_WIDTH, LCD_HEIGHT, 0);
+}
+
+/**
+ * @brief Set a palette entry
+ *
+ * @return void
+ */
+void lcdSetPalette(uint8_t index, uint16_t rgb565)
+{
+    lcdPalette[index & (LCD_PALETTE_SIZE - 1U)] = rgb565;
+}
+
+/**
+ * @brief Set one pixel
+ *
+ * @return void
+ */
+void lcdSetPixel(uint16_t x, uint16_t y, uint8_t color)
+{
+    if((x >= LCD_WIDTH) || (y >= LCD_HEIGHT))
+    {
+        return;
+    }
+
+    lcdPutPixel(x, y, color);
+    lcdMarkDirty(x, y, x, y);
+}
+
+/**
+ * @brief Fill a rectangle (clipped to the screen)
+ *
+ * Whole bytes are written when both pixels of the pair are inside the
+ * rectangle, so wide fills cost one store per two pixels.
+ *
+ * @return void
+ */
+void lcdFillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t color)
+{
+    uint8_t pair = (uint8_t)((color & 0x0FU) | ((color & 0x0FU) << 4));
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t cx;
+
+    if((x >= LCD_WIDTH) || (y >= LCD_HEIGHT) || (w == 0U) || (h == 0U))
+    {
+        return;
+    }
+
+    x1 = ((uint32_t)x + w > LCD_WIDTH) ? (LCD_WIDTH - 1U) : (uint16_t)(x + w - 1U);
+    y1 = ((uint32_t)y + h > LCD_HEIGHT) ? (LCD_HEIGHT - 1U) : (uint16_t)(y + h - 1U);
+
+    for(uint16_t cy = y; cy <= y1; cy++)
+    {
+        cx = x;
+        if(cx & 1U)
+        {
+            lcdPutPixel(cx++, cy, color);
+        }
+        for(; (cx + 1U) <= x1; cx += 2U)
+        {
+            lcdFb[(cy * LCD_FB_STRIDE) + (cx >> 1)] = pair;
+        }
+        if(cx == x1)
+        {
+            lcdPutPixel(cx, cy, color);
+        }
+    }
+
+    lcdMarkDirty(x, y, x1, y1);
+}
+
+/**
+ * @brief Draw a 1 bit per pixel bitmap
+ *
+ * @return void
+ */
+void lcdDrawBitmap(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                   const uint8_t *bits, uint8_t fg, uint8_t bg)
+{
+    uint16_t stride = (uint16_t)((w + 7U) / 8U);
+    uint16_t x1 = x;
+    uint16_t y1 = y;
+
+    for(uint16_t row = 0; row < h; row++)
+    {
+        if((y + row) >= LCD_HEIGHT)
+        {
+            break;
+        }
+        for(uint16_t col = 0; col < w; col++)
+        {
+            if((x + col) >= LCD_WIDTH)
+            {
+                break;
+            }
+            lcdPutPixel(x + col, y + row,
+                        (bits[(row * stride) + (col >> 3)] & (0x80U >> (col & 7U))) ? fg : bg);
+            x1 = x + col;
+        }
+        y1 = y + row;
+    }
+
+    if((x < LCD_WIDTH) && (y < LCD_HEIGHT) && (w != 0U) && (h != 0U))
+    {
+        lcdMarkDirty(x, y, x1, y1);
+    }
+}
+
+/**
+ * @brief Mark the whole screen dirty
+ *
+ * @return void
+ */
+void lcdInvalidate(void)
+{
+    lcdMarkDirty(0, 0, LCD_WIDTH - 1U, LCD_HEIGHT - 1U);
+}
+
+/**
+ * @brief Start sending the dirty regions to the panel
+ *
+ * @return 1 if started, 0 if busy or nothing to send
+ */
+uint8_t lcdFlush(void)
+{
+    uint16_t any = 0;
+
+    if(lcdBusy)
+    {
+        return 0;
+    }
+
+    /*Snapshot the dirty map; new drawing goes to the next flush*/
+    for(uint32_t r = 0; r < LCD_TILE_ROWS; r++)
+    {
+        lcdFlushMap[r] = lcdDirty[r];
+        lcdDirty[r] = 0;
+        any |= lcdFlushMap[r];
+    }
+
+    if(!any)
+    {
+        return 0;
+    }
+
+    lcdBusy = 1;
+    lcdScanRow = 0;
+    lcdCsEnable();
+    SPI2->CR2 |= SPI_CR2_TXDMAEN;
+    lcdStartRect();
+    return 1;
+}
+
+/**
+ * @brief Check whether a flush is in progress
+ *
+ * @return 1 if busy, 0 otherwise
+ */
+uint8_t lcdIsBusy(void)
+{
+    return lcdBusy;
+}
+
+/**
+ * @brief Total bytes clocked out on SPI2
+ *
+ * @return Byte count
+ */
+uint32_t lcdGetBytesSent(void)
+{
+    return lcdBytesSent;
+}
+
+/**
+ * @brief DMA1 Stream4 interrupt handler (SPI2 TX complete)
+ *
+ * @return void
+ */
+void DMA1_Stream4_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA1, LCD_DMA_STREAM);
+
+    dmaClearFlags(DMA1, LCD_DMA_STREAM, flags);
+
+    if(!(flags & (DMA_FLAG_TC | DMA_FLAG_TE)))
+    {
+        return;
+    }
+
+    lcdLine++;
+
+    /*Rectangle done (or aborted on error): go to the next one*/
+    if((flags & DMA_FLAG_TE) || (lcdLine > lcdRectY1))
+    {
+        lcdStartRect();
+        return;
+    }
+
+    /*Send the line expanded during the previous transfer, then refill the free buffer*/
+    lcdSendLine((uint32_t)(lcdLine - lcdRectY0) & 1U);
+    if(lcdLine < lcdRectY1)
+    {
+        lcdExpandLine(lcdLineBuf[(uint32_t)(lcdLine + 1U - lcdRectY0) & 1U], lcdLine + 1U);
+    }
+}
@@ -0,0 +1,598 @@
+/**
+ * @file logstore.c
+ * @brief Append-only log-structured record store implementation
+ *
+ * Sectors are used in ring order. Each opened sector receives a summary
+ * in page 0 with a sequence number one higher than the previous head.
+ * Committing a data page first clears its bit in the summary bitmap and
+ * then programs the page, so a power loss between the two steps leaves
+ * an erased page that the reader skips.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "logstore.h"
+
+#define LOG_MAGIC               0x53474F4CU
+#define LOG_PAGES_PER_SECTOR    (SPI_FLASH_SECTOR_SIZE / SPI_FLASH_PAGE_SIZE)
+#define LOG_FIRST_DATA_PAGE     1U
+#define LOG_LEN_EMPTY           0xFFFFU
+#define LOG_CRC_INIT            0xFFFFU
+#define LOG_BITMAP_BYTES        ((LOG_SECTOR_COUNT + 7U) / 8U)
+#define LOG_PAGEMAP_OFFSET      10U
+
+/**
+ * @brief Sector summary stored at the start of page 0
+ */
+typedef struct
+{
+    uint32_t magic;     /**< LOG_MAGIC when the sector is in use */
+    uint32_t seq;       /**< Sector sequence number */
+    uint16_t hdrCrc;    /**< CRC of magic and seq */
+    uint16_t pageMap;   /**< Bit n cleared when data page n is committed */
+} logSectorHeader_t;
+
+/** CRC-16/CCITT (poly 0x1021) lookup table */
+static const uint16_t crc16Table[256] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+static uint8_t logPageBuf[LOG_PAGE_BUFFERS][SPI_FLASH_PAGE_SIZE];
+static uint8_t logFillIdx;
+static uint8_t logPendingCount;
+static uint16_t logFillOffset;
+static uint8_t logPageMarked;
+
+static uint8_t logErased[LOG_BITMAP_BYTES];
+static uint8_t logValid[LOG_BITMAP_BYTES];
+
+static uint16_t logHeadSector;
+static uint16_t logHeadPage;
+static uint32_t logHeadSeq;
+static uint8_t logHeadOpen;
+static uint16_t logTailSector;
+static uint32_t logTailSeq;
+static uint8_t logEmpty;
+
+static logStats_t logStats;
+
+/**
+ * @brief Update a CRC-16/CCITT with a block of bytes
+ *
+ * @param[in] crc Current CRC value
+ * @param[in] data Bytes to add
+ * @param[in] size Number of bytes
+ *
+ * @return Updated CRC
+ */
+static uint16_t crc16Update(uint16_t crc, const uint8_t *data, uint32_t size)
+{
+    while(size--)
+    {
+        crc = (uint16_t)((crc << 8) ^ crc16Table[((crc >> 8) ^ *data++) & 0xFFU]);
+    }
+    return crc;
+}
+
+static uint8_t bitmapGet(const uint8_t *map, uint16_t n)
+{
+    return (map[n >> 3] >> (n & 7U)) & 1U;
+}
+
+static void bitmapSet(uint8_t *map, uint16_t n)
+{
+    map[n >> 3] |= (uint8_t)(1U << (n & 7U));
+}
+
+static void bitmapClear(uint8_t *map, uint16_t n)
+{
+    map[n >> 3] &= (uint8_t)~(1U << (n & 7U));
+}
+
+static uint16_t logNextSector(uint16_t sector)
+{
+    return (uint16_t)((sector + 1U) % LOG_SECTOR_COUNT);
+}
+
+static uint32_t logPageAddr(uint16_t sector, uint16_t page)
+{
+    return LOG_FLASH_BASE + ((uint32_t)sector * SPI_FLASH_SECTOR_SIZE) + ((uint32_t)page * SPI_FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief Compute the CRC protecting the summary identity fields
+ *
+ * @param[in] hdr Sector summary
+ *
+ * @return CRC of magic and seq
+ */
+static uint16_t logHeaderCrc(const logSectorHeader_t *hdr)
+{
+    return crc16Update(LOG_CRC_INIT, (const uint8_t *)hdr, 8U);
+}
+
+/**
+ * @brief Fill the current RAM page with the erased pattern
+ *
+ * @return void
+ */
+static void logClearFillPage(void)
+{
+    uint8_t *buf = logPageBuf[logFillIdx];
+
+    for(uint32_t i = 0; i < SPI_FLASH_PAGE_SIZE; i++)
+    {
+        buf[i] = 0xFFU;
+    }
+    logFillOffset = 0;
+}
+
+/**
+ * @brief Hand the current RAM page over to logStorePoll()
+ *
+ * @return LOG_OK or LOG_ERR_FULL when no free buffer is left
+ */
+static logStatus_t logSealFillPage(void)
+{
+    if(logPendingCount >= (LOG_PAGE_BUFFERS - 1U))
+    {
+        return LOG_ERR_FULL;
+    }
+
+    logPendingCount++;
+    logFillIdx = (uint8_t)((logFillIdx + 1U) % LOG_PAGE_BUFFERS);
+    logClearFillPage();
+    return LOG_OK;
+}
+
+/**
+ * @brief Write the summary of the sector after the head
+ *
+ * @return 1 if a sector was opened, 0 if it still needs an erase
+ */
+static uint8_t logOpenNextSector(void)
+{
+    logSectorHeader_t hdr;
+    uint16_t next = logNextSector(logHeadSector);
+
+    if(!bitmapGet(logErased, next))
+    {
+        return 0;
+    }
+
+    hdr.magic = LOG_MAGIC;
+    hdr.seq = logHeadSeq + 1U;
+    hdr.hdrCrc = logHeaderCrc(&hdr);
+    hdr.pageMap = 0xFFFFU;
+    spiFlashPageProgram(logPageAddr(next, 0), (const uint8_t *)&hdr, sizeof(hdr));
+    logStats.bytesProgrammed += sizeof(hdr);
+
+    bitmapClear(logErased, next);
+    logHeadSector = next;
+    logHeadSeq = hdr.seq;
+    logHeadPage = LOG_FIRST_DATA_PAGE;
+    logHeadOpen = 1;
+    logPageMarked = 0;
+
+    if(logEmpty)
+    {
+        logTailSector = next;
+        logTailSeq = hdr.seq;
+        logEmpty = 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Clear the summary bit of the head page about to be programmed
+ *
+ * Programming only clears bits, so writing a word with a single zero
+ * leaves the bits of the other pages untouched.
+ *
+ * @return void
+ */
+static void logMarkHeadPage(void)
+{
+    uint16_t mask = (uint16_t)~(1U << logHeadPage);
+
+    spiFlashPageProgram(logPageAddr(logHeadSector, 0) + LOG_PAGEMAP_OFFSET, (const uint8_t *)&mask, sizeof(mask));
+    logStats.bytesProgrammed += sizeof(mask);
+    logPageMarked = 1;
+}
+
+/**
+ * @brief Program the oldest sealed RAM page into the head page
+ *
+ * @return void
+ */
+static void logProgramPendingPage(void)
+{
+    uint8_t idx = (uint8_t)((logFillIdx + LOG_PAGE_BUFFERS - logPendingCount) % LOG_PAGE_BUFFERS);
+
+    spiFlashPageProgram(logPageAddr(logHeadSector, logHeadPage), logPageBuf[idx], SPI_FLASH_PAGE_SIZE);
+    logStats.bytesProgrammed += SPI_FLASH_PAGE_SIZE;
+    logStats.pagesProgrammed++;
+
+    logHeadPage++;
+    logPageMarked = 0;
+    logPendingCount--;
+}
+
+/**
+ * @brief Start erasing the first non-erased sector ahead of the head
+ *
+ * If that sector is the tail, the oldest data is dropped first.
+ *
+ * @return 1 if an erase was started, 0 if nothing to do
+ */
+static uint8_t logEraseAhead(void)
+{
+    uint16_t sector = logHeadSector;
+
+    for(uint32_t k = 0; k < LOG_ERASE_AHEAD; k++)
+    {
+        sector = logNextSector(sector);
+        if(bitmapGet(logErased, sector))
+        {
+            continue;
+        }
+
+        if(!logEmpty && (sector == logTailSector))
+        {
+            logTailSector = logNextSector(logTailSector);
+            logTailSeq++;
+            logStats.sectorsDropped++;
+        }
+
+        spiFlashSectorErase(logPageAddr(sector, 0));
+        bitmapSet(logErased, sector);
+        logStats.sectorsErased++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initialize the flash and mount the log
+ *
+ * @return void
+ */
+void logStoreInit(void)
+{
+    spiFlashInit();
+    logStoreMount();
+}
+
+/**
+ * @brief Rebuild head and tail from the sector summaries
+ *
+ * @return void
+ */
+void logStoreMount(void)
+{
+    logSectorHeader_t hdr;
+    uint16_t headMap = 0xFFFFU;
+    uint16_t free;
+    uint16_t sector;
+    uint8_t found = 0;
+
+    logStats.mountHeaderReads = 0;
+    logFillIdx = 0;
+    logPendingCount = 0;
+    logPageMarked = 0;
+    logClearFillPage();
+
+    for(uint32_t i = 0; i < LOG_BITMAP_BYTES; i++)
+    {
+        logErased[i] = 0;
+        logValid[i] = 0;
+    }
+
+    /*Read one summary per sector; sectors without a valid one get erased before use*/
+    for(sector = 0; sector < LOG_SECTOR_COUNT; sector++)
+    {
+        spiFlashRead(logPageAddr(sector, 0), (uint8_t *)&hdr, sizeof(hdr));
+        logStats.mountHeaderReads++;
+
+        if((hdr.magic != LOG_MAGIC) || (hdr.hdrCrc != logHeaderCrc(&hdr)))
+        {
+            continue;
+        }
+
+        bitmapSet(logValid, sector);
+        if(!found || (hdr.seq > logHeadSeq))
+        {
+            logHeadSector = sector;
+            logHeadSeq = hdr.seq;
+            headMap = hdr.pageMap;
+            found = 1;
+        }
+    }
+
+    if(!found)
+    {
+        /*Empty log: the first sector opened will be sector 0*/
+        logHeadSector = LOG_SECTOR_COUNT - 1U;
+        logHeadSeq = 0;
+        logHeadPage = LOG_PAGES_PER_SECTOR;
+        logHeadOpen = 0;
+        logEmpty = 1;
+        return;
+    }
+
+    /*Next free page is the lowest data page whose bit is still set*/
+    free = headMap & (uint16_t)~((1U << LOG_FIRST_DATA_PAGE) - 1U);
+    logHeadPage = free ? (uint16_t)__builtin_ctz(free) : LOG_PAGES_PER_SECTOR;
+    logHeadOpen = 1;
+    logEmpty = 0;
+
+    /*Walk back from the head through contiguous valid sectors*/
+    logTailSector = logHeadSector;
+    logTailSeq = logHeadSeq;
+    for(uint32_t k = 1; k < LOG_SECTOR_COUNT; k++)
+    {
+        sector = (uint16_t)((logTailSector + LOG_SECTOR_COUNT - 1U) % LOG_SECTOR_COUNT);
+        if(!bitmapGet(logValid, sector))
+        {
+            break;
+        }
+        logTailSector = sector;
+        logTailSeq--;
+    }
+}
+
+/**
+ * @brief Append one record to the log
+ *
+ * @param[in] data Payload bytes
+ * @param[in] len Payload length
+ *
+ * @return LOG_OK, LOG_ERR_SIZE or LOG_ERR_FULL
+ */
+logStatus_t logStoreAppend(const uint8_t *data, uint16_t len)
+{
+    uint32_t need = LOG_REC_HDR_SIZE + (uint32_t)len;
+    uint8_t *rec;
+    uint16_t crc;
+
+    if((len == 0U) || (len > LOG_MAX_RECORD_SIZE))
+    {
+        return LOG_ERR_SIZE;
+    }
+
+    if((logFillOffset + need) > SPI_FLASH_PAGE_SIZE)
+    {
+        if(logSealFillPage() != LOG_OK)
+        {
+            logStats.recordsDropped++;
+            return LOG_ERR_FULL;
+        }
+    }
+
+    rec = &logPageBuf[logFillIdx][logFillOffset];
+    rec[0] = (uint8_t)(len);
+    rec[1] = (uint8_t)(len >> 8);
+    crc = crc16Update(LOG_CRC_INIT, rec, 2U);
+    crc = crc16Update(crc, data, len);
+    rec[2] = (uint8_t)(crc);
+    rec[3] = (uint8_t)(crc >> 8);
+
+    for(uint32_t i = 0; i < len; i++)
+    {
+        rec[LOG_REC_HDR_SIZE + i] = data[i];
+    }
+
+    logFillOffset += (uint16_t)need;
+    logStats.bytesAppended += len;
+
+    /*Seal early when not even a 1-byte record fits anymore*/
+    if((logFillOffset + LOG_REC_HDR_SIZE) >= SPI_FLASH_PAGE_SIZE)
+    {
+        (void)logSealFillPage();
+    }
+    return LOG_OK;
+}
+
+/**
+ * @brief Seal the partially filled RAM page
+ *
+ * @return LOG_OK or LOG_ERR_FULL
+ */
+logStatus_t logStoreFlush(void)
+{
+    if(logFillOffset == 0U)
+    {
+        return LOG_OK;
+    }
+    return logSealFillPage();
+}
+
+/**
+ * @brief Advance the background flash work by one step
+ *
+ * @return void
+ */
+void logStorePoll(void)
+{
+    /*Never wait on the flash: one operation per call*/
+    if(spiFlashIsBusy())
+    {
+        return;
+    }
+
+    if(logPendingCount > 0U)
+    {
+        if(!logHeadOpen || (logHeadPage >= LOG_PAGES_PER_SECTOR))
+        {
+            if(!logOpenNextSector())
+            {
+                (void)logEraseAhead();
+            }
+            return;
+        }
+
+        if(!logPageMarked)
+        {
+            logMarkHeadPage();
+            return;
+        }
+
+        logProgramPendingPage();
+        return;
+    }
+
+    (void)logEraseAhead();
+}
+
+/**
+ * @brief Place a cursor on the oldest record
+ *
+ * @param[out] cursor Cursor to initialize
+ *
+ * @return void
+ */
+void logStoreCursorInit(logCursor_t *cursor)
+{
+    cursor->seq = logTailSeq;
+    cursor->sector = logTailSector;
+    cursor->page = LOG_FIRST_DATA_PAGE;
+    cursor->offset = 0;
+}
+
+/**
+ * @brief Read the next record and advance the cursor
+ *
+ * @param[in,out] cursor Read position
+ * @param[out] data Destination buffer
+ * @param[in] maxLen Size of the destination buffer
+ * @param[out] len Length of the record read
+ *
+ * @return LOG_OK, LOG_END, LOG_BUSY or LOG_ERR_SIZE
+ */
+logStatus_t logStoreReadNext(logCursor_t *cursor, uint8_t *data, uint16_t maxLen, uint16_t *len)
+{
+    uint8_t hdr[LOG_REC_HDR_SIZE];
+    uint16_t recLen;
+    uint16_t crc;
+
+    if(logEmpty)
+    {
+        return LOG_END;
+    }
+
+    if(spiFlashIsBusy())
+    {
+        return LOG_BUSY;
+    }
+
+    /*Sector under the cursor was erased: restart from the oldest data*/
+    if(cursor->seq < logTailSeq)
+    {
+        logStoreCursorInit(cursor);
+    }
+
+    while(1)
+    {
+        if((cursor->sector == logHeadSector) && (cursor->page >= logHeadPage))
+        {
+            return LOG_END;
+        }
+
+        if(cursor->page >= LOG_PAGES_PER_SECTOR)
+        {
+            cursor->sector = logNextSector(cursor->sector);
+            cursor->seq++;
+            cursor->page = LOG_FIRST_DATA_PAGE;
+            cursor->offset = 0;
+            continue;
+        }
+
+        if((cursor->offset + LOG_REC_HDR_SIZE) > SPI_FLASH_PAGE_SIZE)
+        {
+            cursor->page++;
+            cursor->offset = 0;
+            continue;
+        }
+
+        spiFlashRead(logPageAddr(cursor->sector, cursor->page) + cursor->offset, hdr, LOG_REC_HDR_SIZE);
+        recLen = (uint16_t)(hdr[0] | (hdr[1] << 8));
+
+        /*Erased length marks the end of the page; a bad length means a torn page*/
+        if((recLen == LOG_LEN_EMPTY) || (recLen == 0U) ||
+           ((cursor->offset + LOG_REC_HDR_SIZE + recLen) > SPI_FLASH_PAGE_SIZE))
+        {
+            if(recLen != LOG_LEN_EMPTY)
+            {
+                logStats.crcErrors++;
+            }
+            cursor->page++;
+            cursor->offset = 0;
+            continue;
+        }
+
+        if(recLen > maxLen)
+        {
+            return LOG_ERR_SIZE;
+        }
+
+        spiFlashRead(logPageAddr(cursor->sector, cursor->page) + cursor->offset + LOG_REC_HDR_SIZE, data, recLen);
+        cursor->offset += (uint16_t)(LOG_REC_HDR_SIZE + recLen);
+
+        crc = crc16Update(LOG_CRC_INIT, hdr, 2U);
+        crc = crc16Update(crc, data, recLen);
+        if(crc != (uint16_t)(hdr[2] | (hdr[3] << 8)))
+        {
+            logStats.crcErrors++;
+            continue;
+        }
+
+        *len = recLen;
+        return LOG_OK;
+    }
+}
+
+/**
+ * @brief Copy the log store counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void logStoreGetStats(logStats_t *stats)
+{
+    *stats = logStats;
+}
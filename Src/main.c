@@ -7,6 +7,10 @@
 #include "adc.h"
 #include "exti.h"
 #include "rtc.h"
+#include "rtcalarm.h"
+
+/*Seconds between two calendar printouts*/
+#define DISPLAY_PERIOD_S    10U
 
 /**
  * @brief Convert integer to string (no sprintf needed)
@@ -125,8 +129,28 @@ static void displayRtcCalendar(void)
     uartSendString("\r\n");
 }
 
+/**
+ * @brief Alarm callback printing the calendar
+ * 
+ * @param event Periodic display event
+ * @param now Current Unix time
+ * @return void
+ */
+static void displayEvent(rtcAlarmEvent_t *event, uint32_t now)
+{
+    (void)event;
+    (void)now;
+
+    displayRtcCalendar();
+
+    /*Let the last byte leave before STOP gates the UART clock*/
+    while(!(USART2->SR & USART_SR_TC)){}
+}
+
 int main(void)
 {
+    static rtcAlarmEvent_t displayAlarm;
+
     /*Initialize UART for debugging*/
     uartInit();
 
@@ -136,14 +160,19 @@ int main(void)
     /*Send startup message*/
     uartSendString("=== STM32F411 RTC Demo ===\r\n");
     
+    /*Display RTC time and date now and every DISPLAY_PERIOD_S*/
+    rtcAlarmInit();
+    displayAlarm.when = rtcGetEpoch();
+    displayAlarm.periodS = DISPLAY_PERIOD_S;
+    displayAlarm.callback = displayEvent;
+    rtcAlarmAdd(&displayAlarm);
+    
     /*Main loop*/
     while (1)
     {
-        /*Display RTC time and date*/
-        displayRtcCalendar();
-        
-        /*Add delay to avoid flooding UART output*/
-        systickMsecDelay(1000);
+        /*Run due events, then STOP until the next alarm*/
+        rtcAlarmDispatch();
+        rtcAlarmSleep();
     }
 }
 
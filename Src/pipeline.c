@@ -0,0 +1,558 @@
+/**
+ * @file pipeline.c
+ * @brief Zero-copy acquisition pipeline implementation
+ *
+ * Both queues are single-producer single-consumer rings of descriptor
+ * indices with free running head and tail counters: the ready ring is
+ * filled by the ADC DMA interrupt and drained by pipePoll(), the sink
+ * ring is filled by pipePoll() and drained by the sink.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "pipeline.h"
+#include "uart.h"
+#include "sdcard.h"
+
+#define PIPE_MASK               (PIPE_POOL_SIZE - 1U)
+
+/**
+ * @brief Owner of a slot
+ */
+typedef enum
+{
+    PIPE_FREE = 0,      /**< In the pool */
+    PIPE_ADC,           /**< DMA memory target */
+    PIPE_READY,         /**< Filled, waiting for pipePoll() */
+    PIPE_SINK           /**< Queued on or owned by the sink */
+} pipeState_t;
+
+/**
+ * @brief Slot descriptor
+ */
+typedef struct
+{
+    uint8_t *slot;              /**< Header followed by the samples */
+    uint16_t len;               /**< Bytes to send */
+    volatile uint8_t state;     /**< pipeState_t */
+} pipeDesc_t;
+
+static pipeConfig_t pipeCfg;
+static pipeDesc_t pipeDesc[PIPE_POOL_SIZE];
+static uint32_t pipeSamples;
+static uint16_t pipeSeq;
+static pipeStats_t pipeStats;
+static uint8_t pipeSinkFailed;
+
+static uint8_t pipeReady[PIPE_POOL_SIZE];
+static volatile uint32_t pipeReadyHead;
+static volatile uint32_t pipeReadyTail;
+
+/*Sink ring: tail = released, sent = handed to the hardware, head = queued*/
+static uint8_t pipeSinkRing[PIPE_POOL_SIZE];
+static volatile uint32_t pipeSinkHead;
+static volatile uint32_t pipeSinkSent;
+static volatile uint32_t pipeSinkTail;
+
+/**
+ * @brief Sample area of a slot
+ *
+ * @param[in] i Descriptor index
+ *
+ * @return First sample
+ */
+static uint16_t *pipeSampleArea(uint32_t i)
+{
+    return (uint16_t *)(pipeDesc[i].slot + PIPE_HEADER_BYTES);
+}
+
+/**
+ * @brief Take a free slot (DMA interrupt)
+ *
+ * @return Descriptor index, -1 if the pool is empty
+ */
+static int32_t pipeAlloc(void)
+{
+    int32_t found = -1;
+    uint32_t spare = 0;
+
+    for(uint32_t i = 0; i < PIPE_POOL_SIZE; i++)
+    {
+        if(pipeDesc[i].state == PIPE_FREE)
+        {
+            if(found < 0)
+            {
+                found = (int32_t)i;
+            }
+            else
+            {
+                spare++;
+            }
+        }
+    }
+
+    if(found >= 0)
+    {
+        pipeDesc[found].state = PIPE_ADC;
+    }
+    if(spare < pipeStats.minFree)
+    {
+        pipeStats.minFree = spare;
+    }
+
+    return found;
+}
+
+/**
+ * @brief ADC block callback: swap in a free slot, queue the full one
+ *
+ * @return None
+ */
+static void pipeAdcBlock(const uint16_t *samples, uint16_t frames, uint32_t timestamp)
+{
+    pipeHeader_t *hdr;
+    uint32_t done = PIPE_POOL_SIZE;
+    int32_t next;
+
+    (void)frames;
+
+    pipeStats.acquired++;
+    pipeSeq++;
+
+    for(uint32_t i = 0; i < PIPE_POOL_SIZE; i++)
+    {
+        if(pipeSampleArea(i) == samples)
+        {
+            done = i;
+            break;
+        }
+    }
+
+    next = pipeAlloc();
+    if((next < 0) || (done == PIPE_POOL_SIZE))
+    {
+        /*Nothing to swap in: the DMA overwrites this block*/
+        pipeStats.dropped++;
+        return;
+    }
+
+    adcTrigReplaceBuffer(pipeSampleArea((uint32_t)next));
+
+    hdr = (pipeHeader_t *)pipeDesc[done].slot;
+    hdr->seq = (uint16_t)(pipeSeq - 1U);
+    hdr->timestamp = timestamp;
+
+    pipeDesc[done].state = PIPE_READY;
+    pipeReady[pipeReadyHead & PIPE_MASK] = (uint8_t)done;
+    pipeReadyHead++;
+}
+
+/**
+ * @brief Delta encode interleaved samples in place
+ *
+ * Runs from the end so every difference still sees the original
+ * previous sample of its channel.
+ *
+ * @return Payload bytes
+ */
+static uint32_t pipePackDelta16(uint16_t *s, uint32_t n, uint32_t channels)
+{
+    for(uint32_t i = n; i > channels; i--)
+    {
+        s[i - 1U] = (uint16_t)(s[i - 1U] - s[i - 1U - channels]);
+    }
+
+    return n * 2U;
+}
+
+/**
+ * @brief Pack 12-bit samples, two in three bytes, in place
+ *
+ * Pair p is read from bytes 4p-4p+3 before bytes 3p-3p+2 are written.
+ *
+ * @return Payload bytes
+ */
+static uint32_t pipePack12(uint16_t *s, uint32_t n)
+{
+    uint8_t *out = (uint8_t *)s;
+    uint32_t a;
+    uint32_t b;
+    uint32_t o = 0;
+    uint32_t i;
+
+    for(i = 0; (i + 1U) < n; i += 2U)
+    {
+        a = s[i] & 0xFFFU;
+        b = s[i + 1U] & 0xFFFU;
+
+        out[o++] = (uint8_t)a;
+        out[o++] = (uint8_t)((a >> 8) | (b << 4));
+        out[o++] = (uint8_t)(b >> 4);
+    }
+
+    if(i < n)
+    {
+        a = s[i] & 0xFFFU;
+        out[o++] = (uint8_t)a;
+        out[o++] = (uint8_t)(a >> 8);
+    }
+
+    return o;
+}
+
+/**
+ * @brief Release the oldest sink block
+ *
+ * @return None
+ */
+static void pipeSinkRelease(void)
+{
+    pipeDesc[pipeSinkRing[pipeSinkTail & PIPE_MASK]].state = PIPE_FREE;
+    pipeSinkTail++;
+    pipeStats.sent++;
+}
+
+/**
+ * @brief Start the next queued block on the UART if it is idle
+ *
+ * Called from pipePoll() with interrupts masked and from the UART DMA
+ * completion interrupt.
+ *
+ * @return None
+ */
+static void pipeUartKick(void)
+{
+    pipeDesc_t *d;
+
+    if((pipeSinkSent == pipeSinkHead) || uartDmaBusy())
+    {
+        return;
+    }
+
+    d = &pipeDesc[pipeSinkRing[pipeSinkSent & PIPE_MASK]];
+    if(uartWriteDma(d->slot, d->len))
+    {
+        pipeSinkSent++;
+    }
+}
+
+/**
+ * @brief UART DMA completion: free the block, send the next one
+ *
+ * @return None
+ */
+static void pipeUartDone(uint8_t ok)
+{
+    if(!ok)
+    {
+        pipeStats.sinkErrors++;
+    }
+
+    if(pipeSinkTail != pipeSinkSent)
+    {
+        pipeSinkRelease();
+    }
+
+    pipeUartKick();
+}
+
+/**
+ * @brief Release finished SD slots and submit queued blocks
+ *
+ * The SD stream releases buffers in submission order, so the number
+ * of occupied stream slots tells how many of ours are done. After a
+ * failure blocks are released unsent.
+ *
+ * @return None
+ */
+static void pipeSdService(void)
+{
+    uint32_t busy = SD_STREAM_SLOTS - sdStreamSlotsFree();
+    pipeDesc_t *d;
+    sdStatus_t st;
+
+    /*A failed transfer stops the data path, nothing is read any more*/
+    if(pipeSinkFailed)
+    {
+        busy = 0;
+    }
+
+    while((pipeSinkSent - pipeSinkTail) > busy)
+    {
+        pipeSinkRelease();
+    }
+
+    while(pipeSinkSent != pipeSinkHead)
+    {
+        d = &pipeDesc[pipeSinkRing[pipeSinkSent & PIPE_MASK]];
+
+        if(!pipeSinkFailed)
+        {
+            st = sdStreamSubmit(d->slot, d->len / SD_BLOCK_SIZE);
+            if(st == SD_BUSY)
+            {
+                break;
+            }
+            if(st == SD_OK)
+            {
+                pipeSinkSent++;
+                continue;
+            }
+
+            /*Stream broken: keep draining the pool so the ADC keeps running*/
+            pipeSinkFailed = 1;
+            pipeStats.sinkErrors++;
+        }
+
+        pipeSinkSent++;
+        pipeSinkRelease();
+    }
+}
+
+/**
+ * @brief Check whether the sink can take a block right now
+ *
+ * @return 1 if busy
+ */
+static uint8_t pipeSinkBusy(void)
+{
+    if(pipeSinkHead != pipeSinkSent)
+    {
+        return 1;
+    }
+
+    if(pipeCfg.sink == PIPE_SINK_UART)
+    {
+        return uartDmaBusy();
+    }
+
+    return (sdStreamSlotsFree() == 0U) ? 1U : 0U;
+}
+
+/**
+ * @brief Run the stage and the packer on one block and queue it
+ *
+ * @param[in] i Descriptor index
+ *
+ * @return None
+ */
+static void pipeProcess(uint32_t i)
+{
+    pipeDesc_t *d = &pipeDesc[i];
+    pipeHeader_t *hdr = (pipeHeader_t *)d->slot;
+    uint16_t *s = pipeSampleArea(i);
+    uint32_t bytes;
+    uint32_t padded;
+
+    if(pipeCfg.stage)
+    {
+        pipeCfg.stage(s, pipeCfg.frames, pipeCfg.count);
+    }
+
+    switch(pipeCfg.pack)
+    {
+        case PIPE_PACK_DELTA16:
+            bytes = pipePackDelta16(s, pipeSamples, pipeCfg.count);
+            break;
+
+        case PIPE_PACK_12BIT:
+            bytes = pipePack12(s, pipeSamples);
+            break;
+
+        default:
+            bytes = pipeSamples * 2U;
+            break;
+    }
+
+    hdr->magic = PIPE_MAGIC;
+    hdr->pack = (uint8_t)pipeCfg.pack;
+    hdr->channels = pipeCfg.count;
+    hdr->frames = pipeCfg.frames;
+
+    bytes += PIPE_HEADER_BYTES;
+
+    if(pipeCfg.sink == PIPE_SINK_SD)
+    {
+        /*Whole blocks for the card, zero padded*/
+        padded = (bytes + (SD_BLOCK_SIZE - 1U)) & ~(SD_BLOCK_SIZE - 1U);
+        while(bytes < padded)
+        {
+            d->slot[bytes++] = 0;
+        }
+    }
+
+    d->len = (uint16_t)bytes;
+    pipeStats.processed++;
+    pipeStats.bytes += bytes;
+
+    if(pipeSinkBusy())
+    {
+        pipeStats.sinkWaits++;
+    }
+
+    d->state = PIPE_SINK;
+    pipeSinkRing[pipeSinkHead & PIPE_MASK] = (uint8_t)i;
+    pipeSinkHead++;
+}
+
+/**
+ * @brief Configure the ADC, the pool and the sink
+ *
+ * @return 1 on success, 0 if a parameter is out of range
+ */
+uint8_t pipeInit(const pipeConfig_t *config)
+{
+    uint32_t slotBytes;
+
+    if(!config->pool || (config->frames == 0U) || (config->count == 0U))
+    {
+        return 0;
+    }
+
+    pipeCfg = *config;
+    pipeSamples = (uint32_t)config->frames * config->count;
+    slotBytes = PIPE_SLOT_BYTES(pipeSamples);
+
+    /*Block length must fit the UART DMA counter*/
+    if(slotBytes > 0xFFFFU)
+    {
+        return 0;
+    }
+
+    for(uint32_t i = 0; i < PIPE_POOL_SIZE; i++)
+    {
+        pipeDesc[i].slot = (uint8_t *)config->pool + (i * slotBytes);
+        pipeDesc[i].len = 0;
+        pipeDesc[i].state = PIPE_FREE;
+    }
+
+    pipeReadyHead = 0;
+    pipeReadyTail = 0;
+    pipeSinkHead = 0;
+    pipeSinkSent = 0;
+    pipeSinkTail = 0;
+    pipeSeq = 0;
+    pipeSinkFailed = 0;
+
+    pipeStats.acquired = 0;
+    pipeStats.dropped = 0;
+    pipeStats.processed = 0;
+    pipeStats.sent = 0;
+    pipeStats.bytes = 0;
+    pipeStats.sinkWaits = 0;
+    pipeStats.sinkErrors = 0;
+    pipeStats.minFree = PIPE_POOL_SIZE - 2U;
+
+    /*First two slots are the ping-pong targets*/
+    pipeDesc[0].state = PIPE_ADC;
+    pipeDesc[1].state = PIPE_ADC;
+
+    if(!adcTrigInit(config->channels, config->count, pipeSampleArea(0), pipeSampleArea(1),
+                    config->frames, config->rateHz, pipeAdcBlock))
+    {
+        return 0;
+    }
+
+    if(config->sink == PIPE_SINK_UART)
+    {
+        uartDmaInit(pipeUartDone);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Open the sink and start the ADC trigger
+ *
+ * @return 1 on success, 0 if the SD stream could not be opened
+ */
+uint8_t pipeStart(void)
+{
+    if(pipeCfg.sink == PIPE_SINK_SD)
+    {
+        if(sdStreamOpen(pipeCfg.sdLba, 0) != SD_OK)
+        {
+            return 0;
+        }
+    }
+
+    adcTrigStart();
+
+    return 1;
+}
+
+/**
+ * @brief Run the stage and the packer on every finished block
+ *
+ * @return Number of blocks processed
+ */
+uint32_t pipePoll(void)
+{
+    uint32_t count = 0;
+    uint32_t primask;
+
+    while(pipeReadyTail != pipeReadyHead)
+    {
+        pipeProcess(pipeReady[pipeReadyTail & PIPE_MASK]);
+        pipeReadyTail++;
+        count++;
+    }
+
+    if(pipeCfg.sink == PIPE_SINK_UART)
+    {
+        /*The completion interrupt also kicks the UART*/
+        primask = __get_PRIMASK();
+        __disable_irq();
+        pipeUartKick();
+        __set_PRIMASK(primask);
+    }
+    else
+    {
+        pipeSdService();
+    }
+
+    return count;
+}
+
+/**
+ * @brief Stop the ADC, flush the queued blocks and close the sink
+ *
+ * @return 1 on success, 0 if the sink failed
+ */
+uint8_t pipeStop(void)
+{
+    adcTrigStop();
+
+    /*Blocks already acquired still go out*/
+    do
+    {
+        pipePoll();
+    }
+    while((pipeReadyTail != pipeReadyHead) || (pipeSinkTail != pipeSinkHead));
+
+    if(pipeCfg.sink == PIPE_SINK_SD)
+    {
+        if(sdStreamClose() != SD_OK)
+        {
+            return 0;
+        }
+    }
+
+    return pipeSinkFailed ? 0U : 1U;
+}
+
+/**
+ * @brief Copy the counters
+ *
+ * @return void
+ */
+void pipeGetStats(pipeStats_t *stats)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    *stats = pipeStats;
+    __set_PRIMASK(primask);
+}
@@ -1,4 +1,6 @@
 #include "rtc.h"
+#include "clock.h"
+#include "timer.h"
 
 #define PWREN		(1U<<28)
 #define CR_DBP		(1U<<8)
@@ -19,36 +21,309 @@
 #define CR_FMT							(1U<<6)
 #define ISR_RSF							(1U<<5)
 
-#define RTC_ASYNCH_PREDIV          ((uint32_t)0x7F)
-#define RTC_SYNCH_PREDIV           ((uint32_t)0x00F9)
+#define BDCR_LSEON		(1U<<0)
+#define BDCR_LSERDY		(1U<<1)
+
+/*LSE: 32768 Hz / 128 / 256; LSI: 32 kHz / 16 / 2000 (steps of 500 ppm
+  when the synchronous divider is fitted to the measured LSI)*/
+#define RTC_LSE_ASYNCH_PREDIV      ((uint32_t)0x7F)
+#define RTC_LSE_SYNCH_PREDIV       ((uint32_t)0x00FF)
+#define RTC_LSI_ASYNCH_PREDIV      ((uint32_t)0x0F)
+#define RTC_LSI_SYNCH_PREDIV       ((uint32_t)0x07CF)
+
+/*Oscillator edges per TIM5 capture (IC4PSC = /8)*/
+#define RTC_CAL_EDGES              8U
+
+/*Flag polls before giving up (INITF/RSF take up to 2 RTCCLK periods)*/
+#define RTC_TIMEOUT                100000U
+
+static uint8_t rtcWarmBoot;
+
+static uint8_t rtcInitSeq(void);
+static uint8_t waitForSynchro(void);
+static uint8_t exitInitSeq(void);
+static void rtcDateConfig(uint32_t weekDay, uint32_t day, uint32_t month, uint32_t year);
+static void rtcTimeConfig(uint32_t format1224, uint32_t hours, uint32_t minutes, uint32_t seconds);
+static void rtcSetAsynchPrescaler(uint32_t asynchPrescaler);
+static void rtcSetSynchPrescaler(uint32_t synchPrescaler);
+
+/**
+ * @brief Check for a calendar configured by an earlier rtcInit()
+ *
+ * @return 1 if the RTC is enabled, initialized and marked in BKP0R
+ */
+static uint8_t rtcIsConfigured(void)
+{
+    return ((RCC->BDCR & BDCR_RTCEN) && (RTC->ISR & RTC_ISR_INITS) &&
+            (RTC->BKP0R == RTC_BKP_MAGIC)) ? 1U : 0U;
+}
+
+/**
+ * @brief Wait for the shadow registers after a reset or wakeup
+ *
+ * RSF is set by hardware once TR/DR have been copied, without clearing
+ * it first (that would need write access).
+ *
+ * @return 1 if synchronized, 0 if timeout
+ */
+static uint8_t rtcWaitShadow(void)
+{
+    uint32_t timeout = RTC_TIMEOUT;
+
+    if(RTC->CR & RTC_CR_BYPSHAD)
+    {
+        return 1;
+    }
+
+    while(rtcIsActiveFlagRS() != 1)
+    {
+        if(--timeout == 0U)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Rounded a * b / c without a 64-bit division
+ *
+ * @return Quotient, which must fit in 32 bits
+ */
+static uint32_t rtcMulDiv(uint32_t a, uint32_t b, uint32_t c)
+{
+    uint64_t n = ((uint64_t)a * b) + (c / 2U);
+    uint64_t r = 0;
+    uint32_t q = 0;
+
+    /*Shift-subtract long division, one quotient bit per step*/
+    for(uint32_t i = 0; i < 64U; i++)
+    {
+        r = (r << 1) | (n >> 63);
+        n <<= 1;
+        q <<= 1;
+        if(r >= c)
+        {
+            r -= c;
+            q |= 1U;
+        }
+    }
+
+    return q;
+}
+
+/**
+ * @brief Check whether the timer clock comes from the crystal
+ *
+ * @return 1 if SYSCLK is HSE or PLL fed by HSE
+ */
+static uint8_t rtcIsReferenceHse(void)
+{
+    uint32_t sws = RCC->CFGR & RCC_CFGR_SWS;
+
+    return ((sws == RCC_CFGR_SWS_HSE) ||
+            ((sws == RCC_CFGR_SWS_PLL) && (RCC->PLLCFGR & RCC_PLLCFGR_PLLSRC))) ? 1U : 0U;
+}
+
+/**
+ * @brief TIM5 counting frequency
+ *
+ * APB1 timers run at twice PCLK1 when the APB1 prescaler divides.
+ *
+ * @return TIM5 ticks per second
+ */
+static uint32_t rtcGetReferenceHz(void)
+{
+    uint32_t timClk = clockGetPclk1();
+
+    if(RCC->CFGR & RCC_CFGR_PPRE1_2)
+    {
+        timClk *= 2U;
+    }
+
+    return timClk / (TIM5->PSC + 1U);
+}
+
+/**
+ * @brief Wait for the next TIM5 channel 4 capture
+ *
+ * @param t Captured counter value
+ *
+ * @return 1 on capture, 0 if none within RTC_CAL_CAPTURE_TIMEOUT_US
+ */
+static uint8_t rtcCaptureWait(uint32_t *t)
+{
+    uint32_t start = timGetMicros();
+
+    while(!(TIM5->SR & TIM_SR_CC4IF))
+    {
+        if((timGetMicros() - start) > RTC_CAL_CAPTURE_TIMEOUT_US)
+        {
+            return 0;
+        }
+    }
+
+    /*Reading CCR4 clears CC4IF*/
+    *t = TIM5->CCR4;
+
+    return 1;
+}
+
+/**
+ * @brief Count LSI or LSE cycles against TIM5
+ *
+ * TIM5 input 4 is remapped to the oscillator (TI4_RMP) and captures
+ * every 8th edge (IC4PSC) for RTC_CAL_WINDOW_MS. Captures lost to long
+ * interrupts are recovered by rounding the gap to whole periods. The
+ * free-running timebase and channel 1 are not touched.
+ *
+ * @param source Oscillator to measure
+ * @param refHz TIM5 ticks per second
+ * @param cycles Oscillator cycles counted
+ * @param ticks TIM5 ticks over those cycles
+ *
+ * @return 1 on success, 0 if the oscillator does not reach TIM5
+ */
+static uint8_t rtcMeasureClock(rtcClock_t source, uint32_t refHz, uint32_t *cycles, uint32_t *ticks)
+{
+    uint32_t nominalHz = (source == RTC_CLOCK_LSE) ? RTC_LSE_VALUE : RTC_LSI_VALUE;
+    uint32_t savedOr;
+    uint32_t savedCcmr2;
+    uint32_t savedCcer;
+    uint32_t period;
+    uint32_t target;
+    uint32_t captures = 0;
+    uint32_t steps;
+    uint32_t first;
+    uint32_t last;
+    uint32_t t;
+    uint8_t ok = 0;
+
+    tim5TimebaseInit();
+
+    savedOr = TIM5->OR;
+    savedCcmr2 = TIM5->CCMR2;
+    savedCcer = TIM5->CCER;
+
+    /*Rising edges of LSI (01) or LSE (10) on TI4, every 8th captured*/
+    TIM5->CCER &= ~(TIM_CCER_CC4E | TIM_CCER_CC4P | TIM_CCER_CC4NP);
+    TIM5->OR = (savedOr & ~TIM_OR_TI4_RMP) |
+               ((source == RTC_CLOCK_LSE) ? TIM_OR_TI4_RMP_1 : TIM_OR_TI4_RMP_0);
+    TIM5->CCMR2 = (savedCcmr2 & ~(TIM_CCMR2_CC4S | TIM_CCMR2_IC4PSC | TIM_CCMR2_IC4F)) |
+                  TIM_CCMR2_CC4S_0 | TIM_CCMR2_IC4PSC;
+    TIM5->SR = ~(TIM_SR_CC4IF | TIM_SR_CC4OF);
+    TIM5->CCER |= TIM_CCER_CC4E;
+
+    period = rtcMulDiv(RTC_CAL_EDGES, refHz, nominalHz);
+    target = rtcMulDiv(nominalHz, RTC_CAL_WINDOW_MS, RTC_CAL_EDGES * 1000U);
+
+    /*The first capture may predate the remap*/
+    if(rtcCaptureWait(&t) && rtcCaptureWait(&first))
+    {
+        last = first;
+        ok = 1;
+
+        while(captures < target)
+        {
+            if(!rtcCaptureWait(&t))
+            {
+                ok = 0;
+                break;
+            }
+
+            steps = ((t - last) + (period / 2U)) / period;
+            if(steps == 0U)
+            {
+                /*Not an 8-edge period: wrong oscillator frequency*/
+                ok = 0;
+                break;
+            }
+
+            captures += steps;
+            last = t;
+        }
+
+        *cycles = captures * RTC_CAL_EDGES;
+        *ticks = last - first;
+    }
+
+    TIM5->CCER &= ~TIM_CCER_CC4E;
+    TIM5->CCMR2 = savedCcmr2;
+    TIM5->OR = savedOr;
+    TIM5->CCER = savedCcer;
+    TIM5->SR = ~(TIM_SR_CC4IF | TIM_SR_CC4OF);
+
+    return ok;
+}
+
+/**
+ * @brief Initialize RTC peripheral with the default clock source
+ *
+ * @return void
+ */
+void rtcInit(void)
+{
+	rtcInitSource(RTC_CLOCK_DEFAULT);
+}
 
 /**
- * @brief Initialize RTC peripheral with LSI clock source
+ * @brief Initialize RTC peripheral with LSI or LSE clock source
  * 
  * Configuration steps:
  * 1. Enable PWR clock
  * 2. Enable backup domain access (DBP bit in PWR->CR)
- * 3. Enable and wait for LSI to be ready
- * 4. Reset and enable RTC
- * 5. Disable write protection
- * 6. Enter initialization mode
+ * 3. Warm start (same source requested): turn LSI back on if used (a
+ *    system reset clears LSION, the LSE keeps running in the backup
+ *    domain) and wait for RSF
+ * 4. Cold start: reset the backup domain, start the oscillator (LSE
+ *    falls back to LSI if it does not start)
+ * 5. Select and enable the RTC clock, measure LSI for its prescalers
+ * 6. Disable write protection
+ * 7. Enter initialization mode, set calendar and prescalers
+ * 8. Mark the backup domain with RTC_BKP_MAGIC
+ * 9. Trim the clock with rtcCalibrate() (RTC_CAL_AT_BOOT)
  * 
- * @note LSI frequency is approximately 32 kHz
+ * @param source Requested RTC clock
+ *
  * @return void
  */
-void rtcInit(void)
+void rtcInitSource(rtcClock_t source)
 {
+	uint32_t start;
+	uint32_t asynchPrediv;
+	uint32_t synchPrediv;
+	uint32_t cycles;
+	uint32_t ticks;
+
 	/*Enable clock access to PWR */
 	RCC->APB1ENR |= PWREN;
 
 	/*Enable Backup access to config RTC*/
 	PWR->CR |=CR_DBP;
 
-	/*Enable Low Speed Internal (LSI)*/
-	RCC->CSR |=CSR_LSION;
+	/*Calendar still running from before the reset, on the requested clock*/
+	if(rtcIsConfigured() && (RTC->BKP1R == (uint32_t)source))
+	{
+		rtcWarmBoot = 1;
+
+		/*Restart LSI without waiting for it*/
+		if(rtcGetClockSource() == RTC_CLOCK_LSI)
+		{
+			RCC->CSR |=CSR_LSION;
+		}
 
-	/*Wait for LSI to be ready*/
-	while((RCC->CSR & CSR_LSIRDY) != CSR_LSIRDY){}
+		/*Calendar readable once the shadow registers are reloaded*/
+		rtcWaitShadow();
+
+		/*CALR is in the backup domain and survived the reset*/
+#if RTC_CAL_AT_WARM_BOOT
+		rtcCalibrate(0);
+#endif
+		return;
+	}
+
+	rtcWarmBoot = 0;
 
 	/*Force backup domain reset*/
 	RCC->BDCR |=BDCR_BDRST;
@@ -56,9 +331,53 @@ void rtcInit(void)
 	/*Release backup domain reset*/
 	RCC->BDCR &= ~BDCR_BDRST;
 
-	/*Set RTC clock source to LSI*/
-	RCC->BDCR &=~(1U<<8);
-	RCC->BDCR |= (1U<<9);
+	if(source == RTC_CLOCK_LSE)
+	{
+		/*Enable Low Speed External (LSE), up to 2 s for a crystal*/
+		RCC->BDCR |=BDCR_LSEON;
+
+		tim5TimebaseInit();
+		start = timGetMicros();
+		while((RCC->BDCR & BDCR_LSERDY) != BDCR_LSERDY)
+		{
+			if((timGetMicros() - start) > (RTC_LSE_STARTUP_MS * 1000U))
+			{
+				/*No crystal: run from LSI*/
+				RCC->BDCR &= ~BDCR_LSEON;
+				break;
+			}
+		}
+	}
+
+	if(RCC->BDCR & BDCR_LSERDY)
+	{
+		/*Set RTC clock source to LSE*/
+		RCC->BDCR &=~(1U<<9);
+		RCC->BDCR |= (1U<<8);
+
+		asynchPrediv = RTC_LSE_ASYNCH_PREDIV;
+		synchPrediv = RTC_LSE_SYNCH_PREDIV;
+	}
+	else
+	{
+		/*Enable Low Speed Internal (LSI)*/
+		RCC->CSR |=CSR_LSION;
+
+		/*Wait for LSI to be ready*/
+		while((RCC->CSR & CSR_LSIRDY) != CSR_LSIRDY){}
+
+		/*Set RTC clock source to LSI*/
+		RCC->BDCR &=~(1U<<8);
+		RCC->BDCR |= (1U<<9);
+
+		/*LSI is only known to +-10 %: count it for the 1 Hz divider*/
+		asynchPrediv = RTC_LSI_ASYNCH_PREDIV;
+		synchPrediv = RTC_LSI_SYNCH_PREDIV;
+		if(rtcMeasureClock(RTC_CLOCK_LSI, rtcGetReferenceHz(), &cycles, &ticks))
+		{
+			synchPrediv = rtcMulDiv(cycles, rtcGetReferenceHz(), ticks * (asynchPrediv + 1U)) - 1U;
+		}
+	}
 
 	/*Enable the RTC*/
 	RCC->BDCR |=BDCR_RTCEN;
@@ -70,7 +389,9 @@ void rtcInit(void)
 	/*Enter the initialization mode*/
 	if(rtcInitSeq() != 1)
 	{
-		//Do something...
+		/*No RTC clock: leave the domain unmarked so the next boot retries*/
+		RTC->WPR = 0xFF;
+		return;
 	}
 
 	/*Set desired date :  Friday December 29th 2016*/
@@ -83,21 +404,163 @@ void rtcInit(void)
 	RTC->CR |=CR_FMT;
 
 	/*Set Asynch prescaler*/
-	rtcSetAsynchPrescaler(RTC_ASYNCH_PREDIV);
+	rtcSetAsynchPrescaler(asynchPrediv);
 
 	/*Set Sync prescaler*/
-	rtcSetSynchPrescaler(RTC_SYNCH_PREDIV);
+	rtcSetSynchPrescaler(synchPrediv);
 
 	/*Exit the initialization mode*/
 	exitInitSeq();
 
 	/*Enable RTC registers write protection*/
 	RTC->WPR = 0xFF;
+
+	/*Backup registers only need DBP; the next boot keeps this calendar*/
+	RTC->BKP1R = (uint32_t)source;
+	RTC->BKP0R = RTC_BKP_MAGIC;
+
+#if RTC_CAL_AT_BOOT
+	rtcCalibrate(0);
+#endif
+}
+
+/**
+ * @brief Get the clock driving the RTC
+ *
+ * @return RTC_CLOCK_LSE if RTCSEL selects LSE, RTC_CLOCK_LSI otherwise
+ */
+rtcClock_t rtcGetClockSource(void)
+{
+    return ((RCC->BDCR & RCC_BDCR_RTCSEL) == RCC_BDCR_RTCSEL_0) ? RTC_CLOCK_LSE : RTC_CLOCK_LSI;
+}
+
+/**
+ * @brief Measure the RTC clock and program the smooth calibration
+ *
+ * The oscillator is compared with the TIM5 clock, so the result is as
+ * accurate as the system clock (HSE or PLL from HSE for crystal
+ * accuracy). An LSE crystal (+-20 ppm) is only measured against HSE:
+ * HSI (+-1 %) would make it worse. CALR is written once RECALPF is
+ * clear; the calendar keeps counting and the new value applies from
+ * the next 32 s cycle.
+ *
+ * @param result Measurement details (may be 0)
+ *
+ * @return RTC_CAL_OK, RTC_CAL_CLAMPED, RTC_CAL_FAILED or
+ *         RTC_CAL_NO_REFERENCE
+ */
+uint8_t rtcCalibrate(rtcCal_t *result)
+{
+    rtcClock_t source = rtcGetClockSource();
+    uint32_t refHz = rtcGetReferenceHz();
+    uint32_t prer = RTC->PRER;
+    uint32_t divider;
+    uint32_t cycles;
+    uint32_t ticks;
+    uint32_t expected;
+    uint32_t diff;
+    uint32_t pulses;
+    uint32_t calr;
+    uint32_t timeout = RTC_TIMEOUT;
+    uint8_t status = RTC_CAL_OK;
+    int32_t ppm;
+
+    if((source == RTC_CLOCK_LSE) && !rtcIsReferenceHse())
+    {
+        return RTC_CAL_NO_REFERENCE;
+    }
+
+    if(!rtcMeasureClock(source, refHz, &cycles, &ticks))
+    {
+        return RTC_CAL_FAILED;
+    }
+
+    /*Nominal RTCCLK for 1 Hz with the programmed prescalers*/
+    divider = ((((prer & RTC_PRER_PREDIV_A) >> RTC_PRER_PREDIV_A_Pos) + 1U) *
+               ((prer & RTC_PRER_PREDIV_S) + 1U));
+
+    /*Fewer reference ticks than expected: the RTC clock is fast*/
+    expected = rtcMulDiv(cycles, refHz, divider);
+    diff = (expected > ticks) ? (expected - ticks) : (ticks - expected);
+
+    /*CALM pulses per 2^20 RTCCLK cycles = 2^20 * error*/
+    pulses = rtcMulDiv(diff, 1UL << 20, ticks);
+    ppm = (int32_t)rtcMulDiv(diff, 1000000U, ticks);
+
+    if(expected > ticks)
+    {
+        /*Fast: mask pulses*/
+        if(pulses > RTC_CALR_CALM)
+        {
+            pulses = RTC_CALR_CALM;
+            status = RTC_CAL_CLAMPED;
+        }
+        calr = pulses;
+    }
+    else
+    {
+        /*Slow: insert 512 pulses, mask the excess*/
+        ppm = -ppm;
+        if(pulses > 512U)
+        {
+            pulses = 512U;
+            status = RTC_CAL_CLAMPED;
+        }
+        calr = RTC_CALR_CALP | (512U - pulses);
+    }
+
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_1;
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_2;
+
+    /*A previous CALR write is still being applied*/
+    while(RTC->ISR & RTC_ISR_RECALPF)
+    {
+        if(--timeout == 0U)
+        {
+            RTC->WPR = 0xFF;
+            return RTC_CAL_FAILED;
+        }
+    }
+
+    /*32 s cycle (CALW8 = CALW16 = 0) for 0.95 ppm steps*/
+    RTC->CALR = calr;
+
+    RTC->WPR = 0xFF;
+
+    if(result)
+    {
+        result->ppm = ppm;
+        result->frequency = rtcMulDiv(cycles, refHz, ticks);
+        result->calr = calr;
+        result->hseReference = rtcIsReferenceHse();
+    }
+
+    return status;
+}
+
+/**
+ * @brief Check how the last rtcInit() started the RTC
+ *
+ * @return 1 if the running calendar was kept, 0 after a cold start
+ */
+uint8_t rtcIsWarmBoot(void)
+{
+    return rtcWarmBoot;
 }
 
+/**
+ * @brief Convert decimal to BCD (Binary Coded Decimal)
+ * 
+ * @param value Decimal value (0-99)
+ * @return BCD encoded value
+ */
 uint8_t rtcConvertDec2BCD(uint8_t value)
 {
-    return (uint8_t)((((value) / 10U) / 10U) << 4U) | ((value) % 10U);
+    if(value > 99U)
+    {
+        return 0;
+    }
+    return rtcBcdEncode(value);
 }
 
 /**
@@ -111,7 +574,7 @@ uint8_t rtcConvertDec2BCD(uint8_t value)
  */
 uint8_t rtcConvertBCD2Dec(uint8_t value)
 {
-    return (uint8_t)(((uint8_t)((value) & (uint8_t)0xF0U) >> (uint8_t)0x4U) * 10U + ((value) & (uint8_t)0x0FU));
+    return rtcBcdDecode(value);
 }
 
 /**
@@ -121,8 +584,10 @@ uint8_t rtcConvertBCD2Dec(uint8_t value)
  */
 uint32_t rtcDateGetDay(void)
 {
-    uint8_t bcd = (RTC->DR >> RTC_DR_DU_Pos) & 0x3F;
-    return rtcConvertBCD2Dec(bcd);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.day;
 }
 
 /**
@@ -132,8 +597,10 @@ uint32_t rtcDateGetDay(void)
  */
 uint32_t rtcDateGetYear(void)
 {
-    uint8_t bcd = (RTC->DR >> RTC_DR_YU_Pos) & 0xFF;
-    return rtcConvertBCD2Dec(bcd);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.year;
 }
 /**
  * @brief Get current month from RTC
@@ -142,8 +609,10 @@ uint32_t rtcDateGetYear(void)
  */
 uint32_t rtcDateGetMonth(void)
 {
-    uint8_t bcd = (RTC->DR >> RTC_DR_MU_Pos) & 0x1F;
-    return rtcConvertBCD2Dec(bcd);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.month;
 }
 
 
@@ -154,8 +623,10 @@ uint32_t rtcDateGetMonth(void)
  */
 uint32_t rtcTimeGetSecond(void)
 {
-    uint8_t bcd = (RTC->TR >> RTC_TR_SU_Pos) & 0x7F; // ST[6:4], SU[3:0]
-    return rtcConvertBCD2Dec(bcd);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.seconds;
 }
 
 /**
@@ -165,17 +636,218 @@ uint32_t rtcTimeGetSecond(void)
  */
 uint32_t rtcTimeGetMinute(void)
 {
-    return (uint32_t)(READ_BIT(RTC->TR, (RTC_TR_MNT | RTC_TR_MNU))>> RTC_TR_MNU_Pos);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.minutes;
 }
 
 /**
  * @brief Get current hours from RTC
  * 
- * @return Hours value (0-23) in decimal format for 24-hour mode
+ * @return Hours value (0-23) in decimal format, also in 12-hour mode
  */
 uint32_t rtcTimeGetHour(void)
 {
-    return (uint32_t)((READ_BIT(RTC->TR, (RTC_TR_HT | RTC_TR_HU))) >> RTC_TR_HU_Pos);
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return dt.hours;
+}
+
+/**
+ * @brief Read the whole calendar coherently
+ *
+ * Shadow registers: reading SSR locks TR and DR until DR is read, so
+ * SSR -> TR -> DR is one instant. Bypass: no lock, a second pass must
+ * return the same values, otherwise a counter moved in between.
+ *
+ * @param dt Destination
+ *
+ * @return void
+ */
+void rtcGetSnapshot(rtcDateTime_t *dt)
+{
+    uint32_t ssr;
+    uint32_t tr;
+    uint32_t dr;
+    uint32_t hours;
+    uint32_t preS = RTC->PRER & RTC_PRER_PREDIV_S;
+
+    ssr = RTC->SSR;
+    tr = RTC->TR;
+    dr = RTC->DR;
+
+    if(RTC->CR & RTC_CR_BYPSHAD)
+    {
+        while((RTC->SSR != ssr) || (RTC->TR != tr) || (RTC->DR != dr))
+        {
+            ssr = RTC->SSR;
+            tr = RTC->TR;
+            dr = RTC->DR;
+        }
+    }
+
+    dt->year = rtcBcdDecode((dr & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos);
+    dt->month = rtcBcdDecode((dr & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+    dt->day = rtcBcdDecode((dr & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+    dt->weekDay = (uint8_t)((dr & RTC_DR_WDU) >> RTC_DR_WDU_Pos);
+
+    hours = rtcBcdDecode((tr & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos);
+    if(RTC->CR & RTC_CR_FMT)
+    {
+        /*12 AM = 0 h, 12 PM = 12 h*/
+        hours = (hours % 12U) + ((tr & RTC_TR_PM) ? 12U : 0U);
+    }
+    dt->hours = (uint8_t)hours;
+    dt->minutes = rtcBcdDecode((tr & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos);
+    dt->seconds = rtcBcdDecode((tr & (RTC_TR_ST | RTC_TR_SU)) >> RTC_TR_SU_Pos);
+
+    /*SSR counts down from PREDIV_S; above it only after a shift*/
+    if(ssr > preS)
+    {
+        ssr = preS;
+    }
+    dt->subSeconds = (uint16_t)ssr;
+    dt->millis = (uint16_t)(((preS - ssr) * 1000U) / (preS + 1U));
+}
+
+/**
+ * @brief Current time as Unix milliseconds
+ *
+ * @return Milliseconds since 1970-01-01 00:00:00
+ */
+uint64_t rtcGetEpochMs(void)
+{
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return rtcEpochMsFromDateTime(&dt);
+}
+
+/**
+ * @brief Set the calendar from Unix seconds
+ *
+ * @param seconds RTC_EPOCH_2000 to RTC_EPOCH_2100 - 1
+ *
+ * @return 1 on success, 0 if seconds is out of range or the RTC did
+ *         not enter initialization mode
+ */
+uint8_t rtcSetEpoch(uint32_t seconds)
+{
+    uint32_t tr;
+    uint32_t dr;
+
+    if((seconds < RTC_EPOCH_2000) || (seconds >= RTC_EPOCH_2100))
+    {
+        return 0;
+    }
+
+    rtcRegsFromEpoch(seconds, &tr, &dr);
+
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_1;
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_2;
+
+    if(rtcInitSeq() != 1)
+    {
+        /*INITF never set: TR/DR would ignore the writes*/
+        rtcDisableInitMode();
+        RTC->WPR = 0xFF;
+        return 0;
+    }
+
+    RTC->CR &= ~CR_FMT;
+    RTC->TR = tr;
+    RTC->DR = dr;
+
+    exitInitSeq();
+
+    RTC->WPR = 0xFF;
+
+    return 1;
+}
+
+/**
+ * @brief Select direct counter reads (BYPSHAD)
+ *
+ * CR is write protected but does not need initialization mode.
+ *
+ * @param enable 1 = read the counters directly, 0 = shadow registers
+ *
+ * @return void
+ */
+void rtcSetBypassShadow(uint8_t enable)
+{
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_1;
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_2;
+
+    if(enable)
+    {
+        RTC->CR |= RTC_CR_BYPSHAD;
+    }
+    else
+    {
+        RTC->CR &= ~RTC_CR_BYPSHAD;
+    }
+
+    RTC->WPR = 0xFF;
+}
+
+/**
+ * @brief Current time as Unix seconds
+ *
+ * @return Seconds since 1970-01-01 00:00:00
+ */
+uint32_t rtcGetEpoch(void)
+{
+    rtcDateTime_t dt;
+
+    rtcGetSnapshot(&dt);
+    return rtcEpochFromDateTime(&dt);
+}
+
+/**
+ * @brief Resynchronize the shadow registers after a wakeup
+ *
+ * Clearing RSF needs write access to ISR.
+ *
+ * @return 1 if synchronized, 0 if timeout
+ */
+uint8_t rtcResync(void)
+{
+    uint8_t ok;
+
+    if(RTC->CR & RTC_CR_BYPSHAD)
+    {
+        return 1;
+    }
+
+    rtcDisableWriteProtection();
+    ok = waitForSynchro();
+    rtcEnableWriteProtection();
+
+    return ok;
+}
+
+/**
+ * @brief Unlock the RTC registers
+ *
+ * @return void
+ */
+void rtcDisableWriteProtection(void)
+{
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_1;
+    RTC->WPR = RTC_WRITE_PROTECTION_KEY_2;
+}
+
+/**
+ * @brief Lock the RTC registers
+ *
+ * @return void
+ */
+void rtcEnableWriteProtection(void)
+{
+    RTC->WPR = 0xFF;
 }
 
 /**
@@ -234,11 +906,21 @@ uint8_t rtcIsActiveFlagRS(void)
  */
 static uint8_t rtcInitSeq(void)
 {
+    uint32_t timeout = RTC_TIMEOUT;
+
     /*Start init mode*/
     rtcEnableInitMode();
 
     /*Wait till we are in init mode*/
-    while(rtcIsActiveFlagInit() != 1) {}
+    while(rtcIsActiveFlagInit() != 1)
+    {
+        if(--timeout == 0U)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
 }
 
 /**
@@ -248,18 +930,27 @@ static uint8_t rtcInitSeq(void)
  * that shadow registers are synchronized with RTC registers.
  * 
  * @return 1 if synchronized, 0 if timeout
- * @note Timeout set to ~32000 iterations (approximates 1 second at 32kHz)
+ * @note Gives up after RTC_TIMEOUT polls
  */
 static uint8_t waitForSynchro(void)
 {
+    uint32_t timeout = RTC_TIMEOUT;
+
     /*Clear RSF*/
     RTC->ISR &= ~RTC_ISR_RSF;
 
     /*Wait for registers to synchronize*/
-    while(rtcIsActiveFlagRS() != 1) {}
+    while(rtcIsActiveFlagRS() != 1)
+    {
+        if(--timeout == 0U)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
 }
 
-//todo
 /**
  * @brief Exit RTC initialization sequence
  * 
@@ -0,0 +1,401 @@
+/**
+ * @file rtcalarm.c
+ * @brief Calendar event scheduler on RTC Alarm A/B implementation
+ *
+ * The queue is a singly linked list sorted by due time. Only the main
+ * loop changes it; the alarm interrupt just sets a pending flag, so no
+ * critical sections are needed around the list.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "rtcalarm.h"
+#include "rtc.h"
+
+/*EXTI line of the RTC alarms*/
+#define RTC_ALARM_EXTI_LINE     (1U<<17)
+
+/*Alarm register fields shared with TR (bits 22:0) and DR (day, << 24)*/
+#define RTC_ALARM_TIME_MASK     (RTC_TR_PM | RTC_TR_HT | RTC_TR_HU | RTC_TR_MNT | RTC_TR_MNU | RTC_TR_ST | RTC_TR_SU)
+#define RTC_ALARM_DATE_MASK     (RTC_DR_DT | RTC_DR_DU)
+#define RTC_ALARM_DATE_SHIFT    24U
+
+/*Polls of ALRxWF, which is set within 2 RTCCLK periods*/
+#define RTC_ALARM_TIMEOUT       100000U
+
+static rtcAlarmEvent_t *rtcAlarmHead;
+static uint32_t rtcAlarmQueued;
+static volatile uint8_t rtcAlarmPending;
+static rtcAlarmStats_t rtcAlarmStats;
+
+/**
+ * @brief Alarm register value matching a Unix time
+ *
+ * @param[in] when Unix seconds
+ *
+ * @return ALRMxR value (date, hours, minutes, seconds compared)
+ */
+static uint32_t rtcAlarmRegister(uint32_t when)
+{
+    uint32_t tr;
+    uint32_t dr;
+    uint32_t hours;
+
+    rtcRegsFromEpoch(when, &tr, &dr);
+
+    /*12-hour calendar: 1-12 plus PM*/
+    if(RTC->CR & RTC_CR_FMT)
+    {
+        hours = rtcBcdDecode((tr & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos);
+        tr &= ~(RTC_TR_HT | RTC_TR_HU);
+        if(hours >= 12U)
+        {
+            tr |= RTC_TR_PM;
+            hours -= 12U;
+        }
+        if(hours == 0U)
+        {
+            hours = 12U;
+        }
+        tr |= (uint32_t)rtcBcdEncode(hours) << RTC_TR_HU_Pos;
+    }
+
+    return (tr & RTC_ALARM_TIME_MASK) | ((dr & RTC_ALARM_DATE_MASK) << RTC_ALARM_DATE_SHIFT);
+}
+
+/**
+ * @brief Load one alarm, or leave it disabled
+ *
+ * @param[in] enableBit RTC_CR_ALRAE or RTC_CR_ALRBE
+ * @param[in] event Event to match (0 = disable)
+ *
+ * @return void
+ * @note Write protection must be off
+ */
+static void rtcAlarmLoad(uint32_t enableBit, const rtcAlarmEvent_t *event)
+{
+    uint32_t isA = (enableBit == RTC_CR_ALRAE);
+    uint32_t writeFlag = isA ? RTC_ISR_ALRAWF : RTC_ISR_ALRBWF;
+    uint32_t timeout = RTC_ALARM_TIMEOUT;
+
+    RTC->CR &= ~(enableBit | (isA ? RTC_CR_ALRAIE : RTC_CR_ALRBIE));
+
+    if(!event)
+    {
+        return;
+    }
+
+    /*Alarm registers are writable once the alarm is off*/
+    while(!(RTC->ISR & writeFlag))
+    {
+        if(--timeout == 0U)
+        {
+            return;
+        }
+    }
+
+    /*Sub-seconds not compared*/
+    if(isA)
+    {
+        RTC->ALRMAR = rtcAlarmRegister(event->when);
+        RTC->ALRMASSR = 0;
+    }
+    else
+    {
+        RTC->ALRMBR = rtcAlarmRegister(event->when);
+        RTC->ALRMBSSR = 0;
+    }
+
+    RTC->CR |= enableBit | (isA ? RTC_CR_ALRAIE : RTC_CR_ALRBIE);
+}
+
+/**
+ * @brief Program the alarms with the two nearest events
+ *
+ * An event that fell due while the alarms were being written would
+ * never match, so the queue is marked pending instead.
+ *
+ * @return void
+ */
+static void rtcAlarmProgram(void)
+{
+    const rtcAlarmEvent_t *first = rtcAlarmHead;
+    const rtcAlarmEvent_t *second = first;
+
+    /*Alarm B: first event due after the one in Alarm A*/
+    while(second && (second->when == first->when))
+    {
+        second = second->next;
+    }
+
+    rtcDisableWriteProtection();
+    rtcAlarmLoad(RTC_CR_ALRAE, first);
+    rtcAlarmLoad(RTC_CR_ALRBE, second);
+    rtcEnableWriteProtection();
+
+    if(first && ((int32_t)(first->when - rtcGetEpoch()) <= 0))
+    {
+        rtcAlarmStats.late++;
+        rtcAlarmPending = 1;
+    }
+}
+
+/**
+ * @brief Link an event into the sorted queue
+ *
+ * @param[in,out] event Event
+ *
+ * @return void
+ */
+static void rtcAlarmInsert(rtcAlarmEvent_t *event)
+{
+    rtcAlarmEvent_t **link = &rtcAlarmHead;
+
+    /*Behind every event due at the same time*/
+    while(*link && ((*link)->when <= event->when))
+    {
+        link = &(*link)->next;
+    }
+
+    event->next = *link;
+    *link = event;
+    event->queued = 1;
+
+    rtcAlarmQueued++;
+    if(rtcAlarmQueued > rtcAlarmStats.maxQueued)
+    {
+        rtcAlarmStats.maxQueued = rtcAlarmQueued;
+    }
+}
+
+/**
+ * @brief Enable the alarm interrupt path
+ *
+ * @return void
+ */
+void rtcAlarmInit(void)
+{
+    rtcAlarmHead = 0;
+    rtcAlarmQueued = 0;
+    rtcAlarmPending = 0;
+
+    rtcDisableWriteProtection();
+    rtcAlarmLoad(RTC_CR_ALRAE, 0);
+    rtcAlarmLoad(RTC_CR_ALRBE, 0);
+    rtcEnableWriteProtection();
+
+    /*Clear stale flags (ISR[13:8] are not write protected)*/
+    RTC->ISR = (~(RTC_ISR_ALRAF | RTC_ISR_ALRBF | RTC_ISR_INIT) & 0x0000FFFFU) | (RTC->ISR & RTC_ISR_INIT);
+
+    /*EXTI line 17, rising edge: interrupt and wake-up from STOP*/
+    EXTI->IMR |= RTC_ALARM_EXTI_LINE;
+    EXTI->RTSR |= RTC_ALARM_EXTI_LINE;
+    EXTI->PR = RTC_ALARM_EXTI_LINE;
+
+    NVIC_EnableIRQ(RTC_Alarm_IRQn);
+}
+
+/**
+ * @brief Queue an event
+ *
+ * @return 1 if queued, 0 if already queued or when is out of range
+ */
+uint8_t rtcAlarmAdd(rtcAlarmEvent_t *event)
+{
+    if(event->queued || (event->when < RTC_EPOCH_2000) || (event->when >= RTC_EPOCH_2100))
+    {
+        return 0;
+    }
+
+    rtcAlarmInsert(event);
+    rtcAlarmProgram();
+
+    return 1;
+}
+
+/**
+ * @brief Take an event out of the queue
+ *
+ * @return 1 if removed, 0 if it was not queued
+ */
+uint8_t rtcAlarmRemove(rtcAlarmEvent_t *event)
+{
+    rtcAlarmEvent_t **link = &rtcAlarmHead;
+
+    while(*link && (*link != event))
+    {
+        link = &(*link)->next;
+    }
+
+    if(!*link)
+    {
+        return 0;
+    }
+
+    *link = event->next;
+    event->next = 0;
+    event->queued = 0;
+    rtcAlarmQueued--;
+
+    rtcAlarmProgram();
+
+    return 1;
+}
+
+/**
+ * @brief Run the callbacks of every due event
+ *
+ * @return Number of callbacks run
+ */
+uint32_t rtcAlarmDispatch(void)
+{
+    rtcAlarmEvent_t *event;
+    uint32_t now;
+    uint32_t count = 0;
+
+    if(!rtcAlarmPending)
+    {
+        return 0;
+    }
+    rtcAlarmPending = 0;
+
+    now = rtcGetEpoch();
+
+    while(rtcAlarmHead && ((int32_t)(rtcAlarmHead->when - now) <= 0))
+    {
+        event = rtcAlarmHead;
+        rtcAlarmHead = event->next;
+        event->next = 0;
+        event->queued = 0;
+        rtcAlarmQueued--;
+
+        if(event->periodS)
+        {
+            /*Skip the periods missed while asleep or busy*/
+            do
+            {
+                event->when += event->periodS;
+            } while((int32_t)(event->when - now) <= 0);
+
+            if(event->when < RTC_EPOCH_2100)
+            {
+                rtcAlarmInsert(event);
+            }
+        }
+
+        if(event->callback)
+        {
+            event->callback(event, now);
+        }
+        count++;
+
+        /*Callbacks may take a while*/
+        now = rtcGetEpoch();
+    }
+
+    if(count == 0U)
+    {
+        rtcAlarmStats.early++;
+    }
+    rtcAlarmStats.dispatched += count;
+
+    rtcAlarmProgram();
+
+    return count;
+}
+
+/**
+ * @brief Due time of the first queued event
+ *
+ * @return Unix seconds, 0 if the queue is empty
+ */
+uint32_t rtcAlarmNext(void)
+{
+    return rtcAlarmHead ? rtcAlarmHead->when : 0U;
+}
+
+/**
+ * @brief Enter STOP mode until an interrupt
+ *
+ * @return 1 if the MCU went to STOP, 0 if an event was pending
+ */
+uint8_t rtcAlarmSleep(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t cr = RCC->CR;
+    uint32_t sw = RCC->CFGR & RCC_CFGR_SW;
+
+    /*An interrupt between the check and WFI still ends WFI*/
+    __disable_irq();
+
+    if(rtcAlarmPending)
+    {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+
+    /*STOP (PDDS = 0) with the low-power regulator*/
+    PWR->CR &= ~PWR_CR_PDDS;
+    PWR->CR |= PWR_CR_LPDS;
+    SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+
+    __DSB();
+    __WFI();
+
+    SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+
+    /*Wake-up runs from HSI: restart what was running before*/
+    if(cr & RCC_CR_HSEON)
+    {
+        RCC->CR |= RCC_CR_HSEON;
+        while(!(RCC->CR & RCC_CR_HSERDY)){}
+    }
+    if(cr & RCC_CR_PLLON)
+    {
+        RCC->CR |= RCC_CR_PLLON;
+        while(!(RCC->CR & RCC_CR_PLLRDY)){}
+    }
+    if(sw != RCC_CFGR_SW_HSI)
+    {
+        RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | sw;
+        while((RCC->CFGR & RCC_CFGR_SWS) != (sw << 2)){}
+    }
+
+    __set_PRIMASK(primask);
+
+    /*TR/DR shadows are stale after STOP*/
+    rtcResync();
+
+    return 1;
+}
+
+/**
+ * @brief Copy the scheduler counters
+ *
+ * @return void
+ */
+void rtcAlarmGetStats(rtcAlarmStats_t *stats)
+{
+    *stats = rtcAlarmStats;
+}
+
+/**
+ * @brief RTC Alarm A/B interrupt handler
+ *
+ * @return void
+ */
+void RTC_Alarm_IRQHandler(void)
+{
+    uint32_t flags = RTC->ISR & (RTC_ISR_ALRAF | RTC_ISR_ALRBF);
+
+    if(flags)
+    {
+        RTC->ISR = (~(flags | RTC_ISR_INIT) & 0x0000FFFFU) | (RTC->ISR & RTC_ISR_INIT);
+        rtcAlarmStats.wakeups++;
+        rtcAlarmPending = 1;
+    }
+
+    EXTI->PR = RTC_ALARM_EXTI_LINE;
+}
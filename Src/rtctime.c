@@ -0,0 +1,240 @@
+/**
+ * @file rtctime.c
+ * @brief Calendar, BCD and Unix epoch conversions implementation
+ *
+ * Register field positions are spelled out here because this file does
+ * not include the device headers (RM0383, RTC_TR and RTC_DR).
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "rtctime.h"
+
+/*RTC_TR fields: SU[3:0] ST[6:4] MNU[11:8] MNT[14:12] HU[19:16] HT[21:20]*/
+#define RTC_TIME_SEC_POS        0U
+#define RTC_TIME_MIN_POS        8U
+#define RTC_TIME_HOUR_POS       16U
+
+/*RTC_DR fields: DU/DT[5:0] MU/MT[12:8] WDU[15:13] YU/YT[23:16]*/
+#define RTC_DATE_DAY_POS        0U
+#define RTC_DATE_MONTH_POS      8U
+#define RTC_DATE_WDU_POS        13U
+#define RTC_DATE_YEAR_POS       16U
+
+/*Days from 0000-03-01 to 1970-01-01 in the proleptic Gregorian calendar*/
+#define RTC_CIVIL_SHIFT         719468U
+
+#define RTC_SECONDS_PER_DAY     86400U
+
+const uint8_t rtcBcdEncodeTable[100] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99
+};
+
+/*Invalid BCD bytes decode to 0*/
+const uint8_t rtcBcdDecodeTable[256] =
+{
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  0,  0,  0,  0,  0,  0,
+    10, 11, 12, 13, 14, 15, 16, 17, 18, 19,  0,  0,  0,  0,  0,  0,
+    20, 21, 22, 23, 24, 25, 26, 27, 28, 29,  0,  0,  0,  0,  0,  0,
+    30, 31, 32, 33, 34, 35, 36, 37, 38, 39,  0,  0,  0,  0,  0,  0,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49,  0,  0,  0,  0,  0,  0,
+    50, 51, 52, 53, 54, 55, 56, 57, 58, 59,  0,  0,  0,  0,  0,  0,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69,  0,  0,  0,  0,  0,  0,
+    70, 71, 72, 73, 74, 75, 76, 77, 78, 79,  0,  0,  0,  0,  0,  0,
+    80, 81, 82, 83, 84, 85, 86, 87, 88, 89,  0,  0,  0,  0,  0,  0,
+    90, 91, 92, 93, 94, 95, 96, 97, 98, 99,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+/**
+ * @brief Days since 1970-01-01 of a date
+ *
+ * Years start on March 1st so February is the last month and
+ * 153 * m + 2) / 5 gives the days before month m (0 = March).
+ *
+ * @return Day number
+ */
+uint32_t rtcDaysFromCivil(uint32_t year, uint32_t month, uint32_t day)
+{
+    uint32_t era;
+    uint32_t yoe;
+    uint32_t doy;
+    uint32_t doe;
+
+    year -= (month <= 2U) ? 1U : 0U;
+    era = year / 400U;
+    yoe = year - (era * 400U);
+    doy = (((153U * ((month > 2U) ? (month - 3U) : (month + 9U))) + 2U) / 5U) + day - 1U;
+    doe = (yoe * 365U) + (yoe / 4U) - (yoe / 100U) + doy;
+
+    return (era * 146097U) + doe - RTC_CIVIL_SHIFT;
+}
+
+/**
+ * @brief Date of a day number
+ *
+ * @return void
+ */
+void rtcCivilFromDays(uint32_t days, rtcDateTime_t *dt)
+{
+    uint32_t z = days + RTC_CIVIL_SHIFT;
+    uint32_t era = z / 146097U;
+    uint32_t doe = z - (era * 146097U);
+    uint32_t yoe = (doe - (doe / 1460U) + (doe / 36524U) - (doe / 146096U)) / 365U;
+    uint32_t doy = doe - ((365U * yoe) + (yoe / 4U) - (yoe / 100U));
+    uint32_t mp = ((5U * doy) + 2U) / 153U;
+    uint32_t month = (mp < 10U) ? (mp + 3U) : (mp - 9U);
+    uint32_t year = yoe + (era * 400U) + ((month <= 2U) ? 1U : 0U);
+
+    dt->year = (uint8_t)(year - 2000U);
+    dt->month = (uint8_t)month;
+    dt->day = (uint8_t)(doy - (((153U * mp) + 2U) / 5U) + 1U);
+
+    /*1970-01-01 was a Thursday (4)*/
+    dt->weekDay = (uint8_t)(((days + 3U) % 7U) + 1U);
+}
+
+/**
+ * @brief Unix seconds of a calendar value
+ *
+ * @return Seconds since 1970-01-01 00:00:00
+ */
+uint32_t rtcEpochFromDateTime(const rtcDateTime_t *dt)
+{
+    uint32_t days = rtcDaysFromCivil(2000U + dt->year, dt->month, dt->day);
+
+    return (days * RTC_SECONDS_PER_DAY) + (dt->hours * 3600U) + (dt->minutes * 60U) + dt->seconds;
+}
+
+/**
+ * @brief Unix milliseconds of a calendar value
+ *
+ * @return Milliseconds since 1970-01-01 00:00:00
+ */
+uint64_t rtcEpochMsFromDateTime(const rtcDateTime_t *dt)
+{
+    return ((uint64_t)rtcEpochFromDateTime(dt) * 1000U) + dt->millis;
+}
+
+/**
+ * @brief Split seconds of the day into the time fields
+ *
+ * @param[in] secs Seconds since midnight
+ * @param[out] dt Time fields
+ *
+ * @return void
+ */
+static void rtcTimeFromSeconds(uint32_t secs, rtcDateTime_t *dt)
+{
+    uint32_t minutes = secs / 60U;
+
+    dt->seconds = (uint8_t)(secs - (minutes * 60U));
+    dt->hours = (uint8_t)(minutes / 60U);
+    dt->minutes = (uint8_t)(minutes - (dt->hours * 60U));
+}
+
+/**
+ * @brief Calendar of a Unix time
+ *
+ * @return void
+ */
+void rtcDateTimeFromEpoch(uint32_t seconds, rtcDateTime_t *dt)
+{
+    uint32_t days = seconds / RTC_SECONDS_PER_DAY;
+
+    rtcCivilFromDays(days, dt);
+    rtcTimeFromSeconds(seconds - (days * RTC_SECONDS_PER_DAY), dt);
+    dt->subSeconds = 0;
+    dt->millis = 0;
+}
+
+/**
+ * @brief Calendar of a Unix time in milliseconds
+ *
+ * ms / 1000 = (ms / 8) / 125. ms / 8 is below 2^40, so it is divided
+ * by 125 as three digits (8, 16, 16 bits) of a long division; every
+ * partial dividend fits in 32 bits because the remainder is below 125.
+ * In range the quotient (seconds) fits in 32 bits.
+ *
+ * @return void
+ */
+void rtcDateTimeFromEpochMs(uint64_t ms, rtcDateTime_t *dt)
+{
+    uint64_t x = ms >> 3;
+    uint32_t hi = (uint32_t)(x >> 32);
+    uint32_t lo = (uint32_t)x;
+    uint32_t q1;
+    uint32_t q0;
+    uint32_t r;
+    uint32_t t;
+
+    r = hi % 125U;
+
+    t = (r << 16) | (lo >> 16);
+    q1 = t / 125U;
+    r = t - (q1 * 125U);
+
+    t = (r << 16) | (lo & 0xFFFFU);
+    q0 = t / 125U;
+    r = t - (q0 * 125U);
+
+    rtcDateTimeFromEpoch((q1 << 16) + q0, dt);
+
+    /*Remainder of / 125 and the three bits dropped by / 8*/
+    dt->millis = (uint16_t)((r * 8U) + ((uint32_t)ms & 7U));
+}
+
+/**
+ * @brief Unix seconds of raw RTC registers
+ *
+ * @return Seconds since 1970-01-01 00:00:00
+ */
+uint32_t rtcEpochFromRegs(uint32_t tr, uint32_t dr)
+{
+    uint32_t days = rtcDaysFromCivil(2000U + rtcBcdDecode((dr >> RTC_DATE_YEAR_POS) & 0xFFU),
+                                     rtcBcdDecode((dr >> RTC_DATE_MONTH_POS) & 0x1FU),
+                                     rtcBcdDecode((dr >> RTC_DATE_DAY_POS) & 0x3FU));
+
+    return (days * RTC_SECONDS_PER_DAY) +
+           (rtcBcdDecode((tr >> RTC_TIME_HOUR_POS) & 0x3FU) * 3600U) +
+           (rtcBcdDecode((tr >> RTC_TIME_MIN_POS) & 0x7FU) * 60U) +
+           rtcBcdDecode((tr >> RTC_TIME_SEC_POS) & 0x7FU);
+}
+
+/**
+ * @brief Raw RTC register values of a Unix time
+ *
+ * @return void
+ */
+void rtcRegsFromEpoch(uint32_t seconds, uint32_t *tr, uint32_t *dr)
+{
+    rtcDateTime_t dt;
+
+    rtcDateTimeFromEpoch(seconds, &dt);
+
+    *tr = ((uint32_t)rtcBcdEncode(dt.hours) << RTC_TIME_HOUR_POS) |
+          ((uint32_t)rtcBcdEncode(dt.minutes) << RTC_TIME_MIN_POS) |
+          ((uint32_t)rtcBcdEncode(dt.seconds) << RTC_TIME_SEC_POS);
+
+    *dr = ((uint32_t)rtcBcdEncode(dt.year) << RTC_DATE_YEAR_POS) |
+          ((uint32_t)dt.weekDay << RTC_DATE_WDU_POS) |
+          ((uint32_t)rtcBcdEncode(dt.month) << RTC_DATE_MONTH_POS) |
+          ((uint32_t)rtcBcdEncode(dt.day) << RTC_DATE_DAY_POS);
+}
@@ -0,0 +1,584 @@
+/**
+ * @file sdcard.c
+ * @brief SD card driver implementation
+ *
+ * Only the sdio.c functions and systickMsecDelay() are used, so the
+ * protocol and the stream queue run on the host against the card model
+ * in Tests/sdmodel.c (Tests/sdcardtest.c).
+ *
+ * The stream queue is shared with the data interrupt without locking:
+ * the main loop only advances sdQueued, the interrupt only advances
+ * sdDone, and a transfer is started either by sdStreamSubmit() when the
+ * data path is idle or by the interrupt when more buffers are queued.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "sdcard.h"
+#include "systick.h"
+
+#define SD_CMD_GO_IDLE              0U
+#define SD_CMD_ALL_SEND_CID         2U
+#define SD_CMD_SEND_RELATIVE_ADDR   3U
+#define SD_CMD_SELECT_CARD          7U
+#define SD_CMD_SEND_IF_COND         8U
+#define SD_CMD_SEND_CSD             9U
+#define SD_CMD_STOP_TRANSMISSION    12U
+#define SD_CMD_SEND_STATUS          13U
+#define SD_CMD_SET_BLOCKLEN         16U
+#define SD_CMD_READ_SINGLE          17U
+#define SD_CMD_READ_MULTIPLE        18U
+#define SD_CMD_WRITE_MULTIPLE       25U
+#define SD_CMD_APP                  55U
+#define SD_ACMD_SET_BUS_WIDTH       6U
+#define SD_ACMD_SET_WR_ERASE_COUNT  23U
+#define SD_ACMD_SEND_OP_COND        41U
+
+/*CMD8: 2.7-3.6 V, check pattern 0xAA*/
+#define SD_IF_COND_ARG              0x1AAU
+/*ACMD41: 3.2-3.4 V window*/
+#define SD_OCR_VOLTAGE              0x00300000U
+#define SD_OCR_HCS                  (1U<<30)
+#define SD_OCR_POWER_UP             (1U<<31)
+/*ACMD6: 4-bit bus*/
+#define SD_BUS_WIDTH_4              2U
+
+/*R1 card status*/
+#define SD_R1_ERRORS                0xFDFFE008U
+#define SD_R1_READY_FOR_DATA        (1U<<8)
+#define SD_R1_STATE_Pos             9U
+#define SD_R1_STATE_TRAN            4U
+
+/**
+ * @brief Driver state
+ */
+typedef enum
+{
+    SD_STATE_RESET = 0,     /**< Card not identified */
+    SD_STATE_IDLE,          /**< Card selected, no data transfer */
+    SD_STATE_READING,       /**< Read in progress */
+    SD_STATE_STREAM         /**< Write stream open */
+} sdState_t;
+
+static volatile sdState_t sdState;
+static uint8_t sdHighCapacity;
+static uint32_t sdRca;
+static uint32_t sdBlockCount;
+
+/*Write stream queue*/
+static const uint8_t *sdSlotBuf[SD_STREAM_SLOTS];
+static uint32_t sdSlotBlocks[SD_STREAM_SLOTS];
+static volatile uint32_t sdQueued;
+static volatile uint32_t sdDone;
+static volatile uint8_t sdXferActive;
+static volatile sdioStatus_t sdXferStatus;
+
+static sdStats_t sdStats;
+
+/**
+ * @brief Convert a block number to a command address
+ *
+ * @param[in] lba Block number
+ *
+ * @return Block number (SDHC/SDXC) or byte address (SDSC)
+ */
+static uint32_t sdAddress(uint32_t lba)
+{
+    return sdHighCapacity ? lba : (lba * SD_BLOCK_SIZE);
+}
+
+/**
+ * @brief Send a command with an R1 response and check the card status
+ *
+ * @param[in] index Command index
+ * @param[in] arg Argument
+ * @param[out] status Card status (may be 0)
+ *
+ * @return SD_OK or SD_ERR_CMD
+ */
+static sdStatus_t sdCommandR1(uint8_t index, uint32_t arg, uint32_t *status)
+{
+    uint32_t r1;
+
+    if(sdioSendCommand(index, arg, SDIO_RESP_SHORT, &r1) != SDIO_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    if(status)
+    {
+        *status = r1;
+    }
+
+    return (r1 & SD_R1_ERRORS) ? SD_ERR_CMD : SD_OK;
+}
+
+/**
+ * @brief Send an application command (CMD55 followed by the ACMD)
+ *
+ * @param[in] index Application command index
+ * @param[in] arg Argument
+ *
+ * @return SD_OK or SD_ERR_CMD
+ */
+static sdStatus_t sdAppCommandR1(uint8_t index, uint32_t arg)
+{
+    if(sdCommandR1(SD_CMD_APP, sdRca << 16, 0) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    return sdCommandR1(index, arg, 0);
+}
+
+/**
+ * @brief Wait until the card is back in the transfer state
+ *
+ * Polls SEND_STATUS after a write or a STOP_TRANSMISSION (R1b), while
+ * the card holds D0 low to program the data.
+ *
+ * @return SD_OK or SD_ERR_CMD
+ */
+static sdStatus_t sdWaitReady(void)
+{
+    uint32_t tries;
+    uint32_t status;
+
+    for(tries = 0; tries < SD_READY_TRIES; tries++)
+    {
+        if(sdCommandR1(SD_CMD_SEND_STATUS, sdRca << 16, &status) != SD_OK)
+        {
+            return SD_ERR_CMD;
+        }
+
+        if((status & SD_R1_READY_FOR_DATA) &&
+           (((status >> SD_R1_STATE_Pos) & 0xFU) == SD_R1_STATE_TRAN))
+        {
+            return SD_OK;
+        }
+    }
+
+    return SD_ERR_CMD;
+}
+
+/**
+ * @brief Compute the capacity from the CSD register
+ *
+ * @param[in] csd CSD as returned in RESP1-RESP4 (bits 127-0)
+ *
+ * @return Number of 512-byte blocks
+ */
+static uint32_t sdParseCsd(const uint32_t *csd)
+{
+    uint32_t cSize;
+    uint32_t mult;
+    uint32_t readBlLen;
+
+    if((csd[0] >> 30) == 1U)
+    {
+        /*CSD 2.0: C_SIZE [69:48], capacity = (C_SIZE + 1) * 512 KB*/
+        cSize = ((csd[1] & 0x3FU) << 16) | (csd[2] >> 16);
+
+        return (cSize + 1U) * 1024U;
+    }
+
+    /*CSD 1.0: C_SIZE [73:62], C_SIZE_MULT [49:47], READ_BL_LEN [83:80]*/
+    readBlLen = (csd[1] >> 16) & 0xFU;
+    cSize = ((csd[1] & 0x3FFU) << 2) | (csd[2] >> 30);
+    mult = (csd[2] >> 15) & 0x7U;
+
+    return (cSize + 1U) << (mult + 2U + readBlLen - 9U);
+}
+
+/**
+ * @brief Start the data transfer of the oldest queued stream buffer
+ *
+ * @return void
+ */
+static void sdStreamStartNext(void)
+{
+    uint32_t slot = sdDone % SD_STREAM_SLOTS;
+
+    sdXferActive = 1;
+    sdioStartData((uint8_t *)sdSlotBuf[slot], sdSlotBlocks[slot], 1);
+}
+
+/**
+ * @brief Data completion callback (SDIO interrupt context)
+ *
+ * @param[in] status Result of the transfer
+ *
+ * @return void
+ */
+static void sdDataDone(sdioStatus_t status)
+{
+    sdXferStatus = status;
+
+    if(status != SDIO_OK)
+    {
+        sdStats.dataErrors++;
+        sdXferActive = 0;
+        return;
+    }
+
+    if(sdState != SD_STATE_STREAM)
+    {
+        sdXferActive = 0;
+        return;
+    }
+
+    /*Release the slot just written*/
+    sdStats.blocksWritten += sdSlotBlocks[sdDone % SD_STREAM_SLOTS];
+    sdDone++;
+
+    /*Chain the next buffer without waiting for the main loop*/
+    if(sdQueued != sdDone)
+    {
+        sdStreamStartNext();
+    }
+    else
+    {
+        sdXferActive = 0;
+    }
+}
+
+/**
+ * @brief Initialize the controller and identify the card
+ *
+ * @return SD_OK, SD_ERR_NO_CARD, SD_ERR_UNSUPPORTED or SD_ERR_CMD
+ */
+sdStatus_t sdInit(void)
+{
+    uint32_t resp[4];
+    uint32_t ocrArg = SD_OCR_VOLTAGE;
+    uint32_t tries;
+
+    sdState = SD_STATE_RESET;
+    sdRca = 0;
+    sdBlockCount = 0;
+
+    sdioInit();
+    sdioSetDataCallback(sdDataDone);
+
+    /*At least 74 clocks before the first command*/
+    systickMsecDelay(1);
+
+    sdioSendCommand(SD_CMD_GO_IDLE, 0, SDIO_RESP_NONE, 0);
+
+    /*Version 2.0 cards echo the check pattern, 1.x cards do not answer*/
+    if(sdioSendCommand(SD_CMD_SEND_IF_COND, SD_IF_COND_ARG, SDIO_RESP_SHORT, resp) == SDIO_OK)
+    {
+        if((resp[0] & 0xFFFU) != SD_IF_COND_ARG)
+        {
+            return SD_ERR_UNSUPPORTED;
+        }
+
+        ocrArg |= SD_OCR_HCS;
+    }
+
+    /*Repeat ACMD41 until the card has finished powering up*/
+    for(tries = 0; tries < SD_INIT_TRIES; tries++)
+    {
+        if(sdCommandR1(SD_CMD_APP, 0, 0) != SD_OK)
+        {
+            return (tries == 0U) ? SD_ERR_NO_CARD : SD_ERR_CMD;
+        }
+
+        if(sdioSendCommand(SD_ACMD_SEND_OP_COND, ocrArg, SDIO_RESP_SHORT_NOCRC, resp) != SDIO_OK)
+        {
+            return SD_ERR_CMD;
+        }
+
+        if(resp[0] & SD_OCR_POWER_UP)
+        {
+            break;
+        }
+
+        systickMsecDelay(1);
+    }
+
+    if(tries == SD_INIT_TRIES)
+    {
+        return SD_ERR_UNSUPPORTED;
+    }
+
+    sdHighCapacity = ((resp[0] & SD_OCR_HCS) != 0U);
+
+    /*Identification: CID, then the card publishes its address*/
+    if(sdioSendCommand(SD_CMD_ALL_SEND_CID, 0, SDIO_RESP_LONG, resp) != SDIO_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    if(sdioSendCommand(SD_CMD_SEND_RELATIVE_ADDR, 0, SDIO_RESP_SHORT, resp) != SDIO_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    sdRca = resp[0] >> 16;
+
+    if(sdioSendCommand(SD_CMD_SEND_CSD, sdRca << 16, SDIO_RESP_LONG, resp) != SDIO_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    sdBlockCount = sdParseCsd(resp);
+
+    /*Select the card, switch both sides to 4 bits and full speed*/
+    if(sdCommandR1(SD_CMD_SELECT_CARD, sdRca << 16, 0) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    if(sdAppCommandR1(SD_ACMD_SET_BUS_WIDTH, SD_BUS_WIDTH_4) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    sdioSetBus(SDIO_CLKDIV_TRANSFER, 1);
+
+    /*Fixed 512-byte blocks on standard capacity cards*/
+    if(sdCommandR1(SD_CMD_SET_BLOCKLEN, SD_BLOCK_SIZE, 0) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    sdState = SD_STATE_IDLE;
+
+    return SD_OK;
+}
+
+/**
+ * @brief Card capacity
+ *
+ * @return Number of 512-byte blocks
+ */
+uint32_t sdGetBlockCount(void)
+{
+    return sdBlockCount;
+}
+
+/**
+ * @brief Read blocks (CMD17 or CMD18)
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ */
+sdStatus_t sdReadBlocks(uint32_t lba, uint8_t *buf, uint32_t count)
+{
+    sdStatus_t result = SD_OK;
+    uint8_t cmd = (count > 1U) ? SD_CMD_READ_MULTIPLE : SD_CMD_READ_SINGLE;
+
+    if((sdState != SD_STATE_IDLE) || (count == 0U))
+    {
+        return SD_ERR_STATE;
+    }
+
+    sdState = SD_STATE_READING;
+    sdXferActive = 1;
+
+    /*Reads: arm the data path before the command*/
+    sdioStartData(buf, count, 0);
+
+    if(sdCommandR1(cmd, sdAddress(lba), 0) != SD_OK)
+    {
+        sdioAbortData();
+        sdState = SD_STATE_IDLE;
+        return SD_ERR_CMD;
+    }
+
+    /*Bounded by the hardware data timeout*/
+    while(sdXferActive){}
+
+    if(sdXferStatus != SDIO_OK)
+    {
+        result = SD_ERR_DATA;
+    }
+    else
+    {
+        sdStats.blocksRead += count;
+    }
+
+    if(cmd == SD_CMD_READ_MULTIPLE)
+    {
+        if(sdCommandR1(SD_CMD_STOP_TRANSMISSION, 0, 0) != SD_OK)
+        {
+            result = SD_ERR_CMD;
+        }
+    }
+
+    sdState = SD_STATE_IDLE;
+
+    return result;
+}
+
+/**
+ * @brief Write blocks (one-shot stream)
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ */
+sdStatus_t sdWriteBlocks(uint32_t lba, const uint8_t *buf, uint32_t count)
+{
+    sdStatus_t result;
+
+    result = sdStreamOpen(lba, count);
+
+    if(result != SD_OK)
+    {
+        return result;
+    }
+
+    result = sdStreamSubmit(buf, count);
+
+    if(result != SD_OK)
+    {
+        sdStreamClose();
+        return result;
+    }
+
+    return sdStreamClose();
+}
+
+/**
+ * @brief Open a multi-block write stream
+ *
+ * @return SD_OK, SD_ERR_STATE or SD_ERR_CMD
+ */
+sdStatus_t sdStreamOpen(uint32_t lba, uint32_t preErase)
+{
+    if(sdState != SD_STATE_IDLE)
+    {
+        return SD_ERR_STATE;
+    }
+
+    /*Let the card erase the whole range up front (23-bit count)*/
+    if(preErase)
+    {
+        if(preErase > 0x7FFFFFU)
+        {
+            preErase = 0x7FFFFFU;
+        }
+
+        if(sdAppCommandR1(SD_ACMD_SET_WR_ERASE_COUNT, preErase) != SD_OK)
+        {
+            return SD_ERR_CMD;
+        }
+    }
+
+    if(sdCommandR1(SD_CMD_WRITE_MULTIPLE, sdAddress(lba), 0) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    sdQueued = 0;
+    sdDone = 0;
+    sdXferActive = 0;
+    sdXferStatus = SDIO_OK;
+    sdStats.streamsOpened++;
+
+    sdState = SD_STATE_STREAM;
+
+    return SD_OK;
+}
+
+/**
+ * @brief Queue a buffer on the write stream
+ *
+ * @return SD_OK, SD_BUSY, SD_ERR_STATE or SD_ERR_DATA
+ */
+sdStatus_t sdStreamSubmit(const uint8_t *buf, uint32_t blocks)
+{
+    uint32_t slot;
+
+    if((sdState != SD_STATE_STREAM) || (blocks == 0U))
+    {
+        return SD_ERR_STATE;
+    }
+
+    if(sdXferStatus != SDIO_OK)
+    {
+        return SD_ERR_DATA;
+    }
+
+    if((sdQueued - sdDone) >= SD_STREAM_SLOTS)
+    {
+        sdStats.queueFull++;
+        return SD_BUSY;
+    }
+
+    slot = sdQueued % SD_STREAM_SLOTS;
+    sdSlotBuf[slot] = buf;
+    sdSlotBlocks[slot] = blocks;
+    sdQueued++;
+
+    /*The interrupt chains buffers while a transfer is running*/
+    if(!sdXferActive)
+    {
+        sdStreamStartNext();
+    }
+
+    return SD_OK;
+}
+
+/**
+ * @brief Number of free slots on the write stream queue
+ *
+ * @return 0 to SD_STREAM_SLOTS
+ */
+uint8_t sdStreamSlotsFree(void)
+{
+    if(sdState != SD_STATE_STREAM)
+    {
+        return SD_STREAM_SLOTS;
+    }
+
+    return (uint8_t)(SD_STREAM_SLOTS - (sdQueued - sdDone));
+}
+
+/**
+ * @brief Finish the write stream
+ *
+ * @return SD_OK, SD_ERR_STATE, SD_ERR_CMD or SD_ERR_DATA
+ */
+sdStatus_t sdStreamClose(void)
+{
+    sdStatus_t result = SD_OK;
+
+    if(sdState != SD_STATE_STREAM)
+    {
+        return SD_ERR_STATE;
+    }
+
+    /*Drain the queue (bounded by the hardware data timeout per buffer)*/
+    while(sdXferActive){}
+
+    if(sdXferStatus != SDIO_OK)
+    {
+        result = SD_ERR_DATA;
+    }
+
+    sdState = SD_STATE_IDLE;
+
+    if(sdCommandR1(SD_CMD_STOP_TRANSMISSION, 0, 0) != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    if(sdWaitReady() != SD_OK)
+    {
+        return SD_ERR_CMD;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Copy the transfer counters
+ *
+ * @return void
+ */
+void sdGetStats(sdStats_t *stats)
+{
+    *stats = sdStats;
+}
@@ -0,0 +1,302 @@
+/**
+ * @file sdio.c
+ * @brief SDIO host controller driver implementation
+ *
+ * Commands are sent with the command path state machine and polled
+ * until the response (or its timeout) arrives. Data blocks are moved by
+ * DMA2 Stream6 under SDIO flow control; the data path interrupt reports
+ * the end of the transfer.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "sdio.h"
+#include "dma.h"
+#include "clock.h"
+
+/*SDIO request: DMA2 Stream6, channel 4*/
+#define SDIO_DMA_STREAM     6U
+#define SDIO_DMA_CHANNEL    4U
+
+/*512-byte blocks: DBLOCKSIZE = log2(512)*/
+#define SDIO_DBLOCKSIZE     9U
+
+#define SDIO_CMD_FLAGS      (SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT | SDIO_STA_CMDREND | SDIO_STA_CMDSENT)
+#define SDIO_DATA_ERRORS    (SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_TXUNDERR | \
+                             SDIO_STA_RXOVERR | SDIO_STA_STBITERR)
+#define SDIO_DATA_FLAGS     (SDIO_DATA_ERRORS | SDIO_STA_DATAEND | SDIO_STA_DBCKEND)
+
+static sdioDataCallback_t sdioDataCallback;
+static volatile uint8_t sdioRxActive;
+
+/**
+ * @brief Initialize pins, clocks and the controller
+ *
+ * @return void
+ */
+void sdioInit(void)
+{
+    /*SDIOCLK comes from PLL48CK*/
+    clockEnablePll48();
+
+    /*Enable clock access to GPIOC, GPIOD and SDIO*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOCEN | RCC_AHB1ENR_GPIODEN;
+    RCC->APB2ENR |= RCC_APB2ENR_SDIOEN;
+
+    /*PC8-PC12 alternate function mode*/
+    GPIOC->MODER &= ~(0x3FFU << 16);
+    GPIOC->MODER |= (0x2AAU << 16);
+
+    /*PC8-PC12 very high speed*/
+    GPIOC->OSPEEDR |= (0x3FFU << 16);
+
+    /*Pull-up on D0-D3, none on CK*/
+    GPIOC->PUPDR &= ~(0x3FFU << 16);
+    GPIOC->PUPDR |= (0x55U << 16);
+
+    /*PC8-PC12 AF12 (SDIO)*/
+    GPIOC->AFR[1] &= ~(0xFFFFFU);
+    GPIOC->AFR[1] |= 0xCCCCCU;
+
+    /*PD2 alternate function mode, very high speed, pull-up, AF12*/
+    GPIOD->MODER &= ~(3U << 4);
+    GPIOD->MODER |= (2U << 4);
+    GPIOD->OSPEEDR |= (3U << 4);
+    GPIOD->PUPDR &= ~(3U << 4);
+    GPIOD->PUPDR |= (1U << 4);
+    GPIOD->AFR[0] &= ~(0xFU << 8);
+    GPIOD->AFR[0] |= (0xCU << 8);
+
+    /*Reset the controller*/
+    RCC->APB2RSTR |= RCC_APB2RSTR_SDIORST;
+    RCC->APB2RSTR &= ~RCC_APB2RSTR_SDIORST;
+
+    /*1-bit bus at 400 kHz for card identification*/
+    sdioSetBus(SDIO_CLKDIV_INIT, 0);
+
+    /*Power on the card bus*/
+    SDIO->POWER = SDIO_POWER_PWRCTRL;
+
+    /*Data interrupts are enabled per transfer*/
+    SDIO->MASK = 0;
+    SDIO->ICR = SDIO_CMD_FLAGS | SDIO_DATA_FLAGS;
+    NVIC_EnableIRQ(SDIO_IRQn);
+}
+
+/**
+ * @brief Change the bus clock and width
+ *
+ * @return void
+ */
+void sdioSetBus(uint8_t clkdiv, uint8_t wide)
+{
+    uint32_t clkcr = SDIO_CLKCR_CLKEN | clkdiv;
+
+    if(wide)
+    {
+        clkcr |= SDIO_CLKCR_WIDBUS_0;
+    }
+
+    SDIO->CLKCR = clkcr;
+}
+
+/**
+ * @brief Send a command and wait for its response
+ *
+ * @return SDIO_OK, SDIO_ERR_TIMEOUT or SDIO_ERR_CRC
+ */
+sdioStatus_t sdioSendCommand(uint8_t index, uint32_t arg, sdioResp_t resp, uint32_t *response)
+{
+    uint32_t cmd = (index & SDIO_CMD_CMDINDEX) | SDIO_CMD_CPSMEN;
+    uint32_t sta;
+
+    if(resp == SDIO_RESP_LONG)
+    {
+        cmd |= SDIO_CMD_WAITRESP_0 | SDIO_CMD_WAITRESP_1;
+    }
+    else if(resp != SDIO_RESP_NONE)
+    {
+        cmd |= SDIO_CMD_WAITRESP_0;
+    }
+
+    SDIO->ICR = SDIO_CMD_FLAGS;
+    SDIO->ARG = arg;
+    SDIO->CMD = cmd;
+
+    if(resp == SDIO_RESP_NONE)
+    {
+        /*Wait until the command has been clocked out*/
+        while(!(SDIO->STA & SDIO_STA_CMDSENT)){}
+        SDIO->ICR = SDIO_CMD_FLAGS;
+
+        return SDIO_OK;
+    }
+
+    /*Wait for the response or the response timeout*/
+    do
+    {
+        sta = SDIO->STA;
+    } while(!(sta & (SDIO_STA_CMDREND | SDIO_STA_CCRCFAIL | SDIO_STA_CTIMEOUT)));
+
+    SDIO->ICR = SDIO_CMD_FLAGS;
+
+    if(sta & SDIO_STA_CTIMEOUT)
+    {
+        return SDIO_ERR_TIMEOUT;
+    }
+
+    /*R3 carries no valid CRC, the failure flag is expected*/
+    if((sta & SDIO_STA_CCRCFAIL) && (resp != SDIO_RESP_SHORT_NOCRC))
+    {
+        return SDIO_ERR_CRC;
+    }
+
+    if(response)
+    {
+        response[0] = SDIO->RESP1;
+
+        if(resp == SDIO_RESP_LONG)
+        {
+            response[1] = SDIO->RESP2;
+            response[2] = SDIO->RESP3;
+            response[3] = SDIO->RESP4;
+        }
+    }
+
+    return SDIO_OK;
+}
+
+/**
+ * @brief Start a block data transfer
+ *
+ * @return void
+ */
+void sdioStartData(uint8_t *buf, uint32_t blocks, uint8_t toCard)
+{
+    DMA_Stream_TypeDef *s = dmaGetStream(DMA2, SDIO_DMA_STREAM);
+    uint32_t cr;
+    uint32_t dctrl;
+
+    /*Peripheral flow control, word accesses in 4-beat bursts*/
+    cr = DMA_SxCR_PFCTRL | DMA_SxCR_MINC |
+         DMA_SxCR_PSIZE_1 | DMA_SxCR_MSIZE_1 |
+         DMA_SxCR_PBURST_0 | DMA_SxCR_MBURST_0 |
+         DMA_SxCR_PL_0 | DMA_SxCR_PL_1;
+
+    if(toCard)
+    {
+        cr |= DMA_SxCR_DIR_0;
+    }
+
+    /*Item count is ignored under peripheral flow control*/
+    dmaStreamConfig(DMA2, SDIO_DMA_STREAM, SDIO_DMA_CHANNEL, cr, &SDIO->FIFO, buf, 0);
+
+    /*Bursts need the FIFO: direct mode off, full threshold*/
+    s->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0 | DMA_SxFCR_FTH_1;
+
+    dmaStreamStart(DMA2, SDIO_DMA_STREAM);
+
+    sdioRxActive = (toCard == 0);
+
+    /*Program the data path state machine*/
+    SDIO->ICR = SDIO_DATA_FLAGS;
+    SDIO->DTIMER = SDIO_DATA_TIMEOUT;
+    SDIO->DLEN = blocks * SDIO_BLOCK_SIZE;
+    SDIO->MASK = SDIO_MASK_DATAENDIE | SDIO_MASK_DCRCFAILIE | SDIO_MASK_DTIMEOUTIE |
+                 SDIO_MASK_TXUNDERRIE | SDIO_MASK_RXOVERRIE | SDIO_MASK_STBITERRIE;
+
+    dctrl = SDIO_DCTRL_DTEN | SDIO_DCTRL_DMAEN | (SDIO_DBLOCKSIZE << SDIO_DCTRL_DBLOCKSIZE_Pos);
+
+    if(!toCard)
+    {
+        dctrl |= SDIO_DCTRL_DTDIR;
+    }
+
+    SDIO->DCTRL = dctrl;
+}
+
+/**
+ * @brief Abort the data transfer in progress
+ *
+ * @return void
+ */
+void sdioAbortData(void)
+{
+    SDIO->MASK = 0;
+    SDIO->DCTRL = 0;
+    SDIO->ICR = SDIO_DATA_FLAGS;
+
+    dmaStreamStop(DMA2, SDIO_DMA_STREAM);
+    dmaClearFlags(DMA2, SDIO_DMA_STREAM, DMA_FLAG_ALL);
+}
+
+/**
+ * @brief Register the data completion callback
+ *
+ * @return void
+ */
+void sdioSetDataCallback(sdioDataCallback_t callback)
+{
+    sdioDataCallback = callback;
+}
+
+/**
+ * @brief SDIO interrupt handler
+ *
+ * Maps the data path flags to a status, stops the DMA stream on error
+ * and reports the result.
+ *
+ * @return void
+ */
+void SDIO_IRQHandler(void)
+{
+    uint32_t sta = SDIO->STA;
+    sdioStatus_t status = SDIO_OK;
+
+    if(!(sta & (SDIO_STA_DATAEND | SDIO_DATA_ERRORS)))
+    {
+        return;
+    }
+
+    SDIO->MASK = 0;
+    SDIO->ICR = SDIO_DATA_FLAGS;
+
+    if(sta & SDIO_STA_DTIMEOUT)
+    {
+        status = SDIO_ERR_TIMEOUT;
+    }
+    else if(sta & SDIO_STA_DCRCFAIL)
+    {
+        status = SDIO_ERR_CRC;
+    }
+    else if(sta & (SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR | SDIO_STA_STBITERR))
+    {
+        status = SDIO_ERR_FIFO;
+    }
+    else if(dmaGetFlags(DMA2, SDIO_DMA_STREAM) & DMA_FLAG_TE)
+    {
+        status = SDIO_ERR_DMA;
+    }
+
+    if(status != SDIO_OK)
+    {
+        sdioAbortData();
+    }
+    else
+    {
+        /*On reads the DMA drains the last burst after DATAEND*/
+        if(sdioRxActive)
+        {
+            while(dmaGetStream(DMA2, SDIO_DMA_STREAM)->CR & DMA_SxCR_EN){}
+        }
+
+        dmaClearFlags(DMA2, SDIO_DMA_STREAM, DMA_FLAG_ALL);
+    }
+
+    if(sdioDataCallback)
+    {
+        sdioDataCallback(status);
+    }
+}
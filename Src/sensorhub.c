@@ -0,0 +1,549 @@
+/**
+ * @file sensorhub.c
+ * @brief Timer-scheduled I2C sensor sampling implementation
+ *
+ * The TIM5 compare interrupt submits one scheduler job per due device;
+ * the job completion callback decodes the burst and appends the sample
+ * to the device ring. Rings have a single producer (the completion
+ * callback) and a single consumer (the application), so they need no
+ * locking.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "sensorhub.h"
+#include "timer.h"
+
+#define LSM303_ACC_ADDR         0x19U
+#define LSM303_MAG_ADDR         0x1EU
+
+#define LSM303_CTRL_REG1_A      0x20U
+#define LSM303_CTRL_REG4_A      0x23U
+#define LSM303_STATUS_REG_A     0x27U
+#define LSM303_CRA_REG_M        0x00U
+#define LSM303_CRB_REG_M        0x01U
+#define LSM303_MR_REG_M         0x02U
+#define LSM303_OUT_X_H_M        0x03U
+#define LSM303_IRA_REG_M        0x0AU
+
+#define LSM303_ACC_AUTOINC      (1U<<7)
+#define LSM303_MAG_ID           0x48U   // 'H'
+
+#define CTRL1_A_ODR400_XYZ      0x77U   // ODR=0111, LPen=0, Zen=Yen=Xen=1
+#define ACC_ODR_PERIOD_US       2500U   // 400 Hz
+#define CTRL4_A_BDU_HR_2G       0x88U   // BDU=1, FS=00, HR=1
+#define STATUS_A_ZYXDA          (1U<<3)
+#define CRA_M_ODR75             0x18U   // DO=110
+#define CRB_M_GAIN_1_3          0x20U   // +-1.3 gauss
+#define MR_M_CONTINUOUS         0x00U
+
+/** Longest burst (status + 3 axes) */
+#define SENSOR_HUB_MAX_BURST    7U
+
+/** Deadline of the blocking configuration writes */
+#define SENSOR_HUB_CFG_TIMEOUT_US   20000U
+
+/**
+ * @brief Turn a raw burst into three axes
+ *
+ * @param raw Burst bytes
+ * @param xyz Decoded X, Y, Z
+ *
+ * @return 1 if the burst holds a new sample, 0 if it is stale
+ */
+typedef uint8_t (*sensorHubDecode_t)(const uint8_t *raw, int16_t *xyz);
+
+/**
+ * @brief Fixed description of a sampled device
+ */
+typedef struct
+{
+    uint8_t addr;               /**< 7-bit I2C address */
+    uint8_t reg;                /**< First register of the burst */
+    uint8_t len;                /**< Burst length in bytes */
+    uint8_t drdy;               /**< 1 if gated and timestamped by a DRDY edge */
+    uint16_t timeErrUs;         /**< Worst-case age of the sample at its time stamp */
+    sensorHubDecode_t decode;   /**< Burst decoder */
+} sensorHubDesc_t;
+
+static uint8_t sensorHubDecodeAccel(const uint8_t *raw, int16_t *xyz);
+static uint8_t sensorHubDecodeMag(const uint8_t *raw, int16_t *xyz);
+
+static const sensorHubDesc_t sensorHubDesc[SENSOR_HUB_DEVICE_COUNT] =
+{
+    /*STATUS_REG_A then OUT_X_L_A..OUT_Z_H_A*/
+    {LSM303_ACC_ADDR, LSM303_STATUS_REG_A | LSM303_ACC_AUTOINC, 7U, 0U, ACC_ODR_PERIOD_US, sensorHubDecodeAccel},
+    /*OUT_X_H_M..OUT_Y_L_M, the pointer wraps after 0x08*/
+    {LSM303_MAG_ADDR, LSM303_OUT_X_H_M, 6U, 1U, 0U, sensorHubDecodeMag}
+};
+
+static i2cJob_t sensorHubJobs[SENSOR_HUB_DEVICE_COUNT];
+static uint8_t sensorHubRaw[SENSOR_HUB_DEVICE_COUNT][SENSOR_HUB_MAX_BURST];
+/*Time of the burst in flight: DRDY edge (latch) or tick (read) time*/
+static uint32_t sensorHubSampleTime[SENSOR_HUB_DEVICE_COUNT];
+static volatile uint8_t sensorHubBusy[SENSOR_HUB_DEVICE_COUNT];
+static sensorHubRing_t sensorHubRings[SENSOR_HUB_DEVICE_COUNT];
+
+/*Last DRDY edge of the magnetometer, set from EXTI2*/
+static volatile uint32_t sensorHubDrdyTime;
+static volatile uint8_t sensorHubDrdySeen;
+static volatile uint32_t sensorHubDrdyCount;
+/*Edge count when the burst in flight was submitted*/
+static uint32_t sensorHubDrdyMark;
+
+static sensorHubStats_t sensorHubStats;
+
+/**
+ * @brief Decode an accelerometer burst (little endian, 12-bit left aligned)
+ *
+ * @param[in] raw STATUS_REG_A followed by the output registers
+ * @param[out] xyz Decoded axes
+ *
+ * @return 1 if ZYXDA was set
+ */
+static uint8_t sensorHubDecodeAccel(const uint8_t *raw, int16_t *xyz)
+{
+    xyz[0] = (int16_t)((uint16_t)raw[1] | ((uint16_t)raw[2] << 8)) >> 4;
+    xyz[1] = (int16_t)((uint16_t)raw[3] | ((uint16_t)raw[4] << 8)) >> 4;
+    xyz[2] = (int16_t)((uint16_t)raw[5] | ((uint16_t)raw[6] << 8)) >> 4;
+
+    return ((raw[0] & STATUS_A_ZYXDA) != 0U);
+}
+
+/**
+ * @brief Decode a magnetometer burst (big endian, X/Z/Y order)
+ *
+ * @param[in] raw Output registers from OUT_X_H_M
+ * @param[out] xyz Decoded axes
+ *
+ * @return 1 (freshness comes from the DRDY edge)
+ */
+static uint8_t sensorHubDecodeMag(const uint8_t *raw, int16_t *xyz)
+{
+    xyz[0] = (int16_t)(((uint16_t)raw[0] << 8) | raw[1]);
+    xyz[2] = (int16_t)(((uint16_t)raw[2] << 8) | raw[3]);
+    xyz[1] = (int16_t)(((uint16_t)raw[4] << 8) | raw[5]);
+
+    return 1;
+}
+
+/**
+ * @brief Run one register access through the scheduler and wait for it
+ *
+ * @param[in] dev Device (its job is used)
+ * @param[in] reg Register address
+ * @param[in] tx Byte to write, or 0 to read
+ * @param[out] rx Destination of the read byte
+ *
+ * @return Transfer status
+ */
+static i2cStatus_t sensorHubAccess(sensorHubDevice_t dev, uint8_t reg, const uint8_t *tx, uint8_t *rx)
+{
+    i2cJob_t *job = &sensorHubJobs[dev];
+    uint32_t start;
+
+    job->xfer.addr = sensorHubDesc[dev].addr;
+    job->xfer.headerLen = 1;
+    job->xfer.header[0] = reg;
+    job->xfer.txBuf = tx;
+    job->xfer.txLen = tx ? 1U : 0U;
+    job->xfer.rxBuf = rx;
+    job->xfer.rxLen = tx ? 0U : 1U;
+
+    job->priority = I2C_SCHED_PRIO_NORMAL;
+    job->retries = 1;
+    job->timeoutUs = SENSOR_HUB_CFG_TIMEOUT_US;
+    job->done = 0;
+
+    /*A full queue drains as the other jobs finish*/
+    start = timGetMicros();
+    while(!i2cSchedSubmit(job))
+    {
+        if((timGetMicros() - start) >= SENSOR_HUB_CFG_TIMEOUT_US)
+        {
+            return I2C_ERR_TIMEOUT;
+        }
+        i2cSchedPoll();
+    }
+
+    /*Released only after the retry, rx is written until then*/
+    while(i2cSchedBusy(job))
+    {
+        i2cSchedPoll();
+    }
+
+    return job->xfer.status;
+}
+
+/**
+ * @brief Write one sensor register (blocking)
+ *
+ * @param[in] dev Device
+ * @param[in] reg Register address
+ * @param[in] value Value to write
+ *
+ * @return 1 on success, 0 on error
+ */
+static uint8_t sensorHubWriteReg(sensorHubDevice_t dev, uint8_t reg, uint8_t value)
+{
+    return (sensorHubAccess(dev, reg, &value, 0) == I2C_OK);
+}
+
+/**
+ * @brief Append a sample to a device ring
+ *
+ * @param[in] dev Device
+ * @param[in] t Latch time
+ * @param[in] xyz Axes
+ *
+ * @return void
+ */
+static void sensorHubPush(uint32_t dev, uint32_t t, const int16_t *xyz)
+{
+    sensorHubRing_t *ring = &sensorHubRings[dev];
+    uint32_t head = ring->head;
+    uint32_t i;
+
+    if((head - ring->tail) >= SENSOR_HUB_RING_SIZE)
+    {
+        sensorHubStats.dropped[dev]++;
+        return;
+    }
+
+    i = head & (SENSOR_HUB_RING_SIZE - 1U);
+    ring->t[i] = t;
+    ring->x[i] = xyz[0];
+    ring->y[i] = xyz[1];
+    ring->z[i] = xyz[2];
+
+    /*Publish after the data is in place*/
+    ring->head = head + 1U;
+    sensorHubStats.samples[dev]++;
+}
+
+/**
+ * @brief Burst completion (scheduler callback)
+ *
+ * @param[in] job Finished job
+ *
+ * @return void
+ */
+static void sensorHubDone(i2cJob_t *job)
+{
+    uint32_t dev = (uint32_t)(job - sensorHubJobs);
+    int16_t xyz[3];
+
+    if(job->xfer.status == I2C_OK)
+    {
+        sensorHubStats.bursts[dev]++;
+
+        if(sensorHubDesc[dev].drdy && (sensorHubDrdyCount != sensorHubDrdyMark))
+        {
+            /*An edge during the burst: the registers may already hold the
+              next sample. That edge is still latched, so the next tick
+              reads it with its own time instead*/
+            sensorHubStats.superseded[dev]++;
+        }
+        else if(sensorHubDesc[dev].decode(sensorHubRaw[dev], xyz))
+        {
+            sensorHubPush(dev, sensorHubSampleTime[dev], xyz);
+        }
+    }
+    else
+    {
+        sensorHubStats.errors[dev]++;
+    }
+
+    sensorHubBusy[dev] = 0;
+}
+
+/**
+ * @brief Submit the bursts of one tick
+ *
+ * @param[in] tick Compare time of the tick
+ *
+ * @return void
+ */
+static void sensorHubTick(uint32_t tick)
+{
+    const sensorHubDesc_t *desc;
+    i2cJob_t *job;
+    uint32_t primask;
+    uint8_t seen;
+
+    sensorHubStats.ticks++;
+
+    for(uint32_t dev = 0; dev < SENSOR_HUB_DEVICE_COUNT; dev++)
+    {
+        desc = &sensorHubDesc[dev];
+
+        if(sensorHubBusy[dev])
+        {
+            sensorHubStats.overruns[dev]++;
+            continue;
+        }
+
+        if(desc->drdy)
+        {
+            /*Take the latch and its edge count in one go against EXTI2*/
+            primask = __get_PRIMASK();
+            __disable_irq();
+            seen = sensorHubDrdySeen;
+            sensorHubSampleTime[dev] = sensorHubDrdyTime;
+            sensorHubDrdyMark = sensorHubDrdyCount;
+            sensorHubDrdySeen = 0;
+            __set_PRIMASK(primask);
+
+            /*Nothing latched since the last burst*/
+            if(!seen)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            /*No latch edge: the read time, up to one ODR period late*/
+            sensorHubSampleTime[dev] = tick;
+        }
+
+        job = &sensorHubJobs[dev];
+        job->xfer.addr = desc->addr;
+        job->xfer.headerLen = 1;
+        job->xfer.header[0] = desc->reg;
+        job->xfer.txBuf = 0;
+        job->xfer.txLen = 0;
+        job->xfer.rxBuf = sensorHubRaw[dev];
+        job->xfer.rxLen = desc->len;
+
+        /*The burst must finish before the next tick*/
+        job->priority = SENSOR_HUB_PRIORITY;
+        job->retries = 0;
+        job->timeoutUs = SENSOR_HUB_TICK_US;
+        job->done = sensorHubDone;
+
+        sensorHubBusy[dev] = 1;
+        if(!i2cSchedSubmit(job))
+        {
+            /*Queue full: no completion will come*/
+            sensorHubBusy[dev] = 0;
+            sensorHubStats.errors[dev]++;
+        }
+    }
+}
+
+/**
+ * @brief Set up PE2 (magnetometer DRDY) as EXTI2 rising edge
+ *
+ * @return void
+ */
+static void sensorHubDrdyInit(void)
+{
+    /*Enable clock access to GPIOE and SYSCFG*/
+    RCC->AHB1ENR |= RCC_AHB1ENR_GPIOEEN;
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+
+    /*PE2 as input, no pull (push-pull output on the sensor)*/
+    GPIOE->MODER &= ~(GPIO_MODER_MODER2);
+    GPIOE->PUPDR &= ~(GPIO_PUPDR_PUPDR2);
+
+    /*Select PORTE for EXTI2*/
+    SYSCFG->EXTICR[0] &= ~SYSCFG_EXTICR1_EXTI2;
+    SYSCFG->EXTICR[0] |= SYSCFG_EXTICR1_EXTI2_PE;
+
+    /*Unmask EXTI2, rising edge*/
+    EXTI->IMR |= EXTI_IMR_MR2;
+    EXTI->RTSR |= EXTI_RTSR_TR2;
+    EXTI->PR = EXTI_PR_PR2;
+
+    NVIC_EnableIRQ(EXTI2_IRQn);
+}
+
+/**
+ * @brief Configure the sensors and start sampling
+ *
+ * @return Bit mask of the devices that answered
+ */
+uint32_t sensorHubInit(void)
+{
+    uint32_t found = 0;
+    uint8_t id = 0;
+
+    tim5TimebaseInit();
+
+    for(uint32_t dev = 0; dev < SENSOR_HUB_DEVICE_COUNT; dev++)
+    {
+        sensorHubBusy[dev] = 0;
+        sensorHubRings[dev].head = 0;
+        sensorHubRings[dev].tail = 0;
+    }
+    sensorHubDrdySeen = 0;
+
+    /*Accelerometer: 400 Hz, block data update so a burst is coherent*/
+    if(sensorHubWriteReg(SENSOR_HUB_ACCEL, LSM303_CTRL_REG4_A, CTRL4_A_BDU_HR_2G) &&
+       sensorHubWriteReg(SENSOR_HUB_ACCEL, LSM303_CTRL_REG1_A, CTRL1_A_ODR400_XYZ))
+    {
+        found |= (1U << SENSOR_HUB_ACCEL);
+    }
+
+    /*Magnetometer: identify, 75 Hz continuous conversion*/
+    if((sensorHubAccess(SENSOR_HUB_MAG, LSM303_IRA_REG_M, 0, &id) == I2C_OK) && (id == LSM303_MAG_ID) &&
+       sensorHubWriteReg(SENSOR_HUB_MAG, LSM303_CRA_REG_M, CRA_M_ODR75) &&
+       sensorHubWriteReg(SENSOR_HUB_MAG, LSM303_CRB_REG_M, CRB_M_GAIN_1_3) &&
+       sensorHubWriteReg(SENSOR_HUB_MAG, LSM303_MR_REG_M, MR_M_CONTINUOUS))
+    {
+        found |= (1U << SENSOR_HUB_MAG);
+    }
+
+    sensorHubDrdyInit();
+
+    /*Channel 1 compare on the time base, frozen output (interrupt only)*/
+    TIM5->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_OC1M | TIM_CCMR1_OC1PE);
+    TIM5->CCR1 = timGetMicros() + SENSOR_HUB_TICK_US;
+    TIM5->SR = ~TIM_SR_CC1IF;
+    TIM5->DIER |= TIM_DIER_CC1IE;
+    NVIC_EnableIRQ(TIM5_IRQn);
+
+    return found;
+}
+
+/**
+ * @brief Stop the tick
+ *
+ * @return void
+ */
+void sensorHubStop(void)
+{
+    TIM5->DIER &= ~TIM_DIER_CC1IE;
+    EXTI->IMR &= ~EXTI_IMR_MR2;
+}
+
+/**
+ * @brief Number of samples waiting in a device ring
+ *
+ * @return Sample count
+ */
+uint32_t sensorHubAvailable(sensorHubDevice_t dev)
+{
+    return sensorHubRings[dev].head - sensorHubRings[dev].tail;
+}
+
+/**
+ * @brief Pop samples from a device ring
+ *
+ * @return Number of samples copied
+ */
+uint32_t sensorHubRead(sensorHubDevice_t dev, uint32_t *t, int16_t *x, int16_t *y, int16_t *z, uint32_t n)
+{
+    sensorHubRing_t *ring = &sensorHubRings[dev];
+    uint32_t tail = ring->tail;
+    uint32_t count = ring->head - tail;
+    uint32_t i;
+
+    if(count > n)
+    {
+        count = n;
+    }
+
+    for(uint32_t k = 0; k < count; k++)
+    {
+        i = (tail + k) & (SENSOR_HUB_RING_SIZE - 1U);
+
+        if(t)
+        {
+            t[k] = ring->t[i];
+        }
+        if(x)
+        {
+            x[k] = ring->x[i];
+        }
+        if(y)
+        {
+            y[k] = ring->y[i];
+        }
+        if(z)
+        {
+            z[k] = ring->z[i];
+        }
+    }
+
+    /*Release the entries after they are copied*/
+    ring->tail = tail + count;
+
+    return count;
+}
+
+/**
+ * @brief Direct access to a device ring
+ *
+ * @return Ring of the device
+ */
+sensorHubRing_t *sensorHubGetRing(sensorHubDevice_t dev)
+{
+    return &sensorHubRings[dev];
+}
+
+/**
+ * @brief Copy the hub counters
+ *
+ * @return void
+ */
+void sensorHubGetStats(sensorHubStats_t *stats)
+{
+    *stats = sensorHubStats;
+}
+
+/**
+ * @brief Worst-case age of a sample at its time stamp
+ *
+ * @return Microseconds (0 for a latch time)
+ */
+uint32_t sensorHubTimeErrorUs(sensorHubDevice_t dev)
+{
+    return sensorHubDesc[dev].timeErrUs;
+}
+
+/**
+ * @brief TIM5 interrupt handler (channel 1 compare tick)
+ *
+ * @return void
+ */
+void TIM5_IRQHandler(void)
+{
+    uint32_t tick;
+
+    if(TIM5->SR & TIM_SR_CC1IF)
+    {
+        /*rc_w0: write 0 to the flag, 1 to the others*/
+        TIM5->SR = ~TIM_SR_CC1IF;
+
+        /*The compare value is the hardware tick time*/
+        tick = TIM5->CCR1;
+
+        /*Next tick; skip ticks already in the past so CCR1 stays ahead*/
+        do
+        {
+            TIM5->CCR1 += SENSOR_HUB_TICK_US;
+        } while((int32_t)(TIM5->CCR1 - TIM5->CNT) <= 0);
+
+        sensorHubTick(tick);
+    }
+}
+
+/**
+ * @brief EXTI2 interrupt handler (PE2, magnetometer DRDY)
+ *
+ * @return void
+ */
+void EXTI2_IRQHandler(void)
+{
+    uint32_t now = timGetMicros();
+
+    /*Clear pending bit*/
+    EXTI->PR = EXTI_PR_PR2;
+
+    sensorHubDrdyTime = now;
+    sensorHubDrdySeen = 1;
+    sensorHubDrdyCount++;
+}
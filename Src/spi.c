@@ -12,6 +12,10 @@
 
 #include "spi.h"
 
+/*Ownership of the shared SPI1 bus*/
+static volatile uint8_t spi1Owned;
+static spi1ReleaseCallback_t spi1ReleaseCallback;
+
 /**
  * @brief Initialize SPI1 GPIO pins
  * 
@@ -59,16 +63,16 @@ void spiInit(void)
     GPIOA->AFR[0] &= ~(1U<<23);
 
     /*PA6*/
-    GPIOA->AFR[0] &= ~(1U<<24);
-    GPIOA->AFR[1] |= (1U<<25);
-    GPIOA->AFR[2] |= (1U<<26);
-    GPIOA->AFR[3] &= ~(1U<<27);
+    GPIOA->AFR[0] |= (1U<<24);
+    GPIOA->AFR[0] &= ~(1U<<25);
+    GPIOA->AFR[0] |= (1U<<26);
+    GPIOA->AFR[0] &= ~(1U<<27);
 
     /*PA7*/
     GPIOA->AFR[0] |= (1U<<28);
-    GPIOA->AFR[1] |= (1U<<29);
-    GPIOA->AFR[2] |= (1U<<30);
-    GPIOA->AFR[3] &= ~(1U<<31);
+    GPIOA->AFR[0] &= ~(1U<<29);
+    GPIOA->AFR[0] |= (1U<<30);
+    GPIOA->AFR[0] &= ~(1U<<31);
 }
 
 /**
@@ -236,4 +240,64 @@ void csEnable(void)
 void csDisable(void)
 {
     GPIOA->ODR |= (1U<<9);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Try to take ownership of SPI1
+ * 
+ * @return 1 if the bus was taken, 0 if another driver owns it
+ */
+uint8_t spi1TryLock(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t taken = 0;
+
+    __disable_irq();
+
+    if(!spi1Owned)
+    {
+        spi1Owned = 1;
+        taken = 1;
+    }
+
+    __set_PRIMASK(primask);
+
+    return taken;
+}
+
+/**
+ * @brief Take ownership of SPI1, waiting while another driver owns it
+ * 
+ * @return void
+ */
+void spi1Lock(void)
+{
+    while(!spi1TryLock()){}
+}
+
+/**
+ * @brief Give SPI1 back and run the release callback
+ * 
+ * @return void
+ */
+void spi1Unlock(void)
+{
+    spi1ReleaseCallback_t callback = spi1ReleaseCallback;
+
+    spi1Owned = 0;
+
+    if(callback)
+    {
+        callback();
+    }
+}
+
+/**
+ * @brief Register the callback run by every spi1Unlock()
+ * 
+ * @return void
+ */
+void spi1SetReleaseCallback(spi1ReleaseCallback_t callback)
+{
+    spi1ReleaseCallback = callback;
+}
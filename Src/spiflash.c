@@ -0,0 +1,205 @@
+/**
+ * @file spiflash.c
+ * @brief External SPI NOR flash driver implementation for STM32F411
+ *
+ * Implements the W25Qxx command set on top of spi1Transmit() and
+ * spi1Receive(). Every command is framed by spiFlashSelect() and
+ * spiFlashDeselect(), which also hold the shared SPI1 bus for the
+ * duration of the command, so the gyroscope DMA burst cannot start in the
+ * middle of it.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "spiflash.h"
+#include "spi.h"
+
+#define CMD_WRITE_ENABLE    0x06U
+#define CMD_READ_STATUS1    0x05U
+#define CMD_READ_DATA       0x03U
+#define CMD_PAGE_PROGRAM    0x02U
+#define CMD_SECTOR_ERASE    0x20U
+#define CMD_JEDEC_ID        0x9FU
+
+#define SR1_BUSY            (1U<<0)
+
+/**
+ * @brief Take the SPI1 bus and select the flash
+ *
+ * @return void
+ * @note Waits while another driver owns the bus (at most one gyroscope
+ *       burst)
+ */
+static void spiFlashSelect(void)
+{
+    spi1Lock();
+    csEnable();
+}
+
+/**
+ * @brief Deselect the flash and release the SPI1 bus
+ *
+ * @return void
+ */
+static void spiFlashDeselect(void)
+{
+    csDisable();
+    spi1Unlock();
+}
+
+/**
+ * @brief Send a command byte followed by a 24-bit address
+ *
+ * @param[in] cmd Command opcode
+ * @param[in] addr 24-bit flash address
+ *
+ * @return void
+ * @note Chip select must already be enabled
+ */
+static void spiFlashSendCmdAddr(uint8_t cmd, uint32_t addr)
+{
+    uint8_t frame[4];
+
+    frame[0] = cmd;
+    frame[1] = (uint8_t)(addr >> 16);
+    frame[2] = (uint8_t)(addr >> 8);
+    frame[3] = (uint8_t)(addr);
+
+    spi1Transmit(frame, 4);
+}
+
+/**
+ * @brief Set the write enable latch
+ *
+ * Required before every page program and erase command.
+ *
+ * @return void
+ */
+static void spiFlashWriteEnable(void)
+{
+    uint8_t cmd = CMD_WRITE_ENABLE;
+
+    spiFlashSelect();
+    spi1Transmit(&cmd, 1);
+    spiFlashDeselect();
+}
+
+/**
+ * @brief Initialize SPI1 and the external flash
+ *
+ * @return void
+ */
+void spiFlashInit(void)
+{
+    /*Configure SPI1 pins and peripheral*/
+    spiInit();
+    spi1Config();
+
+    /*Deselect the flash*/
+    csDisable();
+
+    /*Let an operation interrupted by reset finish*/
+    spiFlashWaitReady();
+}
+
+/**
+ * @brief Read the 3-byte JEDEC identification
+ *
+ * @param[out] id Buffer of 3 bytes
+ *
+ * @return void
+ */
+void spiFlashReadJedecId(uint8_t *id)
+{
+    uint8_t cmd = CMD_JEDEC_ID;
+
+    spiFlashSelect();
+    spi1Transmit(&cmd, 1);
+    spi1Receive(id, 3);
+    spiFlashDeselect();
+}
+
+/**
+ * @brief Check if a program or erase operation is in progress
+ *
+ * @return 1 if busy, 0 if ready
+ */
+uint8_t spiFlashIsBusy(void)
+{
+    uint8_t cmd = CMD_READ_STATUS1;
+    uint8_t status;
+
+    spiFlashSelect();
+    spi1Transmit(&cmd, 1);
+    spi1Receive(&status, 1);
+    spiFlashDeselect();
+
+    return ((status & SR1_BUSY) == SR1_BUSY);
+}
+
+/**
+ * @brief Wait until the flash is ready
+ *
+ * @return void
+ */
+void spiFlashWaitReady(void)
+{
+    while(spiFlashIsBusy()){}
+}
+
+/**
+ * @brief Read data from flash
+ *
+ * Uses the plain READ (0x03) command, which has no dummy cycles and is
+ * valid at any SPI clock this driver uses (fPCLK/4).
+ *
+ * @param[in] addr Start address
+ * @param[out] data Destination buffer
+ * @param[in] size Number of bytes to read
+ *
+ * @return void
+ */
+void spiFlashRead(uint32_t addr, uint8_t *data, uint32_t size)
+{
+    spiFlashSelect();
+    spiFlashSendCmdAddr(CMD_READ_DATA, addr);
+    spi1Receive(data, size);
+    spiFlashDeselect();
+}
+
+/**
+ * @brief Start a page program operation
+ *
+ * @param[in] addr Start address
+ * @param[in] data Bytes to program
+ * @param[in] size Number of bytes
+ *
+ * @return void
+ */
+void spiFlashPageProgram(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    spiFlashWriteEnable();
+
+    spiFlashSelect();
+    spiFlashSendCmdAddr(CMD_PAGE_PROGRAM, addr);
+    spi1Transmit((uint8_t *)data, size);
+    spiFlashDeselect();
+}
+
+/**
+ * @brief Start a 4 KB sector erase
+ *
+ * @param[in] addr Any address inside the sector
+ *
+ * @return void
+ */
+void spiFlashSectorErase(uint32_t addr)
+{
+    spiFlashWriteEnable();
+
+    spiFlashSelect();
+    spiFlashSendCmdAddr(CMD_SECTOR_ERASE, addr);
+    spiFlashDeselect();
+}
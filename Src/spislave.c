@@ -0,0 +1,410 @@
+/**
+ * @file spislave.c
+ * @brief SPI1/SPI2 slave register-file driver implementation
+ *
+ * Both DMA streams of a port run in circular mode and never interrupt.
+ * On every NSS rising edge the handler decodes the received command,
+ * applies master writes, publishes a pending commit and re-arms the
+ * port. The SPI is reset through RCC while re-arming, which drops the
+ * byte the DMA had already loaded into the data register, so the next
+ * transaction starts exactly at the read pointer.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include "spislave.h"
+#include "dma.h"
+
+/** Clock mode, same as the master configuration in spi1Config() */
+#define SPI_SLAVE_CR1_MODE      (SPI_CR1_CPOL | SPI_CR1_CPHA)
+/** Command byte + whole register file, plus one so a full write never wraps to NDTR reload */
+#define SPI_SLAVE_RX_SIZE       (SPI_SLAVE_REG_SIZE + 2U)
+
+/**
+ * @brief Fixed hardware resources of a slave port
+ */
+typedef struct
+{
+    SPI_TypeDef *spi;               /**< SPI peripheral */
+    DMA_TypeDef *dma;               /**< DMA controller */
+    uint8_t rxStream;               /**< RX stream index */
+    uint8_t txStream;               /**< TX stream index */
+    uint8_t channel;                /**< DMA request channel */
+    volatile uint32_t *rstReg;      /**< RCC reset register */
+    uint32_t rstBit;                /**< SPI reset bit */
+    GPIO_TypeDef *nssPort;          /**< NSS GPIO port */
+    uint32_t nssMask;               /**< NSS bit in IDR */
+    uint32_t extiLine;              /**< NSS EXTI line mask */
+    IRQn_Type irq;                  /**< NSS EXTI interrupt */
+} spiSlaveHw_t;
+
+static spiSlaveHw_t spiSlaveHw[SPI_SLAVE_PORT_COUNT];
+
+static uint8_t spiSlaveRegs[SPI_SLAVE_PORT_COUNT][2][SPI_SLAVE_REG_SIZE];
+static uint8_t spiSlaveRx[SPI_SLAVE_PORT_COUNT][SPI_SLAVE_RX_SIZE];
+static volatile uint8_t spiSlaveFront[SPI_SLAVE_PORT_COUNT];
+static volatile uint8_t spiSlaveSwapPending[SPI_SLAVE_PORT_COUNT];
+static uint8_t spiSlavePtr[SPI_SLAVE_PORT_COUNT];
+static spiSlaveWriteCallback_t spiSlaveCallback[SPI_SLAVE_PORT_COUNT];
+static volatile uint32_t spiSlaveTransactions[SPI_SLAVE_PORT_COUNT];
+
+/**
+ * @brief Fill in the hardware description of a port
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void spiSlaveHwInit(spiSlavePort_t port)
+{
+    spiSlaveHw_t *hw = &spiSlaveHw[port];
+
+    if(port == SPI_SLAVE_PORT1)
+    {
+        hw->spi = SPI1;
+        hw->dma = DMA2;
+        hw->rxStream = 2U;
+        hw->txStream = 3U;
+        hw->channel = 3U;
+        hw->rstReg = &RCC->APB2RSTR;
+        hw->rstBit = RCC_APB2RSTR_SPI1RST;
+        hw->nssPort = GPIOA;
+        hw->nssMask = GPIO_IDR_ID4;
+        hw->extiLine = EXTI_IMR_MR4;
+        hw->irq = EXTI4_IRQn;
+    }
+    else
+    {
+        hw->spi = SPI2;
+        hw->dma = DMA1;
+        hw->rxStream = 3U;
+        hw->txStream = 4U;
+        hw->channel = 0U;
+        hw->rstReg = &RCC->APB1RSTR;
+        hw->rstBit = RCC_APB1RSTR_SPI2RST;
+        hw->nssPort = GPIOB;
+        hw->nssMask = GPIO_IDR_ID12;
+        hw->extiLine = EXTI_IMR_MR12;
+        hw->irq = EXTI15_10_IRQn;
+    }
+}
+
+/**
+ * @brief Configure pins, peripheral clock and NSS interrupt routing
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void spiSlaveGpioInit(spiSlavePort_t port)
+{
+    /*Enable clock access to SYSCFG for the NSS EXTI line*/
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+
+    if(port == SPI_SLAVE_PORT1)
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN;
+        RCC->APB2ENR |= RCC_APB2ENR_SPI1EN;
+
+        /*PA4..PA7 alternate function, AF5 (SPI1)*/
+        GPIOA->MODER &= ~(0xFFU << 8);
+        GPIOA->MODER |= (0xAAU << 8);
+        GPIOA->AFR[0] &= ~(0xFFFFU << 16);
+        GPIOA->AFR[0] |= (0x5555U << 16);
+
+        /*Select PORTA for EXTI4*/
+        SYSCFG->EXTICR[1] &= ~SYSCFG_EXTICR2_EXTI4;
+    }
+    else
+    {
+        RCC->AHB1ENR |= RCC_AHB1ENR_GPIOBEN;
+        RCC->APB1ENR |= RCC_APB1ENR_SPI2EN;
+
+        /*PB12..PB15 alternate function, AF5 (SPI2)*/
+        GPIOB->MODER &= ~(0xFFU << 24);
+        GPIOB->MODER |= (0xAAU << 24);
+        GPIOB->AFR[1] &= ~(0xFFFFU << 16);
+        GPIOB->AFR[1] |= (0x5555U << 16);
+
+        /*Select PORTB for EXTI12*/
+        SYSCFG->EXTICR[3] &= ~SYSCFG_EXTICR4_EXTI12;
+        SYSCFG->EXTICR[3] |= SYSCFG_EXTICR4_EXTI12_PB;
+    }
+}
+
+/**
+ * @brief Reset the SPI and restart both DMA streams for a new transaction
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void spiSlaveArm(spiSlavePort_t port)
+{
+    spiSlaveHw_t *hw = &spiSlaveHw[port];
+    DMA_Stream_TypeDef *rx = dmaGetStream(hw->dma, hw->rxStream);
+    DMA_Stream_TypeDef *tx = dmaGetStream(hw->dma, hw->txStream);
+    uint8_t ptr = spiSlavePtr[port];
+
+    dmaStreamStop(hw->dma, hw->rxStream);
+    dmaStreamStop(hw->dma, hw->txStream);
+
+    /*Reset the SPI to drop the byte preloaded for the previous transaction*/
+    *hw->rstReg |= hw->rstBit;
+    *hw->rstReg &= ~hw->rstBit;
+
+    dmaClearFlags(hw->dma, hw->rxStream, DMA_FLAG_ALL);
+    dmaClearFlags(hw->dma, hw->txStream, DMA_FLAG_ALL);
+
+    rx->M0AR = (uint32_t)spiSlaveRx[port];
+    rx->NDTR = SPI_SLAVE_RX_SIZE;
+    tx->M0AR = (uint32_t)&spiSlaveRegs[port][spiSlaveFront[port]][ptr];
+    tx->NDTR = SPI_SLAVE_REG_SIZE - ptr;
+
+    /*Slave, hardware NSS (SSM = 0), 8-bit, MSB first*/
+    hw->spi->CR1 = SPI_SLAVE_CR1_MODE;
+
+    dmaStreamStart(hw->dma, hw->rxStream);
+    dmaStreamStart(hw->dma, hw->txStream);
+    hw->spi->CR2 = SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+    /*Enable SPI module*/
+    hw->spi->CR1 |= SPI_CR1_SPE;
+}
+
+/**
+ * @brief Make the back copy the one served to the master
+ *
+ * The new back copy is refreshed from the new front copy so partial
+ * updates that follow start from the published values.
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void spiSlaveSwap(spiSlavePort_t port)
+{
+    uint8_t front = spiSlaveFront[port] ^ 1U;
+    uint8_t *src = spiSlaveRegs[port][front];
+    uint8_t *dst = spiSlaveRegs[port][front ^ 1U];
+
+    for(uint32_t i = 0; i < SPI_SLAVE_RO_SIZE; i++)
+    {
+        dst[i] = src[i];
+    }
+
+    spiSlaveFront[port] = front;
+    spiSlaveSwapPending[port] = 0;
+}
+
+/**
+ * @brief Handle the end of a transaction (NSS rising edge)
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+static void spiSlaveEndOfFrame(spiSlavePort_t port)
+{
+    spiSlaveHw_t *hw = &spiSlaveHw[port];
+    const uint8_t *rx = spiSlaveRx[port];
+    uint32_t count = SPI_SLAVE_RX_SIZE - dmaGetStream(hw->dma, hw->rxStream)->NDTR;
+    uint8_t addr;
+    uint8_t accepted = 0;
+    uint32_t a;
+
+    if(count > 0U)
+    {
+        addr = rx[0] & (uint8_t)~SPI_SLAVE_CMD_WRITE;
+
+        if(rx[0] & SPI_SLAVE_CMD_WRITE)
+        {
+            /*Store into both copies so a later swap keeps master data*/
+            for(uint32_t i = 1; i < count; i++)
+            {
+                a = addr + i - 1U;
+                if(a >= SPI_SLAVE_REG_SIZE)
+                {
+                    break;
+                }
+                if(a >= SPI_SLAVE_RO_SIZE)
+                {
+                    spiSlaveRegs[port][0][a] = rx[i];
+                    spiSlaveRegs[port][1][a] = rx[i];
+                    accepted++;
+                }
+            }
+
+            if(accepted && spiSlaveCallback[port])
+            {
+                spiSlaveCallback[port](port, addr, accepted);
+            }
+        }
+        else
+        {
+            spiSlavePtr[port] = (addr < SPI_SLAVE_REG_SIZE) ? addr : 0U;
+        }
+    }
+
+    spiSlaveTransactions[port]++;
+
+    if(spiSlaveSwapPending[port])
+    {
+        spiSlaveSwap(port);
+    }
+
+    spiSlaveArm(port);
+}
+
+/**
+ * @brief Initialize a port as SPI slave
+ *
+ * @param[in] port Port
+ *
+ * @return void
+ */
+void spiSlaveInit(spiSlavePort_t port)
+{
+    spiSlaveHw_t *hw = &spiSlaveHw[port];
+
+    spiSlaveHwInit(port);
+    spiSlaveGpioInit(port);
+
+    for(uint32_t i = 0; i < SPI_SLAVE_REG_SIZE; i++)
+    {
+        spiSlaveRegs[port][0][i] = 0;
+        spiSlaveRegs[port][1][i] = 0;
+    }
+    spiSlaveFront[port] = 0;
+    spiSlaveSwapPending[port] = 0;
+    spiSlavePtr[port] = 0;
+
+    /*Circular streams, no interrupts: the CPU is not involved per byte*/
+    dmaStreamConfig(hw->dma, hw->rxStream, hw->channel,
+                    DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_PL_1,
+                    &hw->spi->DR, spiSlaveRx[port], SPI_SLAVE_RX_SIZE);
+    dmaStreamConfig(hw->dma, hw->txStream, hw->channel,
+                    DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC | DMA_SxCR_PL_1,
+                    &hw->spi->DR, spiSlaveRegs[port][0], SPI_SLAVE_REG_SIZE);
+
+    spiSlaveArm(port);
+
+    /*NSS rising edge marks the end of a transaction*/
+    EXTI->IMR |= hw->extiLine;
+    EXTI->RTSR |= hw->extiLine;
+    NVIC_SetPriority(hw->irq, 0);
+    NVIC_EnableIRQ(hw->irq);
+}
+
+/**
+ * @brief Write into the back copy of the read-only area
+ *
+ * @return void
+ */
+void spiSlaveUpdate(spiSlavePort_t port, uint8_t addr, const uint8_t *data, uint8_t len)
+{
+    uint8_t *back;
+
+    /*Keep the NSS handler from swapping in the middle of the update*/
+    NVIC_DisableIRQ(spiSlaveHw[port].irq);
+
+    back = spiSlaveRegs[port][spiSlaveFront[port] ^ 1U];
+    for(uint32_t i = 0; (i < len) && ((addr + i) < SPI_SLAVE_RO_SIZE); i++)
+    {
+        back[addr + i] = data[i];
+    }
+
+    NVIC_EnableIRQ(spiSlaveHw[port].irq);
+}
+
+/**
+ * @brief Publish the back copy to the master
+ *
+ * @return void
+ */
+void spiSlaveCommit(spiSlavePort_t port)
+{
+    spiSlaveHw_t *hw = &spiSlaveHw[port];
+
+    NVIC_DisableIRQ(hw->irq);
+
+    if(hw->nssPort->IDR & hw->nssMask)
+    {
+        /*Bus idle: publish now*/
+        spiSlaveSwap(port);
+        spiSlaveArm(port);
+    }
+    else
+    {
+        /*Transaction in progress: publish on NSS rising edge*/
+        spiSlaveSwapPending[port] = 1;
+    }
+
+    NVIC_EnableIRQ(hw->irq);
+}
+
+/**
+ * @brief Read registers
+ *
+ * @return void
+ */
+void spiSlaveRead(spiSlavePort_t port, uint8_t addr, uint8_t *data, uint8_t len)
+{
+    const uint8_t *front = spiSlaveRegs[port][spiSlaveFront[port]];
+
+    for(uint32_t i = 0; (i < len) && ((addr + i) < SPI_SLAVE_REG_SIZE); i++)
+    {
+        data[i] = front[addr + i];
+    }
+}
+
+/**
+ * @brief Register the master-write notification
+ *
+ * @return void
+ */
+void spiSlaveSetWriteCallback(spiSlavePort_t port, spiSlaveWriteCallback_t callback)
+{
+    spiSlaveCallback[port] = callback;
+}
+
+/**
+ * @brief Number of transactions handled on a port
+ *
+ * @return Transaction count
+ */
+uint32_t spiSlaveGetTransactions(spiSlavePort_t port)
+{
+    return spiSlaveTransactions[port];
+}
+
+/**
+ * @brief EXTI4 interrupt handler (SPI1 NSS rising edge)
+ *
+ * @return void
+ */
+void EXTI4_IRQHandler(void)
+{
+    /*Clear pending flag*/
+    EXTI->PR = EXTI_PR_PR4;
+
+    spiSlaveEndOfFrame(SPI_SLAVE_PORT1);
+}
+
+/**
+ * @brief EXTI15_10 interrupt handler (SPI2 NSS rising edge)
+ *
+ * @return void
+ */
+void EXTI15_10_IRQHandler(void)
+{
+    if(EXTI->PR & EXTI_PR_PR12)
+    {
+        /*Clear pending flag*/
+        EXTI->PR = EXTI_PR_PR12;
+
+        spiSlaveEndOfFrame(SPI_SLAVE_PORT2);
+    }
+}
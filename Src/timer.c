@@ -69,4 +69,111 @@ bool getUIF(void)
 void clearUIF(void)
 {
     TIM2->SR &= ~TIM_SR_UIF;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start TIM5 as a 1 MHz free-running time base
+ *
+ * Configuration details:
+ * - Clock source   : APB1 (TIM5)
+ * - Prescaler      : 16 - 1 → Timer clock = 1 MHz (from 16 MHz)
+ * - Auto-reload    : 0xFFFFFFFF → full 32-bit range
+ *
+ * @return None
+ */
+void tim5TimebaseInit(void)
+{
+    /*Already running*/
+    if(TIM5->CR1 & TIM_CR1_CEN)
+    {
+        return;
+    }
+
+    /*Enable clock access to tim5*/
+    RCC->APB1ENR |= RCC_APB1ENR_TIM5EN;
+    /*Set prescaler value*/
+    TIM5->PSC = (TIM_CLK_FREQ / 1000000U) - 1U;  // 16 MHz / 16 = 1 MHz
+    /*Set auto-reload value*/
+    TIM5->ARR = 0xFFFFFFFFU;
+    /*Load prescaler and clear counter*/
+    TIM5->EGR = TIM_EGR_UG;
+    TIM5->CNT = 0;
+    /*Enable timer*/
+    TIM5->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief Read the microsecond time base
+ *
+ * @return Current TIM5 counter value
+ */
+uint32_t timGetMicros(void)
+{
+    return TIM5->CNT;
+}
+
+/**
+ * @brief Configure TIM3 to output its update event on TRGO
+ *
+ * Configuration details:
+ * - Clock source   : APB1 (TIM3)
+ * - Prescaler      : ceil(ticks / 65536) - 1
+ * - Auto-reload    : round(ticks / (PSC + 1)) - 1
+ * - Master mode    : MMS = 010, update event as TRGO
+ *
+ * @return Timer clock ticks per update, 0 if rateHz is out of range
+ */
+uint32_t tim3TrgoInit(uint32_t rateHz)
+{
+    uint32_t ticks;
+    uint32_t psc;
+    uint32_t arr;
+
+    if((rateHz == 0U) || (rateHz > (TIM_CLK_FREQ / 2U)))
+    {
+        return 0;
+    }
+
+    /*Period closest to the requested rate*/
+    ticks = (TIM_CLK_FREQ + (rateHz / 2U)) / rateHz;
+    psc = (ticks - 1U) >> 16;
+    arr = ((ticks + ((psc + 1U) / 2U)) / (psc + 1U)) - 1U;
+
+    /*Enable clock access to tim3*/
+    RCC->APB1ENR |= RCC_APB1ENR_TIM3EN;
+    TIM3->CR1 = 0;
+    TIM3->CR2 = 0;
+    /*Set prescaler and auto-reload value*/
+    TIM3->PSC = psc;
+    TIM3->ARR = arr;
+    /*Load prescaler before TRGO is routed, so UG does not trigger*/
+    TIM3->EGR = TIM_EGR_UG;
+    TIM3->SR = 0;
+    /*Update event as TRGO*/
+    TIM3->CR2 = TIM_CR2_MMS_1;
+
+    return (psc + 1U) * (arr + 1U);
+}
+
+/**
+ * @brief Start TIM3 from a zero count
+ *
+ * @return None
+ */
+void tim3Start(void)
+{
+    /*Clear counter*/
+    TIM3->CNT = 0;
+    /*Enable timer*/
+    TIM3->CR1 |= TIM_CR1_CEN;
+}
+
+/**
+ * @brief Stop TIM3
+ *
+ * @return None
+ */
+void tim3Stop(void)
+{
+    TIM3->CR1 &= ~TIM_CR1_CEN;
+}
@@ -10,8 +10,16 @@
  */
 
 #include "uart.h"
+#include "dma.h"
 #include <stdint.h>
 
+/*USART2_TX DMA request: DMA1 Stream6, channel 4*/
+#define UART_DMA_STREAM     6U
+#define UART_DMA_CHANNEL    4U
+
+static uartDmaCallback_t uartDmaCallback;
+static volatile uint8_t uartDmaActive;
+
 /**
  * @brief Initialize UART2 peripheral with GPIO and clock configuration
  * 
@@ -174,4 +182,92 @@ void uartSendString(const char *s)
     {
         uartSendChar(*s++);
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Enable DMA transmission on UART2
+ *
+ * @param callback Completion callback (may be 0)
+ *
+ * @return None
+ */
+void uartDmaInit(uartDmaCallback_t callback)
+{
+    uartDmaCallback = callback;
+    uartDmaActive = 0;
+
+    /*Transmit requests go to DMA*/
+    USART2->CR3 |= USART_CR3_DMAT;
+
+    NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+}
+
+/**
+ * @brief Start sending a buffer with DMA
+ *
+ * Configuration details:
+ * - Stream         : DMA1 Stream6 channel 4, memory to peripheral
+ * - Data size      : 8 bit, memory increment
+ * - Interrupts     : TC, TE
+ *
+ * @param data Bytes to send
+ * @param len Number of bytes
+ *
+ * @return 1 if started, 0 if busy or len is 0
+ */
+uint8_t uartWriteDma(const uint8_t *data, uint16_t len)
+{
+    if(uartDmaActive || (len == 0U))
+    {
+        return 0;
+    }
+
+    uartDmaActive = 1;
+
+    dmaStreamConfig(DMA1, UART_DMA_STREAM, UART_DMA_CHANNEL,
+                    DMA_SxCR_DIR_0 | DMA_SxCR_MINC | DMA_SxCR_TCIE | DMA_SxCR_TEIE,
+                    &USART2->DR, (void *)data, len);
+
+    /*Clear TC before the first DMA write*/
+    USART2->SR = ~USART_SR_TC;
+    dmaStreamStart(DMA1, UART_DMA_STREAM);
+
+    return 1;
+}
+
+/**
+ * @brief Check for a running DMA transmission
+ *
+ * @return 1 while a buffer is being sent, 0 otherwise
+ */
+uint8_t uartDmaBusy(void)
+{
+    return uartDmaActive;
+}
+
+/**
+ * @brief DMA1 Stream6 interrupt handler (USART2 TX)
+ *
+ * TC means the last byte has been moved into DR: the buffer is free
+ * again even though the shift register may still be sending it.
+ *
+ * @return None
+ */
+void DMA1_Stream6_IRQHandler(void)
+{
+    uint32_t flags = dmaGetFlags(DMA1, UART_DMA_STREAM);
+
+    dmaClearFlags(DMA1, UART_DMA_STREAM, flags);
+
+    if(!(flags & (DMA_FLAG_TC | DMA_FLAG_TE)))
+    {
+        return;
+    }
+
+    uartDmaActive = 0;
+
+    if(uartDmaCallback)
+    {
+        uartDmaCallback((flags & DMA_FLAG_TE) ? 0U : 1U);
+    }
+}
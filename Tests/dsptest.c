@@ -0,0 +1,500 @@
+/**
+ * @file dsptest.c
+ * @brief Host accuracy test of the Q15/Q31 filter kernels
+ *
+ * Builds dsp.c for the host (portable path, no __ARM_FEATURE_DSP) and
+ * compares every kernel with a double-precision model that uses the
+ * same quantized coefficients, so only the arithmetic of the kernels
+ * is measured:
+ * - FIR and decimating FIR: each output is one truncated dot product,
+ *   so the error stays below 1 LSB
+ * - Biquad cascades (Q15 and Q31): the truncation of every section is
+ *   fed back through its poles and filtered by the later sections; the
+ *   error must stay within the sum of the L1 norms of those responses
+ * - Inputs arrive in blocks of random size, in place and out of place,
+ *   so the history and delay line hand-over between blocks is covered
+ * - dspAdcToQ15() and dspAddQ15() conversion and saturation
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "dsp.h"
+
+/** Samples per test signal */
+#define TEST_SAMPLES        4096U
+
+/** FIR taps (odd, so the kernels run their single-tap tail) */
+#define TEST_FIR_TAPS       33U
+
+/** Decimation factor */
+#define TEST_DECIM_FACTOR   4U
+
+/** Biquad sections */
+#define TEST_STAGES         2U
+
+/** Coefficient scaling of the biquads (values up to 2) */
+#define TEST_POST_SHIFT     1U
+
+/** Length of the impulse responses summed for the biquad error bound */
+#define TEST_IMPULSE_LEN    8192U
+
+static int16_t testIn[TEST_SAMPLES];
+static int16_t testOut[TEST_SAMPLES];
+static int16_t testState[TEST_FIR_TAPS - 1U + DSP_MAX_BLOCK];
+static int16_t testFirCoeffs[TEST_FIR_TAPS];
+static int16_t testBqCoeffs[6U * TEST_STAGES];
+static int32_t testBqCoeffs31[5U * TEST_STAGES];
+static double testBq[TEST_STAGES][5];       /**< b0, b1, b2, a1, a2 (a negated) */
+static uint32_t testRand = 2463534242U;
+static uint32_t testFailures;
+
+/**
+ * @brief xorshift32
+ *
+ * @return Pseudo-random value
+ */
+static uint32_t testRandom(void)
+{
+    testRand ^= testRand << 13;
+    testRand ^= testRand >> 17;
+    testRand ^= testRand << 5;
+    return testRand;
+}
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * @param ok Condition
+ * @param what Description
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Two tones and noise at about half scale
+ *
+ * @return void
+ */
+static void testSignal(void)
+{
+    double v;
+
+    for(uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        v = (0.25 * sin(0.031 * i)) + (0.15 * sin(1.7 * i)) +
+            (0.1 * (((double)(testRandom() & 0xFFFFU) / 32768.0) - 1.0));
+        testIn[i] = (int16_t)lrint(v * 32768.0);
+    }
+}
+
+/**
+ * @brief Random asymmetric FIR, sum of |c| below 1 (no saturation)
+ *
+ * @return void
+ */
+static void testFirDesign(void)
+{
+    for(uint32_t k = 0; k < TEST_FIR_TAPS; k++)
+    {
+        testFirCoeffs[k] = (int16_t)((int32_t)(testRandom() % 1800U) - 900);
+    }
+}
+
+/**
+ * @brief Double model of a time reversed FIR at one output position
+ *
+ * @param pos Index of the newest input sample
+ *
+ * @return Output in Q15 LSB
+ */
+static double testFirModel(uint32_t pos)
+{
+    double acc = 0.0;
+    int32_t x;
+
+    for(uint32_t k = 0; k < TEST_FIR_TAPS; k++)
+    {
+        x = (int32_t)pos - (int32_t)(TEST_FIR_TAPS - 1U) + (int32_t)k;
+        if(x >= 0)
+        {
+            acc += ((double)testFirCoeffs[k] / 32768.0) * testIn[x];
+        }
+    }
+
+    return acc;
+}
+
+/**
+ * @brief FIR against the model, in blocks of varying size
+ *
+ * @param inPlace 1 to filter in place
+ *
+ * @return void
+ */
+static void testFir(uint8_t inPlace)
+{
+    dspFirQ15_t f;
+    double err;
+    double maxErr = 0.0;
+    uint32_t i = 0;
+    uint32_t n;
+    char what[64];
+
+    dspFirQ15Init(&f, TEST_FIR_TAPS, testFirCoeffs, testState);
+
+    while(i < TEST_SAMPLES)
+    {
+        n = 1U + (testRandom() % DSP_MAX_BLOCK);
+        if(n > (TEST_SAMPLES - i))
+        {
+            n = TEST_SAMPLES - i;
+        }
+
+        if(inPlace)
+        {
+            memcpy(&testOut[i], &testIn[i], n * sizeof(int16_t));
+            dspFirQ15(&f, &testOut[i], &testOut[i], n);
+        }
+        else
+        {
+            dspFirQ15(&f, &testIn[i], &testOut[i], n);
+        }
+        i += n;
+    }
+
+    for(i = 0; i < TEST_SAMPLES; i++)
+    {
+        err = fabs(testOut[i] - testFirModel(i));
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+
+    printf("fir %2u taps %-12s max error %.4f LSB\n", TEST_FIR_TAPS,
+           inPlace ? "in place" : "", maxErr);
+    snprintf(what, sizeof(what), "fir%s within 1 LSB", inPlace ? " in place" : "");
+    testCheck(maxErr < 1.0, what);
+}
+
+/**
+ * @brief Decimating FIR against the model
+ *
+ * @return void
+ */
+static void testDecim(void)
+{
+    dspDecimQ15_t f;
+    double err;
+    double maxErr = 0.0;
+    uint32_t out = 0;
+    uint32_t n;
+
+    dspDecimQ15Init(&f, TEST_DECIM_FACTOR, TEST_FIR_TAPS, testFirCoeffs, testState);
+
+    for(uint32_t i = 0; i < TEST_SAMPLES; i += n)
+    {
+        n = TEST_DECIM_FACTOR * (1U + (testRandom() % (DSP_MAX_BLOCK / TEST_DECIM_FACTOR)));
+        if(n > (TEST_SAMPLES - i))
+        {
+            n = TEST_SAMPLES - i;
+        }
+        out += dspDecimQ15(&f, &testIn[i], &testOut[out], n);
+    }
+
+    testCheck(out == (TEST_SAMPLES / TEST_DECIM_FACTOR), "decimation output count");
+
+    /*Output j lines up with input (j + 1) * factor - 1*/
+    for(uint32_t j = 0; j < out; j++)
+    {
+        err = fabs(testOut[j] - testFirModel(((j + 1U) * TEST_DECIM_FACTOR) - 1U));
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+
+    printf("decimate by %u           max error %.4f LSB\n", TEST_DECIM_FACTOR, maxErr);
+    testCheck(maxErr < 1.0, "decimation within 1 LSB");
+}
+
+/**
+ * @brief Quantize a Butterworth low pass and a peaking section
+ *
+ * The model keeps the quantized values, scaled back to real numbers.
+ *
+ * @return void
+ */
+static void testBiquadDesign(void)
+{
+    const double scale = 32768.0 / (1U << TEST_POST_SHIFT);
+    const double scale31 = 2147483648.0 / (1U << TEST_POST_SHIFT);
+    double w;
+    double alpha;
+    double a0;
+    double c[TEST_STAGES][5];
+
+    /*Low pass at fs / 10, Q = 0.707*/
+    w = 2.0 * M_PI / 10.0;
+    alpha = sin(w) / (2.0 * M_SQRT1_2);
+    a0 = 1.0 + alpha;
+    c[0][0] = ((1.0 - cos(w)) / 2.0) / a0;
+    c[0][1] = (1.0 - cos(w)) / a0;
+    c[0][2] = c[0][0];
+    c[0][3] = (2.0 * cos(w)) / a0;
+    c[0][4] = -(1.0 - alpha) / a0;
+
+    /*+6 dB peak at fs / 25, Q = 1*/
+    w = 2.0 * M_PI / 25.0;
+    alpha = sin(w) / 2.0;
+    a0 = 1.0 + (alpha / 2.0);
+    c[1][0] = (1.0 + (alpha * 2.0)) / a0;
+    c[1][1] = (-2.0 * cos(w)) / a0;
+    c[1][2] = (1.0 - (alpha * 2.0)) / a0;
+    c[1][3] = (2.0 * cos(w)) / a0;
+    c[1][4] = -(1.0 - (alpha / 2.0)) / a0;
+
+    for(uint32_t s = 0; s < TEST_STAGES; s++)
+    {
+        int16_t *q = &testBqCoeffs[6U * s];
+
+        q[0] = (int16_t)lrint(c[s][0] * scale);
+        q[1] = 0;
+        q[2] = (int16_t)lrint(c[s][1] * scale);
+        q[3] = (int16_t)lrint(c[s][2] * scale);
+        q[4] = (int16_t)lrint(c[s][3] * scale);
+        q[5] = (int16_t)lrint(c[s][4] * scale);
+
+        for(uint32_t k = 0; k < 5U; k++)
+        {
+            testBqCoeffs31[(5U * s) + k] = (int32_t)lrint(c[s][k] * scale31);
+        }
+    }
+}
+
+/**
+ * @brief Set the model coefficients from the Q15 or the Q31 set
+ *
+ * @param q31 1 for the Q31 coefficients
+ *
+ * @return void
+ */
+static void testBiquadModelCoeffs(uint8_t q31)
+{
+    static const uint8_t q15Index[5] = {0, 2, 3, 4, 5};
+
+    for(uint32_t s = 0; s < TEST_STAGES; s++)
+    {
+        for(uint32_t k = 0; k < 5U; k++)
+        {
+            testBq[s][k] = q31 ?
+                (testBqCoeffs31[(5U * s) + k] * ((1U << TEST_POST_SHIFT) / 2147483648.0)) :
+                (testBqCoeffs[(6U * s) + q15Index[k]] * ((1U << TEST_POST_SHIFT) / 32768.0));
+        }
+    }
+}
+
+/**
+ * @brief Run the double model of the cascade from stage first on
+ *
+ * @param first First section
+ * @param feedOnly 1 to skip the numerator of the first section
+ *                 (response to an error injected at its output)
+ * @param[in] in Input
+ * @param[out] out Output
+ * @param n Samples
+ *
+ * @return void
+ */
+static void testBiquadModel(uint32_t first, uint8_t feedOnly, const double *in, double *out,
+                            uint32_t n)
+{
+    for(uint32_t s = first; s < TEST_STAGES; s++)
+    {
+        const double *c = testBq[s];
+        double x1 = 0.0;
+        double x2 = 0.0;
+        double y1 = 0.0;
+        double y2 = 0.0;
+        double x;
+        double y;
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            x = in[i];
+            if(feedOnly && (s == first))
+            {
+                y = x + (c[3] * y1) + (c[4] * y2);
+            }
+            else
+            {
+                y = (c[0] * x) + (c[1] * x1) + (c[2] * x2) + (c[3] * y1) + (c[4] * y2);
+            }
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            out[i] = y;
+        }
+
+        in = out;
+    }
+}
+
+/**
+ * @brief Worst-case output error of the cascade in LSB
+ *
+ * Each section truncates its output (|e| < 1 LSB); that error passes
+ * through 1 / A(z) of the section and the whole later cascade, so the
+ * bound is the sum of the L1 norms of those impulse responses.
+ *
+ * @return Bound in LSB
+ */
+static double testBiquadBound(void)
+{
+    static double imp[TEST_IMPULSE_LEN];
+    static double resp[TEST_IMPULSE_LEN];
+    double bound = 0.0;
+
+    for(uint32_t s = 0; s < TEST_STAGES; s++)
+    {
+        memset(imp, 0, sizeof(imp));
+        imp[0] = 1.0;
+        testBiquadModel(s, 1, imp, resp, TEST_IMPULSE_LEN);
+
+        for(uint32_t i = 0; i < TEST_IMPULSE_LEN; i++)
+        {
+            bound += fabs(resp[i]);
+        }
+    }
+
+    return bound;
+}
+
+/**
+ * @brief Q15 and Q31 biquad cascades against the model
+ *
+ * @return void
+ */
+static void testBiquad(void)
+{
+    static double in[TEST_SAMPLES];
+    static double ref[TEST_SAMPLES];
+    static int32_t in31[TEST_SAMPLES];
+    static int32_t out31[TEST_SAMPLES];
+    int16_t state[4U * TEST_STAGES];
+    int32_t state31[4U * TEST_STAGES];
+    dspBiquadQ15_t f;
+    dspBiquadQ31_t f31;
+    double bound;
+    double err;
+    double maxErr;
+    uint32_t n;
+
+    testBiquadDesign();
+
+    /*Q15, random block sizes*/
+    testBiquadModelCoeffs(0);
+    bound = testBiquadBound();
+
+    for(uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        in[i] = testIn[i];
+    }
+    testBiquadModel(0, 0, in, ref, TEST_SAMPLES);
+
+    dspBiquadQ15Init(&f, TEST_STAGES, testBqCoeffs, state, TEST_POST_SHIFT);
+    for(uint32_t i = 0; i < TEST_SAMPLES; i += n)
+    {
+        n = 1U + (testRandom() % DSP_MAX_BLOCK);
+        if(n > (TEST_SAMPLES - i))
+        {
+            n = TEST_SAMPLES - i;
+        }
+        dspBiquadQ15(&f, &testIn[i], &testOut[i], n);
+    }
+
+    maxErr = 0.0;
+    for(uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        err = fabs(testOut[i] - ref[i]);
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+
+    printf("biquad q15 %u stages     max error %.4f LSB (bound %.2f)\n", TEST_STAGES, maxErr, bound);
+    testCheck(maxErr <= bound, "q15 biquad within the truncation bound");
+
+    /*Q31, in place in one block per DSP_MAX_BLOCK*/
+    testBiquadModelCoeffs(1);
+    bound = testBiquadBound();
+
+    for(uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        in31[i] = (int32_t)testIn[i] * 65536;
+        in[i] = in31[i];
+        out31[i] = in31[i];
+    }
+    testBiquadModel(0, 0, in, ref, TEST_SAMPLES);
+
+    dspBiquadQ31Init(&f31, TEST_STAGES, testBqCoeffs31, state31, TEST_POST_SHIFT);
+    for(uint32_t i = 0; i < TEST_SAMPLES; i += DSP_MAX_BLOCK)
+    {
+        dspBiquadQ31(&f31, &out31[i], &out31[i], DSP_MAX_BLOCK);
+    }
+
+    maxErr = 0.0;
+    for(uint32_t i = 0; i < TEST_SAMPLES; i++)
+    {
+        err = fabs(out31[i] - ref[i]);
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+
+    printf("biquad q31 %u stages     max error %.4f LSB (bound %.2f)\n", TEST_STAGES, maxErr, bound);
+    testCheck(maxErr <= bound, "q31 biquad within the truncation bound");
+}
+
+/**
+ * @brief ADC conversion with a stride and the saturating add
+ *
+ * @return void
+ */
+static void testHelpers(void)
+{
+    uint16_t adc[8] = {0, 111, 2048, 222, 4095, 333, 1024, 444};
+    int16_t q[4];
+    int16_t a[5] = {32000, -32000, 100, -100, 16384};
+    int16_t b[5] = {1000, -1000, -50, 50, 16384};
+
+    dspAdcToQ15(adc, 2, q, 4);
+    testCheck((q[0] == -32768) && (q[1] == 0) && (q[2] == 32752) && (q[3] == -16384),
+              "adc to q15 with stride");
+
+    dspAddQ15(a, b, a, 5);
+    testCheck((a[0] == 32767) && (a[1] == -32768) && (a[2] == 50) && (a[3] == -50) &&
+              (a[4] == 32767), "saturating add");
+}
+
+int main(void)
+{
+    testSignal();
+    testFirDesign();
+
+    testFir(0);
+    testFir(1);
+    testDecim();
+    testBiquad();
+    testHelpers();
+
+    printf("%s\n", testFailures ? "dsp: FAILED" : "dsp: OK");
+
+    return testFailures ? 1 : 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file eeprommodel.c
+ * @brief 24Cxx model implementation
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <string.h>
+#include "eeprommodel.h"
+#include "timer.h"
+
+static uint8_t eeMem[EEPROM_SIZE];
+static eepromModelStats_t eeStats;
+static uint64_t eeBusyUntilNs;
+static uint16_t eePointer;
+static uint32_t eeFailCount;
+
+/**
+ * @brief Account one transaction on the bus
+ *
+ * @param bytes Bytes clocked, address byte included
+ *
+ * @return void
+ */
+static void eepromModelBus(uint32_t bytes)
+{
+    eeStats.transactions++;
+    eeStats.busBytes += bytes;
+    eeStats.timeNs += EEPROM_MODEL_FRAME_NS + ((uint64_t)bytes * EEPROM_MODEL_BYTE_NS);
+}
+
+/**
+ * @brief Run one transfer against the device
+ *
+ * @param xfer Transfer
+ *
+ * @return Transfer status
+ */
+static i2cStatus_t eepromModelTransfer(const i2cTransfer_t *xfer)
+{
+    uint16_t page;
+    uint16_t offset;
+
+    if(eeFailCount)
+    {
+        eeFailCount--;
+        eepromModelBus(1);
+        return I2C_ERR_BUS;
+    }
+
+    /*Write cycle running or wrong device: only the address byte is sent*/
+    if((xfer->addr != EEPROM_I2C_ADDR) || (eeStats.timeNs < eeBusyUntilNs))
+    {
+        eepromModelBus(1);
+        eeStats.nacks++;
+        return I2C_ERR_NACK;
+    }
+
+    eepromModelBus(1U + xfer->headerLen + xfer->txLen + xfer->rxLen);
+
+    if(xfer->headerLen == 2U)
+    {
+        eePointer = (uint16_t)(((xfer->header[0] << 8) | xfer->header[1]) % EEPROM_SIZE);
+    }
+
+    if(xfer->txLen)
+    {
+        /*Page write: the address counter wraps inside the page*/
+        page = eePointer - (eePointer % EEPROM_PAGE_SIZE);
+        offset = eePointer % EEPROM_PAGE_SIZE;
+
+        for(uint16_t i = 0; i < xfer->txLen; i++)
+        {
+            eeMem[page + ((offset + i) % EEPROM_PAGE_SIZE)] = xfer->txBuf[i];
+        }
+
+        eeStats.pageWrites++;
+        eeStats.bytesProgrammed += xfer->txLen;
+        eeBusyUntilNs = eeStats.timeNs + ((uint64_t)EEPROM_MODEL_WRITE_US * 1000U);
+    }
+
+    /*Sequential read rolls over the whole array*/
+    for(uint16_t i = 0; i < xfer->rxLen; i++)
+    {
+        xfer->rxBuf[i] = eeMem[eePointer];
+        eePointer = (uint16_t)((eePointer + 1U) % EEPROM_SIZE);
+    }
+
+    return I2C_OK;
+}
+
+/**
+ * @brief Fill the memory with 0xFF, clear the counters and the faults
+ *
+ * @return void
+ */
+void eepromModelReset(void)
+{
+    memset(eeMem, 0xFF, sizeof(eeMem));
+    memset(&eeStats, 0, sizeof(eeStats));
+    eeBusyUntilNs = 0;
+    eePointer = 0;
+    eeFailCount = 0;
+}
+
+/**
+ * @brief Let the simulated clock run
+ *
+ * @return void
+ */
+void eepromModelAdvance(uint32_t us)
+{
+    eeStats.timeNs += (uint64_t)us * 1000U;
+}
+
+/**
+ * @brief Make the next transactions fail
+ *
+ * @return void
+ */
+void eepromModelFail(uint32_t count)
+{
+    eeFailCount = count;
+}
+
+/**
+ * @brief Direct access to the device memory
+ *
+ * @return Pointer into the memory
+ */
+uint8_t *eepromModelMemory(uint16_t addr)
+{
+    return &eeMem[addr % EEPROM_SIZE];
+}
+
+/**
+ * @brief Copy the model counters
+ *
+ * @return void
+ */
+void eepromModelGetStats(eepromModelStats_t *stats)
+{
+    *stats = eeStats;
+}
+
+/**
+ * @brief Model of i2cSchedSubmit(): run the job with its retries
+ *
+ * @return 1 (always accepted)
+ */
+uint8_t i2cSchedSubmit(i2cJob_t *job)
+{
+    i2cStatus_t status;
+
+    job->attempts = 0;
+
+    do
+    {
+        status = eepromModelTransfer(&job->xfer);
+        job->attempts++;
+    } while((status != I2C_OK) && (job->attempts <= job->retries));
+
+    job->xfer.status = status;
+
+    if(job->done)
+    {
+        job->done(job);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Model of i2cSchedPoll(): jobs complete at submission
+ *
+ * @return void
+ */
+void i2cSchedPoll(void)
+{
+}
+
+/**
+ * @brief Model of i2cSchedBusy(): jobs are released at submission
+ *
+ * @param job Job
+ *
+ * @return 0
+ */
+uint8_t i2cSchedBusy(const i2cJob_t *job)
+{
+    (void)job;
+
+    return 0;
+}
+
+/**
+ * @brief Model of timGetMicros() on the simulated clock
+ *
+ * @return Microseconds
+ */
+uint32_t timGetMicros(void)
+{
+    return (uint32_t)(eeStats.timeNs / 1000U);
+}
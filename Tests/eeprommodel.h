@@ -0,0 +1,95 @@
+/**
+ * @file eeprommodel.h
+ * @brief 24Cxx model replacing i2csched.c and the TIM5 time base in host tests
+ *
+ * Implements i2cSchedSubmit(), i2cSchedPoll() and timGetMicros() on a
+ * simulated 24C32 on a 400 kHz bus, so eeprom.c runs unchanged on the
+ * host and every bus transaction it issues can be counted.
+ *
+ * @details
+ * - A job runs to completion inside i2cSchedSubmit(), with the job's
+ *   retries; every attempt is one bus transaction
+ * - Every byte on the bus (address, memory address, data) costs
+ *   EEPROM_MODEL_BYTE_NS, START and STOP EEPROM_MODEL_FRAME_NS
+ * - A page write wraps inside its page and starts a write cycle of
+ *   EEPROM_MODEL_WRITE_US during which the device NACKs its address
+ * - eepromModelFail(n) makes the next n transactions end with
+ *   I2C_ERR_BUS without touching the memory
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __EEPROMMODEL_H__
+#define __EEPROMMODEL_H__
+
+#include <stdint.h>
+#include "eeprom.h"
+
+/** One byte with its ACK at 400 kHz (ns) */
+#define EEPROM_MODEL_BYTE_NS    22500U
+
+/** START and STOP of one transaction (ns) */
+#define EEPROM_MODEL_FRAME_NS   5000U
+
+/** Internal write cycle (us) */
+#define EEPROM_MODEL_WRITE_US   5000U
+
+/**
+ * @brief Model counters
+ */
+typedef struct
+{
+    uint64_t timeNs;            /**< Simulated time */
+    uint32_t transactions;      /**< Bus transactions (retries included) */
+    uint32_t nacks;             /**< Address NACKs during a write cycle */
+    uint32_t pageWrites;        /**< Write cycles started */
+    uint32_t bytesProgrammed;   /**< Bytes programmed */
+    uint32_t busBytes;          /**< Bytes clocked on the bus */
+} eepromModelStats_t;
+
+/**
+ * @brief Fill the memory with 0xFF, clear the counters and the faults
+ *
+ * @return void
+ */
+void eepromModelReset(void);
+
+/**
+ * @brief Let the simulated clock run (application work between accesses)
+ *
+ * @param us Microseconds
+ *
+ * @return void
+ */
+void eepromModelAdvance(uint32_t us);
+
+/**
+ * @brief Make the next transactions fail with I2C_ERR_BUS
+ *
+ * @param count Number of transactions
+ *
+ * @return void
+ */
+void eepromModelFail(uint32_t count);
+
+/**
+ * @brief Direct access to the device memory
+ *
+ * @param addr Address
+ *
+ * @return Pointer into the EEPROM_SIZE bytes
+ */
+uint8_t *eepromModelMemory(uint16_t addr);
+
+/**
+ * @brief Copy the model counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void eepromModelGetStats(eepromModelStats_t *stats);
+
+#endif // __EEPROMMODEL_H__
@@ -0,0 +1,287 @@
+/**
+ * @file eepromtest.c
+ * @brief Host test of the EEPROM driver against the 24Cxx model
+ *
+ * Runs eeprom.c unchanged against eeprommodel.c and reports, for a few
+ * typical write patterns, the bus transactions with write coalescing
+ * (the driver as is) and without it (every write programmed at once,
+ * i.e. followed by eepromFlush()). Also checks:
+ * - Device contents and reads through the cache match a RAM shadow
+ * - A failed page write keeps the pending bytes for the next flush
+ * - A failed write never leaves unstored data in the read cache
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "eeprom.h"
+#include "eeprommodel.h"
+
+/** Application work between two accesses (us) */
+#define TEST_APP_US     200U
+
+/**
+ * @brief Write pattern
+ */
+typedef enum
+{
+    TEST_BYTES = 0,     /**< 256 bytes written one by one */
+    TEST_COUNTERS,      /**< 8 counters of 4 bytes updated round robin */
+    TEST_RECORDS,       /**< 20-byte records appended */
+    TEST_RANDOM,        /**< Single bytes at random addresses */
+    TEST_PATTERNS
+} testPattern_t;
+
+static const char *const testNames[TEST_PATTERNS] =
+{
+    "bytes 1 by 1", "counters", "20 B records", "random bytes"
+};
+
+static uint8_t testShadow[EEPROM_SIZE];
+static uint32_t testRand = 1U;
+static uint32_t testFailures;
+
+/**
+ * @brief xorshift32
+ *
+ * @return Pseudo-random value
+ */
+static uint32_t testRandom(void)
+{
+    testRand ^= testRand << 13;
+    testRand ^= testRand >> 17;
+    testRand ^= testRand << 5;
+    return testRand;
+}
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * @param ok Condition
+ * @param what Description
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Write through the driver and the shadow
+ *
+ * @param addr First address
+ * @param data Source
+ * @param len Number of bytes
+ * @param immediate 1 to program at once (no coalescing)
+ *
+ * @return void
+ */
+static void testWrite(uint16_t addr, const uint8_t *data, uint16_t len, uint8_t immediate)
+{
+    testCheck(eepromWrite(addr, data, len) == EEPROM_OK, "write");
+    if(immediate)
+    {
+        testCheck(eepromFlush() == EEPROM_OK, "flush after write");
+    }
+
+    memcpy(&testShadow[addr], data, len);
+    eepromModelAdvance(TEST_APP_US);
+}
+
+/**
+ * @brief Run one write pattern
+ *
+ * @param pattern Pattern
+ * @param immediate 1 to program every write at once
+ *
+ * @return void
+ */
+static void testPattern(testPattern_t pattern, uint8_t immediate)
+{
+    uint8_t buf[20];
+    uint32_t counters[8] = {0};
+    uint16_t addr;
+
+    testRand = 1U;
+
+    switch(pattern)
+    {
+        case TEST_BYTES:
+            for(addr = 0; addr < 256U; addr++)
+            {
+                buf[0] = (uint8_t)(addr ^ 0x5AU);
+                testWrite(addr, buf, 1, immediate);
+            }
+            break;
+
+        case TEST_COUNTERS:
+            for(uint32_t n = 0; n < 400U; n++)
+            {
+                counters[n % 8U]++;
+                memcpy(buf, &counters[n % 8U], 4);
+                testWrite((uint16_t)(0x400U + ((n % 8U) * 4U)), buf, 4, immediate);
+            }
+            break;
+
+        case TEST_RECORDS:
+            for(uint32_t n = 0; n < 100U; n++)
+            {
+                for(uint32_t i = 0; i < sizeof(buf); i++)
+                {
+                    buf[i] = (uint8_t)(n + i);
+                }
+                testWrite((uint16_t)(0x800U + (n * sizeof(buf))), buf, sizeof(buf), immediate);
+            }
+            break;
+
+        default:
+            for(uint32_t n = 0; n < 200U; n++)
+            {
+                buf[0] = (uint8_t)testRandom();
+                testWrite((uint16_t)(testRandom() % EEPROM_SIZE), buf, 1, immediate);
+            }
+            break;
+    }
+
+    testCheck(eepromFlush() == EEPROM_OK, "final flush");
+}
+
+/**
+ * @brief Compare the device and the cached reads with the shadow
+ *
+ * @param what Description
+ *
+ * @return void
+ */
+static void testVerify(const char *what)
+{
+    uint8_t buf[EEPROM_CACHE_LINE];
+    uint8_t ok = (memcmp(eepromModelMemory(0), testShadow, EEPROM_SIZE) == 0);
+
+    /*Line-sized reads go through the cache*/
+    for(uint16_t addr = 0; ok && (addr < EEPROM_SIZE); addr += EEPROM_CACHE_LINE)
+    {
+        ok = (eepromRead(addr, buf, EEPROM_CACHE_LINE) == EEPROM_OK) &&
+             (memcmp(buf, &testShadow[addr], EEPROM_CACHE_LINE) == 0);
+    }
+
+    testCheck(ok, what);
+}
+
+/**
+ * @brief Transactions of every pattern with and without coalescing
+ *
+ * @return void
+ */
+static void testCoalescing(void)
+{
+    eepromModelStats_t model[2];
+    eepromStats_t stats;
+    eepromStats_t start;
+    char what[64];
+
+    printf("%-14s %26s %26s %7s\n", "pattern", "coalesced: xfers/pages/polls",
+           "immediate: xfers/pages/polls", "saved");
+
+    for(testPattern_t p = TEST_BYTES; p < TEST_PATTERNS; p++)
+    {
+        for(uint8_t immediate = 0; immediate < 2U; immediate++)
+        {
+            eepromModelReset();
+            eepromInit();
+            memset(testShadow, 0xFF, sizeof(testShadow));
+
+            eepromGetStats(&start);
+            testPattern(p, immediate);
+            eepromModelGetStats(&model[immediate]);
+            eepromGetStats(&stats);
+
+            snprintf(what, sizeof(what), "%s: driver and model agree", testNames[p]);
+            testCheck((stats.busTransactions - start.busTransactions) == model[immediate].transactions, what);
+            snprintf(what, sizeof(what), "%s: contents", testNames[p]);
+            testVerify(what);
+        }
+
+        printf("%-14s %12u/%5u/%7u %12u/%5u/%7u %6.1f%%\n", testNames[p],
+               model[0].transactions, model[0].pageWrites, model[0].nacks,
+               model[1].transactions, model[1].pageWrites, model[1].nacks,
+               100.0 * (1.0 - ((double)model[0].transactions / model[1].transactions)));
+
+        snprintf(what, sizeof(what), "%s: coalescing never costs transactions", testNames[p]);
+        testCheck(model[0].transactions <= model[1].transactions, what);
+    }
+}
+
+/**
+ * @brief Page write failures: pending bytes and cache contents
+ *
+ * @return void
+ */
+static void testWriteErrors(void)
+{
+    uint8_t data[EEPROM_PAGE_SIZE];
+    uint8_t buf[EEPROM_PAGE_SIZE];
+
+    eepromModelReset();
+    eepromInit();
+
+    /*Pending bytes survive a failed flush (both attempts of the job fail)*/
+    memset(data, 0x11, sizeof(data));
+    testCheck(eepromWrite(0x100, data, 4) == EEPROM_OK, "pending write");
+    eepromModelFail(2);
+    testCheck(eepromFlush() == EEPROM_ERR_BUS, "flush fails");
+    testCheck(eepromModelMemory(0x100)[0] == 0xFFU, "nothing stored by the failed flush");
+    testCheck(eepromFlush() == EEPROM_OK, "second flush");
+    testCheck(memcmp(eepromModelMemory(0x100), data, 4) == 0, "pending bytes stored by the retry");
+
+    /*A failed whole-page write leaves the cached line as the device has it*/
+    testCheck(eepromRead(0x200, buf, EEPROM_CACHE_LINE) == EEPROM_OK, "line cached");
+    memset(data, 0x22, sizeof(data));
+    eepromModelFail(2);
+    testCheck(eepromWrite(0x200, data, EEPROM_PAGE_SIZE) == EEPROM_ERR_BUS, "page write fails");
+    testCheck((eepromRead(0x200, buf, EEPROM_CACHE_LINE) == EEPROM_OK) &&
+              (memcmp(buf, eepromModelMemory(0x200), EEPROM_CACHE_LINE) == 0) && (buf[0] == 0xFFU),
+              "cache holds only stored data after a failed write");
+
+    /*A read overlapping the pending page programs it first*/
+    memset(data, 0x33, sizeof(data));
+    testCheck(eepromRead(0x300, buf, EEPROM_CACHE_LINE) == EEPROM_OK, "line cached before write");
+    testCheck(eepromWrite(0x300, data, 3) == EEPROM_OK, "pending write in a cached line");
+    testCheck((eepromRead(0x300, buf, 3) == EEPROM_OK) && (memcmp(buf, data, 3) == 0) &&
+              (memcmp(eepromModelMemory(0x300), data, 3) == 0), "read sees stored data");
+
+    /*If that flush fails the read fails, and the bytes stay pending
+      (end the write cycle first so no ACK poll takes the injected faults)*/
+    testCheck(eepromFlush() == EEPROM_OK, "write cycle finished");
+    memset(data, 0x44, sizeof(data));
+    testCheck(eepromWrite(0x340, data, 2) == EEPROM_OK, "second pending write");
+    eepromModelFail(2);
+    testCheck(eepromRead(0x340, buf, 2) == EEPROM_ERR_BUS, "read reports the failed flush");
+    testCheck(eepromFlush() == EEPROM_OK, "flush after the failed read");
+    testCheck((memcmp(eepromModelMemory(0x340), data, 2) == 0) &&
+              (eepromRead(0x340, buf, 2) == EEPROM_OK) && (memcmp(buf, data, 2) == 0),
+              "bytes stored after the failed read");
+}
+
+int main(void)
+{
+    printf("eeprom: %u B, %u B pages, 400 kHz bus, %u us between writes\n",
+           EEPROM_SIZE, EEPROM_PAGE_SIZE, TEST_APP_US);
+
+    testCoalescing();
+    testWriteErrors();
+
+    printf("%s\n", testFailures ? "eeprom: FAILED" : "eeprom: OK");
+
+    return testFailures ? 1 : 0;
+}
@@ -0,0 +1,307 @@
+/**
+ * @file ffttest.c
+ * @brief Host validation of the real FFT against a double DFT
+ *
+ * Builds fft.c for the host with FFT_ENABLE_F32 and checks, for every
+ * size from FFT_MIN_SIZE to FFT_MAX_SIZE:
+ * - fftRealQ15() against the DFT / n of the same Q15 input, every bin
+ *   of the packed layout including DC and Nyquist, for noise, a tone
+ *   and a signal at the Nyquist frequency
+ * - fftRealF32() against the unscaled DFT of the same input
+ * - Unsupported sizes are refused
+ *
+ * and with a 512-point tone: fftPrepareQ15() windows, fftMagnitudeQ15()
+ * and the bin and interpolated position from fftFindPeaks().
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include "fft.h"
+
+/** Largest Q15 error of a bin (LSB) */
+#define TEST_Q15_TOL        4.0
+
+/** Largest F32 error of a bin, relative to the largest bin (the float
+    path shares the Q15 twiddle table, each twiddle is off by up to 2^-16) */
+#define TEST_F32_TOL        1e-4
+
+/** Input amplitude, half of Q15 full scale as from fftPrepareQ15() */
+#define TEST_AMPLITUDE      16383.0
+
+static int16_t testQ15[FFT_MAX_SIZE];
+static float testF32[FFT_MAX_SIZE];
+static double testIn[FFT_MAX_SIZE];
+static double testRe[(FFT_MAX_SIZE / 2U) + 1U];
+static double testIm[(FFT_MAX_SIZE / 2U) + 1U];
+static double testCos[FFT_MAX_SIZE];
+static double testSin[FFT_MAX_SIZE];
+static uint32_t testRand = 88172645U;
+static uint32_t testFailures;
+
+/**
+ * @brief xorshift32
+ *
+ * @return Pseudo-random value
+ */
+static uint32_t testRandom(void)
+{
+    testRand ^= testRand << 13;
+    testRand ^= testRand >> 17;
+    testRand ^= testRand << 5;
+    return testRand;
+}
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * @param ok Condition
+ * @param what Description
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Double DFT of testIn, bins 0 to n/2
+ *
+ * @param n Size
+ *
+ * @return void
+ */
+static void testDft(uint32_t n)
+{
+    double re;
+    double im;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        testCos[i] = cos((2.0 * M_PI * i) / n);
+        testSin[i] = sin((2.0 * M_PI * i) / n);
+    }
+
+    for(uint32_t k = 0; k <= (n / 2U); k++)
+    {
+        re = 0.0;
+        im = 0.0;
+        for(uint32_t i = 0; i < n; i++)
+        {
+            re += testIn[i] * testCos[(k * i) % n];
+            im -= testIn[i] * testSin[(k * i) % n];
+        }
+        testRe[k] = re;
+        testIm[k] = im;
+    }
+}
+
+/**
+ * @brief Largest difference between a packed spectrum and the DFT
+ *
+ * @param q15 Packed Q15 spectrum, or 0 to use testF32
+ * @param n Size
+ * @param scale Factor applied to the DFT
+ *
+ * @return Largest difference over every value of the layout
+ */
+static double testCompare(const int16_t *q15, uint32_t n, double scale)
+{
+    double err;
+    double maxErr = 0.0;
+    double v;
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        /*buf[0] = DC, buf[1] = Nyquist, then re, im of bins 1..n/2-1*/
+        if(i == 0U)
+        {
+            v = testRe[0];
+        }
+        else if(i == 1U)
+        {
+            v = testRe[n / 2U];
+        }
+        else
+        {
+            v = (i & 1U) ? testIm[i / 2U] : testRe[i / 2U];
+        }
+
+        err = fabs((q15 ? (double)q15[i] : (double)testF32[i]) - (v * scale));
+        maxErr = (err > maxErr) ? err : maxErr;
+    }
+
+    return maxErr;
+}
+
+/**
+ * @brief Run both transforms on testIn against the DFT
+ *
+ * @param n Size
+ * @param signal Signal name for the report
+ *
+ * @return void
+ */
+static void testTransform(uint32_t n, const char *signal)
+{
+    double errQ15;
+    double errF32;
+    double peak = 0.0;
+    char what[80];
+
+    for(uint32_t i = 0; i < n; i++)
+    {
+        testQ15[i] = (int16_t)testIn[i];
+        testF32[i] = (float)testIn[i];
+    }
+
+    testDft(n);
+
+    snprintf(what, sizeof(what), "%u points: q15 size accepted", n);
+    testCheck(fftRealQ15(testQ15, n), what);
+    snprintf(what, sizeof(what), "%u points: f32 size accepted", n);
+    testCheck(fftRealF32(testF32, n), what);
+
+    for(uint32_t k = 0; k <= (n / 2U); k++)
+    {
+        peak = fmax(peak, hypot(testRe[k], testIm[k]));
+    }
+
+    errQ15 = testCompare(testQ15, n, 1.0 / n);
+    errF32 = testCompare(0, n, 1.0) / peak;
+
+    printf("%4u %-9s q15 max error %5.2f LSB   f32 max error %.1e\n", n, signal, errQ15, errF32);
+
+    snprintf(what, sizeof(what), "%u points, %s: q15 matches the DFT", n, signal);
+    testCheck(errQ15 <= TEST_Q15_TOL, what);
+    snprintf(what, sizeof(what), "%u points, %s: f32 matches the DFT", n, signal);
+    testCheck(errF32 <= TEST_F32_TOL, what);
+}
+
+/**
+ * @brief Every size with noise, a tone and a Nyquist-rate signal
+ *
+ * @return void
+ */
+static void testSizes(void)
+{
+    for(uint32_t n = FFT_MIN_SIZE; n <= FFT_MAX_SIZE; n *= 2U)
+    {
+        for(uint32_t i = 0; i < n; i++)
+        {
+            testIn[i] = (double)((int32_t)(testRandom() % 32767U) - 16383);
+        }
+        testTransform(n, "noise");
+
+        for(uint32_t i = 0; i < n; i++)
+        {
+            testIn[i] = floor(TEST_AMPLITUDE * sin((2.0 * M_PI * 5.3 * i) / n));
+        }
+        testTransform(n, "tone");
+
+        /*Nyquist bin plus an offset for DC*/
+        for(uint32_t i = 0; i < n; i++)
+        {
+            testIn[i] = ((i & 1U) ? -12000.0 : 12000.0) + 2000.0;
+        }
+        testTransform(n, "nyquist");
+    }
+
+    testCheck(!fftRealQ15(testQ15, FFT_MIN_SIZE / 2U), "too small a size refused");
+    testCheck(!fftRealQ15(testQ15, FFT_MAX_SIZE * 2U), "too large a size refused");
+    testCheck(!fftRealQ15(testQ15, 1000U), "size that is no power of two refused");
+    testCheck(!fftRealF32(testF32, 1000U), "f32 size that is no power of two refused");
+}
+
+/**
+ * @brief Windows, magnitudes and peak search on a 512-point tone
+ *
+ * @return void
+ */
+static void testAnalysis(void)
+{
+    static uint16_t adc[2U * 512U];
+    static uint16_t mag[256];
+    const uint32_t n = 512U;
+    const double bin = 40.3;
+    fftPeak_t peaks[2];
+    double w;
+    double err;
+    double maxErr = 0.0;
+    uint32_t count;
+    char what[80];
+
+    /*Two channels interleaved, the tone on channel 0*/
+    for(uint32_t i = 0; i < n; i++)
+    {
+        adc[2U * i] = (uint16_t)lrint(2048.0 + (2000.0 * sin((2.0 * M_PI * bin * i) / n)));
+        adc[(2U * i) + 1U] = 0;
+    }
+
+    fftPrepareQ15(adc, 2, testQ15, n, FFT_WINDOW_RECT);
+    for(uint32_t i = 0; i < n; i++)
+    {
+        maxErr = fmax(maxErr, fabs(testQ15[i] - (((double)adc[2U * i] - 2048.0) * 8.0)));
+    }
+    testCheck(maxErr == 0.0, "rect window is the plain conversion");
+
+    for(fftWindow_t win = FFT_WINDOW_HANN; win <= FFT_WINDOW_HAMMING; win++)
+    {
+        fftPrepareQ15(adc, 2, testQ15, n, win);
+
+        maxErr = 0.0;
+        for(uint32_t i = 0; i < n; i++)
+        {
+            w = (win == FFT_WINDOW_HANN) ? (0.5 - (0.5 * cos((2.0 * M_PI * i) / n))) :
+                                           (0.54 - (0.46 * cos((2.0 * M_PI * i) / n)));
+            err = fabs(testQ15[i] - ((((double)adc[2U * i] - 2048.0) * 8.0) * w));
+            maxErr = fmax(maxErr, err);
+        }
+        snprintf(what, sizeof(what), "%s window within 2 LSB", (win == FFT_WINDOW_HANN) ? "hann" : "hamming");
+        testCheck(maxErr <= 2.0, what);
+    }
+
+    /*Hann windowed tone: magnitudes and peak*/
+    fftPrepareQ15(adc, 2, testQ15, n, FFT_WINDOW_HANN);
+    for(uint32_t i = 0; i < n; i++)
+    {
+        testIn[i] = testQ15[i];
+    }
+    testDft(n);
+    fftRealQ15(testQ15, n);
+    fftMagnitudeQ15(testQ15, mag, n);
+
+    maxErr = 0.0;
+    for(uint32_t k = 0; k < (n / 2U); k++)
+    {
+        maxErr = fmax(maxErr, fabs(mag[k] - (hypot(testRe[k], testIm[k]) / n)));
+    }
+    printf("512 hann tone magnitude max error %.2f LSB\n", maxErr);
+    testCheck(maxErr <= TEST_Q15_TOL, "magnitudes match the DFT");
+
+    count = fftFindPeaks(mag, n / 2U, peaks, 2, 50);
+    printf("512 hann tone at bin %.2f: peak bin %u, interpolated %.2f\n", bin,
+           count ? peaks[0].bin : 0U, count ? (peaks[0].binQ8 / 256.0) : 0.0);
+    testCheck((count == 1U) && (peaks[0].bin == 40U), "one peak at the tone bin");
+    testCheck(count && (fabs((peaks[0].binQ8 / 256.0) - bin) < 0.25), "interpolated peak within 1/4 bin");
+}
+
+int main(void)
+{
+    testSizes();
+    testAnalysis();
+
+    printf("%s\n", testFailures ? "fft: FAILED" : "fft: OK");
+
+    return testFailures ? 1 : 0;
+}
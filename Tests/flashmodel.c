@@ -0,0 +1,273 @@
+/**
+ * @file flashmodel.c
+ * @brief RAM-backed W25Qxx model implementation
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <string.h>
+#include "flashmodel.h"
+
+#define FLASH_MODEL_SECTORS     (FLASH_MODEL_SIZE / SPI_FLASH_SECTOR_SIZE)
+
+static uint8_t flashMem[FLASH_MODEL_SIZE];
+static uint32_t flashSectorErases[FLASH_MODEL_SECTORS];
+static flashModelStats_t flashStats;
+static uint64_t flashBusyUntilNs;
+static uint32_t flashOpsLeft;
+static uint8_t flashCutArmed;
+static uint8_t flashDead;
+static uint32_t flashRand;
+
+/**
+ * @brief xorshift32 for the tearing points
+ *
+ * @return Pseudo-random value
+ */
+static uint32_t flashModelRand(void)
+{
+    flashRand ^= flashRand << 13;
+    flashRand ^= flashRand >> 17;
+    flashRand ^= flashRand << 5;
+    return flashRand;
+}
+
+/**
+ * @brief Account bytes clocked on the bus
+ *
+ * @param bytes Number of bytes
+ *
+ * @return void
+ */
+static void flashModelBus(uint32_t bytes)
+{
+    flashStats.busBytes += bytes;
+    flashStats.timeNs += (uint64_t)bytes * FLASH_MODEL_BYTE_NS;
+}
+
+/**
+ * @brief Decide whether a program/erase operation runs, tears or is lost
+ *
+ * @return 2 = complete, 1 = torn, 0 = no power
+ */
+static uint8_t flashModelOpOutcome(void)
+{
+    if(flashDead)
+    {
+        return 0;
+    }
+
+    if(flashCutArmed)
+    {
+        if(flashOpsLeft == 0U)
+        {
+            flashDead = 1;
+            return 1;
+        }
+        flashOpsLeft--;
+    }
+
+    return 2;
+}
+
+/**
+ * @brief Erase the whole device, clear the counters and restore power
+ *
+ * @return void
+ */
+void flashModelReset(uint32_t seed)
+{
+    memset(flashMem, 0xFF, sizeof(flashMem));
+    memset(flashSectorErases, 0, sizeof(flashSectorErases));
+    memset(&flashStats, 0, sizeof(flashStats));
+    flashBusyUntilNs = 0;
+    flashCutArmed = 0;
+    flashDead = 0;
+    flashRand = seed ? seed : 1U;
+}
+
+/**
+ * @brief Let the simulated clock run
+ *
+ * @return void
+ */
+void flashModelAdvance(uint32_t us)
+{
+    flashStats.timeNs += (uint64_t)us * 1000U;
+}
+
+/**
+ * @brief Schedule a power loss
+ *
+ * @return void
+ */
+void flashModelCutPowerAfter(uint32_t ops)
+{
+    flashOpsLeft = ops;
+    flashCutArmed = 1;
+}
+
+/**
+ * @brief Check whether the scheduled power loss has happened
+ *
+ * @return 1 once an operation was torn
+ */
+uint8_t flashModelIsDead(void)
+{
+    return flashDead;
+}
+
+/**
+ * @brief Restore power
+ *
+ * @return void
+ */
+void flashModelPowerOn(void)
+{
+    flashCutArmed = 0;
+    flashDead = 0;
+    flashBusyUntilNs = 0;
+}
+
+/**
+ * @brief Copy the model counters
+ *
+ * @return void
+ */
+void flashModelGetStats(flashModelStats_t *stats)
+{
+    *stats = flashStats;
+}
+
+/**
+ * @brief Model of spiFlashInit(): no SPI setup, wait for BUSY to clear
+ *
+ * @return void
+ */
+void spiFlashInit(void)
+{
+    spiFlashWaitReady();
+}
+
+/**
+ * @brief Model of spiFlashReadJedecId(): W25Q16 identification
+ *
+ * @return void
+ */
+void spiFlashReadJedecId(uint8_t *id)
+{
+    flashModelBus(4);
+    id[0] = 0xEF;
+    id[1] = 0x40;
+    id[2] = 0x15;
+}
+
+/**
+ * @brief Model of spiFlashIsBusy(): one status register read
+ *
+ * @return 1 while a program or erase is running
+ */
+uint8_t spiFlashIsBusy(void)
+{
+    flashModelBus(2);
+    flashStats.statusPolls++;
+
+    return (flashStats.timeNs < flashBusyUntilNs) ? 1U : 0U;
+}
+
+/**
+ * @brief Model of spiFlashWaitReady()
+ *
+ * @return void
+ */
+void spiFlashWaitReady(void)
+{
+    while(spiFlashIsBusy()){}
+}
+
+/**
+ * @brief Model of spiFlashRead()
+ *
+ * @return void
+ */
+void spiFlashRead(uint32_t addr, uint8_t *data, uint32_t size)
+{
+    flashModelBus(4U + size);
+    flashStats.reads++;
+
+    for(uint32_t i = 0; i < size; i++)
+    {
+        data[i] = flashMem[(addr + i) % FLASH_MODEL_SIZE];
+    }
+}
+
+/**
+ * @brief Model of spiFlashPageProgram(): AND the data into the page
+ *
+ * @return void
+ */
+void spiFlashPageProgram(uint32_t addr, const uint8_t *data, uint32_t size)
+{
+    uint32_t page = addr & ~(SPI_FLASH_PAGE_SIZE - 1U);
+    uint32_t n = size;
+    uint8_t outcome;
+
+    /*Write enable + command, address and data*/
+    flashModelBus(1U + 4U + size);
+    flashStats.programs++;
+
+    outcome = flashModelOpOutcome();
+    if(outcome == 0U)
+    {
+        return;
+    }
+    if(outcome == 1U)
+    {
+        n = flashModelRand() % (size + 1U);
+    }
+
+    /*The address wraps inside the page like on the device*/
+    for(uint32_t i = 0; i < n; i++)
+    {
+        flashMem[page + (((addr - page) + i) % SPI_FLASH_PAGE_SIZE)] &= data[i];
+    }
+
+    flashBusyUntilNs = flashStats.timeNs + ((uint64_t)FLASH_MODEL_PROGRAM_US * 1000U);
+}
+
+/**
+ * @brief Model of spiFlashSectorErase(): set the sector to 0xFF
+ *
+ * @return void
+ */
+void spiFlashSectorErase(uint32_t addr)
+{
+    uint32_t sector = (addr % FLASH_MODEL_SIZE) / SPI_FLASH_SECTOR_SIZE;
+    uint32_t bytes = SPI_FLASH_SECTOR_SIZE;
+    uint8_t outcome;
+
+    flashModelBus(1U + 4U);
+    flashStats.erases++;
+
+    outcome = flashModelOpOutcome();
+    if(outcome == 0U)
+    {
+        return;
+    }
+    if(outcome == 1U)
+    {
+        bytes = (flashModelRand() % (SPI_FLASH_SECTOR_SIZE / SPI_FLASH_PAGE_SIZE)) * SPI_FLASH_PAGE_SIZE;
+    }
+
+    memset(&flashMem[sector * SPI_FLASH_SECTOR_SIZE], 0xFF, bytes);
+
+    flashSectorErases[sector]++;
+    if(flashSectorErases[sector] > flashStats.maxSectorErases)
+    {
+        flashStats.maxSectorErases = flashSectorErases[sector];
+    }
+
+    flashBusyUntilNs = flashStats.timeNs + ((uint64_t)FLASH_MODEL_ERASE_US * 1000U);
+}
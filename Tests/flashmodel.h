@@ -0,0 +1,112 @@
+/**
+ * @file flashmodel.h
+ * @brief RAM-backed W25Qxx model replacing spiflash.c in host tests
+ *
+ * Implements the spiflash.h API on a RAM array with NOR semantics
+ * (program only clears bits, erase sets a 4 KB sector to 0xFF) and a
+ * simulated clock, so host tests can measure how long the log store
+ * spends on the SPI bus and waiting for the flash.
+ *
+ * @details
+ * Timing model (SPI1 at fPCLK/4 = 4 MHz, W25Q16 typical values):
+ * - Every byte on the bus costs FLASH_MODEL_BYTE_NS
+ * - Page program keeps BUSY set for FLASH_MODEL_PROGRAM_US
+ * - Sector erase keeps BUSY set for FLASH_MODEL_ERASE_US
+ * - spiFlashIsBusy() costs one status read; the clock only moves
+ *   forward through bus traffic and flashModelAdvance()
+ *
+ * Power loss: flashModelCutPowerAfter(n) lets n more program/erase
+ * operations complete, tears the next one (a random prefix of a page
+ * program, a random number of pages of an erase) and ignores every
+ * later one until flashModelPowerOn().
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __FLASHMODEL_H__
+#define __FLASHMODEL_H__
+
+#include <stdint.h>
+#include "spiflash.h"
+
+/** Size of the simulated device (W25Q16, 2 MB) */
+#ifndef FLASH_MODEL_SIZE
+#define FLASH_MODEL_SIZE        (2UL * 1024UL * 1024UL)
+#endif
+
+/** One byte at 4 MHz (ns) */
+#define FLASH_MODEL_BYTE_NS     2000U
+
+/** Page program time (us) */
+#define FLASH_MODEL_PROGRAM_US  700U
+
+/** Sector erase time (us) */
+#define FLASH_MODEL_ERASE_US    45000U
+
+/**
+ * @brief Model counters
+ */
+typedef struct
+{
+    uint64_t timeNs;            /**< Simulated time */
+    uint64_t busBytes;          /**< Bytes clocked on SPI (commands included) */
+    uint32_t reads;             /**< Read commands */
+    uint32_t programs;          /**< Page program commands */
+    uint32_t erases;            /**< Sector erase commands */
+    uint32_t statusPolls;       /**< Status register reads */
+    uint32_t maxSectorErases;   /**< Highest erase count of one sector */
+} flashModelStats_t;
+
+/**
+ * @brief Erase the whole device, clear the counters and restore power
+ *
+ * @param seed Seed of the power-cut tearing
+ *
+ * @return void
+ */
+void flashModelReset(uint32_t seed);
+
+/**
+ * @brief Let the simulated clock run (idle main loop)
+ *
+ * @param us Microseconds
+ *
+ * @return void
+ */
+void flashModelAdvance(uint32_t us);
+
+/**
+ * @brief Schedule a power loss
+ *
+ * @param ops Program/erase operations that still complete
+ *
+ * @return void
+ */
+void flashModelCutPowerAfter(uint32_t ops);
+
+/**
+ * @brief Check whether the scheduled power loss has happened
+ *
+ * @return 1 once an operation was torn
+ */
+uint8_t flashModelIsDead(void);
+
+/**
+ * @brief Restore power: operations run again and BUSY is clear
+ *
+ * @return void
+ */
+void flashModelPowerOn(void);
+
+/**
+ * @brief Copy the model counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void flashModelGetStats(flashModelStats_t *stats);
+
+#endif // __FLASHMODEL_H__
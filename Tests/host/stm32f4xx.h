@@ -0,0 +1,38 @@
+/**
+ * @file stm32f4xx.h
+ * @brief Host stand-in for the CMSIS device header
+ *
+ * Host tests only compile portable modules and drivers whose hardware
+ * layer is replaced by a model, so nothing beyond the integer types and
+ * the interrupt masking intrinsics is needed. Any register access that
+ * slips into a host build fails to compile, which is intended.
+ *
+ * Models call the completion handlers of the code under test from the
+ * test thread, so masking interrupts has nothing to do on the host.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __HOST_STM32F4XX_H__
+#define __HOST_STM32F4XX_H__
+
+#include <stdint.h>
+
+/** PRIMASK stand-ins for critical sections */
+static inline uint32_t __get_PRIMASK(void)
+{
+    return 0U;
+}
+
+static inline void __set_PRIMASK(uint32_t primask)
+{
+    (void)primask;
+}
+
+static inline void __disable_irq(void)
+{
+}
+
+#endif // __HOST_STM32F4XX_H__
@@ -0,0 +1,162 @@
+/**
+ * @file i2cmodel.c
+ * @brief I2C1 engine model implementation
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <string.h>
+#include "i2cmodel.h"
+#include "timer.h"
+
+static i2cTransfer_t *i2cModelXfer;
+static uint32_t i2cModelTimeUs;
+static i2cModelStats_t i2cModelStats;
+
+/**
+ * @brief Free the engine, clear the counters and the clock
+ *
+ * @return void
+ */
+void i2cModelReset(void)
+{
+    i2cModelXfer = 0;
+    i2cModelTimeUs = 0;
+    memset(&i2cModelStats, 0, sizeof(i2cModelStats));
+}
+
+/**
+ * @brief Let the simulated clock run
+ *
+ * @return void
+ */
+void i2cModelAdvance(uint32_t us)
+{
+    i2cModelTimeUs += us;
+}
+
+/**
+ * @brief Transfer on the bus
+ *
+ * @return Running transfer, 0 if the engine is idle
+ */
+i2cTransfer_t *i2cModelRunning(void)
+{
+    return i2cModelXfer;
+}
+
+/**
+ * @brief End the running transfer (completion interrupt)
+ *
+ * @return void
+ */
+void i2cModelComplete(i2cStatus_t status)
+{
+    i2cTransfer_t *xfer = i2cModelXfer;
+
+    if(!xfer)
+    {
+        return;
+    }
+
+    i2cModelXfer = 0;
+    xfer->status = status;
+
+    if(xfer->callback)
+    {
+        xfer->callback(xfer);
+    }
+}
+
+/**
+ * @brief Copy the model counters
+ *
+ * @return void
+ */
+void i2cModelGetStats(i2cModelStats_t *stats)
+{
+    *stats = i2cModelStats;
+}
+
+/**
+ * @brief Model of i2c1Init()
+ *
+ * @return void
+ */
+void i2c1Init(void)
+{
+    i2cModelXfer = 0;
+}
+
+/**
+ * @brief Model of i2c1Submit()
+ *
+ * @return 1 if started, 0 if another transfer is running
+ */
+uint8_t i2c1Submit(i2cTransfer_t *xfer)
+{
+    if(i2cModelXfer)
+    {
+        return 0;
+    }
+
+    xfer->status = I2C_PENDING;
+    i2cModelXfer = xfer;
+    i2cModelStats.submits++;
+
+    return 1;
+}
+
+/**
+ * @brief Model of i2c1IsBusy()
+ *
+ * @return 1 if a transfer is running
+ */
+uint8_t i2c1IsBusy(void)
+{
+    return i2cModelXfer ? 1U : 0U;
+}
+
+/**
+ * @brief Model of i2c1Abort(): I2C_ERR_TIMEOUT, no callback
+ *
+ * @return void
+ */
+void i2c1Abort(void)
+{
+    if(i2cModelXfer)
+    {
+        i2cModelXfer->status = I2C_ERR_TIMEOUT;
+        i2cModelXfer = 0;
+        i2cModelStats.aborts++;
+    }
+}
+
+/**
+ * @brief Model of i2c1BusRecover()
+ *
+ * @return 1, 0 if a transfer is running
+ */
+uint8_t i2c1BusRecover(void)
+{
+    if(i2cModelXfer)
+    {
+        return 0;
+    }
+
+    i2cModelStats.recoveries++;
+
+    return 1;
+}
+
+/**
+ * @brief Model of timGetMicros() on the simulated clock
+ *
+ * @return Microseconds
+ */
+uint32_t timGetMicros(void)
+{
+    return i2cModelTimeUs;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file i2cmodel.h
+ * @brief I2C1 engine model replacing i2c.c and the TIM5 time base in host tests
+ *
+ * Implements the part of the i2c.h API the scheduler uses (i2c1Init(),
+ * i2c1Submit(), i2c1IsBusy(), i2c1Abort(), i2c1BusRecover()) and
+ * timGetMicros(), so i2csched.c runs unchanged on the host.
+ *
+ * @details
+ * - A submitted transfer stays running until the test ends it with
+ *   i2cModelComplete(), which plays the completion interrupt: status
+ *   set, engine free, then the transfer callback
+ * - i2c1Abort() ends the running transfer with I2C_ERR_TIMEOUT and no
+ *   callback, as the driver does
+ * - Time only moves with i2cModelAdvance()
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __I2CMODEL_H__
+#define __I2CMODEL_H__
+
+#include <stdint.h>
+#include "i2c.h"
+
+/**
+ * @brief Model counters
+ */
+typedef struct
+{
+    uint32_t submits;           /**< Transfers started */
+    uint32_t aborts;            /**< i2c1Abort() on a running transfer */
+    uint32_t recoveries;        /**< i2c1BusRecover() calls */
+} i2cModelStats_t;
+
+/**
+ * @brief Free the engine, clear the counters and the clock
+ *
+ * @return void
+ */
+void i2cModelReset(void);
+
+/**
+ * @brief Let the simulated clock run
+ *
+ * @param us Microseconds
+ *
+ * @return void
+ */
+void i2cModelAdvance(uint32_t us);
+
+/**
+ * @brief Transfer on the bus
+ *
+ * @return Running transfer, 0 if the engine is idle
+ */
+i2cTransfer_t *i2cModelRunning(void);
+
+/**
+ * @brief End the running transfer (completion interrupt)
+ *
+ * @param status Result of the transfer
+ *
+ * @return void
+ */
+void i2cModelComplete(i2cStatus_t status);
+
+/**
+ * @brief Copy the model counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void i2cModelGetStats(i2cModelStats_t *stats);
+
+#endif // __I2CMODEL_H__
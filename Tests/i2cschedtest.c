@@ -0,0 +1,268 @@
+/**
+ * @file i2cschedtest.c
+ * @brief Host test of the I2C scheduler against the I2C1 engine model
+ *
+ * Runs i2csched.c unchanged against i2cmodel.c and checks:
+ * - Priority order and refusal of a job that is already owned
+ * - A failed attempt waiting for its retry behind a higher priority
+ *   job reports I2C_PENDING and stays owned (i2cSchedBusy())
+ * - A bus error holds the queue until i2cSchedPoll() has recovered the
+ *   bus, then the job is retried, still I2C_PENDING meanwhile
+ * - A running job past its deadline is aborted, the bus recovered and
+ *   the job finished with I2C_ERR_TIMEOUT, retries left or not
+ * - Exhausted retries report the last error once, and an expired
+ *   queued job is finished without being started
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "i2csched.h"
+#include "i2cmodel.h"
+
+/** Deadline of the test jobs (us) */
+#define TEST_TIMEOUT_US     10000U
+
+static i2cJob_t testJobs[3];
+static uint32_t testDone[3];
+static i2cStatus_t testFinal[3];
+static uint32_t testFailures;
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * @param ok Condition
+ * @param what Description
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Job completion callback
+ *
+ * @param job Finished job
+ *
+ * @return void
+ */
+static void testOnDone(i2cJob_t *job)
+{
+    uint32_t i = (uint32_t)(job - testJobs);
+
+    testDone[i]++;
+    testFinal[i] = job->xfer.status;
+}
+
+/**
+ * @brief Reset the model and the scheduler, prepare the jobs
+ *
+ * @return void
+ */
+static void testSetup(void)
+{
+    i2cModelReset();
+    i2cSchedInit();
+
+    memset(testJobs, 0, sizeof(testJobs));
+    memset(testDone, 0, sizeof(testDone));
+
+    for(uint32_t i = 0; i < 3U; i++)
+    {
+        testJobs[i].xfer.addr = (uint8_t)(0x20U + i);
+        testJobs[i].priority = I2C_SCHED_PRIO_NORMAL;
+        testJobs[i].retries = 1;
+        testJobs[i].timeoutUs = TEST_TIMEOUT_US;
+        testJobs[i].done = testOnDone;
+    }
+}
+
+/**
+ * @brief Check which job is on the bus
+ *
+ * @param job Expected job, 0 for an idle engine
+ * @param what Description
+ *
+ * @return void
+ */
+static void testRunning(const i2cJob_t *job, const char *what)
+{
+    testCheck(i2cModelRunning() == (job ? &job->xfer : 0), what);
+}
+
+/**
+ * @brief Priority order and double submission
+ *
+ * @return void
+ */
+static void testOrder(void)
+{
+    testSetup();
+    testJobs[1].priority = I2C_SCHED_PRIO_LOW;
+    testJobs[2].priority = I2C_SCHED_PRIO_HIGH;
+
+    testCheck(i2cSchedSubmit(&testJobs[0]), "submit");
+    testCheck(i2cSchedSubmit(&testJobs[1]) && i2cSchedSubmit(&testJobs[2]), "submit queued jobs");
+    testCheck(!i2cSchedSubmit(&testJobs[0]) && !i2cSchedSubmit(&testJobs[1]),
+              "owned job refused");
+    testCheck(i2cSchedPending() == 3U, "three jobs pending");
+
+    testRunning(&testJobs[0], "first job started at once");
+    i2cModelComplete(I2C_OK);
+    testRunning(&testJobs[2], "high priority job next");
+    i2cModelComplete(I2C_OK);
+    testRunning(&testJobs[1], "low priority job last");
+    i2cModelComplete(I2C_OK);
+
+    testCheck((testDone[0] == 1U) && (testDone[1] == 1U) && (testDone[2] == 1U) &&
+              (testFinal[1] == I2C_OK), "every job done once");
+    testCheck(!i2cSchedBusy(&testJobs[1]) && (i2cSchedPending() == 0U), "queue empty");
+}
+
+/**
+ * @brief NACK retried behind a higher priority job
+ *
+ * @return void
+ */
+static void testRetryQueued(void)
+{
+    testSetup();
+    testJobs[1].priority = I2C_SCHED_PRIO_HIGH;
+
+    i2cSchedSubmit(&testJobs[0]);
+    i2cSchedSubmit(&testJobs[1]);
+
+    i2cModelComplete(I2C_ERR_NACK);
+    testRunning(&testJobs[1], "higher priority job overtakes the retry");
+    testCheck(testJobs[0].xfer.status == I2C_PENDING, "queued retry reports I2C_PENDING");
+    testCheck(i2cSchedBusy(&testJobs[0]) && !testDone[0], "queued retry still owned");
+
+    i2cModelComplete(I2C_OK);
+    testRunning(&testJobs[0], "retry started");
+    testCheck(testJobs[0].xfer.status == I2C_PENDING, "retry on the bus reports I2C_PENDING");
+    i2cModelComplete(I2C_OK);
+
+    testCheck((testDone[0] == 1U) && (testFinal[0] == I2C_OK), "retry succeeded");
+    testCheck(!i2cSchedBusy(&testJobs[0]), "job released");
+}
+
+/**
+ * @brief Bus error: queue held until i2cSchedPoll() recovers the bus
+ *
+ * @return void
+ */
+static void testBusRecovery(void)
+{
+    i2cModelStats_t model;
+    i2cSchedStats_t start;
+    i2cSchedStats_t stats;
+
+    testSetup();
+    i2cSchedGetStats(&start);
+
+    i2cSchedSubmit(&testJobs[0]);
+    i2cModelComplete(I2C_ERR_BUS);
+
+    testRunning(0, "nothing started before the recovery");
+    testCheck(testJobs[0].xfer.status == I2C_PENDING, "job waiting for recovery is I2C_PENDING");
+    testCheck(i2cSchedBusy(&testJobs[0]), "job waiting for recovery still owned");
+
+    /*A new job must wait behind the recovery too*/
+    i2cSchedSubmit(&testJobs[1]);
+    testRunning(0, "submission does not bypass the recovery");
+
+    i2cSchedPoll();
+    i2cModelGetStats(&model);
+    testCheck(model.recoveries == 1U, "bus recovered by the poll");
+    testRunning(&testJobs[0], "retry first after the recovery");
+    i2cModelComplete(I2C_OK);
+    testRunning(&testJobs[1], "then the queue");
+    i2cModelComplete(I2C_OK);
+
+    testCheck((testDone[0] == 1U) && (testFinal[0] == I2C_OK), "job done after the recovery");
+    testCheck((testDone[1] == 1U) && (testFinal[1] == I2C_OK), "queued job done");
+
+    i2cSchedGetStats(&stats);
+    testCheck(((stats.recoveries - start.recoveries) == 1U) && ((stats.retries - start.retries) == 1U),
+              "scheduler counters");
+}
+
+/**
+ * @brief Running job past its deadline: aborted, bus recovered
+ *
+ * @return void
+ */
+static void testDeadline(void)
+{
+    i2cModelStats_t model;
+
+    testSetup();
+    testJobs[0].retries = 3;
+
+    i2cSchedSubmit(&testJobs[0]);
+    i2cSchedSubmit(&testJobs[1]);
+
+    /*Out of time, so no retry despite the retries left*/
+    i2cModelAdvance(TEST_TIMEOUT_US);
+    i2cSchedPoll();
+
+    i2cModelGetStats(&model);
+    testCheck((model.aborts == 1U) && (model.recoveries == 1U), "abort and recovery");
+    testCheck((testDone[0] == 1U) && (testFinal[0] == I2C_ERR_TIMEOUT), "job timed out once");
+    testCheck((testDone[1] == 1U) && (testFinal[1] == I2C_ERR_TIMEOUT), "queued job expired too");
+    testCheck(!i2cSchedBusy(&testJobs[0]) && (i2cSchedPending() == 0U), "timed out jobs released");
+    testRunning(0, "nothing left to run");
+}
+
+/**
+ * @brief Retries exhausted and a queued job expiring
+ *
+ * @return void
+ */
+static void testErrors(void)
+{
+    testSetup();
+
+    i2cSchedSubmit(&testJobs[0]);
+    i2cSchedSubmit(&testJobs[1]);
+
+    i2cModelComplete(I2C_ERR_NACK);
+    testCheck(!testDone[0] && (testJobs[0].xfer.status == I2C_PENDING), "first NACK retried");
+    testRunning(&testJobs[0], "retry goes ahead of the same priority");
+    i2cModelComplete(I2C_ERR_NACK);
+    testCheck((testDone[0] == 1U) && (testFinal[0] == I2C_ERR_NACK), "second NACK reported once");
+    testCheck(!i2cSchedBusy(&testJobs[0]), "failed job released");
+
+    /*Job 1 is running; job 2 expires in the queue*/
+    i2cSchedSubmit(&testJobs[2]);
+    i2cModelAdvance(TEST_TIMEOUT_US + 1U);
+    i2cModelComplete(I2C_OK);
+
+    testCheck((testDone[1] == 1U) && (testFinal[1] == I2C_OK), "running job completes late");
+    testCheck((testDone[2] == 1U) && (testFinal[2] == I2C_ERR_TIMEOUT), "expired job not started");
+    testRunning(0, "engine idle");
+}
+
+int main(void)
+{
+    testOrder();
+    testRetryQueued();
+    testBusRecovery();
+    testDeadline();
+    testErrors();
+
+    printf("%s\n", testFailures ? "i2csched: FAILED" : "i2csched: OK");
+
+    return testFailures ? 1 : 0;
+}
@@ -0,0 +1,418 @@
+/**
+ * @file logstoretest.c
+ * @brief Host simulation of the log store on the flash model
+ *
+ * Runs logstore.c unchanged against flashmodel.c and reports:
+ * - Write amplification (bytes programmed / payload bytes) and erase
+ *   traffic for small and large records, with the log wrapping
+ * - Recovery time of logStoreMount() on a full log in simulated SPI
+ *   time, against a scan of every page
+ * - Consistency after power loss at random points: every record read
+ *   back is intact and in order, and the log keeps working
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include "logstore.h"
+#include "flashmodel.h"
+
+/** Main loop period between two appends (us) */
+#define TEST_LOOP_US            1000U
+
+/** Power-loss trials */
+#define TEST_CUT_TRIALS         100U
+
+/** Records appended after each recovery */
+#define TEST_AFTER_CUT_RECORDS  2000U
+
+/** Log capacity in bytes */
+#define TEST_LOG_BYTES          ((uint32_t)LOG_SECTOR_COUNT * SPI_FLASH_SECTOR_SIZE)
+
+static uint32_t testRand = 12345U;
+static uint32_t testNextSeq;
+static uint32_t testFailures;
+
+/**
+ * @brief xorshift32
+ *
+ * @return Pseudo-random value
+ */
+static uint32_t testRandom(void)
+{
+    testRand ^= testRand << 13;
+    testRand ^= testRand >> 17;
+    testRand ^= testRand << 5;
+    return testRand;
+}
+
+/**
+ * @brief Fill a record: 32-bit sequence number, then a pattern of it
+ *
+ * @param buf Destination
+ * @param seq Sequence number
+ * @param len Record length (>= 4)
+ *
+ * @return void
+ */
+static void testMakeRecord(uint8_t *buf, uint32_t seq, uint16_t len)
+{
+    buf[0] = (uint8_t)seq;
+    buf[1] = (uint8_t)(seq >> 8);
+    buf[2] = (uint8_t)(seq >> 16);
+    buf[3] = (uint8_t)(seq >> 24);
+
+    for(uint32_t i = 4; i < len; i++)
+    {
+        buf[i] = (uint8_t)((seq * 31U) + (i * 7U));
+    }
+}
+
+/**
+ * @brief Check a record read back
+ *
+ * @param buf Record
+ * @param len Length
+ * @param seq Decoded sequence number
+ *
+ * @return 1 if the pattern matches
+ */
+static uint8_t testCheckRecord(const uint8_t *buf, uint16_t len, uint32_t *seq)
+{
+    if(len < 4U)
+    {
+        return 0;
+    }
+
+    *seq = buf[0] | (buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+
+    for(uint32_t i = 4; i < len; i++)
+    {
+        if(buf[i] != (uint8_t)((*seq * 31U) + (i * 7U)))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief One main loop pass: poll the store and let time run
+ *
+ * @return void
+ */
+static void testLoop(void)
+{
+    logStorePoll();
+    flashModelAdvance(TEST_LOOP_US);
+}
+
+/**
+ * @brief Append one record, running the main loop while buffers are full
+ *
+ * @param minLen Shortest record
+ * @param maxLen Longest record
+ *
+ * @return void
+ */
+static void testAppend(uint16_t minLen, uint16_t maxLen)
+{
+    uint8_t buf[LOG_MAX_RECORD_SIZE];
+    uint16_t len = (uint16_t)(minLen + (testRandom() % (uint32_t)(maxLen - minLen + 1U)));
+
+    testMakeRecord(buf, testNextSeq, len);
+
+    while(logStoreAppend(buf, len) == LOG_ERR_FULL)
+    {
+        testLoop();
+    }
+
+    testNextSeq++;
+    testLoop();
+}
+
+/**
+ * @brief Flush the RAM page and run the main loop until the flash is idle
+ *
+ * @return void
+ */
+static void testDrain(void)
+{
+    /*The other buffer may still be waiting for the flash*/
+    while(logStoreFlush() == LOG_ERR_FULL)
+    {
+        testLoop();
+    }
+
+    for(uint32_t i = 0; i < 500U; i++)
+    {
+        testLoop();
+    }
+}
+
+/**
+ * @brief Read the whole log
+ *
+ * @param first First sequence number read
+ * @param last Last sequence number read
+ * @param contiguous Set to 0 if a sequence number is skipped
+ *
+ * @return Number of records, 0xFFFFFFFF if a record is corrupt or out of order
+ */
+static uint32_t testReadAll(uint32_t *first, uint32_t *last, uint8_t *contiguous)
+{
+    uint8_t buf[LOG_MAX_RECORD_SIZE];
+    logCursor_t cursor;
+    logStatus_t status;
+    uint32_t count = 0;
+    uint32_t seq;
+    uint16_t len;
+
+    *contiguous = 1;
+    logStoreCursorInit(&cursor);
+
+    while(1)
+    {
+        status = logStoreReadNext(&cursor, buf, sizeof(buf), &len);
+        if(status == LOG_BUSY)
+        {
+            flashModelAdvance(TEST_LOOP_US);
+            continue;
+        }
+        if(status != LOG_OK)
+        {
+            break;
+        }
+
+        if(!testCheckRecord(buf, len, &seq))
+        {
+            return 0xFFFFFFFFU;
+        }
+
+        if(count == 0U)
+        {
+            *first = seq;
+        }
+        else if(seq <= *last)
+        {
+            return 0xFFFFFFFFU;
+        }
+        else if(seq != (*last + 1U))
+        {
+            *contiguous = 0;
+        }
+
+        *last = seq;
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Report a failed check
+ *
+ * @param what Description
+ *
+ * @return void
+ */
+static void testFail(const char *what)
+{
+    printf("FAIL: %s\n", what);
+    testFailures++;
+}
+
+/**
+ * @brief Fill the log several times over and report the write cost
+ *
+ * @param minLen Shortest record
+ * @param maxLen Longest record
+ *
+ * @return void
+ */
+static void testWriteAmplification(uint16_t minLen, uint16_t maxLen)
+{
+    logStats_t start;
+    logStats_t stats;
+    flashModelStats_t flash;
+    uint32_t appended;
+    uint32_t programmed;
+    uint32_t erased;
+    uint32_t full;
+    uint32_t first = 0;
+    uint32_t last = 0;
+    uint32_t count;
+    uint8_t contiguous;
+
+    flashModelReset(1);
+    logStoreInit();
+    testNextSeq = 0;
+
+    /*Counters are not reset by a mount*/
+    logStoreGetStats(&start);
+
+    /*Three times the capacity, so the ring wraps and drops old sectors*/
+    do
+    {
+        testAppend(minLen, maxLen);
+        logStoreGetStats(&stats);
+    } while((stats.bytesAppended - start.bytesAppended) < (3U * TEST_LOG_BYTES));
+
+    testDrain();
+    logStoreGetStats(&stats);
+    flashModelGetStats(&flash);
+
+    appended = stats.bytesAppended - start.bytesAppended;
+    programmed = stats.bytesProgrammed - start.bytesProgrammed;
+    erased = (stats.sectorsErased - start.sectorsErased) * SPI_FLASH_SECTOR_SIZE;
+    full = stats.recordsDropped - start.recordsDropped;
+
+    printf("records %3u-%3u B: appended %8u B, programmed %8u B, WA %.3f, "
+           "erased %.3f B/B, max erases/sector %u, buffer-full retries %u\n",
+           minLen, maxLen, appended, programmed, (double)programmed / appended,
+           (double)erased / appended, flash.maxSectorErases, full);
+
+    count = testReadAll(&first, &last, &contiguous);
+    if((count == 0xFFFFFFFFU) || !contiguous || (last != (testNextSeq - 1U)))
+    {
+        testFail("read back after wrapping");
+    }
+}
+
+/**
+ * @brief Time a mount of a full log against a scan of every page
+ *
+ * @return void
+ */
+static void testRecoveryTime(void)
+{
+    flashModelStats_t before;
+    flashModelStats_t after;
+    logStats_t stats;
+    uint64_t scanNs;
+
+    /*Full log from the previous test would do, but start from a known state*/
+    flashModelReset(2);
+    logStoreInit();
+    testNextSeq = 0;
+    for(uint32_t i = 0; i < ((TEST_LOG_BYTES * 3U) / (2U * 40U)); i++)
+    {
+        testAppend(8, 64);
+    }
+    testDrain();
+
+    flashModelGetStats(&before);
+    logStoreMount();
+    flashModelGetStats(&after);
+    logStoreGetStats(&stats);
+
+    scanNs = (uint64_t)LOG_SECTOR_COUNT * (SPI_FLASH_SECTOR_SIZE / SPI_FLASH_PAGE_SIZE) *
+             (4U + SPI_FLASH_PAGE_SIZE) * FLASH_MODEL_BYTE_NS;
+
+    printf("recovery: %u summaries, %llu bus bytes, %.2f ms (full page scan %.2f ms, %.1fx)\n",
+           stats.mountHeaderReads,
+           (unsigned long long)(after.busBytes - before.busBytes),
+           (double)(after.timeNs - before.timeNs) / 1e6, (double)scanNs / 1e6,
+           (double)scanNs / (double)(after.timeNs - before.timeNs));
+
+    if(stats.mountHeaderReads != LOG_SECTOR_COUNT)
+    {
+        testFail("mount reads one summary per sector");
+    }
+}
+
+/**
+ * @brief Cut the power at random points, remount and check the log
+ *
+ * @return void
+ */
+static void testPowerLoss(void)
+{
+    flashModelStats_t flash;
+    logStats_t start;
+    logStats_t stats;
+    uint32_t first;
+    uint32_t last;
+    uint32_t count;
+    uint32_t cutSeq;
+    uint32_t lost = 0;
+    uint32_t crcErrors;
+    uint8_t contiguous;
+
+    logStoreGetStats(&start);
+
+    for(uint32_t trial = 0; trial < TEST_CUT_TRIALS; trial++)
+    {
+        flashModelReset(trial + 10U);
+        logStoreInit();
+        testNextSeq = 0;
+
+        /*Anywhere in the first one and a half fills*/
+        flashModelCutPowerAfter(testRandom() % ((TEST_LOG_BYTES / SPI_FLASH_PAGE_SIZE) * 3U));
+        while(!flashModelIsDead())
+        {
+            testAppend(8, 128);
+        }
+        cutSeq = testNextSeq;
+
+        /*Reboot*/
+        flashModelPowerOn();
+        logStoreMount();
+
+        first = 0;
+        last = 0;
+        count = testReadAll(&first, &last, &contiguous);
+        if(count == 0xFFFFFFFFU)
+        {
+            testFail("corrupt or reordered record after power loss");
+            continue;
+        }
+        if((count > 0U) && (last >= cutSeq))
+        {
+            testFail("record appended after the power loss was read");
+            continue;
+        }
+        lost += (count > 0U) ? (cutSeq - 1U - last) : cutSeq;
+
+        /*The log keeps working after recovery*/
+        for(uint32_t i = 0; i < TEST_AFTER_CUT_RECORDS; i++)
+        {
+            testAppend(8, 128);
+        }
+        testDrain();
+
+        count = testReadAll(&first, &last, &contiguous);
+        if((count == 0xFFFFFFFFU) || (last != (testNextSeq - 1U)))
+        {
+            testFail("log after recovery");
+        }
+    }
+
+    logStoreGetStats(&stats);
+    crcErrors = stats.crcErrors - start.crcErrors;
+
+    flashModelGetStats(&flash);
+    printf("power loss: %u trials, %.1f records lost per cut (RAM buffers and torn page), "
+           "%u torn records skipped\n",
+           TEST_CUT_TRIALS, (double)lost / TEST_CUT_TRIALS, crcErrors);
+}
+
+int main(void)
+{
+    printf("log store: %u sectors (%u KB)\n", LOG_SECTOR_COUNT, TEST_LOG_BYTES / 1024U);
+
+    testWriteAmplification(8, 32);
+    testWriteAmplification(32, 128);
+    testWriteAmplification(200, LOG_MAX_RECORD_SIZE);
+    testRecoveryTime();
+    testPowerLoss();
+
+    printf("%s\n", testFailures ? "logstore: FAILED" : "logstore: OK");
+
+    return testFailures ? 1 : 0;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file rtctimetest.c
+ * @brief Host test of the RTC calendar conversions against gmtime()
+ *
+ * Runs rtctime.c over the whole RTC range and compares it with the C
+ * library:
+ * - Every day of 2000-2099, at three times of day: epoch to fields,
+ *   weekday, fields back to epoch, day numbers both ways
+ * - TR/DR round trips: rtcRegsFromEpoch() against registers built from
+ *   the gmtime() fields, rtcEpochFromRegs() back to the same second
+ * - Millisecond conversions on the same days
+ * - Every second of 2024-02-29 and the first and last second of the
+ *   range
+ * - All 100 BCD codes both ways and the invalid digits
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "rtctime.h"
+
+#define TEST_SECONDS_PER_DAY    86400U
+
+/** Days from 2000-01-01 to 2100-01-01 */
+#define TEST_DAYS               ((RTC_EPOCH_2100 - RTC_EPOCH_2000) / TEST_SECONDS_PER_DAY)
+
+/** Unix time of 2024-02-29 00:00:00 */
+#define TEST_LEAP_DAY           1709164800UL
+
+static uint32_t testFailures;
+static uint32_t testReported;
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * Only the first few failures of a run are printed.
+ *
+ * @param ok Condition
+ * @param what Description
+ * @param seconds Unix time under test
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what, uint32_t seconds)
+{
+    if(!ok)
+    {
+        if(testReported < 20U)
+        {
+            printf("FAIL: %s at %u\n", what, seconds);
+            testReported++;
+        }
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Binary to BCD without the table
+ *
+ * @param v 0-99
+ *
+ * @return BCD byte
+ */
+static uint32_t testBcd(uint32_t v)
+{
+    return ((v / 10U) << 4) | (v % 10U);
+}
+
+/**
+ * @brief Check every conversion at one Unix time
+ *
+ * @param seconds RTC_EPOCH_2000 to RTC_EPOCH_2100 - 1
+ * @param ms Milliseconds added for the 64-bit conversions
+ *
+ * @return void
+ */
+static void testSecond(uint32_t seconds, uint16_t ms)
+{
+    time_t t = (time_t)seconds;
+    struct tm tm;
+    rtcDateTime_t dt;
+    rtcDateTime_t day;
+    uint32_t weekDay;
+    uint32_t tr;
+    uint32_t dr;
+    uint32_t expTr;
+    uint32_t expDr;
+    uint64_t epochMs = ((uint64_t)seconds * 1000U) + ms;
+
+    gmtime_r(&t, &tm);
+
+    /*tm_wday 0 = Sunday, RTC 7 = Sunday*/
+    weekDay = tm.tm_wday ? (uint32_t)tm.tm_wday : 7U;
+
+    rtcDateTimeFromEpoch(seconds, &dt);
+    testCheck((dt.year == (tm.tm_year - 100)) && (dt.month == (tm.tm_mon + 1)) &&
+              (dt.day == tm.tm_mday), "date", seconds);
+    testCheck(dt.weekDay == weekDay, "weekday", seconds);
+    testCheck((dt.hours == tm.tm_hour) && (dt.minutes == tm.tm_min) &&
+              (dt.seconds == tm.tm_sec), "time", seconds);
+    testCheck((dt.subSeconds == 0U) && (dt.millis == 0U), "sub-second fields cleared", seconds);
+    testCheck(rtcEpochFromDateTime(&dt) == seconds, "fields back to epoch", seconds);
+
+    testCheck(rtcDaysFromCivil(1900U + tm.tm_year, tm.tm_mon + 1U, tm.tm_mday) ==
+              (seconds / TEST_SECONDS_PER_DAY), "days from civil", seconds);
+    rtcCivilFromDays(seconds / TEST_SECONDS_PER_DAY, &day);
+    testCheck((day.year == dt.year) && (day.month == dt.month) && (day.day == dt.day) &&
+              (day.weekDay == dt.weekDay), "civil from days", seconds);
+
+    /*Registers from the gmtime() fields*/
+    expTr = (testBcd(tm.tm_hour) << 16) | (testBcd(tm.tm_min) << 8) | testBcd(tm.tm_sec);
+    expDr = (testBcd(tm.tm_year - 100) << 16) | (weekDay << 13) | (testBcd(tm.tm_mon + 1) << 8) |
+            testBcd(tm.tm_mday);
+
+    rtcRegsFromEpoch(seconds, &tr, &dr);
+    testCheck((tr == expTr) && (dr == expDr), "epoch to TR/DR", seconds);
+    testCheck(rtcEpochFromRegs(expTr, expDr) == seconds, "TR/DR to epoch", seconds);
+
+    rtcDateTimeFromEpochMs(epochMs, &dt);
+    testCheck((rtcEpochFromDateTime(&dt) == seconds) && (dt.millis == ms), "epoch ms to fields",
+              seconds);
+    testCheck(rtcEpochMsFromDateTime(&dt) == epochMs, "fields back to epoch ms", seconds);
+}
+
+/**
+ * @brief Every day of the range at three times of day
+ *
+ * @return void
+ */
+static void testDays(void)
+{
+    uint32_t midnight;
+
+    for(uint32_t d = 0; d < TEST_DAYS; d++)
+    {
+        midnight = RTC_EPOCH_2000 + (d * TEST_SECONDS_PER_DAY);
+
+        testSecond(midnight, 0);
+        testSecond(midnight + ((d * 7919U) % TEST_SECONDS_PER_DAY), (uint16_t)((d * 37U) % 1000U));
+        testSecond(midnight + TEST_SECONDS_PER_DAY - 1U, 999);
+    }
+
+    printf("rtctime: %u days from 2000-01-01 to 2099-12-31\n", (uint32_t)TEST_DAYS);
+}
+
+/**
+ * @brief Every second of a leap day and the range limits
+ *
+ * @return void
+ */
+static void testTimes(void)
+{
+    for(uint32_t s = 0; s < TEST_SECONDS_PER_DAY; s++)
+    {
+        testSecond(TEST_LEAP_DAY + s, (uint16_t)(s % 1000U));
+    }
+
+    testSecond(RTC_EPOCH_2000, 0);
+    testSecond(RTC_EPOCH_2100 - 1U, 999);
+}
+
+/**
+ * @brief BCD tables
+ *
+ * @return void
+ */
+static void testBcdTables(void)
+{
+    for(uint32_t v = 0; v < 100U; v++)
+    {
+        testCheck(rtcBcdEncode(v) == testBcd(v), "bcd encode", v);
+        testCheck(rtcBcdDecode(testBcd(v)) == v, "bcd decode", v);
+    }
+
+    for(uint32_t b = 0; b < 256U; b++)
+    {
+        if(((b & 0x0FU) > 9U) || ((b >> 4) > 9U))
+        {
+            testCheck(rtcBcdDecode(b) == 0U, "invalid bcd digits decode to 0", b);
+        }
+    }
+}
+
+int main(void)
+{
+    testBcdTables();
+    testDays();
+    testTimes();
+
+    printf("%s\n", testFailures ? "rtctime: FAILED" : "rtctime: OK");
+
+    return testFailures ? 1 : 0;
+}
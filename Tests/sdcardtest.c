@@ -0,0 +1,326 @@
+/**
+ * @file sdcardtest.c
+ * @brief Host test of the SD card protocol against the card model
+ *
+ * Runs sdcard.c unchanged against sdmodel.c and checks:
+ * - Identification of an SDHC and a version 1.x SDSC card (command
+ *   sequence, capacity from the CSD, switch to the 4-bit bus)
+ * - CMD17 and CMD18 reads, block and byte addressing
+ * - ACMD23 + CMD25 writes, one-shot and streamed, with the queue full
+ * - Error paths: no card, bad CMD8 echo, card that never powers up,
+ *   command CRC, out-of-range address, data CRC on read and write,
+ *   calls in the wrong state
+ *
+ * Exit status is 0 when every check passes.
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdcard.h"
+#include "sdmodel.h"
+
+#define TEST_BLOCKS     16U
+
+static uint32_t testFailures;
+static uint32_t testWords[2][(TEST_BLOCKS * SD_BLOCK_SIZE) / 4U];
+
+/**
+ * @brief Check a condition and report it when false
+ *
+ * @param ok Condition
+ * @param what Description
+ *
+ * @return void
+ */
+static void testCheck(int ok, const char *what)
+{
+    if(!ok)
+    {
+        printf("FAIL: %s\n", what);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief Fill blocks with a pattern of their block number and a seed
+ *
+ * @param buf Destination
+ * @param lba First block number
+ * @param blocks Number of blocks
+ * @param seed Pattern seed
+ *
+ * @return void
+ */
+static void testFill(uint8_t *buf, uint32_t lba, uint32_t blocks, uint8_t seed)
+{
+    for(uint32_t b = 0; b < blocks; b++)
+    {
+        for(uint32_t i = 0; i < SD_BLOCK_SIZE; i++)
+        {
+            buf[(b * SD_BLOCK_SIZE) + i] = (uint8_t)((lba + b) * 7U + i + seed);
+        }
+    }
+}
+
+/**
+ * @brief Compare card blocks with the pattern
+ *
+ * @param lba First block number
+ * @param blocks Number of blocks
+ * @param seed Pattern seed
+ *
+ * @return 1 if every block matches
+ */
+static uint8_t testCardMatches(uint32_t lba, uint32_t blocks, uint8_t seed)
+{
+    uint8_t expect[SD_BLOCK_SIZE];
+
+    for(uint32_t b = 0; b < blocks; b++)
+    {
+        testFill(expect, lba + b, 1, seed);
+        if(memcmp(sdModelBlock(lba + b), expect, SD_BLOCK_SIZE) != 0)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Identification, then read and write on one card type
+ *
+ * @param type Card type
+ * @param name Label
+ *
+ * @return void
+ */
+static void testCard(sdModelType_t type, const char *name)
+{
+    uint8_t *out = (uint8_t *)testWords[0];
+    uint8_t *in = (uint8_t *)testWords[1];
+    sdModelStats_t model;
+    sdStats_t stats;
+    char what[80];
+
+    sdModelReset(type);
+
+    snprintf(what, sizeof(what), "%s: init", name);
+    testCheck(sdInit() == SD_OK, what);
+    sdModelGetStats(&model);
+
+    snprintf(what, sizeof(what), "%s: capacity from the CSD", name);
+    testCheck(sdGetBlockCount() == SD_MODEL_BLOCKS, what);
+    snprintf(what, sizeof(what), "%s: 4-bit bus at 24 MHz on both sides", name);
+    testCheck(model.wideCard && model.wideHost && (model.clkdiv == SDIO_CLKDIV_TRANSFER), what);
+    snprintf(what, sizeof(what), "%s: identification sequence", name);
+    testCheck((model.cmd[0] == 1U) && (model.cmd[2] == 1U) && (model.cmd[3] == 1U) &&
+              (model.cmd[9] == 1U) && (model.cmd[7] == 1U) && (model.cmd[16] == 1U) &&
+              (model.cmd[8] == ((type == SD_MODEL_SDHC) ? 1U : 0U)) &&
+              (model.acmd[41] >= 1U) && (model.acmd[6] == 1U), what);
+
+    /*One-shot write: ACMD23 with the length, CMD25, CMD12, then SEND_STATUS*/
+    testFill(out, 100, TEST_BLOCKS, 1);
+    snprintf(what, sizeof(what), "%s: write blocks", name);
+    testCheck(sdWriteBlocks(100, out, TEST_BLOCKS) == SD_OK, what);
+    sdModelGetStats(&model);
+    snprintf(what, sizeof(what), "%s: ACMD23 pre-erase + CMD25 + CMD12 + CMD13 busy polls", name);
+    testCheck((model.acmd[23] == 1U) && (model.preErase == TEST_BLOCKS) && (model.cmd[25] == 1U) &&
+              (model.cmd[12] == 1U) && (model.cmd[13] == (SD_MODEL_PROGRAM_POLLS + 1U)), what);
+    snprintf(what, sizeof(what), "%s: written data at the right blocks", name);
+    testCheck(testCardMatches(100, TEST_BLOCKS, 1) && (sdModelBlock(99)[0] == 0xFFU) &&
+              (sdModelBlock(100 + TEST_BLOCKS)[0] == 0xFFU), what);
+
+    /*CMD18 + CMD12*/
+    memset(in, 0, TEST_BLOCKS * SD_BLOCK_SIZE);
+    snprintf(what, sizeof(what), "%s: CMD18 read", name);
+    testCheck((sdReadBlocks(100, in, TEST_BLOCKS) == SD_OK) &&
+              (memcmp(in, out, TEST_BLOCKS * SD_BLOCK_SIZE) == 0), what);
+    sdModelGetStats(&model);
+    snprintf(what, sizeof(what), "%s: CMD18 ends with CMD12", name);
+    testCheck((model.cmd[18] == 1U) && (model.cmd[12] == 2U), what);
+
+    /*CMD17: no STOP_TRANSMISSION*/
+    memset(in, 0, SD_BLOCK_SIZE);
+    snprintf(what, sizeof(what), "%s: CMD17 read", name);
+    testCheck((sdReadBlocks(105, in, 1) == SD_OK) &&
+              (memcmp(in, &out[5U * SD_BLOCK_SIZE], SD_BLOCK_SIZE) == 0), what);
+    sdModelGetStats(&model);
+    snprintf(what, sizeof(what), "%s: CMD17 without CMD12", name);
+    testCheck((model.cmd[17] == 1U) && (model.cmd[12] == 2U), what);
+
+    /*Only CMD8 on the version 1.x card goes unanswered*/
+    snprintf(what, sizeof(what), "%s: no illegal command", name);
+    testCheck(model.illegal == ((type == SD_MODEL_SDHC) ? 0U : 1U), what);
+
+    sdGetStats(&stats);
+    snprintf(what, sizeof(what), "%s: driver counters", name);
+    testCheck((stats.blocksWritten >= TEST_BLOCKS) && (stats.blocksRead >= TEST_BLOCKS + 1U), what);
+
+    printf("%s: init %u ACMD41 polls, %u ms delay, %u illegal commands\n",
+           name, model.acmd[41], model.delayMs, model.illegal);
+}
+
+/**
+ * @brief Open-ended write stream with the queue full
+ *
+ * @return void
+ */
+static void testStream(void)
+{
+    uint8_t *buf[2] = {(uint8_t *)testWords[0], (uint8_t *)testWords[1]};
+    uint32_t lba = 2000;
+    uint32_t waits = 0;
+    sdModelStats_t model;
+    sdStats_t before;
+    sdStats_t stats;
+
+    sdModelReset(SD_MODEL_SDHC);
+    testCheck(sdInit() == SD_OK, "stream: init");
+    sdGetStats(&before);
+
+    testCheck(sdStreamOpen(lba, 64) == SD_OK, "stream: open");
+    sdModelGetStats(&model);
+    testCheck(model.preErase == 64U, "stream: ACMD23 applied to CMD25");
+
+    /*Both slots taken while the interrupt is held off*/
+    sdModelMaskIrq(1);
+    testFill(buf[0], lba, 4, 2);
+    testFill(buf[1], lba + 4U, 4, 2);
+    testCheck(sdStreamSubmit(buf[0], 4) == SD_OK, "stream: first buffer");
+    testCheck(sdStreamSubmit(buf[1], 4) == SD_OK, "stream: second buffer");
+    testCheck(sdStreamSlotsFree() == 0U, "stream: no slot free");
+    testCheck(sdStreamSubmit(buf[0], 4) == SD_BUSY, "stream: queue full");
+    testCheck(sdStreamSubmit(buf[0], 0) == SD_ERR_STATE, "stream: empty buffer refused");
+    sdModelMaskIrq(0);
+    lba += 8U;
+
+    /*Double buffering: the oldest buffer is free again once a slot is*/
+    for(uint32_t n = 0; n < 32U; n++)
+    {
+        if(sdStreamSlotsFree() == 0U)
+        {
+            waits++;
+            while(sdStreamSlotsFree() == 0U){}
+        }
+        testFill(buf[n & 1U], lba, 4, 2);
+        testCheck(sdStreamSubmit(buf[n & 1U], 4) == SD_OK, "stream: submit");
+        lba += 4U;
+    }
+
+    testCheck(sdStreamClose() == SD_OK, "stream: close");
+    testCheck(testCardMatches(2000, lba - 2000U, 2), "stream: data on the card");
+
+    sdGetStats(&stats);
+    sdModelGetStats(&model);
+    testCheck((stats.blocksWritten - before.blocksWritten) == (lba - 2000U), "stream: blocks counted");
+    testCheck((stats.queueFull - before.queueFull) >= 1U, "stream: SD_BUSY counted");
+    testCheck((model.cmd[25] == 1U) && (model.cmd[12] == 1U), "stream: one CMD25 for the session");
+
+    printf("stream: %u blocks in %u data interrupts, one CMD25, %u waits on a full queue\n",
+           lba - 2000U, model.dataIrqs, waits);
+}
+
+/**
+ * @brief Failures of the card or the bus
+ *
+ * @return void
+ */
+static void testErrors(void)
+{
+    uint8_t *buf = (uint8_t *)testWords[0];
+    sdModelStats_t model;
+    sdStats_t before;
+    sdStats_t mark;
+    sdStats_t stats;
+
+    /*Identification*/
+    sdModelReset(SD_MODEL_SDHC);
+    sdModelSetPresent(0);
+    testCheck(sdInit() == SD_ERR_NO_CARD, "no card");
+
+    sdModelReset(SD_MODEL_SDHC);
+    sdModelSetIfCondEcho(0x55);
+    testCheck(sdInit() == SD_ERR_UNSUPPORTED, "wrong CMD8 check pattern");
+
+    sdModelReset(SD_MODEL_SDHC);
+    sdModelSetPowerUpPolls(0xFFFFFFFFU);
+    testCheck(sdInit() == SD_ERR_UNSUPPORTED, "card never powers up");
+    sdModelGetStats(&model);
+    testCheck(model.acmd[41] == SD_INIT_TRIES, "ACMD41 retried SD_INIT_TRIES times");
+
+    sdModelReset(SD_MODEL_SDHC);
+    sdModelFailCommand(9);
+    testCheck(sdInit() == SD_ERR_CMD, "CRC error on CMD9");
+
+    /*Not initialized: every transfer refused*/
+    testCheck(sdReadBlocks(0, buf, 1) == SD_ERR_STATE, "read before init");
+    testCheck(sdStreamOpen(0, 0) == SD_ERR_STATE, "stream before init");
+
+    sdModelReset(SD_MODEL_SDHC);
+    testCheck(sdInit() == SD_OK, "errors: init");
+    sdGetStats(&before);
+
+    /*State checks*/
+    testCheck(sdStreamSubmit(buf, 1) == SD_ERR_STATE, "submit without a stream");
+    testCheck(sdStreamClose() == SD_ERR_STATE, "close without a stream");
+    testCheck(sdReadBlocks(0, buf, 0) == SD_ERR_STATE, "zero block read");
+    testCheck(sdStreamOpen(10, 0) == SD_OK, "open for the state check");
+    testCheck(sdReadBlocks(0, buf, 1) == SD_ERR_STATE, "read while streaming");
+    testCheck(sdStreamOpen(10, 0) == SD_ERR_STATE, "second open");
+    testCheck(sdStreamClose() == SD_OK, "close an empty stream");
+
+    /*Out of range: the command fails, the armed data path is dropped*/
+    testCheck(sdReadBlocks(SD_MODEL_BLOCKS, buf, 2) == SD_ERR_CMD, "read out of range");
+    testCheck(sdStreamOpen(SD_MODEL_BLOCKS + 5U, 0) == SD_ERR_CMD, "write out of range");
+    testCheck(sdReadBlocks(0, buf, 2) == SD_OK, "read after the range error");
+
+    /*Data CRC on the third block of a read*/
+    sdModelFailData(2);
+    testCheck(sdReadBlocks(0, buf, 4) == SD_ERR_DATA, "data CRC on read");
+    testCheck(sdReadBlocks(0, buf, 4) == SD_OK, "read after the data error");
+
+    /*Data CRC in the middle of a stream: later submits and the close fail*/
+    testFill(buf, 300, 4, 3);
+    testCheck(sdStreamOpen(300, 8) == SD_OK, "stream for the data error");
+    sdModelFailData(5);
+    sdGetStats(&mark);
+    testCheck(sdStreamSubmit(buf, 4) == SD_OK, "first buffer before the error");
+    while(sdStreamSlotsFree() < SD_STREAM_SLOTS){}
+    testCheck(sdStreamSubmit(buf, 4) == SD_OK, "buffer hitting the error");
+    do
+    {
+        sdGetStats(&stats);
+    } while(stats.dataErrors == mark.dataErrors);
+    testCheck(sdStreamSubmit(buf, 4) == SD_ERR_DATA, "submit after the data error");
+    testCheck(sdStreamClose() == SD_ERR_DATA, "close reports the data error");
+    testCheck(testCardMatches(300, 4, 3), "blocks before the error stored");
+
+    /*Card still usable*/
+    testCheck(sdReadBlocks(300, buf, 2) == SD_OK, "read after the errors");
+
+    sdGetStats(&stats);
+    testCheck((stats.dataErrors - before.dataErrors) == 2U, "data errors counted");
+
+    /*CRC error on the SEND_STATUS poll after the stop (leaves the card busy)*/
+    testCheck(sdStreamOpen(400, 0) == SD_OK, "stream for the status error");
+    testCheck(sdStreamSubmit(buf, 1) == SD_OK, "status error: submit");
+    sdModelFailCommand(13);
+    testCheck(sdStreamClose() == SD_ERR_CMD, "CRC error on SEND_STATUS");
+}
+
+int main(void)
+{
+    testCard(SD_MODEL_SDHC, "SDHC");
+    testCard(SD_MODEL_SDSC_V1, "SDSC v1");
+    testStream();
+    testErrors();
+
+    printf("%s\n", testFailures ? "sdcard: FAILED" : "sdcard: OK");
+
+    return testFailures ? 1 : 0;
+}
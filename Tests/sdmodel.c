@@ -0,0 +1,680 @@
+/**
+ * @file sdmodel.c
+ * @brief SD card model implementation
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "sdmodel.h"
+#include "systick.h"
+
+#define SD_MODEL_BLOCK_SIZE     512U
+
+/*Card states as reported in R1 bits 12:9*/
+#define SD_MODEL_IDLE           0U
+#define SD_MODEL_READY          1U
+#define SD_MODEL_IDENT          2U
+#define SD_MODEL_STBY           3U
+#define SD_MODEL_TRAN           4U
+#define SD_MODEL_DATA           5U
+#define SD_MODEL_RCV            6U
+#define SD_MODEL_PRG            7U
+
+/*R1 bits*/
+#define R1_OUT_OF_RANGE         (1U<<31)
+#define R1_ADDRESS_ERROR        (1U<<30)
+#define R1_BLOCK_LEN_ERROR      (1U<<29)
+#define R1_READY_FOR_DATA       (1U<<8)
+#define R1_APP_CMD              (1U<<5)
+
+/*OCR*/
+#define OCR_VOLTAGES            0x00FF8000U
+#define OCR_CCS                 (1U<<30)
+#define OCR_POWER_UP            (1U<<31)
+
+static uint8_t sdMem[SD_MODEL_BLOCKS][SD_MODEL_BLOCK_SIZE];
+static sdModelType_t sdType;
+static sdModelStats_t sdStats;
+
+/*Card side*/
+static volatile uint32_t sdCardState;
+static uint8_t sdPresent;
+static uint8_t sdAppNext;
+static uint8_t sdPreEraseNext;
+static uint32_t sdPreEraseCount;
+static uint32_t sdPowerUpPolls;
+static uint32_t sdIfCondEcho;
+static uint32_t sdBusyPolls;
+static uint32_t sdFailCommand;
+static uint32_t sdFailBlock;
+static uint8_t sdFailBlockArmed;
+static volatile uint32_t sdDataLba;
+static volatile uint8_t sdDataSingle;
+
+/*Host side*/
+static volatile uint8_t sdArmed;
+static uint8_t *volatile sdArmedBuf;
+static volatile uint32_t sdArmedBlocks;
+static volatile uint8_t sdArmedToCard;
+static volatile uint8_t sdIrqMasked;
+static volatile sdioDataCallback_t sdCallback;
+static uint8_t sdTimerStarted;
+
+/**
+ * @brief SIGALRM handler: the data interrupt
+ *
+ * @return void
+ */
+static void sdModelTimer(int sig)
+{
+    (void)sig;
+
+    if(sdArmed && !sdIrqMasked)
+    {
+        SDIO_IRQHandler();
+    }
+}
+
+/**
+ * @brief Start the periodic data interrupt once
+ *
+ * @return void
+ */
+static void sdModelStartTimer(void)
+{
+    struct sigaction sa;
+    struct itimerval period;
+
+    if(sdTimerStarted)
+    {
+        return;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sdModelTimer;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGALRM, &sa, 0);
+
+    period.it_interval.tv_sec = 0;
+    period.it_interval.tv_usec = SD_MODEL_IRQ_US;
+    period.it_value = period.it_interval;
+    setitimer(ITIMER_REAL, &period, 0);
+
+    sdTimerStarted = 1;
+}
+
+/**
+ * @brief R1 card status in the current state
+ *
+ * @return Status word
+ */
+static uint32_t sdModelR1(void)
+{
+    uint32_t r1 = sdCardState << 9;
+
+    if((sdCardState == SD_MODEL_TRAN) || (sdCardState == SD_MODEL_RCV))
+    {
+        r1 |= R1_READY_FOR_DATA;
+    }
+    if(sdAppNext)
+    {
+        r1 |= R1_APP_CMD;
+    }
+
+    return r1;
+}
+
+/**
+ * @brief Translate a data command argument into a block number
+ *
+ * @param arg Command argument
+ * @param lba Block number
+ *
+ * @return 0 or the R1 error bits
+ */
+static uint32_t sdModelAddress(uint32_t arg, uint32_t *lba)
+{
+    if(sdType == SD_MODEL_SDSC_V1)
+    {
+        if(arg % SD_MODEL_BLOCK_SIZE)
+        {
+            return R1_ADDRESS_ERROR;
+        }
+        arg /= SD_MODEL_BLOCK_SIZE;
+    }
+
+    if(arg >= SD_MODEL_BLOCKS)
+    {
+        return R1_OUT_OF_RANGE;
+    }
+
+    *lba = arg;
+    return 0;
+}
+
+/**
+ * @brief Fill the CSD for the card type
+ *
+ * @param csd RESP1-RESP4 (bits 127-0)
+ *
+ * @return void
+ */
+static void sdModelCsd(uint32_t *csd)
+{
+    uint32_t cSize;
+
+    memset(csd, 0, 4U * sizeof(uint32_t));
+
+    if(sdType == SD_MODEL_SDHC)
+    {
+        /*CSD 2.0: capacity = (C_SIZE + 1) * 512 KB*/
+        cSize = (SD_MODEL_BLOCKS / 1024U) - 1U;
+        csd[0] = 1U << 30;
+        csd[1] = (cSize >> 16) & 0x3FU;
+        csd[2] = (cSize & 0xFFFFU) << 16;
+    }
+    else
+    {
+        /*CSD 1.0: READ_BL_LEN = 9, C_SIZE_MULT = 0, (C_SIZE + 1) * 4 blocks*/
+        cSize = (SD_MODEL_BLOCKS / 4U) - 1U;
+        csd[1] = (9U << 16) | (cSize >> 2);
+        csd[2] = (cSize & 0x3U) << 30;
+    }
+}
+
+/**
+ * @brief Execute a command on the card
+ *
+ * @param index Command index
+ * @param arg Argument
+ * @param resp Response buffer (4 words)
+ *
+ * @return 1 if the card answers, 0 if the command is illegal in this state
+ */
+static uint8_t sdModelExecute(uint8_t index, uint32_t arg, uint32_t *resp)
+{
+    uint8_t app = sdAppNext;
+    uint8_t preErase = sdPreEraseNext;
+    uint32_t state = sdCardState;
+    uint32_t lba = 0;
+    uint32_t err;
+
+    /*ACMD prefix and ACMD23 only apply to the very next command*/
+    sdAppNext = 0;
+    sdPreEraseNext = 0;
+
+    if(app)
+    {
+        switch(index)
+        {
+            case 41:
+                if((state != SD_MODEL_IDLE) && (state != SD_MODEL_READY))
+                {
+                    return 0;
+                }
+                /*An SDHC card never powers up for a host without HCS*/
+                if(sdPowerUpPolls && (sdPowerUpPolls != 0xFFFFFFFFU))
+                {
+                    sdPowerUpPolls--;
+                }
+                if((sdPowerUpPolls == 0U) && ((sdType != SD_MODEL_SDHC) || (arg & OCR_CCS)))
+                {
+                    sdCardState = SD_MODEL_READY;
+                    resp[0] = OCR_POWER_UP | OCR_VOLTAGES | ((sdType == SD_MODEL_SDHC) ? OCR_CCS : 0U);
+                }
+                else
+                {
+                    resp[0] = OCR_VOLTAGES;
+                }
+                sdStats.acmd[index]++;
+                return 1;
+
+            case 6:
+                if(state != SD_MODEL_TRAN)
+                {
+                    return 0;
+                }
+                resp[0] = sdModelR1();
+                sdStats.wideCard = (arg == 2U);
+                sdStats.acmd[index]++;
+                return 1;
+
+            case 23:
+                if(state != SD_MODEL_TRAN)
+                {
+                    return 0;
+                }
+                resp[0] = sdModelR1();
+                sdPreEraseNext = 1;
+                sdPreEraseCount = arg & 0x7FFFFFU;
+                sdStats.acmd[index]++;
+                return 1;
+
+            default:
+                /*Not an application command: handled as a normal one*/
+                break;
+        }
+    }
+
+    switch(index)
+    {
+        case 0:
+            sdCardState = SD_MODEL_IDLE;
+            sdBusyPolls = 0;
+            break;
+
+        case 8:
+            if((state != SD_MODEL_IDLE) || (sdType == SD_MODEL_SDSC_V1))
+            {
+                return 0;
+            }
+            resp[0] = (arg & 0xF00U) | (sdIfCondEcho ? (sdIfCondEcho & 0xFFU) : (arg & 0xFFU));
+            break;
+
+        case 55:
+            if((state != SD_MODEL_IDLE) && ((arg >> 16) != ((state == SD_MODEL_READY) ? 0U : SD_MODEL_RCA)))
+            {
+                return 0;
+            }
+            sdAppNext = 1;
+            resp[0] = sdModelR1();
+            break;
+
+        case 2:
+            if(state != SD_MODEL_READY)
+            {
+                return 0;
+            }
+            resp[0] = 0x03534453U;
+            resp[1] = 0x4D4F4445U;
+            resp[2] = 0x4C100000U;
+            resp[3] = 0x00000001U;
+            sdCardState = SD_MODEL_IDENT;
+            break;
+
+        case 3:
+            if((state != SD_MODEL_IDENT) && (state != SD_MODEL_STBY))
+            {
+                return 0;
+            }
+            sdCardState = SD_MODEL_STBY;
+            resp[0] = (SD_MODEL_RCA << 16) | (SD_MODEL_STBY << 9);
+            break;
+
+        case 9:
+            if((state != SD_MODEL_STBY) || ((arg >> 16) != SD_MODEL_RCA))
+            {
+                return 0;
+            }
+            sdModelCsd(resp);
+            break;
+
+        case 7:
+            if((state != SD_MODEL_STBY) || ((arg >> 16) != SD_MODEL_RCA))
+            {
+                return 0;
+            }
+            resp[0] = sdModelR1();
+            sdCardState = SD_MODEL_TRAN;
+            break;
+
+        case 13:
+            if((state < SD_MODEL_STBY) || ((arg >> 16) != SD_MODEL_RCA))
+            {
+                return 0;
+            }
+            resp[0] = sdModelR1();
+            if((state == SD_MODEL_PRG) && (--sdBusyPolls == 0U))
+            {
+                sdCardState = SD_MODEL_TRAN;
+            }
+            break;
+
+        case 16:
+            if(state != SD_MODEL_TRAN)
+            {
+                return 0;
+            }
+            resp[0] = sdModelR1() | ((arg != SD_MODEL_BLOCK_SIZE) ? R1_BLOCK_LEN_ERROR : 0U);
+            break;
+
+        case 17:
+        case 18:
+        case 25:
+            if(state != SD_MODEL_TRAN)
+            {
+                return 0;
+            }
+            err = sdModelAddress(arg, &lba);
+            resp[0] = sdModelR1() | err;
+            if(err)
+            {
+                break;
+            }
+            sdDataLba = lba;
+            sdDataSingle = (index == 17U);
+            if(index == 25U)
+            {
+                sdStats.preErase = preErase ? sdPreEraseCount : 0U;
+                sdCardState = SD_MODEL_RCV;
+            }
+            else
+            {
+                sdCardState = SD_MODEL_DATA;
+            }
+            break;
+
+        case 12:
+            if((state != SD_MODEL_DATA) && (state != SD_MODEL_RCV))
+            {
+                return 0;
+            }
+            resp[0] = sdModelR1();
+            if(state == SD_MODEL_RCV)
+            {
+                sdBusyPolls = SD_MODEL_PROGRAM_POLLS;
+                sdCardState = SD_MODEL_PRG;
+            }
+            else
+            {
+                sdCardState = SD_MODEL_TRAN;
+            }
+            break;
+
+        default:
+            return 0;
+    }
+
+    sdStats.cmd[index]++;
+    return 1;
+}
+
+/**
+ * @brief Power-cycle the card
+ *
+ * @return void
+ */
+void sdModelReset(sdModelType_t type)
+{
+    memset(sdMem, 0xFF, sizeof(sdMem));
+    memset(&sdStats, 0, sizeof(sdStats));
+
+    sdType = type;
+    sdCardState = SD_MODEL_IDLE;
+    sdPresent = 1;
+    sdAppNext = 0;
+    sdPreEraseNext = 0;
+    sdPowerUpPolls = 3;
+    sdIfCondEcho = 0;
+    sdBusyPolls = 0;
+    sdFailCommand = 0xFFFFFFFFU;
+    sdFailBlockArmed = 0;
+    sdArmed = 0;
+    sdIrqMasked = 0;
+
+    sdModelStartTimer();
+}
+
+/**
+ * @brief Remove or insert the card
+ *
+ * @return void
+ */
+void sdModelSetPresent(uint8_t present)
+{
+    sdPresent = present;
+}
+
+/**
+ * @brief Set the number of ACMD41 polls answered busy
+ *
+ * @return void
+ */
+void sdModelSetPowerUpPolls(uint32_t polls)
+{
+    sdPowerUpPolls = polls;
+}
+
+/**
+ * @brief Answer CMD8 with a wrong check pattern
+ *
+ * @return void
+ */
+void sdModelSetIfCondEcho(uint32_t echo)
+{
+    sdIfCondEcho = echo;
+}
+
+/**
+ * @brief Fail the next command with this index
+ *
+ * @return void
+ */
+void sdModelFailCommand(uint8_t index)
+{
+    sdFailCommand = index;
+}
+
+/**
+ * @brief Fail the transfer reaching the n-th next data block
+ *
+ * @return void
+ */
+void sdModelFailData(uint32_t block)
+{
+    sdFailBlock = block;
+    sdFailBlockArmed = 1;
+}
+
+/**
+ * @brief Mask or unmask the simulated data interrupt
+ *
+ * @return void
+ */
+void sdModelMaskIrq(uint8_t masked)
+{
+    sdIrqMasked = masked;
+}
+
+/**
+ * @brief Direct access to one block of the card
+ *
+ * @return Pointer to the block
+ */
+uint8_t *sdModelBlock(uint32_t lba)
+{
+    return sdMem[lba % SD_MODEL_BLOCKS];
+}
+
+/**
+ * @brief Copy the model counters
+ *
+ * @return void
+ */
+void sdModelGetStats(sdModelStats_t *stats)
+{
+    *stats = sdStats;
+}
+
+/**
+ * @brief Model of sdioInit(): 1-bit bus at 400 kHz
+ *
+ * @return void
+ */
+void sdioInit(void)
+{
+    sdStats.clkdiv = SDIO_CLKDIV_INIT;
+    sdStats.wideHost = 0;
+}
+
+/**
+ * @brief Model of sdioSetBus()
+ *
+ * @return void
+ */
+void sdioSetBus(uint8_t clkdiv, uint8_t wide)
+{
+    sdStats.clkdiv = clkdiv;
+    sdStats.wideHost = wide;
+}
+
+/**
+ * @brief Model of sdioSendCommand()
+ *
+ * @return SDIO_OK, SDIO_ERR_TIMEOUT or SDIO_ERR_CRC
+ */
+sdioStatus_t sdioSendCommand(uint8_t index, uint32_t arg, sdioResp_t resp, uint32_t *response)
+{
+    uint32_t words[4] = {0, 0, 0, 0};
+    uint8_t answered;
+
+    if(!sdPresent)
+    {
+        return (resp == SDIO_RESP_NONE) ? SDIO_OK : SDIO_ERR_TIMEOUT;
+    }
+
+    answered = sdModelExecute(index, arg, words);
+
+    if(!answered)
+    {
+        sdStats.illegal++;
+    }
+
+    if(resp == SDIO_RESP_NONE)
+    {
+        return SDIO_OK;
+    }
+    if(!answered)
+    {
+        return SDIO_ERR_TIMEOUT;
+    }
+    if(sdFailCommand == index)
+    {
+        sdFailCommand = 0xFFFFFFFFU;
+        return SDIO_ERR_CRC;
+    }
+
+    if(response)
+    {
+        response[0] = words[0];
+        if(resp == SDIO_RESP_LONG)
+        {
+            response[1] = words[1];
+            response[2] = words[2];
+            response[3] = words[3];
+        }
+    }
+
+    return SDIO_OK;
+}
+
+/**
+ * @brief Model of sdioStartData(): arm the transfer for the next interrupt
+ *
+ * @return void
+ */
+void sdioStartData(uint8_t *buf, uint32_t blocks, uint8_t toCard)
+{
+    sdArmedBuf = buf;
+    sdArmedBlocks = blocks;
+    sdArmedToCard = toCard;
+    sdArmed = 1;
+}
+
+/**
+ * @brief Model of sdioAbortData()
+ *
+ * @return void
+ */
+void sdioAbortData(void)
+{
+    sdArmed = 0;
+}
+
+/**
+ * @brief Model of sdioSetDataCallback()
+ *
+ * @return void
+ */
+void sdioSetDataCallback(sdioDataCallback_t callback)
+{
+    sdCallback = callback;
+}
+
+/**
+ * @brief Model of the SDIO interrupt: move the armed blocks, then report
+ *
+ * A read waits for the card to be sending (after CMD17/CMD18), a write
+ * for the card to be receiving (after CMD25).
+ *
+ * @return void
+ */
+void SDIO_IRQHandler(void)
+{
+    sdioStatus_t status = SDIO_OK;
+    sdioDataCallback_t callback = sdCallback;
+    uint32_t state = sdCardState;
+
+    if(sdArmedToCard ? (state != SD_MODEL_RCV) : (state != SD_MODEL_DATA))
+    {
+        return;
+    }
+
+    sdArmed = 0;
+    sdStats.dataIrqs++;
+
+    for(uint32_t i = 0; i < sdArmedBlocks; i++)
+    {
+        if(sdFailBlockArmed && (sdFailBlock-- == 0U))
+        {
+            sdFailBlockArmed = 0;
+            status = SDIO_ERR_CRC;
+            break;
+        }
+
+        if(sdDataLba >= SD_MODEL_BLOCKS)
+        {
+            status = SDIO_ERR_TIMEOUT;
+            break;
+        }
+
+        if(sdArmedToCard)
+        {
+            memcpy(sdMem[sdDataLba], &sdArmedBuf[i * SD_MODEL_BLOCK_SIZE], SD_MODEL_BLOCK_SIZE);
+            sdStats.blocksWritten++;
+        }
+        else
+        {
+            memcpy(&sdArmedBuf[i * SD_MODEL_BLOCK_SIZE], sdMem[sdDataLba], SD_MODEL_BLOCK_SIZE);
+            sdStats.blocksRead++;
+        }
+        sdDataLba++;
+    }
+
+    /*A single block read ends the data state by itself*/
+    if(sdDataSingle && !sdArmedToCard)
+    {
+        sdCardState = SD_MODEL_TRAN;
+    }
+
+    if(callback)
+    {
+        callback(status);
+    }
+}
+
+/**
+ * @brief Model of systickMsecDelay(): only counts
+ *
+ * @return void
+ */
+void systickMsecDelay(uint32_t delay)
+{
+    sdStats.delayMs += delay;
+}
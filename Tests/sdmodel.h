@@ -0,0 +1,159 @@
+/**
+ * @file sdmodel.h
+ * @brief SD card model replacing sdio.c (and the SysTick delay) in host tests
+ *
+ * Implements the sdio.h API on a simulated card, so sdcard.c runs
+ * unchanged on the host: the card follows the SD state machine
+ * (idle, ready, ident, stby, tran, data, rcv, prg) and answers each
+ * command with the response format and R1 status bits a real card uses.
+ *
+ * @details
+ * Card types:
+ * - SD_MODEL_SDHC: version 2.0 card, block addressing, CSD 2.0
+ * - SD_MODEL_SDSC_V1: version 1.x card, no answer to CMD8, byte
+ *   addressing, CSD 1.0
+ *
+ * Data interrupt: a POSIX interval timer (SIGALRM) calls SDIO_IRQHandler()
+ * every SD_MODEL_IRQ_US while a data transfer is armed, preempting the
+ * driver's wait loops like the SDIO interrupt does on the target. The
+ * handler moves all blocks of the armed transfer in one step and calls
+ * the data callback. sdModelMaskIrq() plays the part of PRIMASK.
+ *
+ * Illegal commands get no response (SDIO_ERR_TIMEOUT), as on a card.
+ * Errors can be injected on the card presence, CMD8 echo, ACMD41
+ * power-up, any command (response CRC) and any data block (data CRC).
+ *
+ * @author Bare Metal STM32
+ * @version 1.0
+ * @date 2026
+ */
+
+#ifndef __SDMODEL_H__
+#define __SDMODEL_H__
+
+#include <stdint.h>
+#include "sdio.h"
+
+/** Capacity of the simulated card in 512-byte blocks (8 MB) */
+#define SD_MODEL_BLOCKS         16384U
+
+/** Simulated data interrupt period (us) */
+#define SD_MODEL_IRQ_US         100U
+
+/** SEND_STATUS polls answered in the programming state after a write */
+#define SD_MODEL_PROGRAM_POLLS  3U
+
+/** Relative card address published with CMD3 */
+#define SD_MODEL_RCA            0x1234U
+
+/**
+ * @brief Simulated card type
+ */
+typedef enum
+{
+    SD_MODEL_SDHC = 0,      /**< SDHC, block addressing */
+    SD_MODEL_SDSC_V1        /**< SDSC version 1.x, byte addressing */
+} sdModelType_t;
+
+/**
+ * @brief Model counters
+ */
+typedef struct
+{
+    uint32_t cmd[64];           /**< Commands answered, by index */
+    uint32_t acmd[64];          /**< Application commands answered, by index */
+    uint32_t illegal;           /**< Commands not allowed in the card state */
+    uint32_t blocksRead;        /**< Blocks sent to the host */
+    uint32_t blocksWritten;     /**< Blocks stored */
+    uint32_t dataIrqs;          /**< Data interrupts raised */
+    uint32_t preErase;          /**< ACMD23 count applied to the last CMD25 */
+    uint32_t delayMs;           /**< Time spent in systickMsecDelay() */
+    uint8_t clkdiv;             /**< Last bus clock divider */
+    uint8_t wideHost;           /**< Controller on the 4-bit bus */
+    uint8_t wideCard;           /**< Card on the 4-bit bus (ACMD6) */
+} sdModelStats_t;
+
+/**
+ * @brief Power-cycle the card: new type, erased contents, no faults
+ *
+ * @param type Card type
+ *
+ * @return void
+ */
+void sdModelReset(sdModelType_t type);
+
+/**
+ * @brief Remove or insert the card (a removed card answers nothing)
+ *
+ * @param present 1 if inserted
+ *
+ * @return void
+ */
+void sdModelSetPresent(uint8_t present);
+
+/**
+ * @brief Set the number of ACMD41 polls answered busy
+ *
+ * @param polls Busy polls, 0xFFFFFFFF = never powers up
+ *
+ * @return void
+ */
+void sdModelSetPowerUpPolls(uint32_t polls);
+
+/**
+ * @brief Answer CMD8 with a wrong check pattern
+ *
+ * @param echo Value returned in R7 bits 11:0
+ *
+ * @return void
+ */
+void sdModelSetIfCondEcho(uint32_t echo);
+
+/**
+ * @brief Fail the next command with this index with a response CRC error
+ *
+ * @param index Command index
+ *
+ * @return void
+ */
+void sdModelFailCommand(uint8_t index);
+
+/**
+ * @brief Fail the transfer reaching the n-th next data block (data CRC)
+ *
+ * Blocks before it are transferred normally.
+ *
+ * @param block Data blocks that still succeed
+ *
+ * @return void
+ */
+void sdModelFailData(uint32_t block);
+
+/**
+ * @brief Mask or unmask the simulated data interrupt (like PRIMASK)
+ *
+ * @param masked 1 to hold the interrupt off
+ *
+ * @return void
+ */
+void sdModelMaskIrq(uint8_t masked);
+
+/**
+ * @brief Direct access to one block of the card
+ *
+ * @param lba Block number
+ *
+ * @return Pointer to SD_BLOCK_SIZE bytes
+ */
+uint8_t *sdModelBlock(uint32_t lba);
+
+/**
+ * @brief Copy the model counters
+ *
+ * @param[out] stats Destination
+ *
+ * @return void
+ */
+void sdModelGetStats(sdModelStats_t *stats);
+
+#endif // __SDMODEL_H__